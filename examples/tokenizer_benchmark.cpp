@@ -0,0 +1,94 @@
+/*
+ * Host benchmark for the program tokenizer.
+ *
+ * Compares the line classification of program_parser() before (up to six Regexp patterns per
+ * line) and after (tokenize_program_line(), one pass) on a large synthetic program.
+ * Runs on a computer, not on the ESP8266. Build and run from the root of the repository:
+ *
+ *   g++ -O2 -std=gnu++11 -Iinclude -Ilib/Regexp/src examples/tokenizer_benchmark.cpp \
+ *       src/tokenizer.cpp lib/Regexp/src/Regexp.cpp -o tokenizer_benchmark
+ *   ./tokenizer_benchmark [number of lines]
+ *
+ * The results differ on purpose for some lines: Regexp uses Lua patterns which have no
+ * alternation ("(a|b)"), so time and day commands were never recognized, and the unanchored
+ * patterns accepted trailing garbage such as "wait 12a". The differences are listed once.
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "Regexp.h"
+#include "tokenizer.h"
+
+// classification as done by program_parser() with the Regexp library
+static program_command classify_regexp(const std::string &line) {
+  MatchState REGEX;
+  REGEX.Target((char *)line.c_str());
+
+  if (REGEX.Match("play [a-zA-Z0-9\\s\\-\\_]+") == REGEXP_MATCHED) return PROGRAM_PLAY;
+  if (REGEX.Match("wait [0-9]+") == REGEXP_MATCHED) return PROGRAM_WAIT;
+  if (REGEX.Match("^(0[0-9]|1[0-9]|2[0-3]):[0-5][0-9]:[0-5][0-9] [a-zA-Z0-9\\s\\-\\_]+") == REGEXP_MATCHED) return PROGRAM_TIME;
+  if (REGEX.Match("^(monday|tuesday|wednesday|thursday|friday|saturday|sunday|Monday|Tuesday|Wednesday|Thursday|Friday|Saturday|Sunday) (0[0-9]|1[0-9]|2[0-3]):[0-5][0-9]:[0-5][0-9] [a-zA-Z0-9\\s\\-\\_]+") == REGEXP_MATCHED) return PROGRAM_DAY;
+  if (REGEX.Match("skip [0-9]+") == REGEXP_MATCHED) return PROGRAM_SKIP;
+  if (REGEX.Match("loop [0-9]+") == REGEXP_MATCHED || REGEX.Match("loop inf") == REGEXP_MATCHED) return PROGRAM_LOOP;
+  if (line.empty()) return PROGRAM_EMPTY;
+  return PROGRAM_INVALID;
+}
+
+// lines as they are written in the web interface (one of each command)
+static const char *const TEMPLATES[] = {
+  "play tv on", "wait 1500", "17:30:00 lamp_off", "saturday 08:15:00 coffee-machine",
+  "skip 2", "loop 10", "loop inf", "", "play living room light", "Friday 23:59:59 fan",
+  "blah blah", "wait 12a"
+};
+
+int main(int argc, char **argv) {
+  size_t line_count = argc > 1 ? strtoul(argv[1], NULL, 10) : 200000;
+  size_t template_count = sizeof(TEMPLATES) / sizeof(TEMPLATES[0]);
+
+  std::vector<std::string> lines;
+  lines.reserve(line_count);
+  for (size_t i = 0; i < line_count; i++) {
+    lines.push_back(TEMPLATES[(i * 7) % template_count]);
+  }
+
+  // Regexp
+  std::vector<program_command> expected(line_count);
+  auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < line_count; i++) {
+    expected[i] = classify_regexp(lines[i]);
+  }
+  double regexp_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+  // tokenizer
+  std::vector<program_command> actual(line_count);
+  program_line tokens;
+  start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < line_count; i++) {
+    tokenize_program_line(lines[i].c_str(), lines[i].size(), tokens);
+    actual[i] = tokens.command;
+  }
+  double tokenizer_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+  size_t differences = 0;
+  for (size_t i = 0; i < line_count; i++) {
+    if (expected[i] != actual[i]) {
+      if (i < template_count) {
+        printf("different result for \"%s\": regexp %d, tokenizer %d\n", lines[i].c_str(), expected[i], actual[i]);
+      }
+      differences++;
+    }
+  }
+
+  printf("lines:     %zu\n", line_count);
+  printf("regexp:    %8.2f ms (%6.1f ns/line)\n", regexp_ms, regexp_ms * 1e6 / line_count);
+  printf("tokenizer: %8.2f ms (%6.1f ns/line)\n", tokenizer_ms, tokenizer_ms * 1e6 / line_count);
+  printf("speed-up:  %8.1fx\n", regexp_ms / tokenizer_ms);
+  printf("lines with different result: %zu\n", differences);
+
+  return 0;
+}
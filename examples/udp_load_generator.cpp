@@ -0,0 +1,166 @@
+/*
+ * Host load generator for the UDP command port.
+ *
+ * Sends commands to the device one after another (the next one after the acknowledgement of the
+ * last one or a timeout) and prints the 50th and 99th percentile of the time until the
+ * acknowledgement arrived. Runs on a computer, not on the ESP8266. Build and run from the root of
+ * the repository:
+ *
+ *   g++ -O2 -std=gnu++11 -Iinclude examples/udp_load_generator.cpp src/udp_command.cpp -o udp_load_generator
+ *   ./udp_load_generator <device ip> <signal|program|state> <name or protocol:bits:hex state> [options]
+ *
+ * Options:
+ *   -n <count>     number of commands (default 100)
+ *   -i <ms>        pause between two commands (default 100, a signal takes about 70 ms to send)
+ *   -k <key>       key the firmware was built with (UDP_COMMAND_KEY)
+ *   -s <sequence>  first sequence number (default 0: no sequence numbers), has to be higher than the
+ *                  last one the device accepted, after a restart of the device higher than the
+ *                  last one plus 64 (required with -k)
+ *   -p <port>      port (default UDP_COMMAND_PORT)
+ *
+ * Examples:
+ *   ./udp_load_generator 192.168.178.50 signal "tv on" -n 1000 -i 200
+ *   ./udp_load_generator 192.168.178.50 state 3:32:20DF10EF      (NEC value with 32 bits)
+ */
+
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "udp_command.h"
+
+static const char *STATUS_NAMES[] = {"ok", "bad packet", "unauthorized", "replayed", "not found", "busy", "failed"};
+
+// payload of a state command from "protocol:bits:hex"
+static bool parse_state(const std::string &text, std::vector<uint8_t> &payload) {
+  size_t first = text.find(':');
+  size_t second = text.find(':', first + 1);
+  if (first == std::string::npos || second == std::string::npos || (text.size() - second - 1) % 2 != 0) {
+    return false;
+  }
+  unsigned long protocol = strtoul(text.substr(0, first).c_str(), NULL, 10);
+  unsigned long bits = strtoul(text.substr(first + 1, second - first - 1).c_str(), NULL, 10);
+  payload.push_back((uint8_t)(protocol >> 8));
+  payload.push_back((uint8_t)protocol);
+  payload.push_back((uint8_t)(bits >> 8));
+  payload.push_back((uint8_t)bits);
+  for (size_t i = second + 1; i < text.size(); i += 2) {
+    payload.push_back((uint8_t)strtoul(text.substr(i, 2).c_str(), NULL, 16));
+  }
+  return true;
+}
+
+int main(int argc, char **argv) {
+  if (argc < 4) {
+    fprintf(stderr, "usage: %s <device ip> <signal|program|state> <name or protocol:bits:hex state> [-n count] [-i ms] [-k key] [-s sequence] [-p port]\n", argv[0]);
+    return 1;
+  }
+
+  int count = 100;
+  int interval = 100;
+  std::string key;
+  uint32_t sequence = 0;
+  int port = UDP_COMMAND_PORT;
+  for (int i = 4; i + 1 < argc; i += 2) {
+    if (strcmp(argv[i], "-n") == 0) count = atoi(argv[i + 1]);
+    else if (strcmp(argv[i], "-i") == 0) interval = atoi(argv[i + 1]);
+    else if (strcmp(argv[i], "-k") == 0) key = argv[i + 1];
+    else if (strcmp(argv[i], "-s") == 0) sequence = strtoul(argv[i + 1], NULL, 10);
+    else if (strcmp(argv[i], "-p") == 0) port = atoi(argv[i + 1]);
+  }
+
+  // payload of the command
+  udp_command command = {0, 0, 0, 0, NULL};
+  std::vector<uint8_t> payload;
+  std::string kind = argv[2];
+  if (kind == "state") {
+    command.type = UDP_SEND_STATE;
+    if (!parse_state(argv[3], payload)) {
+      fprintf(stderr, "state has to be protocol:bits:hex, e.g. 3:32:20DF10EF\n");
+      return 1;
+    }
+  }
+  else {
+    command.type = kind == "program" ? UDP_PLAY_PROGRAM : UDP_SEND_SIGNAL;
+    payload.assign(argv[3], argv[3] + strlen(argv[3]));
+  }
+  if (payload.size() > UDP_MAX_PAYLOAD) {
+    fprintf(stderr, "payload is longer than %zu bytes\n", UDP_MAX_PAYLOAD);
+    return 1;
+  }
+  command.payload = payload.data();
+  command.length = (uint8_t)payload.size();
+
+  int sock = socket(AF_INET, SOCK_DGRAM, 0);
+  timeval timeout = {1, 0};
+  setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+  sockaddr_in device = {};
+  device.sin_family = AF_INET;
+  device.sin_port = htons(port);
+  if (inet_pton(AF_INET, argv[1], &device.sin_addr) != 1) {
+    fprintf(stderr, "invalid ip: %s\n", argv[1]);
+    return 1;
+  }
+
+  std::vector<double> latencies;
+  int status_counts[7] = {0};
+  int lost = 0;
+  for (int i = 0; i < count; i++) {
+    command.sequence = sequence == 0 ? 0 : sequence + i;
+    uint8_t packet[UDP_MAX_PACKET];
+    size_t size = build_udp_command(command, (const uint8_t *)key.data(), key.size(), packet);
+
+    auto start = std::chrono::steady_clock::now();
+    sendto(sock, packet, size, 0, (sockaddr *)&device, sizeof(device));
+
+    // wait for the acknowledgement of this command (older ones that arrive late are skipped)
+    bool acknowledged = false;
+    uint8_t ack[UDP_MAX_PACKET + 1];
+    while (!acknowledged) {
+      ssize_t received = recv(sock, ack, sizeof(ack), 0);
+      if (received < 0) {
+        break;
+      }
+      uint32_t ack_sequence = ((uint32_t)ack[4] << 24) | ((uint32_t)ack[5] << 16) | ((uint32_t)ack[6] << 8) | ack[7];
+      if (received >= (ssize_t)UDP_HEADER_LENGTH && (ack[3] & UDP_FLAG_ACK) && ack_sequence == command.sequence) {
+        acknowledged = true;
+        if (ack[9] < 7) {
+          status_counts[ack[9]]++;
+        }
+        if (i == 0 || ack[9] != UDP_OK) {
+          printf("%d: %s: %.*s\n", i, ack[9] < 7 ? STATUS_NAMES[ack[9]] : "?", (int)(received - UDP_HEADER_LENGTH), (const char *)ack + UDP_HEADER_LENGTH);
+        }
+      }
+    }
+    if (!acknowledged) {
+      lost++;
+      continue;
+    }
+    latencies.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+
+    usleep(interval * 1000);
+  }
+  close(sock);
+
+  printf("\n%d commands, %zu acknowledged, %d lost\n", count, latencies.size(), lost);
+  for (int i = 0; i < 7; i++) {
+    if (status_counts[i] > 0) {
+      printf("  %s: %d\n", STATUS_NAMES[i], status_counts[i]);
+    }
+  }
+  if (!latencies.empty()) {
+    std::sort(latencies.begin(), latencies.end());
+    printf("latency until acknowledgement: p50 %.2f ms, p99 %.2f ms, max %.2f ms\n",
+           latencies[latencies.size() / 2], latencies[std::min(latencies.size() - 1, latencies.size() * 99 / 100)], latencies.back());
+  }
+  return 0;
+}
@@ -1,9 +1,9 @@
 /**
  * @file base.h
  * @author Marc Ubbelohde
- * @brief Header file for filesystem.cpp and time_management.cpp
+ * @brief Header file for filesystem.cpp, time_management.cpp, archive.cpp, metrics.cpp, trace.cpp, led.cpp, jobs.cpp, log.cpp, learning.cpp, events.cpp, mqtt.cpp, json_arena.cpp, kv_store.cpp and rtc_state.cpp
  * 
- * @details This file includes the dependencies for the filesystem.cpp and time_management.cpp files.
+ * @details This file includes the dependencies for the filesystem.cpp, time_management.cpp, archive.cpp, metrics.cpp, trace.cpp, led.cpp, jobs.cpp, log.cpp, learning.cpp, events.cpp, mqtt.cpp, json_arena.cpp, kv_store.cpp and rtc_state.cpp files.
  * 
  */
 
@@ -18,14 +18,39 @@
 #include <ESP8266WiFi.h>
 #include <NTPClient.h>
 #include <WiFiUdp.h>
+#include "metrics.h"
+#include "trace.h"
+#include "led.h"
+#include "jobs.h"
+#include "log.h"
+#include "learning.h"
+#include "events.h"
+#include "mqtt.h"
+#include "json_arena.h"
+#include "kv_store.h"
+#include "rtc_state.h"
 
 // forward declarations
 // filesystem
 String capture_signal();
+String capture_signal(String name);
+String receive_signal(const String *name);
+IRrecv *start_receiver();
+void stop_receiver();
+IRrecv *create_receiver();
 String save_signal(String result_string, String name);
-void save_json(String filename, DynamicJsonDocument doc);
-DynamicJsonDocument load_json(String filename);
-String send_signal(DynamicJsonDocument doc);
+String save_capture(const decode_results &results, String name);
+String check_signal_name(const String &name);
+void build_signal_json(const decode_results &results, JsonDocument &doc, String &sequence);
+void save_json(const String &filename, const JsonDocument &doc);
+boolean load_json(const String &filename, JsonDocument &doc);
+boolean load_json(const String &filename, JsonDocument &doc, const JsonDocument &filter);
+String send_signal(const JsonDocument &doc);
+String send_state(uint16_t protocol, uint16_t bits, const uint8_t *state, uint16_t length);
+int parse_sequence(String sequence, uint16_t *command, int length);
+boolean add_generic_signal(const uint16_t *raw, int length, JsonDocument &doc);
+void generic_to_json(const generic_signal_t &signal, JsonObject object);
+boolean json_to_generic(JsonObjectConst object, generic_signal_t *signal);
 String get_files(String folder_signals, String folder_programs);
 boolean check_if_file_exists(String filename);
 String read_program(String program_name);
@@ -40,4 +65,16 @@ String get_current_time();
 String turn_seconds_in_time(unsigned long input_seconds);
 String add_time(String time, String offset_time);
 void init_time();
-void check_and_update_offset();
\ No newline at end of file
+boolean read_ntp_time(const uint8_t *packet, size_t size, int32_t timezone, uint32_t &clock, uint16_t &clock_ms);
+void update_ntp_sync();
+void save_clock(uint32_t clock, int timezone, unsigned long offset);
+unsigned long correct_clock_drift(unsigned long elapsed);
+void check_and_update_offset();
+
+// archive
+size_t get_archive_size(String folder_signals, String folder_programs);
+size_t write_archive(Print &output, String folder_signals, String folder_programs);
+void import_archive_begin();
+void import_archive_chunk(const uint8_t *data, size_t length);
+void import_archive_fail(String error, action_status status);
+String import_archive_end(action_status &status);
\ No newline at end of file
@@ -0,0 +1,79 @@
+/**
+ * @file events.h
+ * @author Marc Ubbelohde
+ * @brief Header file for events.cpp
+ *
+ * @details This file declares the event stream. It is included by base.h so every subsystem can
+ * publish what it is doing (action results, job progress, capture state, clock) to the clients of
+ * /api/events (Server-Sent Events). Events are kept in a fixed ring, clients that can not keep up
+ * miss the oldest events instead of the device buffering them.
+ *
+ */
+
+#ifndef EVENTS_H_
+#define EVENTS_H_
+
+#include <Arduino.h>
+#include <ESP8266WiFi.h>
+
+/**
+ * @brief Number of events kept in the ring (the oldest are overwritten).
+ *
+ */
+const uint8_t EVENT_RING_SIZE = 16;
+
+/**
+ * @brief Longest data of an event in bytes (including the terminating zero), longer data is cut.
+ *
+ */
+const size_t EVENT_DATA_LENGTH = 160;
+
+/**
+ * @brief Most clients that are connected to /api/events at the same time.
+ *
+ */
+const uint8_t EVENT_MAX_CLIENTS = 2;
+
+/**
+ * @brief Time (ms) between two clock events (and keep-alives) while a client is connected.
+ *
+ */
+const unsigned long EVENT_CLOCK_INTERVAL = 60000;
+
+/**
+ * @brief Types of events (the SSE event name is in EVENT_NAMES).
+ *
+ */
+enum event_type {
+  EVENT_MESSAGE,
+  EVENT_JOB,
+  EVENT_CAPTURE,
+  EVENT_LEARN,
+  EVENT_CLOCK,
+  EVENT_TYPE_COUNT
+};
+
+/**
+ * @brief One event, data is JSON.
+ *
+ */
+struct event {
+  uint32_t id;
+  event_type type;
+  char data[EVENT_DATA_LENGTH];
+};
+
+void publish_event(event_type type, const char *format, ...);
+void publish_message(const String &message);
+uint32_t get_last_event_id();
+boolean get_event(uint32_t id, event &result);
+size_t print_event(const event &item, Print &output);
+size_t print_events(uint32_t &next_id, Print &output, size_t room);
+size_t print_event_json(const event &item, Print &output);
+size_t print_events_json(uint32_t &next_id, Print &output, size_t room);
+void reset_events();
+uint32_t get_event_resume_id(uint32_t last_id);
+boolean add_event_client(WiFiClient &client, uint32_t last_id);
+void update_events();
+
+#endif  // EVENTS_H_
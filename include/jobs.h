@@ -0,0 +1,100 @@
+/**
+ * @file jobs.h
+ * @author Marc Ubbelohde
+ * @brief Header file for jobs.cpp
+ *
+ * @details This file declares the jobs (capture, send, program) and their cancellation token.
+ * It is included by base.h so every long running part can check if the user canceled it with
+ * the button or on /api/jobs/{id}/cancel.
+ *
+ */
+
+#ifndef JOBS_H_
+#define JOBS_H_
+
+#include <Arduino.h>
+
+/**
+ * @brief GPIO of the cancel button (D6, pulled up, pressed is LOW).
+ *
+ */
+const uint8_t CANCEL_BUTTON_PIN = 12;
+
+/**
+ * @brief Presses within this time (ms) after the last one are ignored (contact bounce).
+ *
+ */
+const unsigned long CANCEL_DEBOUNCE_TIME = 50;
+
+/**
+ * @brief Longest time (ms) job_sleep() sleeps before it calls the idle handler again.
+ *
+ */
+const unsigned long JOB_SLEEP_SLICE = 100;
+
+/**
+ * @brief Kinds of jobs.
+ *
+ */
+enum job_kind {
+  JOB_NONE,
+  JOB_CAPTURE,
+  JOB_SEND,
+  JOB_PROGRAM,
+  JOB_LEARN
+};
+
+/**
+ * @brief The running job.
+ *
+ * @details Only one job runs at a time. Jobs that are started while one is running (e.g. the
+ * signals sent by a program) become part of it and share its cancellation token, depth counts
+ * how many of them are running.
+ *
+ */
+struct job {
+  uint16_t id;
+  job_kind kind;
+  uint8_t depth;
+  volatile boolean cancelled;
+};
+
+/**
+ * @brief Runs a job from its construction until the end of the enclosing block.
+ *
+ * @details Usage: "job_scope scope(JOB_CAPTURE);" at the top of a function. Since the job ends
+ * in the destructor every early return is covered.
+ *
+ */
+struct job_scope {
+  uint16_t id;
+  explicit job_scope(job_kind kind);
+  ~job_scope();
+};
+
+/**
+ * @brief Result of an action on a signal or program.
+ * 
+ * @details Returned next to the message of the action, the HTTP status of the REST routes and the
+ * status of the UDP acknowledgement are derived from it instead of from the wording of the message.
+ * 
+ */
+enum action_status {
+  ACTION_OK,
+  ACTION_INVALID,    // the request can not be executed (e.g. the name is not alphanumeric)
+  ACTION_NOT_FOUND,  // the signal, program or job does not exist
+  ACTION_BUSY,       // another job is running
+  ACTION_FAILED      // the action was executed but failed
+};
+
+void init_cancel_button();
+uint16_t job_begin(job_kind kind);
+void job_end(uint16_t id);
+job get_current_job();
+boolean job_busy(String &message);
+boolean job_cancelled();
+boolean job_cancel(uint16_t id);
+boolean job_sleep(unsigned long time);
+void job_set_idle_handler(void (*handler)());
+
+#endif  // JOBS_H_
@@ -0,0 +1,72 @@
+/**
+ * @file json_arena.h
+ * @author Marc Ubbelohde
+ * @brief Header file for json_arena.cpp
+ *
+ * @details This file declares the allocator of the JSON documents that are loaded from and saved to
+ * the LittleFS. It is included by base.h. Declare documents as "json_document doc(JSON_FILE_CAPACITY);"
+ * and pass them by reference, their memory then comes from a static arena instead of the heap.
+ *
+ */
+
+#ifndef JSON_ARENA_H_
+#define JSON_ARENA_H_
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+
+/**
+ * @brief Size of the arena in bytes (a signal document and a time document at the same time).
+ *
+ */
+const size_t JSON_ARENA_SIZE = 4096;
+
+/**
+ * @brief Capacity of a document that holds a whole file (signal or time).
+ *
+ */
+const size_t JSON_FILE_CAPACITY = 3096;
+
+/**
+ * @brief Capacity of a document that holds the time (seven numbers, their keys are copied from the stored text).
+ *
+ */
+const size_t JSON_TIME_CAPACITY = JSON_OBJECT_SIZE(7) + 128;
+
+/**
+ * @brief Counters of the arena.
+ *
+ * @details heap_allocations counts the documents that did not fit into the arena anymore and were
+ * allocated in the heap instead, it stays 0 as long as the arena is large enough.
+ *
+ */
+struct json_arena_stats {
+  uint32_t allocations;
+  uint32_t heap_allocations;
+  size_t used;
+  size_t peak;
+};
+
+/**
+ * @brief Allocator of BasicJsonDocument that takes the memory from the arena.
+ *
+ * @details The arena is a stack: documents live in the scope they were declared in, so their memory
+ * is given back in the opposite order and the arena is empty again after every request.
+ *
+ */
+struct json_arena_allocator {
+  void *allocate(size_t size);
+  void deallocate(void *pointer);
+  void *reallocate(void *pointer, size_t new_size);
+};
+
+/**
+ * @brief JSON document in the arena.
+ *
+ */
+typedef BasicJsonDocument<json_arena_allocator> json_document;
+
+json_arena_stats get_json_arena_stats();
+void reset_json_arena_stats();
+
+#endif  // JSON_ARENA_H_
@@ -0,0 +1,115 @@
+/**
+ * @file kv_store.h
+ * @author Marc Ubbelohde
+ * @brief Header file for kv_store.cpp
+ *
+ * @details This file declares the journaled key-value store of the small state of the device (AP
+ * mode, password of the access point and the time). It is included by base.h.
+ *
+ * Record in the journal (numbers little endian):\n
+ * byte 0: KV_RECORD_MAGIC\n
+ * byte 1: length of the key\n
+ * byte 2-3: length of the value (KV_REMOVED if the key was removed)\n
+ * byte 4-7: CRC-32 of byte 1-3, the key and the value\n
+ * byte 8-: key and value
+ *
+ */
+
+#ifndef KV_STORE_H_
+#define KV_STORE_H_
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+
+/**
+ * @brief File of the journal.
+ *
+ */
+#define KV_JOURNAL_FILE "/state.log"
+
+/**
+ * @brief File the journal is compacted into before it replaces the journal.
+ *
+ */
+#define KV_COMPACT_FILE "/state.tmp"
+
+/**
+ * @brief File a signal or program is written to before it replaces the old file (see save_json()).
+ *
+ */
+#define REPLACE_TEMP_FILE "/replace.tmp"
+
+/**
+ * @brief Number of keys the index holds.
+ *
+ */
+const uint8_t KV_MAX_KEYS = 16;
+
+/**
+ * @brief Longest key in bytes.
+ *
+ */
+const uint8_t KV_KEY_LENGTH = 15;
+
+/**
+ * @brief Longest value in bytes.
+ *
+ */
+const uint16_t KV_VALUE_LENGTH = 256;
+
+/**
+ * @brief Size of the journal (bytes) from which on it is compacted if less than half of it is current.
+ *
+ */
+const uint32_t KV_COMPACT_SIZE = 4096;
+
+/**
+ * @brief First byte of every record.
+ *
+ */
+const uint8_t KV_RECORD_MAGIC = 0x4b;
+
+/**
+ * @brief Length of the record header in bytes.
+ *
+ */
+const uint8_t KV_HEADER_LENGTH = 8;
+
+/**
+ * @brief Value length of a record that removes its key.
+ *
+ */
+const uint16_t KV_REMOVED = 0xffff;
+
+/**
+ * @brief Counters of the store.
+ *
+ * @details skipped_writes counts writes that were not appended since the value did not change,
+ * dropped_bytes the bytes of torn or damaged records at the end of the journal that were dropped
+ * while loading it.
+ *
+ */
+struct kv_store_stats {
+  uint8_t keys;
+  uint32_t journal_size;
+  uint32_t live_size;
+  uint32_t appends;
+  uint32_t skipped_writes;
+  uint32_t compactions;
+  uint32_t dropped_bytes;
+};
+
+uint32_t kv_crc32(uint32_t crc, const uint8_t *data, size_t length);
+boolean kv_put(const String &key, const String &value);
+String kv_get(const String &key);
+boolean kv_contains(const String &key);
+boolean kv_remove(const String &key);
+boolean kv_save_json(const String &key, const JsonDocument &doc);
+boolean kv_load_json(const String &key, JsonDocument &doc);
+boolean kv_load_json(const String &key, JsonDocument &doc, const JsonDocument &filter);
+boolean kv_compact();
+void kv_unload();
+void kv_reset();
+kv_store_stats get_kv_stats();
+
+#endif  // KV_STORE_H_
@@ -0,0 +1,87 @@
+/**
+ * @file learning.h
+ * @author Marc Ubbelohde
+ * @brief Header file for learning.cpp
+ *
+ * @details This file declares the learning session, which records a whole remote in one go.
+ * It is included by base.h.
+ *
+ */
+
+#ifndef LEARNING_H_
+#define LEARNING_H_
+
+#include <Arduino.h>
+
+/**
+ * @brief Most signals that can be learned in one session.
+ *
+ */
+const uint8_t LEARN_MAX_SIGNALS = 64;
+
+/**
+ * @brief Time (ms) to wait for a signal before it is skipped.
+ *
+ */
+const unsigned long LEARN_SIGNAL_TIMEOUT = 30000;
+
+/**
+ * @brief The same signal within this time (ms) after the last capture is a repeat frame of a held button.
+ *
+ */
+const unsigned long LEARN_REPEAT_TIME = 1000;
+
+/**
+ * @brief Bytes of learned signals kept in RAM before they are written to the LittleFS.
+ *
+ */
+const size_t LEARN_MAX_PENDING = 8192;
+
+/**
+ * @brief State of a signal in the learning session.
+ *
+ */
+enum learn_state {
+  LEARN_WAITING,
+  LEARN_LEARNED,
+  LEARN_SKIPPED
+};
+
+/**
+ * @brief One signal of the learning session.
+ *
+ * @details json holds the signal file until it is written to the LittleFS (empty afterwards).
+ *
+ */
+struct learn_signal {
+  String name;
+  learn_state state;
+  uint32_t fingerprint;
+  String json;
+};
+
+/**
+ * @brief Progress of the learning session.
+ *
+ */
+struct learning_session {
+  boolean active;
+  uint16_t job_id;
+  uint8_t count;
+  uint8_t index;
+  uint8_t learned;
+  uint8_t skipped;
+  uint8_t duplicates;
+  unsigned long signal_start;
+  unsigned long last_capture;
+  uint32_t last_fingerprint;
+  size_t pending;
+  String message;
+};
+
+String start_learning(String names);
+boolean update_learning();
+learning_session get_learning_session();
+size_t print_learning_json(Print &output);
+
+#endif  // LEARNING_H_
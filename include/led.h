@@ -0,0 +1,60 @@
+/**
+ * @file led.h
+ * @author Marc Ubbelohde
+ * @brief Header file for led.cpp
+ *
+ * @details This file declares the LED pattern sequencer. It is included by base.h so every
+ * subsystem can show its state on the status LED without waiting for the LED.
+ *
+ */
+
+#ifndef LED_H_
+#define LED_H_
+
+#include <Arduino.h>
+
+/**
+ * @brief GPIO the status LED is connected to (D1).
+ *
+ */
+const uint8_t LED_PIN = 5;
+
+/**
+ * @brief Longest pattern in steps.
+ *
+ */
+const uint8_t LED_MAX_STEPS = 8;
+
+/**
+ * @brief Blink pattern. The LED is switched on and off every step, starting with first_level.
+ *
+ * @details A pattern with a single step (or none) is a steady level. Repeating patterns
+ * start over after the last step, the others return to the current state.
+ *
+ */
+struct led_pattern {
+  uint8_t first_level;
+  uint8_t count;
+  boolean repeat;
+  uint16_t steps[LED_MAX_STEPS];
+};
+
+/**
+ * @brief Ongoing states that are shown while no one-shot pattern is played.
+ *
+ */
+enum led_state {
+  LED_IDLE,
+  LED_CAPTURING,
+  LED_TRANSMITTING,
+  LED_PROGRAM_RUNNING,
+  LED_STATE_COUNT
+};
+
+void led_play(const led_pattern &pattern);
+led_state led_set_state(led_state state);
+led_state led_get_state();
+boolean led_is_playing();
+void update_led();
+
+#endif  // LED_H_
@@ -0,0 +1,87 @@
+/**
+ * @file log.h
+ * @author Marc Ubbelohde
+ * @brief Header file for log.cpp
+ *
+ * @details This file declares the leveled logger. It is included by base.h so every subsystem
+ * logs with LOG_ERROR(), LOG_WARN(), LOG_INFO() or LOG_DEBUG() (printf format) instead of printing
+ * to Serial. Messages are formatted into a fixed ring buffer, drained to Serial from the background
+ * and served on /api/log. Messages below LOG_LEVEL are compiled out entirely, to change the level
+ * add e.g. "-D LOG_LEVEL=4" (debug) to the build_flags in platformio.ini.
+ *
+ */
+
+#ifndef LOG_H_
+#define LOG_H_
+
+#include <Arduino.h>
+
+#define LOG_LEVEL_NONE 0
+#define LOG_LEVEL_ERROR 1
+#define LOG_LEVEL_WARN 2
+#define LOG_LEVEL_INFO 3
+#define LOG_LEVEL_DEBUG 4
+
+#ifndef LOG_LEVEL
+#define LOG_LEVEL LOG_LEVEL_INFO
+#endif
+
+/**
+ * @brief Size of the ring buffer in bytes (power of two, the oldest messages are overwritten).
+ *
+ */
+const size_t LOG_BUFFER_SIZE = 2048;
+
+/**
+ * @brief Longest message in bytes (including the "[millis] L " prefix), longer ones are cut.
+ *
+ */
+const size_t LOG_LINE_LENGTH = 160;
+
+/**
+ * @brief Writes raw text into the ring buffer (e.g. to stream a capture with resultToSourceCode()).
+ *
+ */
+struct log_writer : public Print {
+  size_t write(uint8_t c) override;
+  size_t write(const uint8_t *buffer, size_t size) override;
+};
+
+/**
+ * @brief Writer for raw text, only use it inside "#if LOG_LEVEL >= ..." so it is compiled out with the level.
+ *
+ */
+extern log_writer LOG_WRITER;
+
+void log_message(uint8_t level, const char *format, ...);
+void reset_log();
+void update_log();
+void flush_log();
+size_t print_log(Print &output);
+uint32_t get_log_dropped();
+
+#if LOG_LEVEL >= LOG_LEVEL_ERROR
+#define LOG_ERROR(format, ...) log_message(LOG_LEVEL_ERROR, PSTR(format), ##__VA_ARGS__)
+#else
+#define LOG_ERROR(format, ...) do {} while (0)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_WARN
+#define LOG_WARN(format, ...) log_message(LOG_LEVEL_WARN, PSTR(format), ##__VA_ARGS__)
+#else
+#define LOG_WARN(format, ...) do {} while (0)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_INFO
+#define LOG_INFO(format, ...) log_message(LOG_LEVEL_INFO, PSTR(format), ##__VA_ARGS__)
+#else
+#define LOG_INFO(format, ...) do {} while (0)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_DEBUG
+#define LOG_DEBUG(format, ...) log_message(LOG_LEVEL_DEBUG, PSTR(format), ##__VA_ARGS__)
+#else
+#define LOG_DEBUG(format, ...) do {} while (0)
+#endif
+
+#endif  // LOG_H_
@@ -10,9 +10,11 @@
 
 #include <WiFiManager.h>         //https://github.com/tzapu/WiFiManager
 #include <ESP8266WebServer.h>
+#include <uri/UriBraces.h>
 #include <ESP8266mDNS.h>
 
 #include "workflows.h"
+#include "udp_command.h"
 #include "website_string.h"
 
 #include "tests.h"
@@ -29,6 +31,35 @@ void handle_apmode();
 void handle_apinfo();
 void handle_password();
 void handle_form();
+void handle_export();
+void handle_import();
+void handle_import_upload();
+void handle_api_route(size_t route_index);
+void handle_api_stats();
+void handle_metrics();
+void handle_trace();
+void handle_log();
+void handle_learn();
+void handle_events();
+void set_message(String message);
+
+int read_api_name(const char *input, boolean url_encoded, char *name);
+action_status run_api_route(size_t route_index, const char *input, boolean url_encoded, String &message);
+int action_http_status(action_status status);
+action_status action_record_signal(const char *name, String &message);
+action_status action_send_signal(const char *name, String &message);
+action_status action_delete_signal(const char *name, String &message);
+action_status action_save_program(const char *name, String &message);
+action_status action_play_program(const char *name, String &message);
+action_status action_delete_program(const char *name, String &message);
+action_status action_edit_program(const char *name, String &message);
+action_status action_cancel_job(const char *name, String &message);
+
+void handle_background();
+void handle_udp_commands();
+void handle_mqtt_commands();
+String run_udp_command(const udp_command &command, udp_status &status);
+void run_pending_program();
 
 // global variables
 /**
@@ -45,11 +76,18 @@ ESP8266WebServer server(80);
 String PROGRAMNAME = "";
 
 /**
- * @brief Holds the message that is displayed on the website and updated on reload.
+ * @brief Holds the last message that is displayed on the website (see set_message()).
  * 
  */
 String MESSAGE = "";
 
+/**
+ * @brief Status and message of the last upload to /api/import (see handle_import_upload()).
+ * 
+ */
+action_status IMPORT_STATUS = ACTION_INVALID;
+String IMPORT_MESSAGE = "Error: no archive was uploaded";
+
 /**
  * @brief Stores the session value (if AP-Mode is activated or not).
  * 
@@ -60,4 +98,133 @@ boolean SESSION_AP = true;
  * @brief Tracks which setting to be used on reboot.
  * 
  */
-boolean AP_SETTING = true;
\ No newline at end of file
+boolean AP_SETTING = true;
+
+/**
+ * @brief Maximum length of a signal or program name that is accepted by the routes.
+ * 
+ */
+const size_t API_NAME_LENGTH = 32;
+
+/**
+ * @brief Describes one action on a signal or program and how it is reached.
+ * 
+ * @details Every action can be reached through its REST route (the name is the {} part of the uri)
+ * and through the form elements of the website (the name is read from name_field when button was pressed).
+ * Exclusive actions change signals or programs and are refused while a job runs (see check_job_running()).
+ * 
+ */
+struct api_route {
+  HTTPMethod method;
+  const char *uri;
+  const char *button;
+  const char *name_field;
+  const char *missing_name;
+  boolean exclusive;
+  action_status (*action)(const char *name, String &message);
+};
+
+/**
+ * @brief Table of all actions on signals and programs.
+ * 
+ * @details The routes are registered from this table in setup() and handle_form() looks up the pressed
+ * button in it, so the dispatch does not depend on comparing the values of all form fields.
+ * Entries without uri can only be reached through the website, entries without button only through
+ * their REST route.
+ * 
+ */
+const api_route API_ROUTES[] = {
+  // method      REST route                 form button              form field          error if name is missing  exclusive
+  {HTTP_POST,   "/api/signals/{}/record",  "add_signal_button",     "signal_name",      "no signal name given",  true,      action_record_signal},
+  {HTTP_POST,   "/api/signals/{}/send",    "send_signal_button",    "selected_signal",  "no signal selected",    false,     action_send_signal},
+  {HTTP_DELETE, "/api/signals/{}",         "delete_signal_button",  "selected_signal",  "no signal selected",    true,      action_delete_signal},
+  {HTTP_POST,   "/api/programs/{}",        "add_program_button",    "program_name",     "no program name given", true,      action_save_program},
+  {HTTP_POST,   "/api/programs/{}/play",   "play_program_button",   "selected_program", "no program selected",   false,     action_play_program},
+  {HTTP_DELETE, "/api/programs/{}",        "delete_program_button", "selected_program", "no program selected",   true,      action_delete_program},
+  {HTTP_ANY,    NULL,                      "edit_program_button",   "selected_program", "no program selected",   false,     action_edit_program},
+  {HTTP_POST,   "/api/jobs/{}/cancel",     NULL,                    NULL,               "no job id given",       false,     action_cancel_job},
+};
+
+/**
+ * @brief Number of entries in API_ROUTES.
+ * 
+ */
+const size_t API_ROUTE_COUNT = sizeof(API_ROUTES) / sizeof(API_ROUTES[0]);
+
+/**
+ * @brief Latency and heap measurements of one route.
+ * 
+ */
+struct api_route_stats {
+  uint32_t calls;
+  uint32_t total_us;
+  uint32_t max_us;
+  int32_t last_heap_delta;
+  int32_t max_heap_delta;
+};
+
+/**
+ * @brief Measurements of every route in API_ROUTES (same index). Served on /api/routes.
+ * 
+ */
+api_route_stats API_ROUTE_STATS[API_ROUTE_COUNT];
+
+/**
+ * @brief Name of the program that is started by the next call of run_pending_program().
+ * 
+ */
+char PENDING_PROGRAM[API_NAME_LENGTH + 1] = "";
+
+/**
+ * @brief Job of the pending program (0 if no program is pending).
+ * 
+ * @details Programs are not played inside the request handler but from loop(), so the webserver
+ * keeps running while the program waits (e.g. to cancel it on /api/jobs/{id}/cancel).
+ * 
+ */
+uint16_t PENDING_PROGRAM_JOB = 0;
+
+/**
+ * @brief Line the pending program continues at (0 to start at the beginning, see restore_rtc_state()).
+ * 
+ */
+uint16_t PENDING_PROGRAM_LINE = 0;
+
+#ifndef UDP_COMMAND_KEY
+#define UDP_COMMAND_KEY ""
+#endif
+
+/**
+ * @brief Socket of the UDP command port (see udp_command.h).
+ * 
+ * @details Commands have to be authenticated if the firmware is built with a key, e.g. with
+ * -D UDP_COMMAND_KEY=\"secret\" in the build_flags of platformio.ini.
+ * 
+ */
+WiFiUDP UDP_COMMANDS;
+
+/**
+ * @brief Last sequence number that was accepted on the UDP command port (commands with a lower one are replays).
+ * 
+ */
+uint32_t UDP_LAST_SEQUENCE = 0;
+
+/**
+ * @brief Highest sequence number that is reserved in the key-value store (all numbers up to it are
+ * refused after a restart).
+ * 
+ */
+uint32_t UDP_RESERVED_SEQUENCE = 0;
+
+/**
+ * @brief Sequence numbers that are reserved with one write to the key-value store (the flash is
+ * only written for every UDP_SEQUENCE_RESERVE accepted commands).
+ * 
+ */
+const uint32_t UDP_SEQUENCE_RESERVE = 64;
+
+/**
+ * @brief Key of the reserved sequence number in the key-value store (it is kept over a restart).
+ * 
+ */
+const char UDP_SEQUENCE_KEY[] = "udp_sequence";
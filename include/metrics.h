@@ -0,0 +1,111 @@
+/**
+ * @file metrics.h
+ * @author Marc Ubbelohde
+ * @brief Header file for metrics.cpp
+ * 
+ * @details This file declares the heap and stack telemetry. It is included by base.h
+ * so every subsystem can mark the parts it wants to be measured with a metrics_scope.
+ * 
+ */
+
+#ifndef METRICS_H_
+#define METRICS_H_
+
+#include <Arduino.h>
+
+/**
+ * @brief Number of samples that are kept in the ring buffer.
+ * 
+ */
+const uint8_t METRICS_SAMPLE_COUNT = 32;
+
+/**
+ * @brief Time between two samples in milliseconds.
+ * 
+ */
+const unsigned long METRICS_INTERVAL = 60000;
+
+/**
+ * @brief Logs every sample as one line (LOG_INFO) if true.
+ * 
+ */
+const boolean METRICS_SERIAL_DUMP = true;
+
+/**
+ * @brief Subsystems whose heap usage is tracked separately.
+ * 
+ */
+enum metrics_subsystem {
+  METRICS_CAPTURE,
+  METRICS_SEND,
+  METRICS_STORAGE,
+  METRICS_TIME,
+  METRICS_PARSER,
+  METRICS_WEB,
+  METRICS_SUBSYSTEM_COUNT
+};
+
+/**
+ * @brief One sample of the heap and stack state.
+ * 
+ */
+struct metrics_sample {
+  uint32_t timestamp;
+  uint32_t free_heap;
+  uint16_t max_free_block;
+  uint8_t fragmentation;
+  uint32_t free_stack;
+};
+
+/**
+ * @brief Heap usage of one subsystem.
+ * 
+ * @details heap_delta is the free heap before minus the free heap after a call,
+ * so a positive value means memory that was not given back.
+ * 
+ */
+struct metrics_counter {
+  uint32_t calls;
+  int32_t total_heap_delta;
+  int32_t max_heap_delta;
+  uint32_t min_free_heap;
+};
+
+/**
+ * @brief Measures the heap usage of a subsystem from its construction until the end of the enclosing block.
+ * 
+ * @details Usage: "metrics_scope scope(METRICS_STORAGE);" at the top of a function. Since the
+ * measurement ends in the destructor every early return is covered. Scopes can be nested, the
+ * heap delta of an inner scope is not counted again for the outer one.
+ * 
+ */
+struct metrics_scope {
+  metrics_subsystem subsystem;
+  uint32_t free_heap_before;
+  metrics_scope *parent;
+  int32_t child_heap_delta;
+  explicit metrics_scope(metrics_subsystem subsystem);
+  ~metrics_scope();
+};
+
+/**
+ * @brief Print that only counts the bytes written to it (used to calculate Content-Length).
+ * 
+ */
+struct metrics_byte_counter : public Print {
+  size_t count = 0;
+  size_t write(uint8_t) override { count++; return 1; }
+  size_t write(const uint8_t *, size_t size) override { count += size; return size; }
+};
+
+void reset_metrics();
+void sample_metrics();
+void update_metrics();
+metrics_sample read_metrics();
+size_t print_metrics_sample(Print &output, const metrics_sample &sample);
+size_t print_metrics_json(Print &output, metrics_sample now);
+metrics_sample get_metrics_sample(uint8_t age);
+uint8_t get_metrics_sample_count();
+metrics_counter get_metrics_counter(metrics_subsystem subsystem);
+
+#endif  // METRICS_H_
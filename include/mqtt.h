@@ -0,0 +1,103 @@
+/**
+ * @file mqtt.h
+ * @author Marc Ubbelohde
+ * @brief Header file for mqtt.cpp
+ *
+ * @details This file declares the MQTT bridge. It is included by base.h. The bridge is disabled
+ * by default and then only the command queue is compiled. To enable it add e.g.
+ * "-D MQTT_ENABLED=1 -D MQTT_HOST=\"192.168.178.2\"" to the build_flags in platformio.ini.
+ *
+ * Topics (below MQTT_TOPIC):\n
+ * signal/send - name of a signal (subscribed)\n
+ * program/play - name of a program (subscribed)\n
+ * state/send - "protocol,hex state[,bits]", protocol as number or name like in IRMQTTServer (subscribed)\n
+ * events - JSON array of the events of the last MQTT_PUBLISH_INTERVAL (see events.h)\n
+ * metrics - current metrics sample every MQTT_METRICS_INTERVAL\n
+ * status - "online" or "offline" (retained, last will)
+ *
+ */
+
+#ifndef MQTT_H_
+#define MQTT_H_
+
+#include <Arduino.h>
+#include "udp_command.h"
+
+#ifndef MQTT_ENABLED
+#define MQTT_ENABLED 0
+#endif
+
+#ifndef MQTT_HOST
+#define MQTT_HOST ""
+#endif
+
+#ifndef MQTT_PORT
+#define MQTT_PORT 1883
+#endif
+
+#ifndef MQTT_TOPIC
+#define MQTT_TOPIC "ir-controller"
+#endif
+
+/**
+ * @brief Number of received commands that wait to be executed (further commands are rejected).
+ *
+ */
+const uint8_t MQTT_QUEUE_SIZE = 8;
+
+/**
+ * @brief Time (ms) the events are collected before they are published in one message.
+ *
+ */
+const unsigned long MQTT_PUBLISH_INTERVAL = 1000;
+
+/**
+ * @brief Time (ms) between two metrics messages.
+ *
+ */
+const unsigned long MQTT_METRICS_INTERVAL = 60000;
+
+/**
+ * @brief Time (ms) between two attempts to connect to the broker, doubled after every failed attempt.
+ *
+ */
+const unsigned long MQTT_RECONNECT_INTERVAL = 10000;
+
+/**
+ * @brief Longest time (ms) between two attempts to connect to the broker.
+ *
+ */
+const unsigned long MQTT_MAX_RECONNECT_INTERVAL = 300000;
+
+/**
+ * @brief Longest time (ms) an attempt to connect waits for the broker (TCP connect and each reply).
+ *
+ */
+const unsigned long MQTT_CONNECT_TIMEOUT = 500;
+
+/**
+ * @brief Longest events message in bytes.
+ *
+ */
+const size_t MQTT_BATCH_SIZE = 1024;
+
+/**
+ * @brief A received command, executed like a command of the UDP command port (see udp_command.h).
+ *
+ */
+struct mqtt_command {
+  uint8_t type;
+  uint8_t length;
+  uint8_t payload[UDP_MAX_PAYLOAD];
+};
+
+boolean parse_mqtt_command(const char *topic, const uint8_t *payload, size_t length, mqtt_command &command);
+boolean mqtt_queue_command(const mqtt_command &command);
+boolean mqtt_next_command(mqtt_command &command);
+
+#if MQTT_ENABLED
+void init_mqtt();
+void update_mqtt();
+#endif
+
+#endif  // MQTT_H_
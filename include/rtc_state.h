@@ -0,0 +1,153 @@
+/**
+ * @file rtc_state.h
+ * @author Marc Ubbelohde
+ * @brief Header file for rtc_state.cpp
+ *
+ * @details This file declares the state that is kept in the RTC user memory of the ESP8266 (clock
+ * and running program), so it survives a reset. It is included by base.h.
+ *
+ */
+
+#ifndef RTC_STATE_H_
+#define RTC_STATE_H_
+
+#include <Arduino.h>
+
+/**
+ * @brief Block (4 bytes) of the RTC user memory the state starts at (the first blocks are used by the OTA update).
+ *
+ */
+const uint32_t RTC_STATE_OFFSET = 32;
+
+/**
+ * @brief First field of a valid state ("RTC2", the state with the milliseconds of the clock).
+ *
+ */
+const uint32_t RTC_STATE_MAGIC = 0x32435452;
+
+/**
+ * @brief Time (ms) between two checkpoints of the clock (also the largest error after a reset).
+ *
+ */
+const unsigned long RTC_CHECKPOINT_INTERVAL = 1000;
+
+/**
+ * @brief Time (ms) after which the clock is anchored again (before millis() overflows).
+ *
+ */
+const unsigned long RTC_ANCHOR_INTERVAL = 86400000;
+
+/**
+ * @brief Time (s) the clock has to run without a reset since the last NTP sync before its drift is measured.
+ *
+ * @details NTP times are whole seconds, after one day this error is at most about 12 ppm.
+ *
+ */
+const uint32_t RTC_DRIFT_MIN_AGE = 86400;
+
+/**
+ * @brief Largest drift (ppm) that is accepted, larger measurements are wrong (e.g. a changed timezone).
+ *
+ */
+const int32_t RTC_DRIFT_LIMIT = 200;
+
+/**
+ * @brief Time (ms) between two NTP syncs in the background (the drift is measured after RTC_DRIFT_MIN_AGE).
+ *
+ */
+const unsigned long NTP_SYNC_INTERVAL = 86400000;
+
+/**
+ * @brief Time (ms) after which a NTP request without an answer is sent again.
+ *
+ */
+const unsigned long NTP_RETRY_INTERVAL = 60000;
+
+/**
+ * @brief Time (ms) a NTP request waits for the answer.
+ *
+ */
+const unsigned long NTP_TIMEOUT = 2000;
+
+/**
+ * @brief Local port of the NTP requests in the background.
+ *
+ */
+const uint16_t NTP_LOCAL_PORT = 2390;
+
+/**
+ * @brief Length of a NTP packet in bytes.
+ *
+ */
+const size_t NTP_PACKET_LENGTH = 48;
+
+/**
+ * @brief Time (ms) millis() has to advance before last_offset of the saved time is written again.
+ *
+ */
+const unsigned long TIME_OFFSET_STEP = 60000;
+
+/**
+ * @brief Number of times a program is continued after a reset without getting to the next line.
+ *
+ */
+const uint8_t RTC_MAX_RESUMES = 3;
+
+/**
+ * @brief Longest name of a program in the state.
+ *
+ */
+const size_t RTC_PROGRAM_LENGTH = 32;
+
+/**
+ * @brief Seconds of a week.
+ *
+ */
+const uint32_t WEEK_SECONDS = 604800;
+
+/**
+ * @brief Flags of the state.
+ *
+ */
+const uint8_t RTC_CLOCK_VALID = 0x01;     // the clock was set by NTP or the user
+const uint8_t RTC_CLOCK_SYNCED = 0x02;    // the clock was set by NTP and did not miss a reset since then
+const uint8_t RTC_PROGRAM_RUNNING = 0x04;
+
+/**
+ * @brief State in the RTC user memory.
+ *
+ * @details clock is the time as seconds since Sunday 00:00 (weekday * 86400 + hh * 3600 + mm * 60 + ss)
+ * and clock_ms the milliseconds of the current second, sync_age the seconds since the last NTP sync,
+ * all at the time of the checkpoint. drift is how many
+ * ppm millis() runs faster than NTP. The checksum is the CRC-32 (kv_crc32()) of all fields before it.
+ *
+ */
+struct rtc_state {
+  uint32_t magic;
+  uint32_t clock;
+  int32_t timezone;
+  int32_t drift;
+  uint32_t sync_age;
+  uint8_t flags;
+  uint8_t resumes;
+  uint16_t program_line;
+  uint16_t clock_ms;
+  char program[RTC_PROGRAM_LENGTH + 2];
+  uint32_t checksum;
+};
+
+boolean read_rtc_state(rtc_state &state);
+void write_rtc_state(rtc_state &state);
+boolean restore_rtc_state();
+void update_rtc_state();
+void checkpoint_rtc_state();
+rtc_state get_rtc_state();
+uint32_t get_rtc_clock();
+int32_t get_clock_drift();
+void rtc_set_clock(uint32_t clock, uint16_t clock_ms, int32_t timezone, boolean synced);
+void rtc_set_timezone(int32_t timezone);
+void rtc_set_program(const char *name);
+void rtc_set_program_line(uint16_t line);
+void rtc_clear();
+
+#endif  // RTC_STATE_H_
@@ -11,14 +11,18 @@
 
 
 #include "workflows.h"
+#include "udp_command.h"
+#include <StreamString.h>
 
 void clean_LittleFS();
 
 boolean test_capture_signal();
 boolean test_save_signal();
+boolean test_save_capture();
 boolean test_save_json();
 boolean test_load_json();
 boolean test_send_signal();
+boolean test_generic_signal_json();
 boolean test_get_files();
 boolean test_check_if_file_exists();
 boolean test_read_program();
@@ -33,19 +37,91 @@ boolean test_turn_seconds_in_time();
 boolean test_add_time();
 boolean test_init_time();
 boolean test_check_and_update_offset();
+boolean test_read_ntp_time();
 
 boolean test_deleting_workflow();
 boolean test_recording_workflow();
 boolean test_sending_workflow();
 boolean test_adding_workflow();
 boolean test_playing_workflow();
+boolean test_playing_workflow_resume();
 boolean test_program_parser();
 boolean test_handle_wait_command();
 boolean test_handle_times_commands();
 
+boolean test_get_archive_size();
+boolean test_write_archive();
+boolean test_import_archive();
+
+boolean test_sample_metrics();
+boolean test_metrics_scope();
+boolean test_print_metrics_json();
+
+boolean test_tokenize_program_line();
+
+boolean test_led_play();
+boolean test_led_set_state();
+
+boolean test_job_begin();
+boolean test_job_cancel();
+boolean test_job_busy();
+boolean test_job_sleep();
+
+boolean test_log_message();
+boolean test_print_log();
+
+boolean test_start_learning();
+boolean test_print_learning_json();
+
+boolean test_publish_event();
+boolean test_publish_message();
+boolean test_get_event_resume_id();
+boolean test_print_events();
+boolean test_print_events_json();
+
+boolean test_hmac_sha256();
+boolean test_parse_udp_command();
+boolean test_build_udp_ack();
+String bytes_to_hex(const uint8_t *data, size_t length);
+
+boolean test_parse_mqtt_command();
+boolean test_mqtt_queue_command();
+
+boolean test_json_arena_allocator();
+boolean test_json_arena_storage();
+
+boolean test_kv_crc32();
+boolean test_kv_put();
+boolean test_kv_load();
+boolean test_kv_compact();
+boolean test_kv_migrate_file();
+
+boolean test_rtc_state_checkpoint();
+boolean test_restore_rtc_state();
+boolean test_rtc_set_clock();
+
+#if TRACE_ENABLED
+boolean test_trace_span();
+boolean test_print_trace_json();
+#endif
+
 boolean run_all_filesystem_tests(boolean stop_on_error);
 boolean run_all_time_management_tests(boolean stop_on_error);
 boolean run_all_workflows_tests(boolean stop_on_error);
+boolean run_all_archive_tests(boolean stop_on_error);
+boolean run_all_metrics_tests(boolean stop_on_error);
+boolean run_all_trace_tests(boolean stop_on_error);
+boolean run_all_tokenizer_tests(boolean stop_on_error);
+boolean run_all_led_tests(boolean stop_on_error);
+boolean run_all_jobs_tests(boolean stop_on_error);
+boolean run_all_log_tests(boolean stop_on_error);
+boolean run_all_learning_tests(boolean stop_on_error);
+boolean run_all_events_tests(boolean stop_on_error);
+boolean run_all_udp_command_tests(boolean stop_on_error);
+boolean run_all_mqtt_tests(boolean stop_on_error);
+boolean run_all_json_arena_tests(boolean stop_on_error);
+boolean run_all_kv_store_tests(boolean stop_on_error);
+boolean run_all_rtc_state_tests(boolean stop_on_error);
 void run_all_tests(boolean stop_on_error);
 void run_all_empirical_tests(boolean stop_on_error);
 
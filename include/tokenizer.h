@@ -0,0 +1,55 @@
+/**
+ * @file tokenizer.h
+ * @author Marc Ubbelohde
+ * @brief Header file for tokenizer.cpp
+ * 
+ * @details This file declares the scanner for the lines of a program. It does not depend on
+ * the Arduino framework so it can also be compiled on a computer (see examples/tokenizer_benchmark.cpp).
+ * 
+ */
+
+#ifndef TOKENIZER_H_
+#define TOKENIZER_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Commands a line of a program can contain.
+ * 
+ */
+enum program_command {
+  PROGRAM_INVALID,
+  PROGRAM_EMPTY,
+  PROGRAM_PLAY,   // "play signal_name"
+  PROGRAM_WAIT,   // "wait milliseconds"
+  PROGRAM_TIME,   // "hh:mm:ss signal_name"
+  PROGRAM_DAY,    // "weekday hh:mm:ss signal_name"
+  PROGRAM_SKIP,   // "skip days"
+  PROGRAM_LOOP    // "loop repetitions" or "loop inf"
+};
+
+/**
+ * @brief Tokens of one line of a program.
+ * 
+ * @details Only the fields used by the command are set. The signal name is not copied, it is
+ * given as position in the scanned line. error_column starts at 1.
+ * 
+ */
+struct program_line {
+  program_command command;
+  unsigned long number;       // wait: milliseconds, skip: days, loop: repetitions
+  bool infinite;              // loop: "loop inf"
+  uint8_t weekday;            // day: 0 (sunday) to 6 (saturday)
+  uint8_t hour;               // time and day
+  uint8_t minute;
+  uint8_t second;
+  size_t name_start;          // play, time and day
+  size_t name_length;
+  size_t error_column;        // invalid: column of the first character that could not be scanned
+  const char *error;          // invalid: description of the error
+};
+
+bool tokenize_program_line(const char *line, size_t length, program_line &result);
+
+#endif  // TOKENIZER_H_
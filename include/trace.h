@@ -0,0 +1,85 @@
+/**
+ * @file trace.h
+ * @author Marc Ubbelohde
+ * @brief Header file for trace.cpp
+ * 
+ * @details This file declares the latency tracing. It is included by base.h so the hot paths
+ * (record, send and play) can be marked with TRACE_SPAN("name"). Tracing is disabled by default
+ * and then compiled out entirely. To enable it add "-D TRACE_ENABLED=1" to the build_flags in
+ * platformio.ini and open /api/trace after using the device. The output can be loaded into
+ * chrome://tracing or https://ui.perfetto.dev.
+ * 
+ */
+
+#ifndef TRACE_H_
+#define TRACE_H_
+
+#include <Arduino.h>
+
+#ifndef TRACE_ENABLED
+#define TRACE_ENABLED 0
+#endif
+
+#if TRACE_ENABLED
+
+/**
+ * @brief Number of spans that are kept in the ring buffer (the oldest are overwritten).
+ * 
+ */
+const uint16_t TRACE_EVENT_COUNT = 128;
+
+/**
+ * @brief One finished span.
+ * 
+ * @details Start and end are taken from micros() so they stay valid over the overflow of the
+ * cycle counter (53 s at 80 MHz, 26 s at 160 MHz). The duration is measured in CPU cycles and only
+ * replaced by the micros() difference for spans that come close to that overflow (e.g. a program
+ * step with "wait", see trace_max_cycle_span()).
+ * 
+ */
+struct trace_event {
+  const char *name;
+  uint32_t start_us;
+  uint32_t end_us;
+  uint32_t cycles;
+};
+
+/**
+ * @brief Distance in microseconds to the overflow of the cycle counter below which the duration of
+ * a span is still taken from the cycle counter.
+ * 
+ */
+const uint32_t TRACE_CYCLE_SPAN_MARGIN = 1000000;
+
+/**
+ * @brief Measures the time from its construction until the end of the enclosing block.
+ * 
+ * @details Do not use directly, use TRACE_SPAN("name") instead. The name has to be a string literal
+ * since only the pointer is stored.
+ * 
+ */
+struct trace_span {
+  const char *name;
+  uint32_t start_us;
+  uint32_t start_cycles;
+  explicit trace_span(const char *name);
+  ~trace_span();
+};
+
+#define TRACE_CONCAT_(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_(a, b)
+#define TRACE_SPAN(name) trace_span TRACE_CONCAT(trace_span_, __LINE__)(name)
+
+void reset_trace();
+uint16_t get_trace_event_count();
+trace_event get_trace_event(uint16_t age);
+uint32_t trace_max_cycle_span(uint32_t cycles_per_us);
+size_t print_trace_json(Print &output);
+
+#else
+
+#define TRACE_SPAN(name) do {} while (0)
+
+#endif  // TRACE_ENABLED
+
+#endif  // TRACE_H_
@@ -0,0 +1,119 @@
+/**
+ * @file udp_command.h
+ * @author Marc Ubbelohde
+ * @brief Header file for udp_command.cpp
+ *
+ * @details This file declares the binary UDP command protocol. It does not depend on the Arduino
+ * framework so it can also be compiled on a computer (see examples/udp_load_generator.cpp).
+ *
+ * Command (all numbers big endian):\n
+ * byte 0-1: magic "IR"\n
+ * byte 2: version (UDP_COMMAND_VERSION)\n
+ * byte 3: flags (UDP_FLAG_TAG if the command ends with a tag)\n
+ * byte 4-7: sequence number (0 if not used, otherwise it has to increase with every command)\n
+ * byte 8: command (udp_command_type)\n
+ * byte 9: length of the payload\n
+ * byte 10-: payload (name of the signal or program, or protocol, number of bits and state)\n
+ * last 8 bytes: HMAC-SHA256 of all bytes before, cut to UDP_TAG_LENGTH (only with UDP_FLAG_TAG)
+ *
+ * The acknowledgement has the same header with UDP_FLAG_ACK, the sequence number and command of
+ * the command, the udp_status in byte 9 and the message of the action as payload.
+ *
+ */
+
+#ifndef UDP_COMMAND_H_
+#define UDP_COMMAND_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Port the device listens on for commands.
+ *
+ */
+const uint16_t UDP_COMMAND_PORT = 4210;
+
+/**
+ * @brief Version of the protocol (byte 2).
+ *
+ */
+const uint8_t UDP_COMMAND_VERSION = 1;
+
+/**
+ * @brief Length of the header in bytes.
+ *
+ */
+const size_t UDP_HEADER_LENGTH = 10;
+
+/**
+ * @brief Length of the tag in bytes (the first bytes of the HMAC-SHA256).
+ *
+ */
+const size_t UDP_TAG_LENGTH = 8;
+
+/**
+ * @brief Longest payload in bytes (names have at most 32 characters, AC states at most 53 bytes).
+ *
+ */
+const size_t UDP_MAX_PAYLOAD = 64;
+
+/**
+ * @brief Longest command or acknowledgement in bytes.
+ *
+ */
+const size_t UDP_MAX_PACKET = UDP_HEADER_LENGTH + UDP_MAX_PAYLOAD + UDP_TAG_LENGTH;
+
+/**
+ * @brief Flag: the command ends with a tag.
+ *
+ */
+const uint8_t UDP_FLAG_TAG = 0x01;
+
+/**
+ * @brief Flag: the packet is an acknowledgement.
+ *
+ */
+const uint8_t UDP_FLAG_ACK = 0x80;
+
+/**
+ * @brief Commands.
+ *
+ */
+enum udp_command_type {
+  UDP_SEND_SIGNAL = 1,   // payload: name of the signal
+  UDP_PLAY_PROGRAM = 2,  // payload: name of the program
+  UDP_SEND_STATE = 3     // payload: protocol (decode_type_t, 2 bytes), bits (2 bytes, 0 for the default) and state (AC) or value (other protocols)
+};
+
+/**
+ * @brief Status in the acknowledgement.
+ *
+ */
+enum udp_status {
+  UDP_OK = 0,
+  UDP_BAD_PACKET = 1,
+  UDP_UNAUTHORIZED = 2,
+  UDP_REPLAYED = 3,
+  UDP_NOT_FOUND = 4,
+  UDP_BUSY = 5,
+  UDP_FAILED = 6
+};
+
+/**
+ * @brief A command (the payload points into the packet).
+ *
+ */
+struct udp_command {
+  uint8_t flags;
+  uint32_t sequence;
+  uint8_t type;
+  uint8_t length;
+  const uint8_t *payload;
+};
+
+void hmac_sha256(const uint8_t *key, size_t key_length, const uint8_t *data, size_t length, uint8_t *digest);
+udp_status parse_udp_command(const uint8_t *packet, size_t size, const uint8_t *key, size_t key_length, udp_command &command);
+size_t build_udp_command(const udp_command &command, const uint8_t *key, size_t key_length, uint8_t *packet);
+size_t build_udp_ack(const udp_command &command, udp_status status, const char *message, uint8_t *packet);
+
+#endif  // UDP_COMMAND_H_
@@ -31,6 +31,7 @@ const char index_html[] PROGMEM = R"rawliteral(<!DOCTYPE HTML><html>
     h2 {text-align: center;}
     p {text-align: center; color: #aaa !important; font-size: 14px;}
     div[id=error_message] {color: red; text-align: center;}
+    div[id=job_status], div[id=clock] {text-align: center;}
     button {padding:5px 15px; background:#ccc; border:0 none; cursor:pointer; -webkit-border-radius: 5px; border-radius: 5px;}
   </style>
 </head>
@@ -39,6 +40,8 @@ const char index_html[] PROGMEM = R"rawliteral(<!DOCTYPE HTML><html>
   <h2>IR-Controller</h2>
   <p id="apinfo">AP-Mode</p>
   <div id="error_message">System message: error message</div>
+  <div id="job_status"></div>
+  <div id="clock"></div>
   <br>
 
 
@@ -79,6 +82,21 @@ const char index_html[] PROGMEM = R"rawliteral(<!DOCTYPE HTML><html>
     <input type="submit" name="edit_program_button" value="edit">
   </form>
 
+  <br><hr>
+
+  <h3>Library:</h3>
+
+  <form action="/api/export">
+    <label for="export_button">Save all signals and programs to a file:</label> <br>
+    <input type="submit" name="export_button" value="export">
+  </form>
+
+  <form action="/api/import" method="post" enctype="multipart/form-data">
+    <label for="archive_file">Load signals and programs from a file:</label> <br>
+    <input type="file" id="archive_file" name="archive_file">
+    <input type="submit" name="import_button" value="import">
+  </form>
+
   <br><hr><br>
 
   <!-- buttons at the bottom of page -->
@@ -157,7 +175,7 @@ const char index_html[] PROGMEM = R"rawliteral(<!DOCTYPE HTML><html>
       - checks if this is the first time the user opens the website (shows welcome message)
       - updates the dropdowns with the current signals and programs
       - inserts the code name and code in the corresponding fields if the user wants to edit a program
-      - updates the error message
+      - updates the error message, job progress and clock from the event stream
       */
 
       // checks if this is the first time the user opens the website
@@ -230,17 +248,40 @@ const char index_html[] PROGMEM = R"rawliteral(<!DOCTYPE HTML><html>
       xhttpProgram.open("GET", "program", true);
       xhttpProgram.send();
 
-      // gets error message from backend
-      var xhttpError = new XMLHttpRequest();
-      xhttpError.onreadystatechange = function() {
-        if (this.readyState == 4 && this.status == 200) {
-          var response = this.responseText;
-          // writes error message to error message field
-          document.getElementById("error_message").innerHTML = "System message: '" + response + "'";
+      // gets messages and progress from the event stream of the backend (reconnects by itself)
+      var events = new EventSource("api/events");
+      events.addEventListener("message", function(event) {
+        // writes error message to error message field
+        document.getElementById("error_message").textContent = "System message: '" + JSON.parse(event.data).message + "'";
+      });
+      events.addEventListener("job", function(event) {
+        var data = JSON.parse(event.data);
+        var status = "job " + data.job;
+        if (data.state !== undefined) {
+          status += " (" + data.kind + "): " + data.state;
         }
-      };
-      xhttpError.open("GET", "error", true);
-      xhttpError.send();
+        else {
+          status += ": line " + data.line;
+          if (data.iteration !== undefined) {
+            status += ", loop iteration " + data.iteration + (data.iterations > 0 ? " of " + data.iterations : "");
+          }
+        }
+        document.getElementById("job_status").textContent = status;
+      });
+      events.addEventListener("capture", function(event) {
+        document.getElementById("job_status").textContent = "capture: " + JSON.parse(event.data).state;
+      });
+      events.addEventListener("learn", function(event) {
+        var data = JSON.parse(event.data);
+        var status = "learned " + data.learned + " of " + data.count + " (" + data.skipped + " skipped, " + data.duplicates + " duplicates)";
+        if (data.active) {
+          status += ", press: " + data.current;
+        }
+        document.getElementById("job_status").textContent = status;
+      });
+      events.addEventListener("clock", function(event) {
+        document.getElementById("clock").textContent = "Device time: " + JSON.parse(event.data).time;
+      });
 
       // gets AP-mode status from backend
       var xhttpAP = new XMLHttpRequest();
@@ -4,23 +4,29 @@
  * @brief Header file for workflows.cpp
  * 
  * @details This file includes the dependencies for the workflows.cpp file
- * which include the Regexp.h file and the base.h file.
+ * which include the tokenizer.h file and the base.h file.
  * 
  */
 
 #include "base.h"
-#include "Regexp.h"
+#include "tokenizer.h"
 
 // forward declarations
 String deleting_workflow(String directory, String command_name);
+String deleting_workflow(String directory, String name, action_status &status);
 
 String recording_workflow(String command_name);
+String recording_workflow(String signal_name, action_status &status);
 String sending_workflow(String command_name);
+String sending_workflow(String signal_name, action_status &status);
 
 String adding_workflow(String program_name, String program_code);
+String adding_workflow(String program_name, String program_code, action_status &status);
 String playing_workflow(String program_name);
+String playing_workflow(String program_name, int resume_line);
 
 String program_parser(String code);
+String program_parser(String code, int first_line);
 
 String handle_wait_command(unsigned long waiting_time);
 String handle_times_commands(String command, boolean day_included);
\ No newline at end of file
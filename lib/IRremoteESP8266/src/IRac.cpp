@@ -64,6 +64,14 @@
 #endif  // ESP8266
 #endif  // STRCASECMP
 
+/// Define a (function) static StrIndex of a table of `{name, value}` pairs.
+/// It is built on the first lookup, for O(1) string to enum conversions.
+#define IRAC_STR_INDEX(INDEX, TABLE) \
+    static const irutils::StrIndex INDEX( \
+        [](const uint16_t i) { \
+          return reinterpret_cast<const char*>(TABLE[i].name); }, \
+        sizeof(TABLE) / sizeof(TABLE[0]))
+
 /// Class constructor
 /// @param[in] pin Gpio pin to use when transmitting IR messages.
 /// @param[in] inverted true, gpio output defaults to high. false, to low.
@@ -3435,34 +3443,34 @@ bool IRac::hasStateChanged(void) { return cmpStates(next, _prev); }
 /// @return The equivalent enum.
 stdAc::opmode_t IRac::strToOpmode(const char *str,
                                   const stdAc::opmode_t def) {
-  if (!STRCASECMP(str, kAutoStr) ||
-      !STRCASECMP(str, kAutomaticStr))
-    return stdAc::opmode_t::kAuto;
-  else if (!STRCASECMP(str, kOffStr) ||
-           !STRCASECMP(str, kStopStr))
-    return stdAc::opmode_t::kOff;
-  else if (!STRCASECMP(str, kCoolStr) ||
-           !STRCASECMP(str, kCoolingStr))
-    return stdAc::opmode_t::kCool;
-  else if (!STRCASECMP(str, kHeatStr) ||
-           !STRCASECMP(str, kHeatingStr))
-    return stdAc::opmode_t::kHeat;
-  else if (!STRCASECMP(str, kDryStr) ||
-           !STRCASECMP(str, kDryingStr) ||
-           !STRCASECMP(str, kDehumidifyStr))
-    return stdAc::opmode_t::kDry;
-  else if (!STRCASECMP(str, kFanStr) ||
-          // The following Fans strings with "only" are required to help with
-          // HomeAssistant & Google Home Climate integration.
-          // For compatibility only.
-          // Ref: https://www.home-assistant.io/integrations/google_assistant/#climate-operation-modes
-           !STRCASECMP(str, kFanOnlyStr) ||
-           !STRCASECMP(str, kFan_OnlyStr) ||
-           !STRCASECMP(str, kFanOnlyWithSpaceStr) ||
-           !STRCASECMP(str, kFanOnlyNoSpaceStr))
-    return stdAc::opmode_t::kFan;
-  else
-    return def;
+  static const struct {
+    IRTEXT_CONST_PTR(name);
+    stdAc::opmode_t value;
+  } kNames[] = {
+      {kAutoStr, stdAc::opmode_t::kAuto},
+      {kAutomaticStr, stdAc::opmode_t::kAuto},
+      {kOffStr, stdAc::opmode_t::kOff},
+      {kStopStr, stdAc::opmode_t::kOff},
+      {kCoolStr, stdAc::opmode_t::kCool},
+      {kCoolingStr, stdAc::opmode_t::kCool},
+      {kHeatStr, stdAc::opmode_t::kHeat},
+      {kHeatingStr, stdAc::opmode_t::kHeat},
+      {kDryStr, stdAc::opmode_t::kDry},
+      {kDryingStr, stdAc::opmode_t::kDry},
+      {kDehumidifyStr, stdAc::opmode_t::kDry},
+      {kFanStr, stdAc::opmode_t::kFan},
+      // The following Fans strings with "only" are required to help with
+      // HomeAssistant & Google Home Climate integration.
+      // For compatibility only.
+      // Ref: https://www.home-assistant.io/integrations/google_assistant/#climate-operation-modes
+      {kFanOnlyStr, stdAc::opmode_t::kFan},
+      {kFan_OnlyStr, stdAc::opmode_t::kFan},
+      {kFanOnlyWithSpaceStr, stdAc::opmode_t::kFan},
+      {kFanOnlyNoSpaceStr, stdAc::opmode_t::kFan},
+  };
+  IRAC_STR_INDEX(index, kNames);
+  const int16_t found = index.find(str);
+  return (found < 0) ? def : kNames[found].value;
 }
 
 /// Convert the supplied str into the appropriate enum.
@@ -3471,29 +3479,29 @@ stdAc::opmode_t IRac::strToOpmode(const char *str,
 /// @return The equivalent enum.
 stdAc::fanspeed_t IRac::strToFanspeed(const char *str,
                                       const stdAc::fanspeed_t def) {
-  if (!STRCASECMP(str, kAutoStr) ||
-      !STRCASECMP(str, kAutomaticStr))
-    return stdAc::fanspeed_t::kAuto;
-  else if (!STRCASECMP(str, kMinStr) ||
-           !STRCASECMP(str, kMinimumStr) ||
-           !STRCASECMP(str, kLowestStr))
-    return stdAc::fanspeed_t::kMin;
-  else if (!STRCASECMP(str, kLowStr) ||
-           !STRCASECMP(str, kLoStr))
-    return stdAc::fanspeed_t::kLow;
-  else if (!STRCASECMP(str, kMedStr) ||
-           !STRCASECMP(str, kMediumStr) ||
-           !STRCASECMP(str, kMidStr))
-    return stdAc::fanspeed_t::kMedium;
-  else if (!STRCASECMP(str, kHighStr) ||
-           !STRCASECMP(str, kHiStr))
-    return stdAc::fanspeed_t::kHigh;
-  else if (!STRCASECMP(str, kMaxStr) ||
-           !STRCASECMP(str, kMaximumStr) ||
-           !STRCASECMP(str, kHighestStr))
-    return stdAc::fanspeed_t::kMax;
-  else
-    return def;
+  static const struct {
+    IRTEXT_CONST_PTR(name);
+    stdAc::fanspeed_t value;
+  } kNames[] = {
+      {kAutoStr, stdAc::fanspeed_t::kAuto},
+      {kAutomaticStr, stdAc::fanspeed_t::kAuto},
+      {kMinStr, stdAc::fanspeed_t::kMin},
+      {kMinimumStr, stdAc::fanspeed_t::kMin},
+      {kLowestStr, stdAc::fanspeed_t::kMin},
+      {kLowStr, stdAc::fanspeed_t::kLow},
+      {kLoStr, stdAc::fanspeed_t::kLow},
+      {kMedStr, stdAc::fanspeed_t::kMedium},
+      {kMediumStr, stdAc::fanspeed_t::kMedium},
+      {kMidStr, stdAc::fanspeed_t::kMedium},
+      {kHighStr, stdAc::fanspeed_t::kHigh},
+      {kHiStr, stdAc::fanspeed_t::kHigh},
+      {kMaxStr, stdAc::fanspeed_t::kMax},
+      {kMaximumStr, stdAc::fanspeed_t::kMax},
+      {kHighestStr, stdAc::fanspeed_t::kMax},
+  };
+  IRAC_STR_INDEX(index, kNames);
+  const int16_t found = index.find(str);
+  return (found < 0) ? def : kNames[found].value;
 }
 
 /// Convert the supplied str into the appropriate enum.
@@ -3502,39 +3510,38 @@ stdAc::fanspeed_t IRac::strToFanspeed(const char *str,
 /// @return The equivalent enum.
 stdAc::swingv_t IRac::strToSwingV(const char *str,
                                   const stdAc::swingv_t def) {
-  if (!STRCASECMP(str, kAutoStr) ||
-      !STRCASECMP(str, kAutomaticStr) ||
-      !STRCASECMP(str, kOnStr) ||
-      !STRCASECMP(str, kSwingStr))
-    return stdAc::swingv_t::kAuto;
-  else if (!STRCASECMP(str, kOffStr) ||
-           !STRCASECMP(str, kStopStr))
-    return stdAc::swingv_t::kOff;
-  else if (!STRCASECMP(str, kMinStr) ||
-           !STRCASECMP(str, kMinimumStr) ||
-           !STRCASECMP(str, kLowestStr) ||
-           !STRCASECMP(str, kBottomStr) ||
-           !STRCASECMP(str, kDownStr))
-    return stdAc::swingv_t::kLowest;
-  else if (!STRCASECMP(str, kLowStr))
-    return stdAc::swingv_t::kLow;
-  else if (!STRCASECMP(str, kMidStr) ||
-           !STRCASECMP(str, kMiddleStr) ||
-           !STRCASECMP(str, kMedStr) ||
-           !STRCASECMP(str, kMediumStr) ||
-           !STRCASECMP(str, kCentreStr))
-    return stdAc::swingv_t::kMiddle;
-  else if (!STRCASECMP(str, kHighStr) ||
-           !STRCASECMP(str, kHiStr))
-    return stdAc::swingv_t::kHigh;
-  else if (!STRCASECMP(str, kHighestStr) ||
-           !STRCASECMP(str, kMaxStr) ||
-           !STRCASECMP(str, kMaximumStr) ||
-           !STRCASECMP(str, kTopStr) ||
-           !STRCASECMP(str, kUpStr))
-    return stdAc::swingv_t::kHighest;
-  else
-    return def;
+  static const struct {
+    IRTEXT_CONST_PTR(name);
+    stdAc::swingv_t value;
+  } kNames[] = {
+      {kAutoStr, stdAc::swingv_t::kAuto},
+      {kAutomaticStr, stdAc::swingv_t::kAuto},
+      {kOnStr, stdAc::swingv_t::kAuto},
+      {kSwingStr, stdAc::swingv_t::kAuto},
+      {kOffStr, stdAc::swingv_t::kOff},
+      {kStopStr, stdAc::swingv_t::kOff},
+      {kMinStr, stdAc::swingv_t::kLowest},
+      {kMinimumStr, stdAc::swingv_t::kLowest},
+      {kLowestStr, stdAc::swingv_t::kLowest},
+      {kBottomStr, stdAc::swingv_t::kLowest},
+      {kDownStr, stdAc::swingv_t::kLowest},
+      {kLowStr, stdAc::swingv_t::kLow},
+      {kMidStr, stdAc::swingv_t::kMiddle},
+      {kMiddleStr, stdAc::swingv_t::kMiddle},
+      {kMedStr, stdAc::swingv_t::kMiddle},
+      {kMediumStr, stdAc::swingv_t::kMiddle},
+      {kCentreStr, stdAc::swingv_t::kMiddle},
+      {kHighStr, stdAc::swingv_t::kHigh},
+      {kHiStr, stdAc::swingv_t::kHigh},
+      {kHighestStr, stdAc::swingv_t::kHighest},
+      {kMaxStr, stdAc::swingv_t::kHighest},
+      {kMaximumStr, stdAc::swingv_t::kHighest},
+      {kTopStr, stdAc::swingv_t::kHighest},
+      {kUpStr, stdAc::swingv_t::kHighest},
+  };
+  IRAC_STR_INDEX(index, kNames);
+  const int16_t found = index.find(str);
+  return (found < 0) ? def : kNames[found].value;
 }
 
 /// Convert the supplied str into the appropriate enum.
@@ -3543,37 +3550,36 @@ stdAc::swingv_t IRac::strToSwingV(const char *str,
 /// @return The equivalent enum.
 stdAc::swingh_t IRac::strToSwingH(const char *str,
                                   const stdAc::swingh_t def) {
-  if (!STRCASECMP(str, kAutoStr) ||
-      !STRCASECMP(str, kAutomaticStr) ||
-      !STRCASECMP(str, kOnStr) || !STRCASECMP(str, kSwingStr))
-    return stdAc::swingh_t::kAuto;
-  else if (!STRCASECMP(str, kOffStr) ||
-           !STRCASECMP(str, kStopStr))
-    return stdAc::swingh_t::kOff;
-  else if (!STRCASECMP(str, kLeftMaxNoSpaceStr) ||              // "LeftMax"
-           !STRCASECMP(str, kLeftMaxStr) ||                     // "Left Max"
-           !STRCASECMP(str, kMaxLeftNoSpaceStr) ||              // "MaxLeft"
-           !STRCASECMP(str, kMaxLeftStr))                       // "Max Left"
-    return stdAc::swingh_t::kLeftMax;
-  else if (!STRCASECMP(str, kLeftStr))
-    return stdAc::swingh_t::kLeft;
-  else if (!STRCASECMP(str, kMidStr) ||
-           !STRCASECMP(str, kMiddleStr) ||
-           !STRCASECMP(str, kMedStr) ||
-           !STRCASECMP(str, kMediumStr) ||
-           !STRCASECMP(str, kCentreStr))
-    return stdAc::swingh_t::kMiddle;
-  else if (!STRCASECMP(str, kRightStr))
-    return stdAc::swingh_t::kRight;
-  else if (!STRCASECMP(str, kRightMaxNoSpaceStr) ||              // "RightMax"
-           !STRCASECMP(str, kRightMaxStr) ||                     // "Right Max"
-           !STRCASECMP(str, kMaxRightNoSpaceStr) ||              // "MaxRight"
-           !STRCASECMP(str, kMaxRightStr))                       // "Max Right"
-    return stdAc::swingh_t::kRightMax;
-  else if (!STRCASECMP(str, kWideStr))
-    return stdAc::swingh_t::kWide;
-  else
-    return def;
+  static const struct {
+    IRTEXT_CONST_PTR(name);
+    stdAc::swingh_t value;
+  } kNames[] = {
+      {kAutoStr, stdAc::swingh_t::kAuto},
+      {kAutomaticStr, stdAc::swingh_t::kAuto},
+      {kOnStr, stdAc::swingh_t::kAuto},
+      {kSwingStr, stdAc::swingh_t::kAuto},
+      {kOffStr, stdAc::swingh_t::kOff},
+      {kStopStr, stdAc::swingh_t::kOff},
+      {kLeftMaxNoSpaceStr, stdAc::swingh_t::kLeftMax},
+      {kLeftMaxStr, stdAc::swingh_t::kLeftMax},
+      {kMaxLeftNoSpaceStr, stdAc::swingh_t::kLeftMax},
+      {kMaxLeftStr, stdAc::swingh_t::kLeftMax},
+      {kLeftStr, stdAc::swingh_t::kLeft},
+      {kMidStr, stdAc::swingh_t::kMiddle},
+      {kMiddleStr, stdAc::swingh_t::kMiddle},
+      {kMedStr, stdAc::swingh_t::kMiddle},
+      {kMediumStr, stdAc::swingh_t::kMiddle},
+      {kCentreStr, stdAc::swingh_t::kMiddle},
+      {kRightStr, stdAc::swingh_t::kRight},
+      {kRightMaxNoSpaceStr, stdAc::swingh_t::kRightMax},
+      {kRightMaxStr, stdAc::swingh_t::kRightMax},
+      {kMaxRightNoSpaceStr, stdAc::swingh_t::kRightMax},
+      {kMaxRightStr, stdAc::swingh_t::kRightMax},
+      {kWideStr, stdAc::swingh_t::kWide},
+  };
+  IRAC_STR_INDEX(index, kNames);
+  const int16_t found = index.find(str);
+  return (found < 0) ? def : kNames[found].value;
 }
 
 /// Convert the supplied str into the appropriate enum.
@@ -3583,96 +3589,70 @@ stdAc::swingh_t IRac::strToSwingH(const char *str,
 /// @return The equivalent enum.
 /// @note After adding a new model you should update modelToStr() too.
 int16_t IRac::strToModel(const char *str, const int16_t def) {
-  // Gree
-  if (!STRCASECMP(str, kYaw1fStr)) {
-    return gree_ac_remote_model_t::YAW1F;
-  } else if (!STRCASECMP(str, kYbofbStr)) {
-    return gree_ac_remote_model_t::YBOFB;
-  } else if (!STRCASECMP(str, kYx1fsfStr)) {
-    return gree_ac_remote_model_t::YX1FSF;
-  // Haier models
-  } else if (!STRCASECMP(str, kV9014557AStr)) {
-    return haier_ac176_remote_model_t::V9014557_A;
-  } else if (!STRCASECMP(str, kV9014557BStr)) {
-    return haier_ac176_remote_model_t::V9014557_B;
-  // HitachiAc1 models
-  } else if (!STRCASECMP(str, kRlt0541htaaStr)) {
-    return hitachi_ac1_remote_model_t::R_LT0541_HTA_A;
-  } else if (!STRCASECMP(str, kRlt0541htabStr)) {
-    return hitachi_ac1_remote_model_t::R_LT0541_HTA_B;
-  // Fujitsu A/C models
-  } else if (!STRCASECMP(str, kArrah2eStr)) {
-    return fujitsu_ac_remote_model_t::ARRAH2E;
-  } else if (!STRCASECMP(str, kArdb1Str)) {
-    return fujitsu_ac_remote_model_t::ARDB1;
-  } else if (!STRCASECMP(str, kArreb1eStr)) {
-    return fujitsu_ac_remote_model_t::ARREB1E;
-  } else if (!STRCASECMP(str, kArjw2Str)) {
-    return fujitsu_ac_remote_model_t::ARJW2;
-  } else if (!STRCASECMP(str, kArry4Str)) {
-    return fujitsu_ac_remote_model_t::ARRY4;
-  } else if (!STRCASECMP(str, kArrew4eStr)) {
-    return fujitsu_ac_remote_model_t::ARREW4E;
-  // LG A/C models
-  } else if (!STRCASECMP(str, kGe6711ar2853mStr)) {
-    return lg_ac_remote_model_t::GE6711AR2853M;
-  } else if (!STRCASECMP(str, kAkb75215403Str)) {
-    return lg_ac_remote_model_t::AKB75215403;
-  } else if (!STRCASECMP(str, kAkb74955603Str)) {
-    return lg_ac_remote_model_t::AKB74955603;
-  } else if (!STRCASECMP(str, kAkb73757604Str)) {
-    return lg_ac_remote_model_t::AKB73757604;
-  } else if (!STRCASECMP(str, kLg6711a20083vStr)) {
-    return lg_ac_remote_model_t::LG6711A20083V;
-  // Panasonic A/C families
-  } else if (!STRCASECMP(str, kLkeStr) ||
-             !STRCASECMP(str, kPanasonicLkeStr)) {
-    return panasonic_ac_remote_model_t::kPanasonicLke;
-  } else if (!STRCASECMP(str, kNkeStr) ||
-             !STRCASECMP(str, kPanasonicNkeStr)) {
-    return panasonic_ac_remote_model_t::kPanasonicNke;
-  } else if (!STRCASECMP(str, kDkeStr) ||
-             !STRCASECMP(str, kPanasonicDkeStr) ||
-             !STRCASECMP(str, kPkrStr) ||
-             !STRCASECMP(str, kPanasonicPkrStr)) {
-    return panasonic_ac_remote_model_t::kPanasonicDke;
-  } else if (!STRCASECMP(str, kJkeStr) ||
-             !STRCASECMP(str, kPanasonicJkeStr)) {
-    return panasonic_ac_remote_model_t::kPanasonicJke;
-  } else if (!STRCASECMP(str, kCkpStr) ||
-             !STRCASECMP(str, kPanasonicCkpStr)) {
-    return panasonic_ac_remote_model_t::kPanasonicCkp;
-  } else if (!STRCASECMP(str, kRkrStr) ||
-             !STRCASECMP(str, kPanasonicRkrStr)) {
-    return panasonic_ac_remote_model_t::kPanasonicRkr;
-  // Sharp A/C Models
-  } else if (!STRCASECMP(str, kA907Str)) {
-    return sharp_ac_remote_model_t::A907;
-  } else if (!STRCASECMP(str, kA705Str)) {
-    return sharp_ac_remote_model_t::A705;
-  } else if (!STRCASECMP(str, kA903Str)) {
-    return sharp_ac_remote_model_t::A903;
-  // TCL A/C Models
-  } else if (!STRCASECMP(str, kTac09chsdStr)) {
-    return tcl_ac_remote_model_t::TAC09CHSD;
-  } else if (!STRCASECMP(str, kGz055be1Str)) {
-    return tcl_ac_remote_model_t::GZ055BE1;
-  // Voltas A/C models
-  } else if (!STRCASECMP(str, k122lzfStr)) {
-    return voltas_ac_remote_model_t::kVoltas122LZF;
-  // Whirlpool A/C models
-  } else if (!STRCASECMP(str, kDg11j13aStr) ||
-             !STRCASECMP(str, kDg11j104Str)) {
-    return whirlpool_ac_remote_model_t::DG11J13A;
-  } else if (!STRCASECMP(str, kDg11j191Str)) {
-    return whirlpool_ac_remote_model_t::DG11J191;
-  } else {
-    int16_t number = atoi(str);
-    if (number > 0)
-      return number;
-    else
-      return def;
-  }
+  static const struct {
+    IRTEXT_CONST_PTR(name);
+    int16_t value;
+  } kNames[] = {
+      // Gree
+      {kYaw1fStr, gree_ac_remote_model_t::YAW1F},
+      {kYbofbStr, gree_ac_remote_model_t::YBOFB},
+      {kYx1fsfStr, gree_ac_remote_model_t::YX1FSF},
+      // Haier models
+      {kV9014557AStr, haier_ac176_remote_model_t::V9014557_A},
+      {kV9014557BStr, haier_ac176_remote_model_t::V9014557_B},
+      // HitachiAc1 models
+      {kRlt0541htaaStr, hitachi_ac1_remote_model_t::R_LT0541_HTA_A},
+      {kRlt0541htabStr, hitachi_ac1_remote_model_t::R_LT0541_HTA_B},
+      // Fujitsu A/C models
+      {kArrah2eStr, fujitsu_ac_remote_model_t::ARRAH2E},
+      {kArdb1Str, fujitsu_ac_remote_model_t::ARDB1},
+      {kArreb1eStr, fujitsu_ac_remote_model_t::ARREB1E},
+      {kArjw2Str, fujitsu_ac_remote_model_t::ARJW2},
+      {kArry4Str, fujitsu_ac_remote_model_t::ARRY4},
+      {kArrew4eStr, fujitsu_ac_remote_model_t::ARREW4E},
+      // LG A/C models
+      {kGe6711ar2853mStr, lg_ac_remote_model_t::GE6711AR2853M},
+      {kAkb75215403Str, lg_ac_remote_model_t::AKB75215403},
+      {kAkb74955603Str, lg_ac_remote_model_t::AKB74955603},
+      {kAkb73757604Str, lg_ac_remote_model_t::AKB73757604},
+      {kLg6711a20083vStr, lg_ac_remote_model_t::LG6711A20083V},
+      // Panasonic A/C families
+      {kLkeStr, panasonic_ac_remote_model_t::kPanasonicLke},
+      {kPanasonicLkeStr, panasonic_ac_remote_model_t::kPanasonicLke},
+      {kNkeStr, panasonic_ac_remote_model_t::kPanasonicNke},
+      {kPanasonicNkeStr, panasonic_ac_remote_model_t::kPanasonicNke},
+      {kDkeStr, panasonic_ac_remote_model_t::kPanasonicDke},
+      {kPanasonicDkeStr, panasonic_ac_remote_model_t::kPanasonicDke},
+      {kPkrStr, panasonic_ac_remote_model_t::kPanasonicDke},
+      {kPanasonicPkrStr, panasonic_ac_remote_model_t::kPanasonicDke},
+      {kJkeStr, panasonic_ac_remote_model_t::kPanasonicJke},
+      {kPanasonicJkeStr, panasonic_ac_remote_model_t::kPanasonicJke},
+      {kCkpStr, panasonic_ac_remote_model_t::kPanasonicCkp},
+      {kPanasonicCkpStr, panasonic_ac_remote_model_t::kPanasonicCkp},
+      {kRkrStr, panasonic_ac_remote_model_t::kPanasonicRkr},
+      {kPanasonicRkrStr, panasonic_ac_remote_model_t::kPanasonicRkr},
+      // Sharp A/C Models
+      {kA907Str, sharp_ac_remote_model_t::A907},
+      {kA705Str, sharp_ac_remote_model_t::A705},
+      {kA903Str, sharp_ac_remote_model_t::A903},
+      // TCL A/C Models
+      {kTac09chsdStr, tcl_ac_remote_model_t::TAC09CHSD},
+      {kGz055be1Str, tcl_ac_remote_model_t::GZ055BE1},
+      // Voltas A/C models
+      {k122lzfStr, voltas_ac_remote_model_t::kVoltas122LZF},
+      // Whirlpool A/C models
+      {kDg11j13aStr, whirlpool_ac_remote_model_t::DG11J13A},
+      {kDg11j104Str, whirlpool_ac_remote_model_t::DG11J13A},
+      {kDg11j191Str, whirlpool_ac_remote_model_t::DG11J191},
+  };
+  IRAC_STR_INDEX(index, kNames);
+  const int16_t found = index.find(str);
+  if (found >= 0) return kNames[found].value;
+  int16_t number = atoi(str);
+  if (number > 0)
+    return number;
+  else
+    return def;
 }
 
 /// Convert the supplied str into the appropriate boolean value.
@@ -3680,18 +3660,22 @@ int16_t IRac::strToModel(const char *str, const int16_t def) {
 /// @param[in] def The boolean value to return if no conversion was possible.
 /// @return The equivalent boolean value.
 bool IRac::strToBool(const char *str, const bool def) {
-  if (!STRCASECMP(str, kOnStr) ||
-      !STRCASECMP(str, k1Str) ||
-      !STRCASECMP(str, kYesStr) ||
-      !STRCASECMP(str, kTrueStr))
-    return true;
-  else if (!STRCASECMP(str, kOffStr) ||
-           !STRCASECMP(str, k0Str) ||
-           !STRCASECMP(str, kNoStr) ||
-           !STRCASECMP(str, kFalseStr))
-    return false;
-  else
-    return def;
+  static const struct {
+    IRTEXT_CONST_PTR(name);
+    bool value;
+  } kNames[] = {
+      {kOnStr, true},
+      {k1Str, true},
+      {kYesStr, true},
+      {kTrueStr, true},
+      {kOffStr, false},
+      {k0Str, false},
+      {kNoStr, false},
+      {kFalseStr, false},
+  };
+  IRAC_STR_INDEX(index, kNames);
+  const int16_t found = index.find(str);
+  return (found < 0) ? def : kNames[found].value;
 }
 
 /// Convert the supplied boolean into the appropriate String.
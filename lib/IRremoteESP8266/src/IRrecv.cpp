@@ -24,6 +24,7 @@ extern "C" {
 #ifdef UNIT_TEST
 #undef ICACHE_RAM_ATTR
 #define ICACHE_RAM_ATTR
+#define USE_IRAM_ATTR
 #endif
 
 #ifndef USE_IRAM_ATTR
@@ -146,6 +147,18 @@ portMUX_TYPE mux = portMUX_INITIALIZER_UNLOCKED;
 #endif  // ESP32
 volatile irparams_t params;
 irparams_t *params_save;  // A copy of the interrupt state while decoding.
+#if ENABLE_DOUBLE_BUFFER_OPTION
+volatile irbuffers_t buffers;  // The second buffer in double buffer mode.
+#endif  // ENABLE_DOUBLE_BUFFER_OPTION
+#if ENABLE_CHUNKED_CAPTURE_OPTION
+volatile irchunks_t chunks;  // The pool of chunks in chunked capture mode.
+#endif  // ENABLE_CHUNKED_CAPTURE_OPTION
+#if ENABLE_CYCLE_COUNT_OPTION
+uint8_t cycle_count_shift = kCycleCountShift80MHz;  // Units of 2^N cycles.
+uint32_t cycle_count_start;    // The cycle counter at the previous edge.
+uint32_t cycle_count_timeout;  // The timeout in hardware timer ticks.
+#endif  // ENABLE_CYCLE_COUNT_OPTION
+volatile uint32_t edge_start;  // The value of micros() at the previous edge.
 }  // namespace _IRrecv
 
 #if defined(ESP32)
@@ -153,6 +166,115 @@ using _IRrecv::mux;
 #endif  // ESP32
 using _IRrecv::params;
 using _IRrecv::params_save;
+using _IRrecv::edge_start;
+#if ENABLE_DOUBLE_BUFFER_OPTION
+using _IRrecv::buffers;
+#endif  // ENABLE_DOUBLE_BUFFER_OPTION
+#if ENABLE_CHUNKED_CAPTURE_OPTION
+using _IRrecv::chunks;
+
+/// Start capturing the next message into the largest free run of the pool.
+/// i.e. Around the captures waiting for, or in use by, `decode()`.
+/// @return true if there was room in the pool, false if not.
+static bool USE_IRAM_ATTR start_chunked_capture(void) {
+  // Put the two regions in use in pool order. Empty ones are at the start.
+  uint32_t first = chunks.ready;
+  uint32_t second = chunks.held;
+  if (first > second) {
+    first = chunks.held;
+    second = chunks.ready;
+  }
+  const uint16_t first_end = first & 0xFFFF;
+  const uint16_t second_start = second >> 16;
+  const uint16_t last_end = std::max(first_end, (uint16_t)(second & 0xFFFF));
+  // The free runs are before, between & after them.
+  uint16_t start = 0;
+  uint16_t length = first >> 16;
+  if (second_start > first_end && second_start - first_end > length) {
+    start = first_end;
+    length = second_start - first_end;
+  }
+  if (chunks.size - last_end > length) {
+    start = last_end;
+    length = chunks.size - last_end;
+  }
+  if (length < 2) return false;  // No room for an entry & the terminating 0.
+  params.rawbuf = chunks.pool + start;
+  params.bufsize = std::min((uint16_t)(length - 1), (uint16_t)chunks.ceiling);
+  params.rawlen = 0;
+  params.overflow = false;
+  params.rcvstate = kIdleState;
+  return true;
+}
+#endif  // ENABLE_CHUNKED_CAPTURE_OPTION
+#if ENABLE_CYCLE_COUNT_OPTION
+using _IRrecv::cycle_count_shift;
+using _IRrecv::cycle_count_start;
+using _IRrecv::cycle_count_timeout;
+#endif  // ENABLE_CYCLE_COUNT_OPTION
+
+/// Stop capturing as we have reached the end of a message.
+/// In double buffer mode, if the spare buffer is free, swap to it instead &
+/// carry on capturing into it straight away.
+static void USE_IRAM_ATTR stop_capture(void) {
+#if ENABLE_CHUNKED_CAPTURE_OPTION
+  if (chunks.pool != NULL) {
+    if (!chunks.ready) {
+      // Hand over the chunks used, incl. the entry for the terminating 0.
+      const uint16_t start = params.rawbuf - chunks.pool;
+      const uint16_t used = (params.rawlen / chunks.chunk + 1) * chunks.chunk;
+      const uint16_t end = std::min((uint16_t)(start + used), (uint16_t)chunks.size);
+      chunks.rawlen = params.rawlen;
+      chunks.overflow = params.overflow;
+      chunks.ready = (uint32_t)start << 16 | end;
+      if (start_chunked_capture()) return;
+      params.rawlen = 0;  // It has been handed over.
+      chunks.stalled = true;
+    }
+    params.rcvstate = kStopState;
+    return;
+  }
+#endif  // ENABLE_CHUNKED_CAPTURE_OPTION
+#if ENABLE_DOUBLE_BUFFER_OPTION
+  uint16_t *spare = buffers.spare;
+  if (spare != NULL) {
+    buffers.rawlen = params.rawlen;
+    buffers.overflow = params.overflow;
+    buffers.ready = params.rawbuf;
+    buffers.spare = NULL;
+    params.rawbuf = spare;
+    params.rawlen = 0;
+    params.overflow = false;
+    params.rcvstate = kIdleState;
+    return;
+  }
+#endif  // ENABLE_DOUBLE_BUFFER_OPTION
+  params.rcvstate = kStopState;
+}
+
+#if ENABLE_CYCLE_COUNT_OPTION
+/// Record an edge of the incoming IR message in CPU cycle counter units.
+/// Converting them into ticks is left to `decode()`, to keep this quick.
+/// @param[in] now The value of the CPU cycle counter at the edge.
+static inline void USE_IRAM_ATTR record_cycle_count(const uint32_t now) {
+  const uint16_t rawlen = params.rawlen;
+  if (rawlen >= params.bufsize) {
+    params.overflow = true;
+    params.rcvstate = kStopState;
+  }
+  if (params.rcvstate == kStopState) return;
+  if (params.rcvstate == kIdleState) {
+    params.rcvstate = kMarkState;
+    params.rawbuf[rawlen] = 1;
+  } else {
+    // Unsigned maths takes care of the counter wrapping around.
+    const uint32_t count = (now - cycle_count_start) >> cycle_count_shift;
+    params.rawbuf[rawlen] = (count > UINT16_MAX) ? UINT16_MAX : count;
+  }
+  params.rawlen = rawlen + 1;
+  cycle_count_start = now;
+}
+#endif  // ENABLE_CYCLE_COUNT_OPTION
 
 #ifndef UNIT_TEST
 #if defined(ESP8266)
@@ -171,7 +293,7 @@ static void USE_IRAM_ATTR read_timeout(void) {
 /// @endcond
   portENTER_CRITICAL(&mux);
 #endif  // ESP32
-  if (params.rawlen) params.rcvstate = kStopState;
+  if (params.rawlen) stop_capture();
 #if defined(ESP8266)
   os_intr_unlock();
 #endif  // ESP8266
@@ -183,7 +305,7 @@ static void USE_IRAM_ATTR read_timeout(void) {
 /// Interrupt handler for changes on the GPIO pin handling incoming IR messages.
 static void USE_IRAM_ATTR gpio_intr() {
   uint32_t now = micros();
-  static uint32_t start = 0;
+  uint32_t start = edge_start;
 
 #if defined(ESP8266)
   uint32_t gpio_status = GPIO_REG_READ(GPIO_STATUS_ADDRESS);
@@ -217,7 +339,7 @@ static void USE_IRAM_ATTR gpio_intr() {
   }
   params.rawlen++;
 
-  start = now;
+  edge_start = now;
 
 #if defined(ESP8266)
   os_timer_arm(&timer, params.timeout, ONCE);
@@ -247,6 +369,26 @@ static void USE_IRAM_ATTR gpio_intr() {
 #endif  // _ESP32_IRRECV_TIMER_HACK
 #endif  // ESP32
 }
+
+#if (ENABLE_CYCLE_COUNT_OPTION && defined(ESP8266))
+/// Interrupt handler for when the hardware timer runs out, when using
+/// `gpio_intr_cycle_count()`.
+static void USE_IRAM_ATTR cycle_count_timeout_intr(void) {
+  if (params.rawlen) stop_capture();
+}
+
+/// Interrupt handler for changes on the GPIO pin handling incoming IR messages,
+/// which does as little as possible. i.e. It records the CPU cycle counter
+/// difference & restarts the single shot hardware timer (timer1) for the
+/// timeout, rather than calling `micros()`, dividing & rearming a software
+/// timer.
+static void USE_IRAM_ATTR gpio_intr_cycle_count() {
+  const uint32_t now = esp_get_cycle_count();
+  GPIO_REG_WRITE(GPIO_STATUS_W1TC_ADDRESS, GPIO_REG_READ(GPIO_STATUS_ADDRESS));
+  record_cycle_count(now);
+  if (params.rcvstate != kStopState) timer1_write(cycle_count_timeout);
+}
+#endif  // (ENABLE_CYCLE_COUNT_OPTION && defined(ESP8266))
 #endif  // UNIT_TEST
 
 // Start of IRrecv class -------------------
@@ -324,6 +466,31 @@ IRrecv::IRrecv(const uint16_t recvpin, const uint16_t bufsize,
 #if DECODE_HASH
   _unknown_threshold = kUnknownThreshold;
 #endif  // DECODE_HASH
+#if ENABLE_NOISE_FILTER_OPTION
+  _noise_filter = {0, 0, true};  // No filtering by default.
+#endif  // ENABLE_NOISE_FILTER_OPTION
+#if ENABLE_DOUBLE_BUFFER_OPTION
+  _double_buffer = false;
+  buffers.spare = NULL;
+  buffers.ready = NULL;
+  buffers.held = NULL;
+#endif  // ENABLE_DOUBLE_BUFFER_OPTION
+#if ENABLE_CHUNKED_CAPTURE_OPTION
+  _chunked = false;
+  chunks.pool = NULL;
+  chunks.ready = 0;
+  chunks.held = 0;
+#endif  // ENABLE_CHUNKED_CAPTURE_OPTION
+#if ENABLE_CYCLE_COUNT_OPTION
+  _cycle_count = false;
+  _cycle_count_mhz = 80;
+#endif  // ENABLE_CYCLE_COUNT_OPTION
+#if ENABLE_EARLY_DECODE_OPTION
+  _early_buf = NULL;
+  _early_length = 0;
+  _early_silence = 0;
+  _early_tried = 0;
+#endif  // ENABLE_EARLY_DECODE_OPTION
   _tolerance = kTolerance;
 }
 
@@ -333,6 +500,15 @@ IRrecv::IRrecv(const uint16_t recvpin, const uint16_t bufsize,
 /// timers or interrupts used.
 IRrecv::~IRrecv(void) {
   disableIRIn();
+#if ENABLE_DOUBLE_BUFFER_OPTION
+  setDoubleBuffer(false);  // Return the second buffer to where we free it.
+#endif  // ENABLE_DOUBLE_BUFFER_OPTION
+#if ENABLE_CHUNKED_CAPTURE_OPTION
+  setChunkedCapture(0);  // Point back at the start of the pool to free it.
+#endif  // ENABLE_CHUNKED_CAPTURE_OPTION
+#if ENABLE_EARLY_DECODE_OPTION
+  setEarlyDecode(0);  // Free the scratch buffer.
+#endif  // ENABLE_EARLY_DECODE_OPTION
 #if defined(ESP32)
   if (timer != NULL) timerEnd(timer);  // Cleanup the ESP32 timeout timer.
 #endif  // ESP32
@@ -378,8 +554,28 @@ void IRrecv::enableIRIn(const bool pullup) {
   // Initialise state machine variables
   resume();
 
+#if ENABLE_CYCLE_COUNT_OPTION
+  // The cycle counts are converted using the CPU speed they were recorded at.
+#if defined(ESP8266) && !defined(UNIT_TEST)
+  _cycle_count_mhz = ESP.getCpuFreqMHz();
+#endif  // defined(ESP8266) && !defined(UNIT_TEST)
+  cycle_count_shift = (_cycle_count_mhz > 80) ? kCycleCountShift160MHz
+                                               : kCycleCountShift80MHz;
+#endif  // ENABLE_CYCLE_COUNT_OPTION
+
 #ifndef UNIT_TEST
 #if defined(ESP8266)
+#if ENABLE_CYCLE_COUNT_OPTION
+  if (_cycle_count) {
+    // timer1 runs at 80MHz / 16. i.e. 5 ticks per usec.
+    cycle_count_timeout = MS_TO_USEC(params.timeout) * 5;
+    timer1_isr_init();
+    timer1_attachInterrupt(cycle_count_timeout_intr);
+    timer1_enable(TIM_DIV16, TIM_EDGE, TIM_SINGLE);
+    attachInterrupt(params.recvpin, gpio_intr_cycle_count, CHANGE);
+    return;
+  }
+#endif  // ENABLE_CYCLE_COUNT_OPTION
   // Initialise ESP8266 timer.
   os_timer_disarm(&timer);
   os_timer_setfn(&timer, reinterpret_cast<os_timer_func_t *>(read_timeout),
@@ -396,6 +592,12 @@ void IRrecv::disableIRIn(void) {
 #ifndef UNIT_TEST
 #if defined(ESP8266)
   os_timer_disarm(&timer);
+#if ENABLE_CYCLE_COUNT_OPTION
+  if (_cycle_count) {
+    timer1_disable();
+    timer1_detachInterrupt();
+  }
+#endif  // ENABLE_CYCLE_COUNT_OPTION
 #endif  // ESP8266
 #if defined(ESP32)
   timerAlarmDisable(timer);
@@ -460,7 +662,291 @@ void IRrecv::copyIrParams(volatile irparams_t *src, irparams_t *dst) {
 /// Obtain the maximum number of entries possible in the capture buffer.
 /// i.e. It's size.
 /// @return The size of the buffer that is in use by the object.
-uint16_t IRrecv::getBufSize(void) { return params.bufsize; }
+/// @note In chunked capture mode, it is the max. nr. of entries in a capture.
+uint16_t IRrecv::getBufSize(void) {
+#if ENABLE_CHUNKED_CAPTURE_OPTION
+  if (_chunked) return chunks.ceiling;
+#endif  // ENABLE_CHUNKED_CAPTURE_OPTION
+  return params.bufsize;
+}
+
+#if ENABLE_DOUBLE_BUFFER_OPTION
+/// Set the double buffer mode. i.e. At the end of each message, the interrupt
+/// swaps to the second (save) buffer and keeps on capturing into that, rather
+/// than `decode()` copying the capture buffer & then resuming.
+/// `decode()` uses the filled buffer as is, until it is handed back by
+/// `releaseBuffer()` or the next `decode()`. If the interrupt has nothing to
+/// swap to at the end of a message, it stops capturing like it normally does,
+/// and the next `decode()` swaps the buffers instead.
+/// @param[in] enable true to swap the buffers, false to copy them.
+/// @return true if the mode was set, false if the class was created without a
+///   `save_buffer`, so there is no second buffer.
+/// @note This pauses the receiver & discards any captured data. Call it before
+///   `enableIRIn()`, or call `resume()` afterwards. In double buffer mode,
+///   don't call `resume()` after `decode()` as it discards the message being
+///   captured.
+bool IRrecv::setDoubleBuffer(const bool enable) {
+  if (params_save == NULL) return false;  // There is no second buffer.
+#if ENABLE_CHUNKED_CAPTURE_OPTION
+  if (enable && _chunked) setChunkedCapture(0);
+#endif  // ENABLE_CHUNKED_CAPTURE_OPTION
+  pause();
+  // Gather up the second buffer, wherever it currently is.
+  uint16_t *other = buffers.spare;
+  if (other == NULL) other = buffers.ready;
+  if (other == NULL) other = buffers.held;
+  if (other != NULL) params_save->rawbuf = other;
+  buffers.spare = enable ? params_save->rawbuf : NULL;
+  buffers.ready = NULL;
+  buffers.held = NULL;
+  _double_buffer = enable;
+  return true;
+}
+
+/// Take the buffer the interrupt has filled, in double buffer mode.
+/// @param[out] results A PTR to the decode_results to point at the buffer.
+/// @return true if there was a filled buffer to take, false if not.
+bool IRrecv::_takeBuffer(decode_results *results) {
+  releaseBuffer();  // The previous results are no longer needed.
+  // The interrupt stopped as it had no buffer to swap to, so swap for it.
+  if (buffers.ready == NULL && params.rcvstate == kStopState &&
+      params.rawlen) {
+    stop_capture();
+    resume();
+  }
+  uint16_t *ready = buffers.ready;
+  if (ready == NULL) return false;
+  results->rawbuf = ready;
+  results->rawlen = buffers.rawlen;
+  results->overflow = buffers.overflow;
+  buffers.held = ready;
+  buffers.ready = NULL;
+  // Clear the entry after the message, as `decode()` does for a single buffer.
+  if (!results->overflow) ready[results->rawlen] = 0;
+  return true;
+}
+#endif  // ENABLE_DOUBLE_BUFFER_OPTION
+
+#if ENABLE_CHUNKED_CAPTURE_OPTION
+/// Set the chunked capture mode. i.e. The capture buffer is used as a pool of
+/// `chunk` sized chunks. Each message is captured into the largest free run of
+/// the pool, and only the chunks it used are kept for `decode()`, so the next
+/// message is captured into the rest of the pool meanwhile. Short messages
+/// only tie up a chunk or two, while long ones (e.g. multi-frame A/C messages)
+/// can use up to `ceiling` entries if there is room.
+/// `decode()` uses the capture in place, until it is handed back by
+/// `releaseBuffer()` or the next `decode()`.
+/// @param[in] chunk Nr. of entries in a chunk. 0 turns chunked capture off.
+/// @param[in] ceiling Max. nr. of entries in a capture.
+///   (Default: 0. i.e. As many as fit in the pool.)
+/// @return true if the mode was set, false if the chunk size is too big.
+/// @note This pauses the receiver & discards any captured data. Call it before
+///   `enableIRIn()`, or call `resume()` afterwards. In chunked capture mode,
+///   don't call `resume()` after `decode()` as it discards the message being
+///   captured. It can't be used together with `setDoubleBuffer()`.
+bool IRrecv::setChunkedCapture(const uint16_t chunk, const uint16_t ceiling) {
+  pause();
+  if (chunks.pool != NULL) {  // Go back to using the buffer as a whole.
+    params.rawbuf = chunks.pool;
+    params.bufsize = chunks.size;
+    chunks.pool = NULL;
+  }
+  _chunked = false;
+  if (chunk == 0) return true;  // Turned off.
+  if (chunk >= params.bufsize) return false;  // The pool needs 2+ chunks.
+#if ENABLE_DOUBLE_BUFFER_OPTION
+  if (_double_buffer) setDoubleBuffer(false);
+#endif  // ENABLE_DOUBLE_BUFFER_OPTION
+  chunks.size = params.bufsize;
+  chunks.chunk = chunk;
+  chunks.ceiling = (ceiling && ceiling < chunks.size) ? ceiling
+                                                      : chunks.size - 1;
+  chunks.ready = 0;
+  chunks.held = 0;
+  chunks.stalled = false;
+  chunks.pool = params.rawbuf;
+  _chunked = true;
+  start_chunked_capture();
+  pause();
+  return true;
+}
+
+/// Take the capture the interrupt has filled, in chunked capture mode.
+/// @param[out] results A PTR to the decode_results to point at the capture.
+/// @return true if there was a filled capture to take, false if not.
+bool IRrecv::_takeChunks(decode_results *results) {
+  releaseBuffer();  // The previous results are no longer needed.
+  if (params.rcvstate == kStopState) {
+    if (params.rawlen)  // The interrupt couldn't hand its capture over.
+      stop_capture();
+    else if (chunks.stalled && start_chunked_capture())  // There is room now.
+      chunks.stalled = false;
+  }
+  const uint32_t ready = chunks.ready;
+  if (!ready) return false;
+  results->rawbuf = chunks.pool + (ready >> 16);
+  results->rawlen = chunks.rawlen;
+  results->overflow = chunks.overflow;
+  chunks.held = ready;
+  chunks.ready = 0;
+  // Clear the entry after the message. There is always room for it.
+  results->rawbuf[results->rawlen] = 0;
+  return true;
+}
+#endif  // ENABLE_CHUNKED_CAPTURE_OPTION
+
+#if (ENABLE_DOUBLE_BUFFER_OPTION || ENABLE_CHUNKED_CAPTURE_OPTION)
+/// Hand the buffer used by the results of the last `decode()` back to the
+/// interrupt, so it can capture into it. Those results must not be used after
+/// this. `decode()` does this itself, so this is only needed in double buffer
+/// or chunked capture mode if the results are finished with well before the
+/// next `decode()`.
+/// @return true if a buffer was handed back, false if none was in use.
+bool IRrecv::releaseBuffer(void) {
+#if ENABLE_CHUNKED_CAPTURE_OPTION
+  if (_chunked) {
+    if (!chunks.held) return false;
+    chunks.held = 0;
+    return true;
+  }
+#endif  // ENABLE_CHUNKED_CAPTURE_OPTION
+#if ENABLE_DOUBLE_BUFFER_OPTION
+  uint16_t *held = buffers.held;
+  if (held == NULL) return false;
+  buffers.held = NULL;
+  buffers.spare = held;
+  return true;
+#else  // ENABLE_DOUBLE_BUFFER_OPTION
+  return false;
+#endif  // ENABLE_DOUBLE_BUFFER_OPTION
+}
+#endif  // (ENABLE_DOUBLE_BUFFER_OPTION || ENABLE_CHUNKED_CAPTURE_OPTION)
+
+#if ENABLE_CYCLE_COUNT_OPTION
+/// Set if the receive interrupt records CPU cycle counts rather than ticks.
+/// i.e. The interrupt only stores the cycle counter difference & restarts a
+/// hardware timer for the timeout, so it is much quicker & can keep up with
+/// faster edges. `decode()` converts the capture into ticks afterwards.
+/// @param[in] enable true to record cycle counts, false to record ticks.
+/// @return true if the mode was set, false if it isn't supported.
+/// @note ESP8266 only. It uses timer1, so it can't be used together with
+///   `analogWrite()`, `tone()` or the Servo library. Call it before
+///   `enableIRIn()`, and don't change the CPU speed while capturing.
+bool IRrecv::setCycleCountCapture(const bool enable) {
+#if defined(ESP8266) || defined(UNIT_TEST)
+  _cycle_count = enable;
+  return true;
+#else  // defined(ESP8266) || defined(UNIT_TEST)
+  _cycle_count = false;
+  return !enable;
+#endif  // defined(ESP8266) || defined(UNIT_TEST)
+}
+
+/// Convert a capture recorded in CPU cycle count units into ticks, in place.
+/// @param[in,out] results A PTR to the decode_results with the capture.
+void IRrecv::_cycleCountsToTicks(decode_results *results) {
+  const uint32_t cycles_per_tick = _cycle_count_mhz * kRawTick;
+  const uint16_t length = std::min(results->rawlen, getBufSize());
+  // The first entry is a marker, not a duration.
+  for (uint16_t i = kStartOffset; i < length; i++) {
+    const uint32_t cycles = (uint32_t)results->rawbuf[i] << cycle_count_shift;
+    results->rawbuf[i] = (cycles + cycles_per_tick / 2) / cycles_per_tick;
+  }
+}
+#endif  // ENABLE_CYCLE_COUNT_OPTION
+
+#if ENABLE_EARLY_DECODE_OPTION
+/// Set the early decode mode. i.e. While a message is still being captured,
+/// `decode()` tries the protocol decoders on a copy of what has arrived so far,
+/// whenever there has been a new edge & the line has been quiet for longer
+/// than any space seen so far. If a (non-`UNKNOWN`) protocol decodes, the
+/// header, bit count & footer have all matched, so the capture is stopped &
+/// reported there & then, rather than after the full timeout.
+/// @param[in] max_length Max. nr. of capture entries to try to decode early.
+///   e.g. The size of the longest protocol expected. 0 turns it off.
+/// @param[in] min_silence Min. nr. of uSeconds of quiet, as well as the
+///   longest space seen, before trying to decode. (Default: 5ms)
+/// @return true if the mode was set, false if the scratch buffer couldn't be
+///   allocated.
+/// @note A protocol that repeats a shorter protocol's frame after a gap longer
+///   than `min_silence` (e.g. Pioneer is two NEC frames) will be reported as
+///   the shorter one. Raise `min_silence` above that gap if they are expected.
+///   The decoders run in `decode()`, so this is only as quick as `decode()`
+///   is called from `loop()`.
+bool IRrecv::setEarlyDecode(const uint16_t max_length,
+                            const uint16_t min_silence) {
+  delete[] _early_buf;
+  _early_buf = NULL;
+  _early_length = 0;
+  if (max_length == 0) return true;  // Turned off.
+  _early_buf = new uint16_t[max_length + 1];  // Incl. the terminating 0.
+  if (_early_buf == NULL) return false;
+  _early_length = max_length;
+  _early_silence = min_silence / kRawTick;
+  _early_tried = 0;
+  return true;
+}
+
+/// Try to decode the message still being captured & stop the capture if it
+/// is already a complete message of a known protocol.
+/// @param[in] rawlen Nr. of entries captured, read before `edge`.
+/// @param[in] edge When the last edge of the capture was. (Any units) Used to
+///   not try the same capture twice.
+/// @param[in] silence Nr. of ticks since that edge.
+/// @param[in] max_skip Passed on to the decoders. See `decode()`.
+/// @param[in] noise_floor Passed on to the decoders. See `decode()`.
+/// @return true if the capture was stopped, false if it carries on.
+bool IRrecv::_earlyDecode(const uint16_t rawlen, const uint32_t edge,
+                          const uint32_t silence, const uint8_t max_skip,
+                          const uint16_t noise_floor) {
+  // Only while capturing, between the marks of a message that fits.
+  if (params.rcvstate == kStopState || rawlen > _early_length ||
+      rawlen < kStartOffset + 2 || rawlen % 2) return false;
+  if (silence < _early_silence || edge == _early_tried) return false;
+  for (uint16_t i = 0; i < rawlen; i++) _early_buf[i] = params.rawbuf[i];
+  _early_buf[rawlen] = 0;
+  decode_results early;
+  early.rawbuf = _early_buf;
+  early.rawlen = rawlen;
+  early.overflow = false;
+#if ENABLE_CYCLE_COUNT_OPTION
+  if (_cycle_count) _cycleCountsToTicks(&early);
+#endif  // ENABLE_CYCLE_COUNT_OPTION
+  // The line must have been quiet for longer than any space so far, or this
+  // is probably just a longer space in the middle of the message.
+  uint32_t longest = 0;
+  for (uint16_t i = kStartOffset + 1; i < rawlen; i += 2)
+    longest = std::max(longest, (uint32_t)_early_buf[i]);
+  if (silence <= longest + longest * _tolerance / 100) return false;
+  _early_tried = edge;
+  if (!_decodeCapture(&early, max_skip, noise_floor) ||
+      early.decode_type == decode_type_t::UNKNOWN) return false;
+  // It is a complete message. Stop the capture, as the timeout would, unless
+  // another edge has arrived meanwhile.
+  bool stopped = false;
+#ifndef UNIT_TEST
+#if defined(ESP8266)
+  os_intr_lock();
+#endif  // ESP8266
+#if defined(ESP32)
+  portENTER_CRITICAL(&mux);
+#endif  // ESP32
+#endif  // UNIT_TEST
+  if (params.rawlen == rawlen && params.rcvstate != kStopState) {
+    stop_capture();
+    stopped = true;
+  }
+#ifndef UNIT_TEST
+#if defined(ESP8266)
+  os_intr_unlock();
+#endif  // ESP8266
+#if defined(ESP32)
+  portEXIT_CRITICAL(&mux);
+#endif  // ESP32
+#endif  // UNIT_TEST
+  return stopped;
+}
+#endif  // ENABLE_EARLY_DECODE_OPTION
 
 #if DECODE_HASH
 /// Set the minimum length we will consider for reporting UNKNOWN message types.
@@ -482,33 +968,68 @@ void IRrecv::setTolerance(const uint8_t percent) {
 uint8_t IRrecv::getTolerance(void) { return _tolerance; }
 
 #if ENABLE_NOISE_FILTER_OPTION
+/// Set the glitch model used by `decode()` when no `noise_floor` is given.
+/// @param[in] filter The minimum mark & space (in usecs) and whether glitches
+///   are merged into the previous entry or dropped.
+///   A `min_mark` & `min_space` of 0 disables the filter. (Default)
+void IRrecv::setNoiseFilter(const noise_filter_t filter) {
+  _noise_filter = filter;
+}
+
+/// Get the glitch model used by `decode()` when no `noise_floor` is given.
+/// @return The current noise filter settings.
+noise_filter_t IRrecv::getNoiseFilter(void) { return _noise_filter; }
+
 /// Remove or merge pulses in the capture buffer that are too short.
 /// @param[in,out] results Ptr to the decode_results we are going to filter.
 /// @param[in] floor Only allow values in the buffer large than this.
 ///   (in microSeconds)
 void IRrecv::crudeNoiseFilter(decode_results *results, const uint16_t floor) {
   if (floor == 0) return;  // Nothing to do.
-  const uint16_t kTickFloor = floor / kRawTick;
+  filterNoise(results, {floor, floor, true});
+}
+
+/// Remove or merge glitches in the capture buffer in a single pass.
+/// A glitch (a mark shorter than `min_mark` or a space shorter than
+/// `min_space`) is removed together with the entry following it. If `merge`
+/// is set, both are added to the previous entry, so the total time is kept.
+/// @param[in,out] results Ptr to the decode_results we are going to filter.
+/// @param[in] filter The glitch model to use.
+/// @note The buffer is compacted with a read & a write position, so every
+///   entry is moved at most once. With `{floor, floor, true}` the result is
+///   identical to shifting the rest of the buffer down for every glitch.
+void IRrecv::filterNoise(decode_results *results,
+                         const noise_filter_t filter) {
+  if (filter.min_mark == 0 && filter.min_space == 0) return;  // Nothing to do.
+  const uint16_t kMarkFloor = filter.min_mark / kRawTick;
+  const uint16_t kSpaceFloor = filter.min_space / kRawTick;
   const uint16_t kBufSize = getBufSize();
-  uint16_t offset = kStartOffset;
-  while (offset < results->rawlen && offset + 2 < kBufSize) {
-    uint16_t curr = results->rawbuf[offset];
-    uint16_t next = results->rawbuf[offset + 1];
-    uint16_t addition = curr + next;
-    if (curr < kTickFloor) {  // Is it too short?
-      // Shuffle the buffer down. i.e. Remove the mark & space pair.
-      // Note: `memcpy()` can't be used as rawbuf is `volatile`.
-      for (uint16_t i = offset + 2; i <= results->rawlen && i < kBufSize; i++)
-        results->rawbuf[i - 2] = results->rawbuf[i];
-      if (offset > 1) {  // There is a previous pair we can add to.
-        // Merge this pair into into the previous space.
-        results->rawbuf[offset - 1] += addition;
+  const uint16_t rawlen = results->rawlen;
+  volatile uint16_t *rawbuf = results->rawbuf;
+  uint16_t read = kStartOffset;
+  uint16_t write = kStartOffset;
+  while (read < rawlen && write + 2 < kBufSize) {
+    const uint16_t curr = rawbuf[read];
+    // Marks are at odd & spaces at even offsets. Removing pairs keeps it so.
+    if (curr < ((write & 1) ? kMarkFloor : kSpaceFloor)) {  // Too short?
+      if (filter.merge && write > 1) {
+        // Merge this pair into the previous (already written) entry.
+        const uint16_t next = (read + 1 < kBufSize) ? rawbuf[read + 1] : 0;
+        rawbuf[write - 1] += (uint16_t)(curr + next);
       }
-      results->rawlen -= 2;  // Adjust the length.
+      read += 2;  // Skip the mark & space pair.
     } else {
-      offset++;  // Move along.
+      if (write != read) rawbuf[write] = curr;
+      read++;
+      write++;
     }
   }
+  const uint16_t removed = read - write;
+  if (removed == 0) return;
+  // Move the unchecked rest of the buffer (& the terminating 0) down.
+  for (; read <= rawlen && read < kBufSize; read++, write++)
+    rawbuf[write] = rawbuf[read];
+  results->rawlen = rawlen - removed;  // Adjust the length.
 }
 #endif  // ENABLE_NOISE_FILTER_OPTION
 
@@ -520,6 +1041,7 @@ void IRrecv::crudeNoiseFilter(decode_results *results, const uint16_t floor) {
 /// @param[out] results A PTR to where the decoded IR message will be stored.
 /// @param[out] save A PTR to an irparams_t instance in which to save
 ///   the interrupt's memory/state. NULL means don't save it.
+///   Not used in double buffer mode. i.e. See `setDoubleBuffer()`.
 /// @param[in] max_skip Maximum Nr. of pulses at the begining of a capture we
 ///   can skip when attempting to find a protocol we can successfully decode.
 ///   This parameter can dramatically improve detection of protocols
@@ -536,7 +1058,8 @@ void IRrecv::crudeNoiseFilter(decode_results *results, const uint16_t floor) {
 ///   merged prior to any decoding. This is to try to remove noise/poor
 ///   readings & slightly increase the chances of a successful decode but at the
 ///   cost of data fidelity & integrity.
-///   (Defaults to 0 usecs. i.e. Don't filter; which is safe!)
+///   (Defaults to 0 usecs. i.e. Use the filter set by `setNoiseFilter()`,
+///    which by default doesn't filter; which is safe!)
 /// @warning DANGER: **Here Be Dragons!**
 ///   If you set the `noise_floor` value too high, it **WILL** break decoding
 ///   of some protocols. You have been warned!
@@ -552,45 +1075,98 @@ void IRrecv::crudeNoiseFilter(decode_results *results, const uint16_t floor) {
 /// @return A boolean indicating if an IR message is ready or not.
 bool IRrecv::decode(decode_results *results, irparams_t *save,
                     uint8_t max_skip, uint16_t noise_floor) {
-  // Proceed only if an IR message been received.
-#ifndef UNIT_TEST
-  if (params.rcvstate != kStopState) return false;
-#endif
-
-  // Clear the entry we are currently pointing to when we got the timeout.
-  // i.e. Stopped collecting IR data.
-  // It's junk as we never wrote an entry to it and can only confuse decoding.
-  // This is done here rather than logically the best place in read_timeout()
-  // as it saves a few bytes of ICACHE_RAM as that routine is bound to an
-  // interrupt. decode() is not stored in ICACHE_RAM.
-  // Another better option would be to zero the entire irparams.rawbuf[] on
-  // resume() but that is a much more expensive operation compare to this.
-  // However, don't do this if rawbuf is already full as we stomp over the heap.
-  // See: https://github.com/crankyoldgit/IRremoteESP8266/issues/1516
-  if (!params.overflow) params.rawbuf[params.rawlen] = 0;
-
   bool resumed = false;  // Flag indicating if we have resumed.
+#if (ENABLE_EARLY_DECODE_OPTION && !defined(UNIT_TEST))
+  if (_early_buf != NULL) {
+    // See if the message still being captured is already complete.
+    const uint16_t rawlen = params.rawlen;
+    uint32_t edge = edge_start;
+    uint32_t silence = (micros() - edge) / kRawTick;
+#if (ENABLE_CYCLE_COUNT_OPTION && defined(ESP8266))
+    if (_cycle_count) {
+      edge = cycle_count_start;
+      silence = (esp_get_cycle_count() - edge) /
+          (_cycle_count_mhz * kRawTick);
+    }
+#endif  // (ENABLE_CYCLE_COUNT_OPTION && defined(ESP8266))
+    _earlyDecode(rawlen, edge, silence, max_skip, noise_floor);
+  }
+#endif  // (ENABLE_EARLY_DECODE_OPTION && !defined(UNIT_TEST))
+#if ENABLE_CHUNKED_CAPTURE_OPTION
+  if (_chunked) {
+    // Decode straight from the chunks the interrupt has filled. It is already
+    // capturing into others, so there is nothing to copy or resume.
+    if (!_takeChunks(results)) return false;
+    resumed = true;
+  }
+#endif  // ENABLE_CHUNKED_CAPTURE_OPTION
+#if ENABLE_DOUBLE_BUFFER_OPTION
+  if (_double_buffer) {
+    // Decode straight from the buffer the interrupt has filled. It is already
+    // capturing into the other one, so there is nothing to copy or resume.
+    if (!_takeBuffer(results)) return false;
+    resumed = true;
+  }
+#endif  // ENABLE_DOUBLE_BUFFER_OPTION
 
-  // If we were requested to use a save buffer previously, do so.
-  if (save == NULL) save = params_save;
+  if (!resumed) {
+    // Proceed only if an IR message been received.
+#ifndef UNIT_TEST
+    if (params.rcvstate != kStopState) return false;
+#endif
 
-  if (save == NULL) {
-    // We haven't been asked to copy it so use the existing memory.
+    // Clear the entry we are currently pointing to when we got the timeout.
+    // i.e. Stopped collecting IR data.
+    // It's junk as we never wrote an entry to it and can only confuse decoding.
+    // This is done here rather than logically the best place in read_timeout()
+    // as it saves a few bytes of ICACHE_RAM as that routine is bound to an
+    // interrupt. decode() is not stored in ICACHE_RAM.
+    // Another better option would be to zero the entire irparams.rawbuf[] on
+    // resume() but that is a much more expensive operation compare to this.
+    // However, don't do this if rawbuf is already full as we stomp over the
+    // heap.
+    // See: https://github.com/crankyoldgit/IRremoteESP8266/issues/1516
+    if (!params.overflow) params.rawbuf[params.rawlen] = 0;
+
+    // If we were requested to use a save buffer previously, do so.
+    if (save == NULL) save = params_save;
+
+    if (save == NULL) {
+      // We haven't been asked to copy it so use the existing memory.
 #ifndef UNIT_TEST
-    results->rawbuf = params.rawbuf;
-    results->rawlen = params.rawlen;
-    results->overflow = params.overflow;
+      results->rawbuf = params.rawbuf;
+      results->rawlen = params.rawlen;
+      results->overflow = params.overflow;
 #endif
-  } else {
-    copyIrParams(&params, save);  // Duplicate the interrupt's memory.
-    resume();  // It's now safe to rearm. The IR message won't be overridden.
-    resumed = true;
-    // Point the results at the saved copy.
-    results->rawbuf = save->rawbuf;
-    results->rawlen = save->rawlen;
-    results->overflow = save->overflow;
+    } else {
+      copyIrParams(&params, save);  // Duplicate the interrupt's memory.
+      resume();  // It's now safe to rearm. The IR message won't be overridden.
+      resumed = true;
+      // Point the results at the saved copy.
+      results->rawbuf = save->rawbuf;
+      results->rawlen = save->rawlen;
+      results->overflow = save->overflow;
+    }
   }
+#if ENABLE_CYCLE_COUNT_OPTION
+  // The interrupt left converting the capture into ticks to us.
+  if (_cycle_count) _cycleCountsToTicks(results);
+#endif  // ENABLE_CYCLE_COUNT_OPTION
+
+  if (_decodeCapture(results, max_skip, noise_floor)) return true;
+  // Throw away and start over
+  if (!resumed)  // Check if we have already resumed.
+    resume();
+  return false;
+}
 
+/// Run the protocol decoders over a capture.
+/// @param[in,out] results A PTR to the decode_results with the capture.
+/// @param[in] max_skip Nr. of entries to skip at the start. See `decode()`.
+/// @param[in] noise_floor Pulses below this are filtered. See `decode()`.
+/// @return true if it decoded, incl. as an `UNKNOWN` hash, false if not.
+bool IRrecv::_decodeCapture(decode_results *results, const uint8_t max_skip,
+                            const uint16_t noise_floor) {
   // Reset any previously partially processed results.
   results->decode_type = UNKNOWN;
   results->bits = 0;
@@ -600,7 +1176,10 @@ bool IRrecv::decode(decode_results *results, irparams_t *save,
   results->repeat = false;
 
 #if ENABLE_NOISE_FILTER_OPTION
-  crudeNoiseFilter(results, noise_floor);
+  if (noise_floor)
+    crudeNoiseFilter(results, noise_floor);
+  else
+    filterNoise(results, _noise_filter);
 #endif  // ENABLE_NOISE_FILTER_OPTION
   // Keep looking for protocols until we've run out of entries to skip or we
   // find a valid protocol message.
@@ -1162,9 +1741,6 @@ bool IRrecv::decode(decode_results *results, irparams_t *save,
     return true;
   }
 #endif  // DECODE_HASH
-  // Throw away and start over
-  if (!resumed)  // Check if we have already resumed.
-    resume();
   return false;
 }  // NOLINT(readability/fn_size)
 
@@ -1350,6 +1926,61 @@ bool IRrecv::matchSpaceRange(const uint32_t measured, const uint32_t desired,
   return match(measured, desired - excess, 0, range);
 }
 
+/// Calculate the range of captured durations that `match()` a desired one.
+/// i.e. Do the tolerance calculations & the conversion to ticks once, so
+///   each capture entry only needs two integer comparisons.
+/// @param[in] usecs The expected period (in usecs) we are matching against.
+/// @param[in] tolerance A percentage expressed as an integer. e.g. 10 is 10%.
+/// @param[in] delta A non-scaling (+/-) error margin (in useconds).
+/// @return The range of matching durations. (ticks)
+tick_range_t IRrecv::_tickRange(const uint32_t usecs, const uint8_t tolerance,
+                                const uint16_t delta) {
+  const uint32_t low = ticksLow(usecs, tolerance, delta);
+  const uint32_t high = ticksHigh(usecs, tolerance, delta);
+  // NOTE: No sanity checks like match(). Some protocols have bit timings that
+  // under/overflow with the excess, which are only ever a problem if compared.
+  // measured * kRawTick >= low, & measured * kRawTick <= high.
+  tick_range_t range;
+  range.low = (low + kRawTick - 1) / kRawTick;
+  range.high = high / kRawTick;
+  if (range.low > range.high) {  // No whole nr. of ticks is in the range.
+    range.low = UINT32_MAX;
+    range.high = UINT32_MAX;
+  }
+  return range;
+}
+
+/// Calculate the ranges that match the marks & spaces of '1' & '0' bits.
+/// @param[in] onemark Nr. of uSeconds in an expected mark signal for a '1' bit.
+/// @param[in] onespace Nr. of uSecs in an expected space signal for a '1' bit.
+/// @param[in] zeromark Nr. of uSecs in an expected mark signal for a '0' bit.
+/// @param[in] zerospace Nr. of uSecs in an expected space signal for a '0' bit.
+/// @param[in] tolerance Percentage error margin to allow.
+/// @param[in] excess Nr. of uSeconds.
+/// @return The ranges. (ticks)
+bit_ranges_t IRrecv::_bitRanges(const uint16_t onemark,
+                                const uint32_t onespace,
+                                const uint16_t zeromark,
+                                const uint32_t zerospace,
+                                const uint8_t tolerance,
+                                const int16_t excess) {
+  bit_ranges_t ranges;
+  ranges.onemark = _tickRange(onemark + excess, tolerance);
+  ranges.onespace = _tickRange(onespace - excess, tolerance);
+  ranges.zeromark = _tickRange(zeromark + excess, tolerance);
+  ranges.zerospace = _tickRange(zerospace - excess, tolerance);
+  return ranges;
+}
+
+/// Check if a captured duration is in a range.
+/// @param[in] measured The recorded period of the signal pulse. (ticks)
+/// @param[in] range The range of matching durations. (ticks)
+/// @return A Boolean. true if it matches, false if it doesn't.
+static inline bool inRange(const uint32_t measured, const tick_range_t range) {
+  // One unsigned comparison. Anything below `low` wraps around to be huge.
+  return measured - range.low <= range.high - range.low;
+}
+
 #if DECODE_HASH
 /// Compare two tick values.
 /// @param[in] oldval Nr. of ticks.
@@ -1420,35 +2051,67 @@ match_result_t IRrecv::matchData(
     const uint32_t onespace, const uint16_t zeromark, const uint32_t zerospace,
     const uint8_t tolerance, const int16_t excess, const bool MSBfirst,
     const bool expectlastspace) {
+  return _matchData(data_ptr, nbits,
+                    _bitRanges(onemark, onespace, zeromark, zerospace,
+                               tolerance, excess),
+                    MSBfirst, expectlastspace);
+}
+
+/// Match & decode the typical data section of an IR message, using ranges
+/// calculated by `_bitRanges()`.
+/// @param[in] data_ptr A pointer to where we are at in the capture buffer.
+/// @param[in] nbits Nr. of data bits we expect.
+/// @param[in] ranges The ranges of the marks & spaces of each bit.
+/// @param[in] MSBfirst Bit order to save the data in.
+///   true is Most Significant Bit First Order, false is Least Significant First
+/// @param[in] expectlastspace Do we expect a space at the end of the message?
+/// @return A match_result_t structure containing the success (or not), the
+///   data value, and how many buffer entries were used.
+match_result_t IRrecv::_matchData(volatile uint16_t *data_ptr,
+                                  const uint16_t nbits,
+                                  const bit_ranges_t &ranges,
+                                  const bool MSBfirst,
+                                  const bool expectlastspace) {
   match_result_t result;
   result.success = false;  // Fail by default.
   result.data = 0;
   if (expectlastspace) {  // We are expecting data with a final space.
+    // Most protocols use the same mark (or space) for both bit values, so
+    // only compare it once.
+    const bool same_marks = ranges.onemark.low == ranges.zeromark.low &&
+        ranges.onemark.high == ranges.zeromark.high;
+    const bool same_spaces = ranges.onespace.low == ranges.zerospace.low &&
+        ranges.onespace.high == ranges.zerospace.high;
+    uint64_t data = 0;
     for (result.used = 0; result.used < nbits * 2;
          result.used += 2, data_ptr += 2) {
-      // Is the bit a '1'?
-      if (matchMark(*data_ptr, onemark, tolerance, excess) &&
-          matchSpace(*(data_ptr + 1), onespace, tolerance, excess)) {
-        result.data = (result.data << 1) | 1;
-      } else if (matchMark(*data_ptr, zeromark, tolerance, excess) &&
-                 matchSpace(*(data_ptr + 1), zerospace, tolerance, excess)) {
-        result.data <<= 1;  // The bit is a '0'.
-      } else {
+      const uint16_t mark = *data_ptr;
+      const uint16_t space = *(data_ptr + 1);
+      const bool onemark = inRange(mark, ranges.onemark);
+      const bool onespace = inRange(space, ranges.onespace);
+      const bool zeromark = same_marks ? onemark
+                                       : inRange(mark, ranges.zeromark);
+      const bool zerospace = same_spaces ? onespace
+                                         : inRange(space, ranges.zerospace);
+      // A '1' wins if the bit could be either.
+      const bool one = onemark & onespace;
+      if (!(one | (zeromark & zerospace))) {  // It's neither, so fail.
+        result.data = data;
         if (!MSBfirst) result.data = reverseBits(result.data, result.used / 2);
-        return result;  // It's neither, so fail.
+        return result;
       }
+      data = (data << 1) | one;
     }
+    result.data = data;
     result.success = true;
   } else {  // We are expecting data without a final space.
     // Match all but the last bit, as it may not match easily.
-    result = matchData(data_ptr, nbits ? nbits - 1 : 0, onemark, onespace,
-                       zeromark, zerospace, tolerance, excess, true, true);
+    result = _matchData(data_ptr, nbits ? nbits - 1 : 0, ranges, true, true);
     if (result.success) {
       // Is the bit a '1'?
-      if (matchMark(*(data_ptr + result.used), onemark, tolerance, excess))
+      if (inRange(*(data_ptr + result.used), ranges.onemark))
         result.data = (result.data << 1) | 1;
-      else if (matchMark(*(data_ptr + result.used), zeromark, tolerance,
-               excess))
+      else if (inRange(*(data_ptr + result.used), ranges.zeromark))
         result.data <<= 1;  // The bit is a '0'.
       else
         result.success = false;
@@ -1485,12 +2148,14 @@ uint16_t IRrecv::matchBytes(volatile uint16_t *data_ptr, uint8_t *result_ptr,
   // Check if there is enough capture buffer to possibly have the desired bytes.
   if (remaining + expectlastspace < (nbytes * 8 * 2) + 1)
     return 0;  // Nope, so abort.
+  // The same ranges are used for every byte, so only calculate them once.
+  const bit_ranges_t ranges = _bitRanges(onemark, onespace, zeromark,
+                                         zerospace, tolerance, excess);
   uint16_t offset = 0;
   for (uint16_t byte_pos = 0; byte_pos < nbytes; byte_pos++) {
     bool lastspace = (byte_pos + 1 == nbytes) ? expectlastspace : true;
-    match_result_t result = matchData(data_ptr + offset, 8, onemark, onespace,
-                                      zeromark, zerospace, tolerance, excess,
-                                      MSBfirst, lastspace);
+    match_result_t result = _matchData(data_ptr + offset, 8, ranges, MSBfirst,
+                                       lastspace);
     if (result.success == false) return 0;  // Fail
     result_ptr[byte_pos] = (uint8_t)result.data;
     offset += result.used;
@@ -2042,5 +2707,18 @@ uint16_t IRrecv::matchManchesterData(volatile const uint16_t *data_ptr,
 volatile irparams_t *IRrecv::_getParamsPtr(void) {
   return &params;
 }
+
+/// Unit test helper to act like the receive timer ran out.
+void IRrecv::_readTimeout(void) {
+  if (params.rawlen) stop_capture();
+}
+
+#if ENABLE_CYCLE_COUNT_OPTION
+/// Unit test helper to act like the cycle count interrupt saw an edge.
+/// @param[in] now The value of the CPU cycle counter at the edge.
+void IRrecv::_recordCycleCount(const uint32_t now) {
+  record_cycle_count(now);
+}
+#endif  // ENABLE_CYCLE_COUNT_OPTION
 #endif  // UNIT_TEST
 // End of IRrecv class -------------------
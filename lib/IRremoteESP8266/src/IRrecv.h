@@ -47,6 +47,12 @@ const uint16_t kRawTick = 2;     // Capture tick to uSec factor.
 const uint8_t kTimeoutMs = 15;  // In MilliSeconds.
 #define TIMEOUT_MS kTimeoutMs   // For legacy documentation.
 const uint16_t kMaxTimeoutMs = kRawTick * (UINT16_MAX / MS_TO_USEC(1));
+// Default min. nr. of uSeconds of silence before an early decode is tried.
+const uint16_t kEarlyDecodeMinSilence = 5000;
+// CPU cycles are recorded in units of 2^N cycles by the cycle count interrupt.
+// i.e. 1.6 usecs at 80MHz & 160MHz, so a capture entry can hold ~100ms.
+const uint8_t kCycleCountShift80MHz = 7;
+const uint8_t kCycleCountShift160MHz = 8;
 
 // Use FNV hash algorithm: http://isthe.com/chongo/tech/comp/fnv/#FNV-param
 const uint32_t kFnvPrime32 = 16777619UL;
@@ -86,6 +92,54 @@ typedef struct {
   uint8_t timeout;   // Nr. of milliSeconds before we give up.
 } irparams_t;
 
+/// Where the second capture buffer is in double buffer mode.
+/// Exactly one of `spare`, `ready` & `held` points to it, the others are NULL.
+typedef struct {
+  uint16_t *spare;   // Free, so the interrupt can swap to it.
+  uint16_t *ready;   // Filled by the interrupt, waiting for `decode()`.
+  uint16_t *held;    // In use by the results of the last `decode()`.
+  uint16_t rawlen;   // Nr. of entries in the `ready` buffer.
+  uint8_t overflow;  // Did the `ready` buffer overflow?
+} irbuffers_t;
+
+/// The pool of chunks captures are taken from in chunked capture mode.
+/// Regions of the pool are packed as `start << 16 | end` (in entries), so they
+/// can be updated in one go. A region of 0 is empty.
+typedef struct {
+  uint16_t *pool;    // The capture buffer, used as the pool.
+  uint16_t size;     // Nr. of entries in the pool.
+  uint16_t chunk;    // Nr. of entries in a chunk.
+  uint16_t ceiling;  // Max. nr. of entries in a capture.
+  uint32_t ready;    // The capture waiting for `decode()`.
+  uint32_t held;     // The capture in use by the results of the last `decode()`.
+  uint16_t rawlen;   // Nr. of entries in the `ready` capture.
+  uint8_t overflow;  // Did the `ready` capture overflow?
+  bool stalled;      // Is there no room to capture the next message?
+} irchunks_t;
+
+/// Model of the glitches removed by the noise filter. (All values in usecs)
+typedef struct {
+  uint16_t min_mark;   // Marks shorter than this are glitches. (0 = keep all)
+  uint16_t min_space;  // Spaces shorter than this are glitches. (0 = keep all)
+  bool merge;          // Merge a glitch & the entry after it into the previous
+                       // entry (true), or just drop the pair (false).
+} noise_filter_t;
+
+/// The range of durations that match an expected mark or space. (ticks)
+/// @note An empty range is `{UINT32_MAX, UINT32_MAX}`.
+typedef struct {
+  uint32_t low;   // Shortest matching duration.
+  uint32_t high;  // Longest matching duration.
+} tick_range_t;
+
+/// The ranges that match the marks & spaces of the bits of a data section.
+typedef struct {
+  tick_range_t onemark;
+  tick_range_t onespace;
+  tick_range_t zeromark;
+  tick_range_t zerospace;
+} bit_ranges_t;
+
 /// Results from a data match
 typedef struct {
   bool success;   // Was the match successful?
@@ -143,6 +197,26 @@ class IRrecv {
 #if DECODE_HASH
   void setUnknownThreshold(const uint16_t length);
 #endif
+#if ENABLE_NOISE_FILTER_OPTION
+  void setNoiseFilter(const noise_filter_t filter);
+  noise_filter_t getNoiseFilter(void);
+#endif  // ENABLE_NOISE_FILTER_OPTION
+#if ENABLE_DOUBLE_BUFFER_OPTION
+  bool setDoubleBuffer(const bool enable = true);
+#endif  // ENABLE_DOUBLE_BUFFER_OPTION
+#if ENABLE_CHUNKED_CAPTURE_OPTION
+  bool setChunkedCapture(const uint16_t chunk, const uint16_t ceiling = 0);
+#endif  // ENABLE_CHUNKED_CAPTURE_OPTION
+#if (ENABLE_DOUBLE_BUFFER_OPTION || ENABLE_CHUNKED_CAPTURE_OPTION)
+  bool releaseBuffer(void);
+#endif  // (ENABLE_DOUBLE_BUFFER_OPTION || ENABLE_CHUNKED_CAPTURE_OPTION)
+#if ENABLE_CYCLE_COUNT_OPTION
+  bool setCycleCountCapture(const bool enable = true);
+#endif  // ENABLE_CYCLE_COUNT_OPTION
+#if ENABLE_EARLY_DECODE_OPTION
+  bool setEarlyDecode(const uint16_t max_length,
+                      const uint16_t min_silence = kEarlyDecodeMinSilence);
+#endif  // ENABLE_EARLY_DECODE_OPTION
   bool match(const uint32_t measured, const uint32_t desired,
              const uint8_t tolerance = kUseDefTol,
              const uint16_t delta = 0);
@@ -170,8 +244,39 @@ class IRrecv {
 #if DECODE_HASH
   uint16_t _unknown_threshold;
 #endif
+#if ENABLE_NOISE_FILTER_OPTION
+  noise_filter_t _noise_filter;
+#endif  // ENABLE_NOISE_FILTER_OPTION
+#if ENABLE_DOUBLE_BUFFER_OPTION
+  bool _double_buffer;
+  bool _takeBuffer(decode_results *results);
+#endif  // ENABLE_DOUBLE_BUFFER_OPTION
+#if ENABLE_CHUNKED_CAPTURE_OPTION
+  bool _chunked;
+  bool _takeChunks(decode_results *results);
+#endif  // ENABLE_CHUNKED_CAPTURE_OPTION
+#if ENABLE_CYCLE_COUNT_OPTION
+  bool _cycle_count;
+  uint8_t _cycle_count_mhz;  // CPU speed the cycle counts were recorded at.
+  void _cycleCountsToTicks(decode_results *results);
+#endif  // ENABLE_CYCLE_COUNT_OPTION
+#if ENABLE_EARLY_DECODE_OPTION
+  uint16_t *_early_buf;  // Scratch copy of the message being captured.
+  uint16_t _early_length;  // Max. nr. of entries to try to decode early.
+  uint32_t _early_silence;  // Min. nr. of ticks of silence before trying.
+  uint32_t _early_tried;  // The edge the last early decode attempt ended at.
+  bool _earlyDecode(const uint16_t rawlen, const uint32_t edge,
+                    const uint32_t silence, const uint8_t max_skip,
+                    const uint16_t noise_floor);
+#endif  // ENABLE_EARLY_DECODE_OPTION
+  bool _decodeCapture(decode_results *results, const uint8_t max_skip,
+                      const uint16_t noise_floor);
 #ifdef UNIT_TEST
   volatile irparams_t *_getParamsPtr(void);
+  void _readTimeout(void);
+#if ENABLE_CYCLE_COUNT_OPTION
+  void _recordCycleCount(const uint32_t now);
+#endif  // ENABLE_CYCLE_COUNT_OPTION
 #endif  // UNIT_TEST
   // These are called by decode
   uint8_t _validTolerance(const uint8_t percentage);
@@ -186,6 +291,15 @@ class IRrecv {
   bool matchAtLeast(const uint32_t measured, const uint32_t desired,
                     const uint8_t tolerance = kUseDefTol,
                     const uint16_t delta = 0);
+  tick_range_t _tickRange(const uint32_t usecs,
+                          const uint8_t tolerance = kUseDefTol,
+                          const uint16_t delta = 0);
+  bit_ranges_t _bitRanges(const uint16_t onemark, const uint32_t onespace,
+                          const uint16_t zeromark, const uint32_t zerospace,
+                          const uint8_t tolerance, const int16_t excess);
+  match_result_t _matchData(volatile uint16_t *data_ptr, const uint16_t nbits,
+                            const bit_ranges_t &ranges, const bool MSBfirst,
+                            const bool expectlastspace);
   uint16_t _matchGeneric(volatile uint16_t *data_ptr,
                          uint64_t *result_bits_ptr,
                          uint8_t *result_ptr,
@@ -280,6 +394,7 @@ class IRrecv {
                            const bool MSBfirst = true,
                            const bool GEThomas = true);
   void crudeNoiseFilter(decode_results *results, const uint16_t floor = 0);
+  void filterNoise(decode_results *results, const noise_filter_t filter);
   bool decodeHash(decode_results *results);
 #if DECODE_VOLTAS
   bool decodeVoltas(decode_results *results,
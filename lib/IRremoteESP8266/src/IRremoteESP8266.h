@@ -975,6 +975,35 @@
 #define ENABLE_NOISE_FILTER_OPTION true
 #endif  // ENABLE_NOISE_FILTER_OPTION
 
+// Allow `IRrecv::setDoubleBuffer()` to be used. i.e. Have the receive interrupt
+// swap between the two buffers of an IRrecv created with `save_buffer` at the
+// end of each message, rather than `decode()` copying the capture buffer.
+#ifndef ENABLE_DOUBLE_BUFFER_OPTION
+#define ENABLE_DOUBLE_BUFFER_OPTION true
+#endif  // ENABLE_DOUBLE_BUFFER_OPTION
+
+// Allow `IRrecv::setChunkedCapture()` to be used. i.e. Split the capture buffer
+// into a pool of chunks, so each message only keeps the chunks it needs and
+// the next message can be captured into the rest while it is decoded.
+#ifndef ENABLE_CHUNKED_CAPTURE_OPTION
+#define ENABLE_CHUNKED_CAPTURE_OPTION true
+#endif  // ENABLE_CHUNKED_CAPTURE_OPTION
+
+// Allow `IRrecv::setCycleCountCapture()` to be used. i.e. Use a receive
+// interrupt that only records CPU cycle counter differences & restarts a
+// hardware timer for the timeout, leaving the conversion into ticks to
+// `decode()`. (ESP8266 only)
+#ifndef ENABLE_CYCLE_COUNT_OPTION
+#define ENABLE_CYCLE_COUNT_OPTION true
+#endif  // ENABLE_CYCLE_COUNT_OPTION
+
+// Allow `IRrecv::setEarlyDecode()` to be used. i.e. Let `decode()` try the
+// protocol decoders on the message still being captured, & report it as soon
+// as it decodes & the line has gone quiet, rather than waiting for the timeout.
+#ifndef ENABLE_EARLY_DECODE_OPTION
+#define ENABLE_EARLY_DECODE_OPTION true
+#endif  // ENABLE_EARLY_DECODE_OPTION
+
 /// Enumerator for defining and numbering of supported IR protocol.
 /// @note Always add to the end of the list and should never remove entries
 ///  or change order. Projects may save the type number for later usage
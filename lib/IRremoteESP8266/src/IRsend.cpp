@@ -432,6 +432,46 @@ void IRsend::sendGeneric(const uint16_t headermark, const uint32_t headerspace,
   }
 }
 
+/// Generic method for sending a message described by a `generic_signal_t`.
+/// e.g. One worked out from a capture by `rawToGeneric()`.
+/// @param[in] signal A PTR to the description of the message.
+/// @param[in] frequency The frequency we want to modulate at. (Hz/kHz)
+/// @param[in] repeat Nr. of extra times the message will be sent.
+/// @param[in] dutycycle Percentage duty cycle of the LED.
+void IRsend::sendGeneric(const generic_signal_t * const signal,
+                         const uint16_t frequency, const uint16_t repeat,
+                         const uint8_t dutycycle) {
+  // Setup
+  enableIROut(frequency, dutycycle);
+  // We always send a message, even for repeat=0, hence '<= repeat'.
+  for (uint16_t r = 0; r <= repeat; r++) {
+    const uint8_t *ptr = signal->data;
+    for (uint8_t section = 0; section < signal->sections; section++) {
+      // Header
+      if (!(signal->headerless & (1 << section))) {
+        if (signal->hdrmark) mark(signal->hdrmark);
+        if (signal->hdrspace) space(signal->hdrspace);
+      }
+
+      // Data, a byte at a time. The last byte may only be partly used.
+      for (uint16_t bits = signal->nbits[section]; bits; ptr++) {
+        const uint16_t nbits = std::min(bits, (uint16_t)8);
+        sendData(signal->onemark, signal->onespace,
+                 signal->zeromark, signal->zerospace,
+                 *ptr >> (8 - nbits), nbits, true);
+        bits -= nbits;
+      }
+
+      // Footer. Leave at least the usual gap after the last section.
+      if (signal->footermark) mark(signal->footermark);
+      if (section + 1 < signal->sections)
+        space(signal->gap);
+      else
+        space(std::max(signal->gap, kDefaultMessageGap));
+    }
+  }
+}
+
 /// Generic method for sending Manchester code data.
 /// Will send leading or trailing 0's if the nbits is larger than the number
 /// of bits in data.
@@ -39,6 +39,29 @@ const uint8_t kDutyMax = 100;     // Percentage
 const uint16_t kMaxAccurateUsecDelay = 16383;
 //  Usecs to wait between messages we don't know the proper gap time.
 const uint32_t kDefaultMessageGap = 100000;
+// Limits of a `generic_signal_t`.
+const uint8_t kGenericSignalMaxSections = 8;
+const uint16_t kGenericSignalMaxBytes = 64;  // i.e. Up to 512 bits of data.
+
+/// A simple pulse distance or pulse width message, in `sendGeneric()` terms.
+/// e.g. As worked out from a capture by `rawToGeneric()`.
+/// Each section is sent as: header, data bits, footer mark & gap.
+typedef struct {
+  uint16_t hdrmark;  ///< Header mark in usecs. 0 means no header.
+  uint32_t hdrspace;  ///< Header space in usecs.
+  uint16_t onemark;  ///< Mark of a '1' bit in usecs.
+  uint32_t onespace;  ///< Space of a '1' bit in usecs.
+  uint16_t zeromark;  ///< Mark of a '0' bit in usecs.
+  uint32_t zerospace;  ///< Space of a '0' bit in usecs.
+  uint16_t footermark;  ///< Footer mark in usecs. 0 means no footer mark.
+  uint32_t gap;  ///< Space after each section in usecs.
+  uint8_t sections;  ///< Nr. of sections.
+  uint8_t headerless;  ///< Bitmask of the sections sent without the header.
+  uint16_t nbits[kGenericSignalMaxSections];  ///< Nr. of bits per section.
+  /// The data bits, MSB first, in the order sent. Each section starts on a new
+  /// byte.
+  uint8_t data[kGenericSignalMaxBytes];
+} generic_signal_t;
 
 /// Enumerators and Structures for the Common A/C API.
 namespace stdAc {
@@ -256,6 +279,10 @@ class IRsend {
                    const uint8_t *dataptr, const uint16_t nbytes,
                    const uint16_t frequency, const bool MSBfirst,
                    const uint16_t repeat, const uint8_t dutycycle);
+  void sendGeneric(const generic_signal_t * const signal,
+                   const uint16_t frequency = 38,
+                   const uint16_t repeat = kNoRepeat,
+                   const uint8_t dutycycle = kDutyDefault);
   static uint16_t minRepeats(const decode_type_t protocol);
   static uint16_t defaultBits(const decode_type_t protocol);
   bool send(const decode_type_t type, const uint64_t data,
@@ -6,6 +6,7 @@
 #endif
 
 #define __STDC_LIMIT_MACROS
+#include <ctype.h>
 #include <stdint.h>
 #include <string.h>
 #include <algorithm>
@@ -37,6 +38,13 @@
 #ifndef FPSTR
 #define FPSTR(X) X
 #endif  // FPSTR
+#ifndef READCHAR
+#if defined(ESP8266)
+#define READCHAR(PTR) static_cast<char>(pgm_read_byte(PTR))
+#else  // ESP8266
+#define READCHAR(PTR) (*(PTR))
+#endif  // ESP8266
+#endif  // READCHAR
 
 /// Reverse the order of the requested least significant nr. of bits.
 /// @param[in] input Bit pattern/integer to reverse.
@@ -113,26 +121,119 @@ void serialPrintUint64(uint64_t input, uint8_t base) {
 }
 #endif
 
+namespace {
+/// Direct index of where each protocol's name is in `kAllProtocolNamesStr`,
+/// so the names don't have to be searched for.
+class ProtocolNames {
+ public:
+  ProtocolNames(void) : count(0) {
+    auto *ptr = reinterpret_cast<const char*>(kAllProtocolNamesStr);
+    for (uint16_t length = STRLEN(ptr); length && count <= kLastDecodeType;
+         length = STRLEN(ptr)) {
+      offsets[count++] = ptr - reinterpret_cast<const char*>(
+          kAllProtocolNamesStr);
+      ptr += length + 1;
+    }
+  }
+  uint16_t count;  ///< Nr. of protocol names.
+  uint16_t offsets[kLastDecodeType + 1];  ///< Where each name starts.
+};
+
+/// The index of the protocol names. Built on first use.
+/// @return A reference to the index.
+const ProtocolNames &protocolNames(void) {
+  static const ProtocolNames names;
+  return names;
+}
+
+/// Get the name of a protocol.
+/// @param[in] protocol Nr. (enum) of the protocol. Must be < the nr. of names.
+/// @return A ptr to the name. (In flash/PROGMEM)
+const char *protocolName(const uint16_t protocol) {
+  return reinterpret_cast<const char*>(kAllProtocolNamesStr) +
+      protocolNames().offsets[protocol];
+}
+}  // namespace
+
 /// Convert a C-style string to a decode_type_t.
 /// @param[in] str A C-style string containing a protocol name or number.
 /// @return A decode_type_t enum. (decode_type_t::UNKNOWN if no match.)
 decode_type_t strToDecodeType(const char * const str) {
-  auto *ptr = reinterpret_cast<const char*>(kAllProtocolNamesStr);
-  uint16_t length = STRLEN(ptr);
-  for (uint16_t i = 0; length; i++) {
-    if (!STRCASECMP(str, ptr)) return (decode_type_t)i;
-    ptr += length + 1;
-    length = STRLEN(ptr);
-  }
-  // Handle integer values of the type by converting to a string and back again.
-  decode_type_t result = strToDecodeType(
-      typeToString((decode_type_t)atoi(str)).c_str());
-  if (result > 0)
-    return result;
-
+  static const irutils::StrIndex index(protocolName, protocolNames().count);
+  const int16_t found = index.find(str);
+  if (found >= 0) return (decode_type_t)found;
+  // Handle integer values of the type, if the protocol has a name.
+  const int number = atoi(str);
+  if (number > 0 && number < protocolNames().count)
+    return (decode_type_t)number;
   return decode_type_t::UNKNOWN;
 }
 
+namespace {
+/// A Print that appends what is written to it to a String.
+class StringPrint : public Print {
+ public:
+  explicit StringPrint(String *output) : _output(output) {}
+  size_t write(uint8_t c) override {
+    *_output += static_cast<char>(c);
+    return 1;
+  }
+  /// Append a whole block at once, rather than a char at a time.
+  size_t write(const uint8_t *buffer, size_t size) override {
+#ifdef UNIT_TEST
+    _output->append(reinterpret_cast<const char *>(buffer), size);
+#else  // UNIT_TEST
+    if (!_output->concat(reinterpret_cast<const char *>(buffer), size))
+      return 0;
+#endif  // UNIT_TEST
+    return size;
+  }
+
+ private:
+  String *_output;
+};
+
+/// Print a uint64_t (unsigned long long) using a fixed size stack buffer.
+/// @param[in,out] output Where to print the value.
+/// @param[in] input The value to print.
+/// @param[in] base The output base.
+/// @param[in] width Space pad the value till it is at least this many chars.
+/// @return The nr. of bytes printed.
+size_t printUint64(Print &output, uint64_t input, uint8_t base = 10,
+                   const uint8_t width = 0) {
+  // Same sanity checks as uint64ToString().
+  if (base < 2 || base > 36) base = 10;
+  char buffer[sizeof(input) * 8 + 1];  // Base 2 is the worst case.
+  char *digits = &buffer[sizeof(buffer) - 1];
+  *digits = '\0';
+  do {
+    char c = input % base;
+    input /= base;
+    *--digits = (c < 10) ? c + '0' : c + 'A' - 10;
+  } while (input);
+  size_t printed = 0;
+  for (uint8_t len = &buffer[sizeof(buffer) - 1] - digits; len < width; len++)
+    printed += output.print(' ');
+  return printed + output.print(digits);
+}
+
+/// Build a String from one of the streaming functions in a single pass.
+/// @param[in] printer The streaming function to use.
+/// @param[in] results A ptr to a decode_results structure.
+/// @param[in] estimate The expected upper bound of the output's size. The
+///   String is reserved to it once, so it only grows if the estimate is low.
+/// @return A String containing what the function printed.
+String printToString(size_t (*printer)(Print &, const decode_results * const),
+                     const decode_results * const results,
+                     const uint16_t estimate) {
+  String output = "";
+  output.reserve(estimate);
+  StringPrint out(&output);
+  printer(out, results);
+  return output;
+}
+}  // namespace
+
 /// Convert a protocol type (enum etc) to a human readable string.
 /// @param[in] protocol Nr. (enum) of the protocol.
 /// @param[in] isRepeat A flag indicating if it is a repeat message.
@@ -140,28 +241,30 @@ decode_type_t strToDecodeType(const char * const str) {
 String typeToString(const decode_type_t protocol, const bool isRepeat) {
   String result = "";
   result.reserve(30);  // Size of longest protocol name + " (Repeat)"
+  StringPrint output(&result);
+  typeToString(output, protocol, isRepeat);
+  return result;
+}
+
+/// Print a protocol type (enum etc) in a human readable form.
+/// @param[in,out] output Where to print it. e.g. Serial, a File etc.
+/// @param[in] protocol Nr. (enum) of the protocol.
+/// @param[in] isRepeat A flag indicating if it is a repeat message.
+/// @return The nr. of bytes printed.
+size_t typeToString(Print &output, const decode_type_t protocol,
+                    const bool isRepeat) {
+  size_t printed = 0;
   if (protocol > kLastDecodeType || protocol == decode_type_t::UNKNOWN) {
-    result = kUnknownStr;
-  } else {
-    auto *ptr = reinterpret_cast<const char*>(kAllProtocolNamesStr);
-    if (protocol > kLastDecodeType || protocol == decode_type_t::UNKNOWN) {
-      result = kUnknownStr;
-    } else {
-      for (uint16_t i = 0; i <= protocol && STRLEN(ptr); i++) {
-        if (i == protocol) {
-          result = FPSTR(ptr);
-          break;
-        }
-        ptr += STRLEN(ptr) + 1;
-      }
-    }
+    printed += output.print(kUnknownStr);
+  } else if (protocol < protocolNames().count) {
+    printed += output.print(FPSTR(protocolName(protocol)));
   }
   if (isRepeat) {
-    result += kSpaceLBraceStr;
-    result += kRepeatStr;
-    result += ')';
+    printed += output.print(kSpaceLBraceStr);
+    printed += output.print(kRepeatStr);
+    printed += output.print(')');
   }
-  return result;
+  return printed;
 }
 
 /// Does the given protocol use a complex state as part of the decode?
@@ -236,7 +339,8 @@ bool hasACState(const decode_type_t protocol) {
 /// @return The corrected length.
 uint16_t getCorrectedRawLength(const decode_results * const results) {
   uint16_t extended_length = results->rawlen - 1;
-  for (uint16_t i = 0; i < results->rawlen - 1; i++) {
+  // The same entries as `resultToRawArray()`. i.e. Not the leading marker.
+  for (uint16_t i = 1; i < results->rawlen; i++) {
     uint32_t usecs = results->rawbuf[i] * kRawTick;
     // Add two extra entries for multiple larger than UINT16_MAX it is.
     extended_length += (usecs / (UINT16_MAX + 1)) * 2;
@@ -249,72 +353,84 @@ uint16_t getCorrectedRawLength(const decode_results * const results) {
 /// @param[in] results A ptr to a decode_results structure.
 /// @return A String containing the code-ified result.
 String resultToSourceCode(const decode_results * const results) {
-  String output = "";
-  const uint16_t length = getCorrectedRawLength(results);
-  const bool hasState = hasACState(results->decode_type);
-  // Reserve some space for the string to reduce heap fragmentation.
-  // "uint16_t rawData[9999] = {};  // LONGEST_PROTOCOL\n" = ~55 chars.
-  // "NNNN,  " = ~7 chars on average per raw entry
+  // "uint16_t rawData[9999] = {};  // LONGEST_PROTOCOL DEADBEEFDEADBEEF\n"
+  //   = ~80 chars.
+  // "NNNNN,  " = at most 8 chars per raw entry.
   // Protocols with a `state`:
   //   "uint8_t state[NN] = {};\n" = ~25 chars
   //   "0xNN, " = 6 chars per byte.
   // Protocols without a `state`:
-  //   " DEADBEEFDEADBEEF\n"
   //   "uint32_t address = 0xDEADBEEF;\n"
   //   "uint32_t command = 0xDEADBEEF;\n"
-  //   "uint64_t data = 0xDEADBEEFDEADBEEF;" = ~116 chars max.
-  output.reserve(55 + (length * 7) + hasState ? 25 + (results->bits / 8) * 6
-                                              : 116);
+  //   "uint64_t data = 0xDEADBEEFDEADBEEF;\n" = ~100 chars max.
+  const uint16_t extra = hasACState(results->decode_type)
+      ? 25 + (results->bits / 8) * 6 : 100;
+  return printToString(resultToSourceCode, results,
+                       80 + getCorrectedRawLength(results) * 8 + extra);
+}
+
+/// Print the key values of a decode_results structure in a C/C++ code style
+/// format.
+/// @param[in,out] output Where to print it. e.g. Serial, a File etc.
+/// @param[in] results A ptr to a decode_results structure.
+/// @return The nr. of bytes printed.
+/// @note Only uses a small fixed amount of stack, no matter the message size.
+size_t resultToSourceCode(Print &output,
+                          const decode_results * const results) {
+  size_t printed = 0;
+  const bool hasState = hasACState(results->decode_type);
   // Start declaration
-  output += F("uint16_t ");  // variable type
-  output += F("rawData[");   // array name
-  output += uint64ToString(length, 10);
+  printed += output.print(F("uint16_t "));  // variable type
+  printed += output.print(F("rawData["));   // array name
+  printed += printUint64(output, getCorrectedRawLength(results));
   // array size
-  output += F("] = {");  // Start declaration
+  printed += output.print(F("] = {"));  // Start declaration
 
   // Dump data
   for (uint16_t i = 1; i < results->rawlen; i++) {
     uint32_t usecs;
     for (usecs = results->rawbuf[i] * kRawTick; usecs > UINT16_MAX;
          usecs -= UINT16_MAX) {
-      output += uint64ToString(UINT16_MAX);
+      printed += printUint64(output, UINT16_MAX);
       if (i % 2)
-        output += F(", 0,  ");
+        printed += output.print(F(", 0,  "));
       else
-        output += F(",  0, ");
+        printed += output.print(F(",  0, "));
     }
-    output += uint64ToString(usecs, 10);
+    printed += printUint64(output, usecs);
     if (i < results->rawlen - 1)
-      output += kCommaSpaceStr;            // ',' not needed on the last one
-    if (i % 2 == 0) output += ' ';  // Extra if it was even.
+      printed += output.print(kCommaSpaceStr);  // ',' not needed on the last
+    if (i % 2 == 0) printed += output.print(' ');  // Extra if it was even.
   }
 
   // End declaration
-  output += F("};");
+  printed += output.print(F("};"));
 
   // Comment
-  output += F("  // ");
-  output += typeToString(results->decode_type, results->repeat);
+  printed += output.print(F("  // "));
+  printed += typeToString(output, results->decode_type, results->repeat);
   // Only display the value if the decode type doesn't have an A/C state.
-  if (!hasState)
-    output += ' ' + uint64ToString(results->value, 16);
-  output += F("\n");
+  if (!hasState) {
+    printed += output.print(' ');
+    printed += printUint64(output, results->value, 16);
+  }
+  printed += output.print(F("\n"));
 
   // Now dump "known" codes
   if (results->decode_type != UNKNOWN) {
     if (hasState) {
 #if DECODE_AC
       uint16_t nbytes = results->bits / 8;
-      output += F("uint8_t state[");
-      output += uint64ToString(nbytes);
-      output += F("] = {");
+      printed += output.print(F("uint8_t state["));
+      printed += printUint64(output, nbytes);
+      printed += output.print(F("] = {"));
       for (uint16_t i = 0; i < nbytes; i++) {
-        output += F("0x");
-        if (results->state[i] < 0x10) output += '0';
-        output += uint64ToString(results->state[i], 16);
-        if (i < nbytes - 1) output += kCommaSpaceStr;
+        printed += output.print(F("0x"));
+        if (results->state[i] < 0x10) printed += output.print('0');
+        printed += printUint64(output, results->state[i], 16);
+        if (i < nbytes - 1) printed += output.print(kCommaSpaceStr);
       }
-      output += F("};\n");
+      printed += output.print(F("};\n"));
 #endif  // DECODE_AC
     } else {
       // Simple protocols
@@ -322,20 +438,20 @@ String resultToSourceCode(const decode_results * const results) {
       // NOTE: It will ignore the atypical case when a message has been
       // decoded but the address & the command are both 0.
       if (results->address > 0 || results->command > 0) {
-        output += F("uint32_t address = 0x");
-        output += uint64ToString(results->address, 16);
-        output += F(";\n");
-        output += F("uint32_t command = 0x");
-        output += uint64ToString(results->command, 16);
-        output += F(";\n");
+        printed += output.print(F("uint32_t address = 0x"));
+        printed += printUint64(output, results->address, 16);
+        printed += output.print(F(";\n"));
+        printed += output.print(F("uint32_t command = 0x"));
+        printed += printUint64(output, results->command, 16);
+        printed += output.print(F(";\n"));
       }
       // Most protocols have data
-      output += F("uint64_t data = 0x");
-      output += uint64ToString(results->value, 16);
-      output += F(";\n");
+      printed += output.print(F("uint64_t data = 0x"));
+      printed += printUint64(output, results->value, 16);
+      printed += output.print(F(";\n"));
     }
   }
-  return output;
+  return printed;
 }
 
 /// Dump out the decode_results structure.
@@ -343,79 +459,94 @@ String resultToSourceCode(const decode_results * const results) {
 /// @return A String containing the legacy information format.
 /// @deprecated This is only for those that want this legacy format.
 String resultToTimingInfo(const decode_results * const results) {
-  String output = "";
-  String value = "";
-  // Reserve some space for the string to reduce heap fragmentation.
-  // "Raw Timing[NNNN]:\n\n" = 19 chars
-  // "   +123456, " / "-123456, " = ~12 chars on avg per raw entry.
-  output.reserve(19 + 12 * results->rawlen);  // Should be less than this.
-  value.reserve(6);  // Max value should be 2^17 = 131072
-  output += F("Raw Timing[");
-  output += uint64ToString(results->rawlen - 1, 10);
-  output += F("]:\n");
+  // "Raw Timing[NNN]:\n" & "   +NNNNNN, " per entry, a '\n' every 8.
+  return printToString(resultToTimingInfo, results, 20 + 13 * results->rawlen);
+}
+
+/// Print out the decode_results structure.
+/// @param[in,out] output Where to print it. e.g. Serial, a File etc.
+/// @param[in] results A ptr to a decode_results structure.
+/// @return The nr. of bytes printed.
+/// @deprecated This is only for those that want this legacy format.
+size_t resultToTimingInfo(Print &output,
+                          const decode_results * const results) {
+  size_t printed = output.print(F("Raw Timing["));
+  printed += printUint64(output, results->rawlen - 1, 10);
+  printed += output.print(F("]:\n"));
 
   for (uint16_t i = 1; i < results->rawlen; i++) {
     if (i % 2 == 0)
-      output += kDashStr;  // even
+      printed += output.print(kDashStr);  // even
     else
-      output += F("   +");  // odd
-    value = uint64ToString(results->rawbuf[i] * kRawTick);
+      printed += output.print(F("   +"));  // odd
     // Space pad the value till it is at least 6 chars long.
-    while (value.length() < 6) value = ' ' + value;
-    output += value;
+    printed += printUint64(output, results->rawbuf[i] * kRawTick, 10, 6);
     if (i < results->rawlen - 1)
-      output += kCommaSpaceStr;  // ',' not needed for last one
-    if (!(i % 8)) output += '\n';  // Newline every 8 entries.
+      printed += output.print(kCommaSpaceStr);  // ',' not needed for last one
+    if (!(i % 8)) printed += output.print('\n');  // Newline every 8 entries.
   }
-  output += '\n';
-  return output;
+  printed += output.print('\n');
+  return printed;
 }
 
 /// Convert the decode_results structure's value/state to simple hexadecimal.
 /// @param[in] result A ptr to a decode_results structure.
 /// @return A String containing the output.
 String resultToHexidecimal(const decode_results * const result) {
-  String output = F("0x");
-  // Reserve some space for the string to reduce heap fragmentation.
-  output.reserve(2 * kStateSizeMax + 2);  // Should cover worst cases.
+  return printToString(resultToHexidecimal, result,
+                       2 * kStateSizeMax + 2);  // Should cover worst cases.
+}
+
+/// Print the decode_results structure's value/state as simple hexadecimal.
+/// @param[in,out] output Where to print it. e.g. Serial, a File etc.
+/// @param[in] result A ptr to a decode_results structure.
+/// @return The nr. of bytes printed.
+size_t resultToHexidecimal(Print &output,
+                           const decode_results * const result) {
+  size_t printed = output.print(F("0x"));
   if (hasACState(result->decode_type)) {
 #if DECODE_AC
     for (uint16_t i = 0; result->bits > i * 8; i++) {
-      if (result->state[i] < 0x10) output += '0';  // Zero pad
-      output += uint64ToString(result->state[i], 16);
+      if (result->state[i] < 0x10) printed += output.print('0');  // Zero pad
+      printed += printUint64(output, result->state[i], 16);
     }
 #endif  // DECODE_AC
   } else {
-    output += uint64ToString(result->value, 16);
+    printed += printUint64(output, result->value, 16);
   }
-  return output;
+  return printed;
 }
 
 /// Dump out the decode_results structure into a human readable format.
 /// @param[in] results A ptr to a decode_results structure.
 /// @return A String containing the output.
 String resultToHumanReadableBasic(const decode_results * const results) {
-  String output = "";
-  // Reserve some space for the string to reduce heap fragmentation.
-  // "Protocol  : LONGEST_PROTOCOL_NAME (Repeat)\n"
-  // "Code      : 0x (NNNN Bits)\n" = 70 chars
-  output.reserve(2 * kStateSizeMax + 70);  // Should cover most cases.
+  return printToString(resultToHumanReadableBasic, results,
+                       2 * kStateSizeMax + 70);  // Should cover most cases.
+}
+
+/// Print the decode_results structure in a human readable format.
+/// @param[in,out] output Where to print it. e.g. Serial, a File etc.
+/// @param[in] results A ptr to a decode_results structure.
+/// @return The nr. of bytes printed.
+size_t resultToHumanReadableBasic(Print &output,
+                                  const decode_results * const results) {
   // Show Encoding standard
-  output += kProtocolStr;
-  output += F("  : ");
-  output += typeToString(results->decode_type, results->repeat);
-  output += '\n';
+  size_t printed = output.print(kProtocolStr);
+  printed += output.print(F("  : "));
+  printed += typeToString(output, results->decode_type, results->repeat);
+  printed += output.print('\n');
 
   // Show Code & length
-  output += kCodeStr;
-  output += F("      : ");
-  output += resultToHexidecimal(results);
-  output += kSpaceLBraceStr;
-  output += uint64ToString(results->bits);
-  output += ' ';
-  output += kBitsStr;
-  output +=  F(")\n");
-  return output;
+  printed += output.print(kCodeStr);
+  printed += output.print(F("      : "));
+  printed += resultToHexidecimal(output, results);
+  printed += output.print(kSpaceLBraceStr);
+  printed += printUint64(output, results->bits);
+  printed += output.print(' ');
+  printed += output.print(kBitsStr);
+  printed += output.print(F(")\n"));
+  return printed;
 }
 
 /// Convert a decode_results into an array suitable for `sendRaw()`.
@@ -441,6 +572,291 @@ uint16_t* resultToRawArray(const decode_results * const decode) {
   return result;
 }
 
+namespace {
+/// Max. nr. of different mark or space lengths `rawToGeneric()` will handle.
+const uint8_t kGenericMaxDurations = 16;
+
+/// A group of similar durations. i.e. One of the mark or space lengths used.
+typedef struct {
+  uint32_t sum;  // Of all the durations in the group.
+  uint16_t count;  // Nr. of durations in the group.
+} duration_group_t;
+
+/// Is a measured duration close enough to an expected one?
+/// @param[in] measured The measured duration in usecs.
+/// @param[in] expected The expected duration in usecs. 0 only matches 0.
+/// @return true if it is within tolerance, false if not.
+bool nearDuration(const uint32_t measured, const uint32_t expected) {
+  if (expected == 0) return measured == 0;
+  const uint32_t margin = expected * kTolerance / 100 + kMarkExcess;
+  return measured + margin >= expected && measured <= expected + margin;
+}
+
+/// How far apart two durations are.
+uint32_t durationDistance(const uint32_t a, const uint32_t b) {
+  return a > b ? a - b : b - a;
+}
+
+/// Group every other duration of a raw array by length.
+/// @param[in] raw The array of durations in usecs.
+/// @param[in] length Nr. of entries in the array.
+/// @param[in] first The entry to start from. i.e. 0 for marks, 1 for spaces.
+/// @param[out] groups The groups found, most common first.
+/// @return Nr. of groups found, or 0 if there are too many.
+uint8_t groupDurations(const uint16_t * const raw, const uint16_t length,
+                       const uint16_t first, duration_group_t *groups) {
+  const uint16_t count = (length - first + 1) / 2;
+  uint16_t *sorted = new uint16_t[count];
+  if (sorted == NULL) return 0;
+  for (uint16_t i = 0; i < count; i++) sorted[i] = raw[first + i * 2];
+  std::sort(sorted, sorted + count);
+  // Each group is everything close enough to its shortest duration.
+  uint8_t ngroups = 0;
+  uint16_t shortest = 0;
+  for (uint16_t i = 0; i < count; i++) {
+    if (ngroups == 0 || !nearDuration(sorted[i], shortest)) {
+      if (ngroups == kGenericMaxDurations) {
+        ngroups = 0;
+        break;
+      }
+      shortest = sorted[i];
+      groups[ngroups].sum = 0;
+      groups[ngroups].count = 0;
+      ngroups++;
+    }
+    groups[ngroups - 1].sum += sorted[i];
+    groups[ngroups - 1].count++;
+  }
+  delete[] sorted;
+  std::stable_sort(groups, groups + ngroups,
+                   [](const duration_group_t &a, const duration_group_t &b) {
+                     return a.count > b.count; });
+  return ngroups;
+}
+
+/// The average duration of a group.
+uint32_t groupAverage(const duration_group_t &group) {
+  return (group.sum + group.count / 2) / group.count;
+}
+
+/// Split a raw array into sections of header, data bits, footer & gap, using
+/// the bit timings already in `signal`.
+/// @param[in] raw The array of durations in usecs.
+/// @param[in] length Nr. of entries in the array.
+/// @param[in] pulse_width Is the data encoded in the mark lengths, rather than
+///   the space lengths? i.e. The last bit of a section ends with the gap.
+/// @param[in,out] signal The description to fill in.
+/// @return Total nr. of data bits, or 0 if it didn't fit that description.
+uint16_t parseGenericSections(const uint16_t * const raw,
+                              const uint16_t length, const bool pulse_width,
+                              generic_signal_t *signal) {
+  memset(signal->data, 0, kGenericSignalMaxBytes);
+  signal->sections = 0;
+  signal->headerless = 0;
+  signal->hdrmark = 0;
+  signal->hdrspace = 0;
+  bool header = false;  // Has the header been seen yet?
+  uint16_t total = 0;
+  uint16_t byte = 0;  // Where the current section's data starts.
+  uint16_t pos = 0;
+  while (pos < length) {
+    if (signal->sections == kGenericSignalMaxSections) return 0;
+    const bool first = signal->sections == 0;
+    // Header. i.e. Anything at the start that isn't a bit.
+    uint16_t hdrmark = 0;
+    uint32_t hdrspace = 0;
+    if (pos + 1 < length &&
+        !(nearDuration(raw[pos], signal->onemark) &&
+          nearDuration(raw[pos + 1], signal->onespace)) &&
+        !(nearDuration(raw[pos], signal->zeromark) &&
+          nearDuration(raw[pos + 1], signal->zerospace))) {
+      hdrmark = raw[pos];
+      hdrspace = raw[pos + 1];
+      pos += 2;
+    }
+    // Some sections may not have one. e.g. A leading or trailing block.
+    if (!hdrmark && !hdrspace) {
+      signal->headerless |= 1 << signal->sections;
+    } else if (!header) {
+      signal->hdrmark = hdrmark;
+      signal->hdrspace = hdrspace;
+      header = true;
+    } else if (!nearDuration(hdrmark, signal->hdrmark) ||
+               !nearDuration(hdrspace, signal->hdrspace)) {
+      return 0;
+    }
+    // Data
+    uint16_t nbits = 0;
+    uint16_t footermark = 0;
+    uint32_t bitspace = 0;  // Any bit space included in the gap.
+    while (pos < length) {
+      const uint16_t mark = raw[pos];
+      const bool last = pos + 1 >= length;
+      const uint32_t space = last ? 0 : raw[pos + 1];
+      // If both are near enough, it's whichever is nearest.
+      const uint32_t one = durationDistance(mark, signal->onemark) +
+          durationDistance(space, signal->onespace);
+      const uint32_t zero = durationDistance(mark, signal->zeromark) +
+          durationDistance(space, signal->zerospace);
+      const bool is_one = !last && nearDuration(mark, signal->onemark) &&
+          nearDuration(space, signal->onespace);
+      const bool is_zero = !last && nearDuration(mark, signal->zeromark) &&
+          nearDuration(space, signal->zerospace);
+      bool bit;
+      if (is_one || is_zero) {
+        bit = is_one && (!is_zero || one < zero);
+      } else if (pulse_width && (nearDuration(mark, signal->onemark) ||
+                                 nearDuration(mark, signal->zeromark)) &&
+                 (last || space > signal->zerospace)) {
+        // The last bit of the section, with its space as part of the gap.
+        bit = durationDistance(mark, signal->onemark) <
+            durationDistance(mark, signal->zeromark);
+        bitspace = signal->zerospace;
+      } else {
+        footermark = mark;
+        pos++;
+        break;
+      }
+      if (byte + nbits / 8 >= kGenericSignalMaxBytes) return 0;
+      if (bit) signal->data[byte + nbits / 8] |= 0x80 >> (nbits % 8);
+      nbits++;
+      pos++;
+      if (bitspace) break;
+      pos++;
+    }
+    if (nbits == 0) return 0;
+    if (first) {
+      signal->footermark = footermark;
+    } else if (!nearDuration(footermark, signal->footermark)) {
+      return 0;
+    }
+    // Gap. The capture normally ends without one, but anything after the last
+    // section is just the silence before the next message anyway.
+    if (pos < length) {
+      const uint32_t gap = raw[pos] > bitspace ? raw[pos] - bitspace : 0;
+      if (first) {
+        signal->gap = gap;
+      } else if (pos + 1 < length && !nearDuration(gap, signal->gap)) {
+        return 0;
+      }
+      pos++;
+    } else if (first) {
+      signal->gap = kDefaultMessageGap;
+    }
+    signal->nbits[signal->sections++] = nbits;
+    byte += (nbits + 7) / 8;
+    total += nbits;
+  }
+  return total;
+}
+
+/// Compares the marks & spaces `IRsend::sendGeneric()` would send for a
+/// description, as a receiver would see them, with a raw array.
+class GenericReplay {
+ public:
+  GenericReplay(const uint16_t * const raw, const uint16_t length)
+      : _raw(raw), _length(length), _pos(0), _mark(false), _pending(0),
+        _matches(true) {}
+  /// Add a mark or space. Consecutive ones of the same kind run together.
+  void add(const bool mark, const uint32_t usecs) {
+    if (usecs == 0) return;
+    if (mark != _mark) flush();
+    _mark = mark;
+    _pending += usecs;
+  }
+  /// @return true if everything matched, apart from the final gap.
+  bool matches(void) {
+    if (_mark) flush();  // The final gap isn't in a capture, or is anything.
+    return _matches && _pos == _length - (_length % 2 == 0);
+  }
+
+ private:
+  const uint16_t * const _raw;
+  const uint16_t _length;
+  uint16_t _pos;
+  bool _mark;
+  uint32_t _pending;
+  bool _matches;
+  void flush(void) {
+    if (!_pending) return;
+    _matches = _matches && _pos < _length &&
+        nearDuration(_raw[_pos], _pending);
+    _pos++;
+    _pending = 0;
+  }
+};
+
+/// Does a description replay as the raw array it was worked out from?
+/// @param[in] raw The array of durations in usecs.
+/// @param[in] length Nr. of entries in the array.
+/// @param[in] signal The description.
+/// @return true if it does, false if not.
+bool replaysAsRaw(const uint16_t * const raw, const uint16_t length,
+                  const generic_signal_t &signal) {
+  GenericReplay replay(raw, length);
+  const uint8_t *ptr = signal.data;
+  for (uint8_t section = 0; section < signal.sections; section++) {
+    if (!(signal.headerless & (1 << section))) {
+      replay.add(true, signal.hdrmark);
+      replay.add(false, signal.hdrspace);
+    }
+    for (uint16_t i = 0; i < signal.nbits[section]; i++) {
+      const bool bit = ptr[i / 8] & (0x80 >> (i % 8));
+      replay.add(true, bit ? signal.onemark : signal.zeromark);
+      replay.add(false, bit ? signal.onespace : signal.zerospace);
+    }
+    ptr += (signal.nbits[section] + 7) / 8;
+    replay.add(true, signal.footermark);
+    if (section + 1 < signal.sections) replay.add(false, signal.gap);
+  }
+  return replay.matches();
+}
+}  // namespace
+
+/// Work out a `sendGeneric()` style description of a raw capture. i.e. The
+/// header, bit & footer timings, and the data bits, of a pulse distance or
+/// pulse width encoded message, like tools/auto_analyse_raw_data.py does.
+/// This is much smaller than the raw durations, e.g. for unknown A/C remotes.
+/// @param[in] raw The array of durations in usecs, starting with a mark.
+///   e.g. As returned by `resultToRawArray()`.
+/// @param[in] length Nr. of entries in the array.
+/// @param[out] signal The description, for `IRsend::sendGeneric()`.
+/// @return true if it could be described, false if it isn't that simple.
+///   e.g. Manchester encoded, or the sections use different timings.
+bool rawToGeneric(const uint16_t * const raw, const uint16_t length,
+                  generic_signal_t *signal) {
+  if (raw == NULL || length < 3) return false;
+  duration_group_t marks[kGenericMaxDurations];
+  duration_group_t spaces[kGenericMaxDurations];
+  const uint8_t nmarks = groupDurations(raw, length, 0, marks);
+  const uint8_t nspaces = groupDurations(raw, length, 1, spaces);
+  if (nmarks == 0 || nspaces == 0) return false;
+  // The data bits use the most common mark & space lengths. Try them both as
+  // pulse distance (two spaces) & pulse width (two marks), and keep whichever
+  // explains the most bits.
+  generic_signal_t candidate;
+  uint16_t best = 0;
+  for (uint8_t pulse_width = 0; pulse_width < 2; pulse_width++) {
+    const duration_group_t *pair = pulse_width ? marks : spaces;
+    if ((pulse_width ? nmarks : nspaces) < 2) continue;
+    const uint32_t shorter = std::min(groupAverage(pair[0]),
+                                      groupAverage(pair[1]));
+    const uint32_t longer = std::max(groupAverage(pair[0]),
+                                     groupAverage(pair[1]));
+    candidate.zeromark = pulse_width ? shorter : groupAverage(marks[0]);
+    candidate.onemark = pulse_width ? longer : groupAverage(marks[0]);
+    candidate.zerospace = pulse_width ? groupAverage(spaces[0]) : shorter;
+    candidate.onespace = pulse_width ? groupAverage(spaces[0]) : longer;
+    const uint16_t nbits = parseGenericSections(raw, length, pulse_width,
+                                                &candidate);
+    if (nbits > best && replaysAsRaw(raw, length, candidate)) {
+      best = nbits;
+      *signal = candidate;
+    }
+  }
+  return best > 0;
+}
+
 /// Sum all the bytes of an array and return the least significant 8-bits of
 /// the result.
 /// @param[in] start A ptr to the start of the byte array to calculate over.
@@ -1311,4 +1727,163 @@ namespace irutils {
       result |= kEndiannessError;
     return result;
   }
+
+  /// Constructor of a StrIndex class.
+  /// @param[in] key A function returning a ptr to the Nth key.
+  /// @param[in] count The nr. of keys.
+  StrIndex::StrIndex(const key_func_t key, const uint16_t count)
+      : _key(key), _count(count), _size(0), _nbuckets(0), _disp(NULL),
+        _slots(NULL) {
+    // If it can't be built, find() falls back to comparing every key.
+    if (!build()) {
+      delete[] _disp;
+      delete[] _slots;
+      _disp = NULL;
+      _slots = NULL;
+    }
+  }
+
+  /// Destructor of a StrIndex class.
+  StrIndex::~StrIndex(void) {
+    delete[] _disp;
+    delete[] _slots;
+  }
+
+  /// Case insensitive FNV-1a hash of a C-style string.
+  /// @param[in] str A ptr to the string.
+  /// @param[in] flash Is the string in flash (PROGMEM) memory?
+  /// @return The hash of the string.
+  uint32_t StrIndex::hash(const char *str, const bool flash) {
+    uint32_t result = 2166136261UL;
+    for (char c = flash ? READCHAR(str) : *str; c;
+         c = flash ? READCHAR(++str) : *(++str)) {
+      result ^= static_cast<uint8_t>(tolower(c));
+      result *= 16777619UL;
+    }
+    return result;
+  }
+
+  /// Case insensitive comparison of two keys, both possibly in flash memory.
+  /// @param[in] a A ptr to a key.
+  /// @param[in] b A ptr to another key.
+  /// @return True, if they are the same. False, if not.
+  bool StrIndex::sameKey(const char *a, const char *b) {
+    for (; tolower(READCHAR(a)) == tolower(READCHAR(b)); a++, b++)
+      if (!READCHAR(a)) return true;
+    return false;
+  }
+
+  /// Calculate which slot a hash goes in, for a given bucket displacement.
+  /// @param[in] hash The hash of the key.
+  /// @param[in] disp The displacement of the bucket the key is in.
+  /// @param[in] size The nr. of slots.
+  /// @return The slot nr.
+  uint16_t StrIndex::slot(const uint32_t hash, const uint16_t disp,
+                          const uint16_t size) {
+    // Mix the displacement in, so each one gives a different spread.
+    uint32_t mixed = hash ^ (disp * 0x9E3779B9UL);
+    mixed ^= mixed >> 16;
+    mixed *= 0x85EBCA6BUL;
+    mixed ^= mixed >> 13;
+    return mixed % size;
+  }
+
+  /// Build the hash. i.e. "Hash, displace, and compress" the keys, so every
+  /// unique key has a slot of its own & there are no empty slots.
+  /// @return True, if it was built. False, if it couldn't be.
+  bool StrIndex::build(void) {
+    if (_count == 0) return false;
+    uint32_t *hashes = new uint32_t[_count];
+    if (hashes == NULL) return false;
+    // Hash every key, & leave duplicates out, so they resolve to the first.
+    bool *dupe = new bool[_count];
+    if (dupe == NULL) {
+      delete[] hashes;
+      return false;
+    }
+    for (uint16_t i = 0; i < _count; i++) {
+      hashes[i] = hash(_key(i), true);
+      dupe[i] = false;
+      for (uint16_t j = 0; j < i && !dupe[i]; j++)
+        dupe[i] = !dupe[j] && hashes[i] == hashes[j] &&
+            sameKey(_key(i), _key(j));
+      if (!dupe[i]) _size++;
+    }
+    _nbuckets = (_size + 1) / 2;
+    // How big is the biggest bucket?
+    uint16_t biggest = 0;
+    for (uint16_t b = 0; b < _nbuckets; b++) {
+      uint16_t members = 0;
+      for (uint16_t i = 0; i < _count; i++)
+        if (!dupe[i] && hashes[i] % _nbuckets == b) members++;
+      biggest = std::max(biggest, members);
+    }
+    _disp = new uint16_t[_nbuckets];
+    _slots = new uint16_t[_size];
+    uint16_t *members = new uint16_t[biggest];
+    uint16_t *claimed = new uint16_t[biggest];
+    bool success = _disp != NULL && _slots != NULL && members != NULL &&
+        claimed != NULL;
+    if (success) {
+      for (uint16_t b = 0; b < _nbuckets; b++) _disp[b] = 0;
+      for (uint16_t s = 0; s < _size; s++) _slots[s] = UINT16_MAX;
+    }
+    // Place the biggest buckets first, while there are the most free slots.
+    for (uint16_t size = biggest; success && size; size--) {
+      for (uint16_t b = 0; success && b < _nbuckets; b++) {
+        uint16_t nr_members = 0;
+        for (uint16_t i = 0; i < _count; i++) {
+          if (dupe[i] || hashes[i] % _nbuckets != b) continue;
+          if (nr_members < biggest) members[nr_members] = i;
+          nr_members++;
+        }
+        if (nr_members != size) continue;
+        // Find a displacement that puts every member in a free slot. Give up
+        // after kStrIndexMaxDisplacement tries, find() then compares every
+        // key instead.
+        success = false;
+        for (uint16_t d = 0; !success && d < kStrIndexMaxDisplacement; d++) {
+#ifndef UNIT_TEST
+          // Let the system (e.g. WiFi) run during a long search.
+          if (d % kStrIndexYieldInterval == kStrIndexYieldInterval - 1)
+            yield();
+#endif  // UNIT_TEST
+          uint16_t nr_claimed = 0;
+          success = true;
+          for (uint16_t m = 0; success && m < size; m++) {
+            const uint16_t s = slot(hashes[members[m]], d, _size);
+            if (_slots[s] == UINT16_MAX) {
+              _slots[s] = members[m];
+              claimed[nr_claimed++] = s;
+            } else {
+              success = false;
+            }
+          }
+          if (success)
+            _disp[b] = d;
+          else  // Release what it claimed.
+            while (nr_claimed) _slots[claimed[--nr_claimed]] = UINT16_MAX;
+        }
+      }
+    }
+    delete[] members;
+    delete[] claimed;
+    delete[] hashes;
+    delete[] dupe;
+    return success;
+  }
+
+  /// Find which key a string matches.
+  /// @param[in] str A ptr to a C-style string. (In RAM)
+  /// @return The index of the matching key, or -1 if there isn't one.
+  int16_t StrIndex::find(const char * const str) const {
+    if (_slots == NULL) {  // Not built, so compare every key.
+      for (uint16_t i = 0; i < _count; i++)
+        if (!STRCASECMP(str, _key(i))) return i;
+      return -1;
+    }
+    const uint32_t h = hash(str, false);
+    const uint16_t i = _slots[slot(h, _disp[h % _nbuckets], _size)];
+    return STRCASECMP(str, _key(i)) ? -1 : i;
+  }
 }  // namespace irutils
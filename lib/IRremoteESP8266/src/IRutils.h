@@ -8,11 +8,33 @@
 #endif
 #define __STDC_LIMIT_MACROS
 #include <stdint.h>
+#include <string.h>
 #ifndef ARDUINO
 #include <string>
 #endif
 #include "IRremoteESP8266.h"
 #include "IRrecv.h"
+#include "IRsend.h"
+
+#ifdef UNIT_TEST
+/// A minimal stand-in for the Arduino `Print` class, so the streaming
+/// functions can be used & tested off the device.
+class Print {
+ public:
+  virtual ~Print() {}
+  virtual size_t write(uint8_t c) = 0;
+  virtual size_t write(const uint8_t *buffer, size_t size) {
+    size_t n = 0;
+    while (size--) n += write(*buffer++);
+    return n;
+  }
+  size_t print(const char c) { return write(c); }
+  size_t print(const char *str) {
+    return write(reinterpret_cast<const uint8_t *>(str), strlen(str));
+  }
+  size_t print(const std::string &str) { return print(str.c_str()); }
+};
+#endif  // UNIT_TEST
 
 const uint8_t kNibbleSize = 4;
 const uint8_t kLowNibble = 0;
@@ -23,14 +45,26 @@ String uint64ToString(uint64_t input, uint8_t base = 10);
 String int64ToString(int64_t input, uint8_t base = 10);
 String typeToString(const decode_type_t protocol,
                     const bool isRepeat = false);
+size_t typeToString(Print &output, const decode_type_t protocol,
+                    const bool isRepeat = false);
 void serialPrintUint64(uint64_t input, uint8_t base = 10);
 String resultToSourceCode(const decode_results * const results);
+size_t resultToSourceCode(Print &output,
+                          const decode_results * const results);
 String resultToTimingInfo(const decode_results * const results);
+size_t resultToTimingInfo(Print &output,
+                          const decode_results * const results);
 String resultToHumanReadableBasic(const decode_results * const results);
+size_t resultToHumanReadableBasic(Print &output,
+                                  const decode_results * const results);
 String resultToHexidecimal(const decode_results * const result);
+size_t resultToHexidecimal(Print &output,
+                           const decode_results * const result);
 bool hasACState(const decode_type_t protocol);
 uint16_t getCorrectedRawLength(const decode_results * const results);
 uint16_t *resultToRawArray(const decode_results * const decode);
+bool rawToGeneric(const uint16_t * const raw, const uint16_t length,
+                  generic_signal_t *signal);
 uint8_t sumBytes(const uint8_t * const start, const uint16_t length,
                  const uint8_t init = 0);
 uint8_t xorBytes(const uint8_t * const start, const uint16_t length,
@@ -135,5 +169,38 @@ namespace irutils {
   uint8_t * invertBytePairs(uint8_t *ptr, const uint16_t length);
   bool checkInvertedBytePairs(const uint8_t * const ptr, const uint16_t length);
   uint8_t lowLevelSanityCheck(void);
+
+  /// Nr. of displacements `StrIndex` tries per bucket before it gives up.
+  const uint16_t kStrIndexMaxDisplacement = 4096;
+  /// Nr. of displacements `StrIndex` tries between two calls to `yield()`.
+  const uint16_t kStrIndexYieldInterval = 256;
+
+  /// A minimal perfect hash of a fixed set of strings, for O(1) lookups.
+  /// It is built once, from the (locale dependent) text, when constructed.
+  /// e.g. As a function `static` so it is built on the first lookup.
+  /// @note Lookups are case insensitive. Duplicate keys resolve to the first.
+  class StrIndex {
+   public:
+    /// A function returning a ptr to the Nth key. (May be in flash/PROGMEM)
+    typedef const char *(*key_func_t)(const uint16_t index);
+    StrIndex(const key_func_t key, const uint16_t count);
+    ~StrIndex(void);
+    int16_t find(const char * const str) const;
+#ifndef UNIT_TEST
+
+   private:
+#endif  // UNIT_TEST
+    key_func_t _key;  ///< Where to get the keys from.
+    uint16_t _count;  ///< Nr. of keys.
+    uint16_t _size;  ///< Nr. of slots. i.e. Nr. of unique keys.
+    uint16_t _nbuckets;  ///< Nr. of entries in `_disp`.
+    uint16_t *_disp;  ///< Displacement for each bucket of keys.
+    uint16_t *_slots;  ///< Key index for each slot. NULL if not built.
+    static uint32_t hash(const char *str, const bool flash);
+    static bool sameKey(const char *a, const char *b);
+    static uint16_t slot(const uint32_t hash, const uint16_t disp,
+                         const uint16_t size);
+    bool build(void);
+  };
 }  // namespace irutils
 #endif  // IRUTILS_H_
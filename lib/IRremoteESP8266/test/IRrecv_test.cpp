@@ -85,6 +85,282 @@ TEST(TestIRrecv, DecodeHeapOverflow) {
   EXPECT_EQ(99, params_ptr->rawbuf[params_ptr->rawlen + 1]);
 }
 
+// Tests for the double buffer mode.
+
+// Mock up the interrupt capturing a message & then timing out.
+static void captureMessage(IRrecv *irrecv, const decode_results *message) {
+  volatile irparams_t *params_ptr = irrecv->_getParamsPtr();
+  for (uint16_t i = 0; i < message->rawlen; i++)
+    params_ptr->rawbuf[i] = message->rawbuf[i];
+  params_ptr->rawlen = message->rawlen;
+  params_ptr->rcvstate = kSpaceState;
+  irrecv->_readTimeout();
+}
+
+TEST(TestDoubleBuffer, SwapsInsteadOfCopying) {
+  {  // N.B. Only one IRrecv can exist at a time.
+    IRrecv no_save(1, 200);
+    EXPECT_FALSE(no_save.setDoubleBuffer());
+  }
+
+  IRrecv irrecv(1, 200, kTimeoutMs, true);
+  ASSERT_TRUE(irrecv.setDoubleBuffer());
+  irrecv.enableIRIn();
+  volatile irparams_t *params_ptr = irrecv._getParamsPtr();
+  uint16_t *first = params_ptr->rawbuf;
+
+  IRsendTest irsend(0);
+  irsend.begin();
+  irsend.reset();
+  irsend.sendNEC(0x4BB640BF);
+  irsend.makeDecodeResult();
+
+  // The interrupt swaps to the spare buffer & keeps capturing.
+  captureMessage(&irrecv, &irsend.capture);
+  EXPECT_EQ(kIdleState, params_ptr->rcvstate);
+  EXPECT_EQ(0, params_ptr->rawlen);
+  uint16_t *second = params_ptr->rawbuf;
+  EXPECT_NE(first, second);
+
+  // The message is decoded from the buffer it was captured into.
+  decode_results results;
+  ASSERT_TRUE(irrecv.decode(&results));
+  EXPECT_EQ(first, results.rawbuf);
+  EXPECT_EQ(NEC, results.decode_type);
+  EXPECT_EQ(0x4BB640BF, results.value);
+
+  // While those results are in use, there is nothing to swap to, so the
+  // interrupt stops after the next message.
+  irsend.reset();
+  irsend.sendNEC(0x20DFC03F);
+  irsend.makeDecodeResult();
+  captureMessage(&irrecv, &irsend.capture);
+  EXPECT_EQ(kStopState, params_ptr->rcvstate);
+  EXPECT_EQ(second, params_ptr->rawbuf);
+  EXPECT_EQ(first, results.rawbuf);
+  EXPECT_EQ(0x4BB640BF, results.value);
+
+  // The next decode() hands the first buffer back & swaps to it itself.
+  ASSERT_TRUE(irrecv.decode(&results));
+  EXPECT_EQ(second, results.rawbuf);
+  EXPECT_EQ(0x20DFC03F, results.value);
+  EXPECT_EQ(first, params_ptr->rawbuf);
+  EXPECT_EQ(kIdleState, params_ptr->rcvstate);
+
+  // Nothing new has been captured.
+  EXPECT_FALSE(irrecv.decode(&results));
+  EXPECT_FALSE(irrecv.releaseBuffer());  // decode() already handed it back.
+
+  // Results can be handed back early, so the interrupt can swap to them.
+  captureMessage(&irrecv, &irsend.capture);
+  ASSERT_TRUE(irrecv.decode(&results));
+  EXPECT_EQ(first, results.rawbuf);
+  EXPECT_TRUE(irrecv.releaseBuffer());
+  EXPECT_FALSE(irrecv.releaseBuffer());
+  captureMessage(&irrecv, &irsend.capture);
+  EXPECT_EQ(kIdleState, params_ptr->rcvstate);
+  EXPECT_EQ(first, params_ptr->rawbuf);
+
+  // Leaving double buffer mode tidies up the buffers.
+  EXPECT_TRUE(irrecv.setDoubleBuffer(false));
+  EXPECT_EQ(kStopState, params_ptr->rcvstate);
+  EXPECT_EQ(first, params_ptr->rawbuf);
+}
+
+// Tests for the chunked capture mode.
+
+TEST(TestChunkedCapture, KeepsOnlyTheChunksUsed) {
+  IRrecv irrecv(1, 400);
+  EXPECT_FALSE(irrecv.setChunkedCapture(400));  // Must have 2+ chunks.
+  ASSERT_TRUE(irrecv.setChunkedCapture(64, 300));
+  EXPECT_EQ(300, irrecv.getBufSize());
+  irrecv.enableIRIn();
+  volatile irparams_t *params_ptr = irrecv._getParamsPtr();
+  uint16_t *pool = params_ptr->rawbuf;
+  EXPECT_EQ(300, params_ptr->bufsize);  // Capped by the ceiling.
+
+  IRsendTest irsend(0);
+  irsend.begin();
+  irsend.reset();
+  irsend.sendNEC(0x4BB640BF);
+  irsend.makeDecodeResult();
+  ASSERT_EQ(69, irsend.capture.rawlen);
+
+  // The message keeps 2 chunks. The rest of the pool is used for the next one.
+  captureMessage(&irrecv, &irsend.capture);
+  EXPECT_EQ(kIdleState, params_ptr->rcvstate);
+  EXPECT_EQ(pool + 128, params_ptr->rawbuf);
+  EXPECT_EQ(400 - 128 - 1, params_ptr->bufsize);
+
+  decode_results results;
+  ASSERT_TRUE(irrecv.decode(&results));
+  EXPECT_EQ(pool, results.rawbuf);  // Decoded in place.
+  EXPECT_EQ(NEC, results.decode_type);
+  EXPECT_EQ(0x4BB640BF, results.value);
+
+  // While those results are in use, the next message goes after it.
+  irsend.reset();
+  irsend.sendNEC(0x20DFC03F);
+  irsend.makeDecodeResult();
+  captureMessage(&irrecv, &irsend.capture);
+  EXPECT_EQ(pool + 256, params_ptr->rawbuf);
+  EXPECT_EQ(400 - 256 - 1, params_ptr->bufsize);
+  EXPECT_EQ(0x4BB640BF, results.value);
+
+  // The next decode() hands the first capture back.
+  ASSERT_TRUE(irrecv.decode(&results));
+  EXPECT_EQ(pool + 128, results.rawbuf);
+  EXPECT_EQ(0x20DFC03F, results.value);
+  EXPECT_FALSE(irrecv.decode(&results));
+  EXPECT_FALSE(irrecv.releaseBuffer());
+
+  // A long message can use up to the ceiling, if there is room.
+  ASSERT_TRUE(irrecv.setChunkedCapture(64, 300));
+  irrecv.resume();
+  EXPECT_EQ(pool, params_ptr->rawbuf);
+  decode_results long_message;
+  uint16_t long_buf[300];
+  long_buf[0] = 0;
+  for (uint16_t i = 1; i < 300; i++) long_buf[i] = 280;
+  long_message.rawbuf = long_buf;
+  long_message.rawlen = 300;
+  captureMessage(&irrecv, &long_message);
+  ASSERT_TRUE(irrecv.decode(&results));
+  EXPECT_EQ(pool, results.rawbuf);
+  EXPECT_EQ(300, results.rawlen);
+  EXPECT_FALSE(results.overflow);
+  EXPECT_EQ(0, results.rawbuf[300]);
+  irrecv.setChunkedCapture(0);
+  EXPECT_EQ(pool, params_ptr->rawbuf);
+  EXPECT_EQ(400, irrecv.getBufSize());
+}
+
+TEST(TestChunkedCapture, StallsWhenThePoolIsFull) {
+  IRrecv irrecv(1, 200);
+  ASSERT_TRUE(irrecv.setChunkedCapture(50));
+  irrecv.enableIRIn();
+  volatile irparams_t *params_ptr = irrecv._getParamsPtr();
+
+  decode_results message;
+  uint16_t buf[160];
+  buf[0] = 0;
+  for (uint16_t i = 1; i < 160; i++) buf[i] = 280;
+  message.rawbuf = buf;
+  message.rawlen = 160;
+  // Uses the whole pool, so there is nowhere to capture the next message.
+  captureMessage(&irrecv, &message);
+  EXPECT_EQ(kStopState, params_ptr->rcvstate);
+
+  decode_results results;
+  ASSERT_TRUE(irrecv.decode(&results));
+  EXPECT_EQ(160, results.rawlen);
+  EXPECT_EQ(kStopState, params_ptr->rcvstate);  // Still no room.
+  // Once the results are handed back, capturing carries on.
+  EXPECT_FALSE(irrecv.decode(&results));
+  EXPECT_EQ(kIdleState, params_ptr->rcvstate);
+  EXPECT_EQ(199, params_ptr->bufsize);
+  irrecv.setChunkedCapture(0);
+}
+
+// Tests for the cycle count capture mode.
+
+TEST(TestCycleCountCapture, DecodesFromCycleCounts) {
+  IRrecv irrecv(1, 200, kTimeoutMs, true);
+  ASSERT_TRUE(irrecv.setDoubleBuffer());
+  ASSERT_TRUE(irrecv.setCycleCountCapture());
+  irrecv.enableIRIn();
+  volatile irparams_t *params_ptr = irrecv._getParamsPtr();
+
+  IRsendTest irsend(0);
+  irsend.begin();
+  irsend.reset();
+  irsend.sendNEC(0x4BB640BF);
+  irsend.makeDecodeResult();
+
+  // Feed the edges in as 80MHz cycle counts, wrapping the counter mid message.
+  const uint32_t kCyclesPerTick = 80 * kRawTick;
+  uint32_t now = UINT32_MAX - 20000 * kCyclesPerTick;
+  for (uint16_t i = 0; i < irsend.capture.rawlen; i++) {
+    if (i) now += irsend.capture.rawbuf[i] * kCyclesPerTick + (i % 3) * 37;
+    irrecv._recordCycleCount(now);
+  }
+  EXPECT_EQ(irsend.capture.rawlen, params_ptr->rawlen);
+  // 560us in units of 128 cycles, rather than ticks.
+  EXPECT_EQ(350, params_ptr->rawbuf[3]);
+  irrecv._readTimeout();
+
+  decode_results results;
+  ASSERT_TRUE(irrecv.decode(&results));
+  EXPECT_EQ(NEC, results.decode_type);
+  EXPECT_EQ(0x4BB640BF, results.value);
+  // Converted back into ticks, to within the resolution of a unit.
+  for (uint16_t i = kStartOffset; i < results.rawlen; i++)
+    EXPECT_NEAR(irsend.capture.rawbuf[i], results.rawbuf[i], 1) << "i = " << i;
+
+  // Long gaps saturate rather than wrap around.
+  irrecv._recordCycleCount(now);
+  irrecv._recordCycleCount(now + 200000 * 80);  // 200ms
+  EXPECT_EQ(UINT16_MAX, params_ptr->rawbuf[1]);
+  irrecv.setDoubleBuffer(false);
+}
+
+TEST(TestEarlyDecode, StopsOnceTheMessageIsComplete) {
+  IRrecv irrecv(1, 200, kTimeoutMs, true);
+  ASSERT_TRUE(irrecv.setEarlyDecode(150));
+  irrecv.enableIRIn();
+  volatile irparams_t *params_ptr = irrecv._getParamsPtr();
+
+  IRsendTest irsend(0);
+  irsend.begin();
+  irsend.reset();
+  irsend.sendNEC(0x4BB640BF);
+  irsend.makeDecodeResult();
+  // Header, data & footer mark. i.e. Everything but the trailing gap.
+  const uint16_t kMessageLength = kStartOffset + 2 + kNECBits * 2 + 1;
+  ASSERT_LT(kMessageLength, irsend.capture.rawlen);
+  const uint32_t kQuiet = 20000 / kRawTick;  // 20ms of silence.
+
+  // Feed it in, as the interrupt would, trying to decode just before every
+  // edge. i.e. After as much silence as there is going to be.
+  // Prefixes of it decode as JVC (16 bits) & Inax (24 bits), but the spaces
+  // are too short for them to be mistaken for the end of the message.
+  params_ptr->rcvstate = kMarkState;
+  for (uint16_t i = 0; i < kMessageLength; i++) {
+    params_ptr->rawbuf[i] = irsend.capture.rawbuf[i];
+    params_ptr->rawlen = i + 1;
+    if (i + 1 < kMessageLength) {
+      EXPECT_FALSE(irrecv._earlyDecode(i + 1, i, irsend.capture.rawbuf[i + 1],
+                                       0, 0)) << "i = " << i;
+    }
+  }
+  // Complete, but not quiet for long enough yet. i.e. Less than the header
+  // space & the minimum silence.
+  EXPECT_FALSE(irrecv._earlyDecode(kMessageLength, 1000, 4000 / kRawTick,
+                                   0, 0));
+  EXPECT_FALSE(irrecv._earlyDecode(kMessageLength, 1000, 100, 0, 0));
+  EXPECT_EQ(kMarkState, params_ptr->rcvstate);
+  EXPECT_TRUE(irrecv._earlyDecode(kMessageLength, 1000, kQuiet, 0, 0));
+  EXPECT_EQ(kStopState, params_ptr->rcvstate);
+  EXPECT_EQ(kMessageLength, params_ptr->rawlen);
+
+  decode_results results;
+  ASSERT_TRUE(irrecv.decode(&results));
+  EXPECT_EQ(NEC, results.decode_type);
+  EXPECT_EQ(kNECBits, results.bits);
+  EXPECT_EQ(0x4BB640BF, results.value);
+
+  // A capture that has already been tried isn't tried again, & nothing is
+  // tried once it has been turned off.
+  irrecv.resume();
+  params_ptr->rcvstate = kMarkState;
+  for (uint16_t i = 0; i < kMessageLength; i++)
+    params_ptr->rawbuf[i] = irsend.capture.rawbuf[i];
+  params_ptr->rawlen = kMessageLength;
+  EXPECT_FALSE(irrecv._earlyDecode(kMessageLength, 1000, kQuiet, 0, 0));
+  ASSERT_TRUE(irrecv.setEarlyDecode(0));
+  EXPECT_EQ(NULL, irrecv._early_buf);
+}
+
 // Tests for copyIrParams()
 
 TEST(TestCopyIrParams, CopyEmpty) {
@@ -604,6 +880,28 @@ TEST(TestMatchData, ArbitraryEncoded) {
   ASSERT_FALSE(result.success);
 }
 
+// The precalculated tick ranges used by matchData() must agree with match().
+TEST(TestMatchData, TickRangesAgreeWithMatch) {
+  IRrecv irrecv(1);
+  const uint32_t desired[] = {1, 2, 3, 50, 428, 560, 1280, 1690, 9000, 29000};
+  const uint8_t tolerances[] = {0, 1, 10, 25, 50, 100};
+  for (uint32_t usecs : desired) {
+    for (uint8_t tolerance : tolerances) {
+      const tick_range_t range = irrecv._tickRange(usecs, tolerance);
+      for (uint32_t ticks = 0; ticks <= (usecs * 2) / kRawTick + 2; ticks++)
+        ASSERT_EQ(irrecv.match(ticks, usecs, tolerance),
+                  ticks >= range.low && ticks <= range.high) <<
+            ticks << " ticks vs " << usecs << " usecs +/- " <<
+            static_cast<int>(tolerance) << "%";
+    }
+    // With a fixed delta instead of a percentage.
+    const tick_range_t range = irrecv._tickRange(usecs, 0, 100);
+    for (uint32_t ticks = 0; ticks <= (usecs + 200) / kRawTick; ticks++)
+      ASSERT_EQ(irrecv.match(ticks, usecs, 0, 100),
+                ticks >= range.low && ticks <= range.high);
+  }
+}
+
 TEST(TestMatchGeneric, NormalWithNoAtleast) {
   IRsendTest irsend(0);
   IRrecv irrecv(1);
@@ -1701,6 +1999,139 @@ TEST(TestCrudeNoiseFilter, NoiseAtEndOfSample) {
       resultToSourceCode(&irsend.capture));
 }
 
+// The original O(n^2) implementation of `crudeNoiseFilter()`, kept as the
+// reference for the single pass version.
+static void referenceCrudeNoiseFilter(decode_results *results,
+                                      const uint16_t floor,
+                                      const uint16_t bufsize) {
+  const uint16_t kTickFloor = floor / kRawTick;
+  uint16_t offset = kStartOffset;
+  while (offset < results->rawlen && offset + 2 < bufsize) {
+    uint16_t curr = results->rawbuf[offset];
+    uint16_t next = results->rawbuf[offset + 1];
+    uint16_t addition = curr + next;
+    if (curr < kTickFloor) {
+      for (uint16_t i = offset + 2; i <= results->rawlen && i < bufsize; i++)
+        results->rawbuf[i - 2] = results->rawbuf[i];
+      if (offset > 1) results->rawbuf[offset - 1] += addition;
+      results->rawlen -= 2;
+    } else {
+      offset++;
+    }
+  }
+}
+
+// Fill a capture buffer (in ticks) with a recorded message & random glitches.
+static uint16_t makeNoisyCapture(uint16_t *buf, const uint16_t bufsize,
+                                 const uint16_t *data, const uint16_t length,
+                                 uint32_t *seed) {
+  uint16_t rawlen = kStartOffset;
+  buf[0] = 0;
+  for (uint16_t i = 0; i < length && rawlen < bufsize; i++) {
+    *seed = *seed * 1103515245UL + 12345UL;
+    // Roughly every 4th entry gets a short glitch pair injected before it.
+    if ((*seed >> 16) % 4 == 0 && rawlen + 2 < bufsize) {
+      buf[rawlen++] = ((*seed >> 8) % 120) / kRawTick;
+      buf[rawlen++] = ((*seed >> 4) % 120) / kRawTick;
+    }
+    buf[rawlen++] = data[i] / kRawTick;
+  }
+  if (rawlen < bufsize) buf[rawlen] = 0;  // As done by `decode()`.
+  return rawlen;
+}
+
+TEST(TestCrudeNoiseFilter, SinglePassMatchesReference) {
+  // Ref: https://github.com/crankyoldgit/IRremoteESP8266/issues/1042#issuecomment-583895303
+  const uint16_t rawData[69] = {
+      9078, 4386, 662, 468, 660, 466, 662, 1588, 660, 468, 660, 468, 662, 466,
+      662, 466, 662, 466, 662, 1588, 660, 1588, 660, 466, 662, 1590, 660, 1586,
+      662, 1586, 662, 1588, 662, 1584, 662, 1588, 662, 1588, 660, 466, 686, 442,
+      662, 466, 662, 466, 662, 466, 662, 468, 662, 466, 662, 466, 662, 1586,
+      662, 1588, 662, 1586, 644, 1600, 662, 1586, 688, 1566, 684, 2638, 146};
+  const uint16_t floors[] = {50, 100, 150, 200, 700};
+  // Large enough for everything, and too small (i.e. an overflowed capture).
+  const uint16_t bufsizes[] = {200, 60};
+  uint32_t seed = 42;
+
+  for (uint16_t bufsize : bufsizes) {
+    IRrecv irrecv(1, bufsize);
+    uint16_t expected_buf[200];
+    uint16_t actual_buf[200];
+    for (uint16_t floor : floors) {
+      for (uint8_t run = 0; run < 50; run++) {
+        decode_results expected;
+        decode_results actual;
+        expected.rawlen = makeNoisyCapture(expected_buf, bufsize, rawData, 69,
+                                           &seed);
+        // An overflowed capture has no terminating 0 to compare.
+        const bool overflow = expected.rawlen >= bufsize;
+        memcpy(actual_buf, expected_buf, sizeof(actual_buf));
+        expected.rawbuf = expected_buf;
+        actual.rawbuf = actual_buf;
+        actual.rawlen = expected.rawlen;
+
+        referenceCrudeNoiseFilter(&expected, floor, bufsize);
+        irrecv.crudeNoiseFilter(&actual, floor);
+
+        ASSERT_EQ(expected.rawlen, actual.rawlen) << "floor " << floor;
+        const uint16_t end = expected.rawlen + (overflow ? 0 : 1);
+        for (uint16_t i = 0; i < end; i++)
+          ASSERT_EQ(expected_buf[i], actual_buf[i]) << "differs at i = " << i;
+      }
+    }
+  }
+}
+
+TEST(TestCrudeNoiseFilter, GlitchModel) {
+  IRrecv irrecv(1);
+  uint16_t buf[10];
+  decode_results results;
+  results.rawbuf = buf;
+
+  // Default is to not filter anything.
+  EXPECT_EQ(0, irrecv.getNoiseFilter().min_mark);
+  EXPECT_EQ(0, irrecv.getNoiseFilter().min_space);
+
+  // Only short spaces are glitches. (Values are in ticks, i.e. usecs / 2)
+  const uint16_t capture[8] = {0, 300, 20, 300, 300, 20, 300, 0};
+  memcpy(buf, capture, sizeof(capture));
+  results.rawlen = 7;
+  irrecv.filterNoise(&results, {0, 100, true});
+  // The 20 space & the following mark are merged into the previous mark.
+  EXPECT_EQ(5, results.rawlen);
+  EXPECT_EQ(620, buf[1]);
+  EXPECT_EQ(300, buf[2]);
+  EXPECT_EQ(20, buf[3]);  // A short mark is kept.
+  EXPECT_EQ(300, buf[4]);
+  EXPECT_EQ(0, buf[5]);
+
+  // Short marks are dropped, without being merged.
+  memcpy(buf, capture, sizeof(capture));
+  results.rawlen = 7;
+  irrecv.filterNoise(&results, {100, 0, false});
+  EXPECT_EQ(5, results.rawlen);
+  EXPECT_EQ(300, buf[1]);
+  EXPECT_EQ(20, buf[2]);
+  EXPECT_EQ(300, buf[3]);
+  EXPECT_EQ(300, buf[4]);
+  EXPECT_EQ(0, buf[5]);
+
+  // decode() uses the configured filter when no noise floor is given.
+  IRsendTest irsend(0);
+  irsend.begin();
+  irsend.reset();
+  irsend.mark(60);
+  irsend.space(60);
+  irsend.sendNEC(0x4BB640BF);
+  irsend.makeDecodeResult();
+  irrecv.setNoiseFilter({100, 100, true});
+  EXPECT_EQ(100, irrecv.getNoiseFilter().min_mark);
+  EXPECT_TRUE(irrecv.decode(&irsend.capture));
+  EXPECT_EQ(NEC, irsend.capture.decode_type);
+  EXPECT_EQ(0x4BB640BF, irsend.capture.value);
+  EXPECT_EQ(69, irsend.capture.rawlen);
+}
+
 TEST(TestManchesterCode, matchManchester) {
   IRsendTest irsend(0);
   IRrecv irrecv(0);
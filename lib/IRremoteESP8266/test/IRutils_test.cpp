@@ -333,6 +333,55 @@ TEST(TestResultToHumanReadableBasic, ComplexCodes) {
       resultToHumanReadableBasic(&irsend.capture));
 }
 
+// A Print that keeps what is written to it, for checking the streamed output.
+class TestPrint : public Print {
+ public:
+  size_t write(uint8_t c) override {
+    text += static_cast<char>(c);
+    return 1;
+  }
+  std::string text;
+};
+
+// Tests for the Print based versions of the above.
+TEST(TestResultToPrint, MatchesTheStrings) {
+  IRsendTest irsend(0);
+  IRrecv irrecv(1);
+  irsend.begin();
+
+  uint8_t state[kToshibaACStateLength] = {0xF2, 0x0D, 0x03, 0xFC, 0x01,
+                                          0x00, 0x00, 0x00, 0x01};
+  irsend.reset();
+  irsend.sendToshibaAC(state);
+  irsend.makeDecodeResult();
+  ASSERT_TRUE(irrecv.decode(&irsend.capture));
+  // Stick in a large value too, so it needs some padding.
+  irsend.capture.rawbuf[3] = 60000;
+
+  TestPrint out;
+  EXPECT_EQ(resultToSourceCode(&irsend.capture).length(),
+            resultToSourceCode(out, &irsend.capture));
+  EXPECT_EQ(resultToSourceCode(&irsend.capture), out.text);
+  out.text.clear();
+  EXPECT_EQ(resultToTimingInfo(&irsend.capture).length(),
+            resultToTimingInfo(out, &irsend.capture));
+  EXPECT_EQ(resultToTimingInfo(&irsend.capture), out.text);
+  out.text.clear();
+  EXPECT_EQ(resultToHumanReadableBasic(&irsend.capture).length(),
+            resultToHumanReadableBasic(out, &irsend.capture));
+  EXPECT_EQ(resultToHumanReadableBasic(&irsend.capture), out.text);
+  out.text.clear();
+  EXPECT_EQ(resultToHexidecimal(&irsend.capture).length(),
+            resultToHexidecimal(out, &irsend.capture));
+  EXPECT_EQ(resultToHexidecimal(&irsend.capture), out.text);
+  out.text.clear();
+  EXPECT_EQ(12U, typeToString(out, NEC, true));
+  EXPECT_EQ("NEC (Repeat)", out.text);
+  out.text.clear();
+  typeToString(out, (decode_type_t)(kLastDecodeType + 1));
+  EXPECT_EQ(typeToString((decode_type_t)(kLastDecodeType + 1)), out.text);
+}
+
 TEST(TestInvertBits, Normal) {
   ASSERT_EQ(0xAAAA5555AAAA5555, invertBits(0x5555AAAA5555AAAA, 64));
   ASSERT_EQ(0xAAAA5555, invertBits(0x5555AAAA, 32));
@@ -492,6 +541,106 @@ TEST(TestResultToRawArray, LargeValues) {
   if (result != NULL) delete[] result;
 }
 
+// Work out the generic description of what was sent, & check sending it
+// decodes the same.
+bool rawToGenericLoopBack(IRsendTest *irsend, generic_signal_t *signal) {
+  IRrecv irrecv(1, 1024);
+  irsend->makeDecodeResult();
+  uint16_t *raw = resultToRawArray(&irsend->capture);
+  const bool described = rawToGeneric(
+      raw, getCorrectedRawLength(&irsend->capture), signal);
+  delete[] raw;
+  if (!described) return false;
+  EXPECT_TRUE(irrecv.decode(&irsend->capture));
+  const decode_results original = irsend->capture;
+  uint8_t state[kStateSizeMax];
+  memcpy(state, original.state, kStateSizeMax);
+  irsend->reset();
+  irsend->sendGeneric(signal);
+  irsend->makeDecodeResult();
+  EXPECT_TRUE(irrecv.decode(&irsend->capture));
+  EXPECT_EQ(original.decode_type, irsend->capture.decode_type);
+  EXPECT_EQ(original.bits, irsend->capture.bits);
+  if (hasACState(original.decode_type)) {
+    EXPECT_STATE_EQ(state, irsend->capture.state, original.bits);
+  } else {
+    EXPECT_EQ(original.value, irsend->capture.value);
+  }
+  return true;
+}
+
+TEST(TestRawToGeneric, PulseDistance) {
+  IRsendTest irsend(0);
+  irsend.begin();
+  irsend.reset();
+  irsend.sendNEC(0x4BB640BF);
+  generic_signal_t signal;
+  ASSERT_TRUE(rawToGenericLoopBack(&irsend, &signal));
+  EXPECT_EQ(1, signal.sections);
+  EXPECT_EQ(0, signal.headerless);
+  EXPECT_EQ(kNECBits, signal.nbits[0]);
+  const uint8_t expected[4] = {0x4B, 0xB6, 0x40, 0xBF};
+  EXPECT_STATE_EQ(expected, signal.data, kNECBits);
+  EXPECT_NEAR(9000, signal.hdrmark, 50);
+  EXPECT_NEAR(4500, signal.hdrspace, 50);
+  EXPECT_NEAR(560, signal.onemark, 50);
+  EXPECT_NEAR(1690, signal.onespace, 50);
+  EXPECT_NEAR(560, signal.zeromark, 50);
+  EXPECT_NEAR(560, signal.zerospace, 50);
+  EXPECT_NEAR(560, signal.footermark, 50);
+}
+
+TEST(TestRawToGeneric, PulseWidth) {
+  IRsendTest irsend(0);
+  irsend.begin();
+  irsend.reset();
+  irsend.sendSony(0xA90, kSony12Bits, kSonyMinRepeat);
+  generic_signal_t signal;
+  ASSERT_TRUE(rawToGenericLoopBack(&irsend, &signal));
+  // Each repeat is a section, ending with the last bit. i.e. No footer.
+  EXPECT_EQ(kSonyMinRepeat + 1, signal.sections);
+  EXPECT_EQ(kSony12Bits, signal.nbits[0]);
+  EXPECT_EQ(0xA9, signal.data[0]);
+  EXPECT_EQ(0x00, signal.data[1]);
+  EXPECT_NEAR(2400, signal.hdrmark, 50);
+  EXPECT_NEAR(1200, signal.onemark, 50);
+  EXPECT_NEAR(600, signal.zeromark, 50);
+  EXPECT_EQ(signal.zerospace, signal.onespace);
+  EXPECT_EQ(0, signal.footermark);
+}
+
+TEST(TestRawToGeneric, Sections) {
+  IRsendTest irsend(0);
+  irsend.begin();
+  irsend.reset();
+  uint8_t state[kDaikinStateLength];
+  for (uint8_t i = 0; i < kDaikinStateLength; i++) state[i] = i * 37 + 11;
+  irsend.sendDaikin(state);
+  generic_signal_t signal;
+  ASSERT_TRUE(rawToGenericLoopBack(&irsend, &signal));
+  // A leading block of 5 bits without the header, then the 3 frames.
+  EXPECT_EQ(4, signal.sections);
+  EXPECT_EQ(0b0001, signal.headerless);
+  EXPECT_EQ(5, signal.nbits[0]);
+  uint16_t nbits = 0;
+  for (uint8_t i = 1; i < signal.sections; i++) nbits += signal.nbits[i];
+  EXPECT_EQ(kDaikinBits, nbits);
+}
+
+TEST(TestRawToGeneric, NotGeneric) {
+  IRsendTest irsend(0);
+  generic_signal_t signal;
+  irsend.begin();
+  // Manchester encoded.
+  irsend.reset();
+  irsend.sendRC6(0x175);
+  EXPECT_FALSE(rawToGenericLoopBack(&irsend, &signal));
+  // Too short.
+  const uint16_t short_raw[2] = {9000, 4500};
+  EXPECT_FALSE(rawToGeneric(short_raw, 2, &signal));
+  EXPECT_FALSE(rawToGeneric(NULL, 0, &signal));
+}
+
 TEST(TestUtils, TypeStringConversionRangeTests) {
   ASSERT_EQ("UNKNOWN", typeToString((decode_type_t)(kLastDecodeType + 1)));
   ASSERT_EQ("UNKNOWN", typeToString(decode_type_t::UNKNOWN));
@@ -504,6 +653,63 @@ TEST(TestUtils, TypeStringConversionRangeTests) {
   }
 }
 
+TEST(TestUtils, StrToDecodeTypeVariants) {
+  EXPECT_EQ(decode_type_t::NEC, strToDecodeType("nec"));
+  EXPECT_EQ(decode_type_t::DAIKIN312, strToDecodeType("Daikin312"));
+  EXPECT_EQ(decode_type_t::UNKNOWN, strToDecodeType(""));
+  EXPECT_EQ(decode_type_t::UNKNOWN, strToDecodeType("NEC "));
+  EXPECT_EQ(decode_type_t::UNKNOWN, strToDecodeType("UNKNOWN"));
+  // Protocol numbers.
+  EXPECT_EQ(decode_type_t::NEC, strToDecodeType("3"));
+  EXPECT_EQ(kLastDecodeType, strToDecodeType(
+      uint64ToString(kLastDecodeType).c_str()));
+  EXPECT_EQ(decode_type_t::UNKNOWN, strToDecodeType("0"));
+  EXPECT_EQ(decode_type_t::UNKNOWN, strToDecodeType("-1"));
+  EXPECT_EQ(decode_type_t::UNKNOWN, strToDecodeType(
+      uint64ToString(kLastDecodeType + 1).c_str()));
+}
+
+const char *kTestKeys[] = {"Alpha", "beta", "GAMMA", "Beta", "delta", "", "e"};
+
+TEST(TestUtils, StrIndex) {
+  irutils::StrIndex index(
+      [](const uint16_t i) { return kTestKeys[i]; },
+      sizeof(kTestKeys) / sizeof(kTestKeys[0]));
+  // Minimal. i.e. One slot per unique key.
+  EXPECT_NE(nullptr, index._slots);
+  EXPECT_EQ(6, index._size);
+  EXPECT_EQ(0, index.find("alpha"));
+  EXPECT_EQ(1, index.find("BETA"));  // Duplicates resolve to the first.
+  EXPECT_EQ(2, index.find("gamma"));
+  EXPECT_EQ(4, index.find("Delta"));
+  EXPECT_EQ(5, index.find(""));
+  EXPECT_EQ(6, index.find("E"));
+  EXPECT_EQ(-1, index.find("epsilon"));
+  EXPECT_EQ(-1, index.find("alph"));
+  EXPECT_EQ(-1, index.find("alphaa"));
+  // Every slot is used exactly once.
+  for (uint16_t s = 0; s < index._size; s++) {
+    EXPECT_NE(3, index._slots[s]);
+    for (uint16_t t = s + 1; t < index._size; t++)
+      EXPECT_NE(index._slots[s], index._slots[t]);
+  }
+}
+
+TEST(TestUtils, StrIndexLarge) {
+  // More keys than any of the library's tables, so the displacement search
+  // has to stay within its bound for every bucket.
+  static char keys[600][8];
+  for (uint16_t i = 0; i < 600; i++) snprintf(keys[i], 8, "key%u", i);
+  irutils::StrIndex index([](const uint16_t i) {
+      return static_cast<const char *>(keys[i]); }, 600);
+  EXPECT_NE(nullptr, index._slots);
+  EXPECT_EQ(600, index._size);
+  for (uint16_t i = 0; i < 600; i++) ASSERT_EQ(i, index.find(keys[i]));
+  EXPECT_EQ(-1, index.find("key600"));
+  for (uint16_t b = 0; b < index._nbuckets; b++)
+    EXPECT_GT(irutils::kStrIndexMaxDisplacement, index._disp[b]);
+}
+
 TEST(TestUtils, MinsToString) {
   EXPECT_EQ("00:00", irutils::minsToString(0));
   EXPECT_EQ("00:01", irutils::minsToString(1));
@@ -0,0 +1,186 @@
+// Quick and dirty host side simulator of the edge timing of the IRrecv
+// receive interrupt handlers.
+// A square wave of edges is played through a model of the interrupt: an edge
+// is serviced once the interrupt latency has passed & the previous handler
+// has finished. The GPIO has only one pending interrupt, so any further edge
+// arriving before a pending one is serviced is lost.
+//   - The "micros" handler is the normal one. It timestamps with `micros()`,
+//     i.e. to the usec, & stores the difference in ticks.
+//   - The "cycles" handler is the one used by `setCycleCountCapture()`. The
+//     simulation runs its recording code (`IRrecv::_recordCycleCount()`) &
+//     the conversion done by `decode()` on the modelled timestamps.
+// For each pulse width, it reports the edges lost & the worst error of the
+// captured durations (when none were lost).
+//
+// The handler costs are inputs, not measurements. The defaults are rough
+// estimates. Measure the handlers on the real hardware (e.g. with
+// `esp_get_cycle_count()` at their entry & exit) & pass them in.
+//
+// Usage example:
+//   ./edge_timing_simulator [micros handler usecs] [cycles handler usecs]
+//                           [interrupt latency usecs] [CPU MHz]
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <algorithm>
+#include "IRrecv.h"
+#include "IRsend.h"
+#include "IRsend_test.h"
+#include "IRutils.h"
+
+const uint16_t kEdges = 200;  // Nr. of edges in each square wave.
+
+typedef struct {
+  uint16_t lost;       // Nr. of edges that were never serviced.
+  double max_error;    // Worst error of a captured duration. (usecs)
+} sim_result_t;
+
+// Work out when each edge is serviced, given the handler cost & latency.
+// Returns the nr. of edges serviced, with their timestamps in `serviced`.
+uint16_t serviceEdges(const double *edges, const uint16_t count,
+                      const double cost, const double latency,
+                      double *serviced) {
+  uint16_t nr = 0;
+  double free_at = -1e9;   // When the handler is next free.
+  double started = -1e9;   // When the last scheduled handler starts.
+  for (uint16_t i = 0; i < count; i++) {
+    const double arrival = edges[i] + latency;
+    if (arrival >= free_at) {
+      started = arrival;  // Serviced straight away.
+    } else if (arrival < started) {
+      continue;  // The previous edge is still pending, so this one is lost.
+    } else {
+      started = free_at;  // Pending until the handler finishes.
+    }
+    free_at = started + cost;
+    serviced[nr++] = started;
+  }
+  return nr;
+}
+
+// Worst error of the captured durations (in ticks) vs the real ones (usecs).
+double maxError(const uint16_t *captured, const double *edges,
+                const uint16_t count) {
+  double worst = 0;
+  for (uint16_t i = 1; i < count; i++)
+    worst = std::max(worst, fabs(captured[i] * kRawTick -
+                                 (edges[i] - edges[i - 1])));
+  return worst;
+}
+
+sim_result_t simulateMicros(const double *edges, const double cost,
+                            const double latency) {
+  double serviced[kEdges];
+  uint16_t captured[kEdges];
+  sim_result_t result;
+  const uint16_t nr = serviceEdges(edges, kEdges, cost, latency, serviced);
+  result.lost = kEdges - nr;
+  uint32_t start = 0;
+  for (uint16_t i = 0; i < nr; i++) {
+    const uint32_t now = floor(serviced[i]);  // micros()
+    captured[i] = i ? (now - start) / kRawTick : 1;
+    start = now;
+  }
+  result.max_error = result.lost ? NAN : maxError(captured, edges, nr);
+  return result;
+}
+
+sim_result_t simulateCycles(IRrecv *irrecv, const double *edges,
+                            const double cost, const double latency,
+                            const uint16_t mhz) {
+  double serviced[kEdges];
+  uint16_t captured[kEdges];
+  sim_result_t result;
+  const uint16_t nr = serviceEdges(edges, kEdges, cost, latency, serviced);
+  result.lost = kEdges - nr;
+  irrecv->resume();
+  for (uint16_t i = 0; i < nr; i++)
+    irrecv->_recordCycleCount(floor(serviced[i] * mhz));
+  volatile irparams_t *params = irrecv->_getParamsPtr();
+  for (uint16_t i = 0; i < params->rawlen; i++) captured[i] = params->rawbuf[i];
+  decode_results results;
+  results.rawbuf = captured;
+  results.rawlen = params->rawlen;
+  irrecv->_cycleCountsToTicks(&results);
+  result.max_error = result.lost ? NAN : maxError(captured, edges, nr);
+  return result;
+}
+
+// Play a NEC message through the cycle count capture & decode it.
+bool decodesNEC(IRrecv *irrecv, const uint16_t mhz) {
+  IRsendTest irsend(0);
+  irsend.begin();
+  irsend.reset();
+  irsend.sendNEC(0x4BB640BF);
+  irsend.makeDecodeResult();
+  irrecv->resume();
+  double now = 1000;
+  for (uint16_t i = 0; i < irsend.capture.rawlen; i++) {
+    if (i) now += irsend.capture.rawbuf[i] * kRawTick;
+    irrecv->_recordCycleCount(floor(now * mhz));
+  }
+  volatile irparams_t *params = irrecv->_getParamsPtr();
+  decode_results results;
+  results.rawbuf = new uint16_t[params->rawlen + 1];
+  results.rawlen = params->rawlen;
+  for (uint16_t i = 0; i < params->rawlen; i++)
+    results.rawbuf[i] = params->rawbuf[i];
+  results.rawbuf[results.rawlen] = 0;
+  irrecv->_cycleCountsToTicks(&results);
+  // Decode the converted copy without capturing in cycle counts again.
+  irrecv->setCycleCountCapture(false);
+  const bool decoded = irrecv->decode(&results) &&
+      results.decode_type == NEC && results.value == 0x4BB640BF;
+  irrecv->setCycleCountCapture(true);
+  delete[] results.rawbuf;
+  return decoded;
+}
+
+int main(int argc, char *argv[]) {
+  double micros_cost = 6.0;  // usecs. micros(), divide, & os_timer re-arm.
+  double cycles_cost = 1.0;  // usecs. Cycle counter, shift, & timer1 write.
+  double latency = 2.0;      // usecs. Interrupt entry & dispatch.
+  uint16_t mhz = 80;
+  if (argc > 1) micros_cost = atof(argv[1]);
+  if (argc > 2) cycles_cost = atof(argv[2]);
+  if (argc > 3) latency = atof(argv[3]);
+  if (argc > 4) mhz = atoi(argv[4]);
+  if (mhz != 80 && mhz != 160) {
+    printf("CPU MHz must be 80 or 160.\n");
+    return 1;
+  }
+
+  IRrecv irrecv(0, kEdges + 1);
+  irrecv.setCycleCountCapture();
+  irrecv._cycle_count_mhz = mhz;
+  irrecv.enableIRIn();
+
+  printf("Handler cost: micros %.2f usecs, cycles %.2f usecs. "
+         "Latency: %.2f usecs. CPU: %d MHz\n",
+         micros_cost, cycles_cost, latency, mhz);
+  printf("%10s | %21s | %21s\n", "Pulse", "micros handler", "cycles handler");
+  printf("%10s | %6s %14s | %6s %14s\n", "(usecs)", "lost", "max err (us)",
+         "lost", "max err (us)");
+  const double widths[] = {560, 100, 50, 20, 15, 12, 10, 9, 8, 7, 6, 5, 4, 3};
+  double micros_fastest = 0;
+  double cycles_fastest = 0;
+  for (double width : widths) {
+    double edges[kEdges];
+    for (uint16_t i = 0; i < kEdges; i++) edges[i] = 1000 + i * width;
+    sim_result_t by_micros = simulateMicros(edges, micros_cost, latency);
+    sim_result_t by_cycles = simulateCycles(&irrecv, edges, cycles_cost,
+                                            latency, mhz);
+    printf("%10.1f | %6d %14.2f | %6d %14.2f\n", width,
+           by_micros.lost, by_micros.max_error,
+           by_cycles.lost, by_cycles.max_error);
+    if (!by_micros.lost) micros_fastest = width;
+    if (!by_cycles.lost) cycles_fastest = width;
+  }
+  printf("Shortest pulse without lost edges: micros %.1f usecs, "
+         "cycles %.1f usecs\n", micros_fastest, cycles_fastest);
+  const bool decoded = decodesNEC(&irrecv, mhz);
+  printf("NEC message via cycle counts %s\n",
+         decoded ? "decodes" : "does NOT decode");
+  return decoded ? 0 : 1;
+}
@@ -0,0 +1,119 @@
+// Quick and dirty benchmark of the data matching of IRrecv.
+// Compares `matchBytes()`, which calculates the tolerance ranges of the bit
+// timings once per call, with the previous version, which worked out the
+// ranges (in floating point) for every mark & space it compared, on an A/C
+// length message.
+//
+// Usage example:
+//   ./match_data_benchmark [nr. of bytes] [iterations]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include "IRrecv.h"
+#include "IRsend.h"
+#include "IRsend_test.h"
+#include "IRutils.h"
+
+// Daikin style bit timings.
+const uint16_t kHdrMark = 3650;
+const uint32_t kHdrSpace = 1623;
+const uint16_t kBitMark = 428;
+const uint32_t kOneSpace = 1280;
+const uint32_t kZeroSpace = 428;
+const uint32_t kGap = 29000;
+
+// The previous version of `matchData()`.
+match_result_t legacyMatchData(IRrecv *irrecv, volatile uint16_t *data_ptr,
+                               const uint16_t nbits, const uint16_t onemark,
+                               const uint32_t onespace,
+                               const uint16_t zeromark,
+                               const uint32_t zerospace) {
+  match_result_t result;
+  result.success = false;
+  result.data = 0;
+  for (result.used = 0; result.used < nbits * 2;
+       result.used += 2, data_ptr += 2) {
+    if (irrecv->matchMark(*data_ptr, onemark) &&
+        irrecv->matchSpace(*(data_ptr + 1), onespace))
+      result.data = (result.data << 1) | 1;
+    else if (irrecv->matchMark(*data_ptr, zeromark) &&
+             irrecv->matchSpace(*(data_ptr + 1), zerospace))
+      result.data <<= 1;
+    else
+      return result;
+  }
+  result.success = true;
+  return result;
+}
+
+// The previous version of `matchBytes()`.
+uint16_t legacyMatchBytes(IRrecv *irrecv, volatile uint16_t *data_ptr,
+                          uint8_t *result_ptr, const uint16_t nbytes) {
+  uint16_t offset = 0;
+  for (uint16_t byte_pos = 0; byte_pos < nbytes; byte_pos++) {
+    match_result_t result = legacyMatchData(irrecv, data_ptr + offset, 8,
+                                            kBitMark, kOneSpace,
+                                            kBitMark, kZeroSpace);
+    if (!result.success) return 0;
+    result_ptr[byte_pos] = result.data;
+    offset += result.used;
+  }
+  return offset;
+}
+
+int main(int argc, char *argv[]) {
+  uint16_t nbytes = 35;  // e.g. A Daikin message.
+  uint32_t iterations = 20000;
+  if (argc > 1) nbytes = atoi(argv[1]);
+  if (argc > 2) iterations = atoi(argv[2]);
+  if (nbytes < 1 || nbytes > 256 || iterations < 1) {
+    printf("Nr. of bytes must be between 1 and 256, & iterations > 0.\n");
+    return 1;
+  }
+
+  uint8_t *message = new uint8_t[nbytes];
+  for (uint16_t i = 0; i < nbytes; i++) message[i] = i * 37 + 11;
+  IRsendTest irsend(0);
+  irsend.begin();
+  irsend.reset();
+  irsend.sendGeneric(kHdrMark, kHdrSpace, kBitMark, kOneSpace,
+                     kBitMark, kZeroSpace, kBitMark, kGap,
+                     message, nbytes, 38000, true, 0, kDutyDefault);
+  irsend.makeDecodeResult();
+  IRrecv irrecv(0, irsend.capture.rawlen + 1);
+  volatile uint16_t *data_ptr = irsend.capture.rawbuf + kStartOffset + 2;
+
+  uint8_t *legacy = new uint8_t[nbytes];
+  uint8_t *current = new uint8_t[nbytes];
+  uint16_t legacy_used = 0;
+  uint16_t current_used = 0;
+
+  auto start = std::chrono::steady_clock::now();
+  for (uint32_t i = 0; i < iterations; i++)
+    legacy_used = legacyMatchBytes(&irrecv, data_ptr, legacy, nbytes);
+  double legacy_us = std::chrono::duration<double, std::micro>(
+      std::chrono::steady_clock::now() - start).count() / iterations;
+
+  start = std::chrono::steady_clock::now();
+  for (uint32_t i = 0; i < iterations; i++)
+    current_used = irrecv.matchBytes(data_ptr, current,
+                                     irsend.capture.rawlen - kStartOffset - 2,
+                                     nbytes, kBitMark, kOneSpace,
+                                     kBitMark, kZeroSpace);
+  double current_us = std::chrono::duration<double, std::micro>(
+      std::chrono::steady_clock::now() - start).count() / iterations;
+
+  bool same = legacy_used && legacy_used == current_used &&
+      memcmp(legacy, current, nbytes) == 0 &&
+      memcmp(message, current, nbytes) == 0;
+  printf("Message: %d bytes, %d capture entries\n", nbytes, current_used);
+  printf("Per mark/space ranges: %10.2f usecs\n", legacy_us);
+  printf("Per call ranges:       %10.2f usecs\n", current_us);
+  printf("Results are %s\n", same ? "identical" : "DIFFERENT");
+  delete[] message;
+  delete[] legacy;
+  delete[] current;
+  return same ? 0 : 1;
+}
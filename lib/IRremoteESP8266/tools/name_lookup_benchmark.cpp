@@ -0,0 +1,143 @@
+// Quick and dirty benchmark of the protocol name & enum string lookups.
+// Compares `strToDecodeType()` & `typeToString()`, which use a minimal perfect
+// hash & a direct index, with the previous linear searches of
+// `kAllProtocolNamesStr`, for every protocol name & number. Also times the
+// `IRac::strTo*()` conversions over every string they know.
+//
+// Usage example:
+//   ./name_lookup_benchmark [iterations]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <chrono>
+#include <string>
+#include <vector>
+#include "IRac.h"
+#include "IRtext.h"
+#include "IRutils.h"
+
+// The previous linear search version of `strToDecodeType()`.
+decode_type_t linearStrToDecodeType(const char * const str);
+
+// The previous linear search version of `typeToString()`.
+std::string linearTypeToString(const decode_type_t protocol) {
+  if (protocol > kLastDecodeType || protocol == decode_type_t::UNKNOWN)
+    return kUnknownStr;
+  const char *ptr = kAllProtocolNamesStr;
+  for (uint16_t i = 0; i <= protocol && strlen(ptr); i++) {
+    if (i == protocol) return ptr;
+    ptr += strlen(ptr) + 1;
+  }
+  return "";
+}
+
+decode_type_t linearStrToDecodeType(const char * const str) {
+  const char *ptr = kAllProtocolNamesStr;
+  uint16_t length = strlen(ptr);
+  for (uint16_t i = 0; length; i++) {
+    if (!strcasecmp(str, ptr)) return (decode_type_t)i;
+    ptr += length + 1;
+    length = strlen(ptr);
+  }
+  decode_type_t result = linearStrToDecodeType(
+      linearTypeToString((decode_type_t)atoi(str)).c_str());
+  if (result > 0)
+    return result;
+  return decode_type_t::UNKNOWN;
+}
+
+// Time a lookup over all the inputs. Returns nsecs per lookup.
+template <typename F>
+double timeIt(const std::vector<std::string> &inputs, const uint32_t iterations,
+              F lookup) {
+  auto start = std::chrono::steady_clock::now();
+  for (uint32_t n = 0; n < iterations; n++)
+    for (const std::string &input : inputs) lookup(input.c_str());
+  return std::chrono::duration<double, std::nano>(
+      std::chrono::steady_clock::now() - start).count() /
+      (static_cast<double>(iterations) * inputs.size());
+}
+
+int main(int argc, char *argv[]) {
+  uint32_t iterations = 2000;
+  if (argc > 1) iterations = atoi(argv[1]);
+  if (iterations == 0) {
+    printf("Iterations must be > 0.\n");
+    return 1;
+  }
+
+  // Every protocol name, in upper & lower case, & every protocol number.
+  std::vector<std::string> names;
+  std::vector<std::string> numbers;
+  for (int i = 0; i <= kLastDecodeType; i++) {
+    std::string name = linearTypeToString((decode_type_t)i);
+    names.push_back(name);
+    for (char &c : name) c = tolower(c);
+    names.push_back(name);
+    numbers.push_back(std::to_string(i));
+  }
+  names.push_back("NOT_A_PROTOCOL");
+
+  // Both versions have to agree before the timings mean anything.
+  uint16_t mismatches = 0;
+  for (const std::vector<std::string> *inputs : {&names, &numbers})
+    for (const std::string &input : *inputs)
+      if (strToDecodeType(input.c_str()) !=
+          linearStrToDecodeType(input.c_str())) {
+        printf("strToDecodeType(\"%s\") differs\n", input.c_str());
+        mismatches++;
+      }
+  for (int i = -1; i <= kLastDecodeType + 1; i++)
+    if (typeToString((decode_type_t)i) !=
+        linearTypeToString((decode_type_t)i)) {
+      printf("typeToString(%d) differs\n", i);
+      mismatches++;
+    }
+
+  volatile int sink = 0;  // Stop the lookups being optimised away.
+  printf("%d protocols, %u iterations\n", kLastDecodeType + 1, iterations);
+  printf("%-28s %12s %12s\n", "(nsecs per lookup)", "linear", "hashed");
+  printf("%-28s %12.1f %12.1f\n", "strToDecodeType(name)",
+         timeIt(names, iterations, [&](const char *s) {
+           sink += linearStrToDecodeType(s); }),
+         timeIt(names, iterations, [&](const char *s) {
+           sink += strToDecodeType(s); }));
+  printf("%-28s %12.1f %12.1f\n", "strToDecodeType(number)",
+         timeIt(numbers, iterations, [&](const char *s) {
+           sink += linearStrToDecodeType(s); }),
+         timeIt(numbers, iterations, [&](const char *s) {
+           sink += strToDecodeType(s); }));
+  printf("%-28s %12.1f %12.1f\n", "typeToString(protocol)",
+         timeIt(numbers, iterations, [&](const char *s) {
+           sink += linearTypeToString((decode_type_t)atoi(s)).length(); }),
+         timeIt(numbers, iterations, [&](const char *s) {
+           sink += typeToString((decode_type_t)atoi(s)).length(); }));
+
+  // The IRac conversions, over the strings they know & a miss.
+  const std::vector<std::string> modes = {
+      kAutoStr, kAutomaticStr, kOffStr, kStopStr, kCoolStr, kCoolingStr,
+      kHeatStr, kHeatingStr, kDryStr, kDryingStr, kDehumidifyStr, kFanStr,
+      kFanOnlyStr, kFan_OnlyStr, kFanOnlyWithSpaceStr, kFanOnlyNoSpaceStr,
+      "FOOBAR"};
+  const std::vector<std::string> models = {
+      kYaw1fStr, kYbofbStr, kYx1fsfStr, kV9014557AStr, kV9014557BStr,
+      kRlt0541htaaStr, kRlt0541htabStr, kArrah2eStr, kArdb1Str, kArreb1eStr,
+      kArjw2Str, kArry4Str, kArrew4eStr, kGe6711ar2853mStr, kAkb75215403Str,
+      kAkb74955603Str, kAkb73757604Str, kLg6711a20083vStr, kLkeStr,
+      kPanasonicLkeStr, kNkeStr, kPanasonicNkeStr, kDkeStr, kPanasonicDkeStr,
+      kPkrStr, kPanasonicPkrStr, kJkeStr, kPanasonicJkeStr, kCkpStr,
+      kPanasonicCkpStr, kRkrStr, kPanasonicRkrStr, kA907Str, kA705Str,
+      kA903Str, kTac09chsdStr, kGz055be1Str, k122lzfStr, kDg11j13aStr,
+      kDg11j104Str, kDg11j191Str, "FOOBAR"};
+  printf("%-28s %12s %12.1f\n", "IRac::strToOpmode()", "-",
+         timeIt(modes, iterations, [&](const char *s) {
+           sink += static_cast<int>(IRac::strToOpmode(s)); }));
+  printf("%-28s %12s %12.1f\n", "IRac::strToModel()", "-",
+         timeIt(models, iterations, [&](const char *s) {
+           sink += IRac::strToModel(s); }));
+
+  printf("Results are %s\n", mismatches ? "DIFFERENT" : "identical");
+  return mismatches ? 1 : 0;
+}
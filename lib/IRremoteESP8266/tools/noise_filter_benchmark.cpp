@@ -0,0 +1,104 @@
+// Quick and dirty benchmark of the noise filter of IRrecv.
+// Compares the single pass `crudeNoiseFilter()` with the previous version,
+// which shifted the rest of the buffer down for every glitch, on a long &
+// noisy capture.
+//
+// Usage example:
+//   ./noise_filter_benchmark [capture length] [glitch every N entries]
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include "IRrecv.h"
+#include "IRutils.h"
+
+const uint16_t kNoiseFloor = 100;  // usecs
+const uint16_t kIterations = 200;
+
+// The previous O(n^2) implementation.
+void shiftingNoiseFilter(decode_results *results, const uint16_t floor,
+                         const uint16_t bufsize) {
+  const uint16_t kTickFloor = floor / kRawTick;
+  uint16_t offset = kStartOffset;
+  while (offset < results->rawlen && offset + 2 < bufsize) {
+    uint16_t curr = results->rawbuf[offset];
+    uint16_t next = results->rawbuf[offset + 1];
+    uint16_t addition = curr + next;
+    if (curr < kTickFloor) {
+      for (uint16_t i = offset + 2; i <= results->rawlen && i < bufsize; i++)
+        results->rawbuf[i - 2] = results->rawbuf[i];
+      if (offset > 1) results->rawbuf[offset - 1] += addition;
+      results->rawlen -= 2;
+    } else {
+      offset++;
+    }
+  }
+}
+
+uint16_t fillCapture(uint16_t *buf, const uint16_t length,
+                     const uint16_t glitch_every) {
+  buf[0] = 0;
+  for (uint16_t i = kStartOffset; i < length; i++) {
+    if (glitch_every && i % glitch_every == 0 && i % 2)
+      buf[i] = 40 / kRawTick;  // A short mark.
+    else
+      buf[i] = ((i % 2) ? 560 : (i % 3 ? 560 : 1690)) / kRawTick;
+  }
+  buf[length] = 0;
+  return length;
+}
+
+int main(int argc, char *argv[]) {
+  uint16_t length = 1000;
+  uint16_t glitch_every = 3;
+  if (argc > 1) length = atoi(argv[1]);
+  if (argc > 2) glitch_every = atoi(argv[2]);
+  if (length < 3 || length > 60000) {
+    printf("Capture length must be between 3 and 60000.\n");
+    return 1;
+  }
+
+  IRrecv irrecv(0, length + 1);
+  uint16_t *original = new uint16_t[length + 1];
+  uint16_t *expected = new uint16_t[length + 1];
+  uint16_t *actual = new uint16_t[length + 1];
+  fillCapture(original, length, glitch_every);
+  decode_results results;
+  uint16_t expected_len = 0;
+  uint16_t actual_len = 0;
+
+  auto start = std::chrono::steady_clock::now();
+  for (uint16_t i = 0; i < kIterations; i++) {
+    memcpy(expected, original, (length + 1) * sizeof(uint16_t));
+    results.rawbuf = expected;
+    results.rawlen = length;
+    shiftingNoiseFilter(&results, kNoiseFloor, length + 1);
+    expected_len = results.rawlen;
+  }
+  double shifting_us = std::chrono::duration<double, std::micro>(
+      std::chrono::steady_clock::now() - start).count() / kIterations;
+
+  start = std::chrono::steady_clock::now();
+  for (uint16_t i = 0; i < kIterations; i++) {
+    memcpy(actual, original, (length + 1) * sizeof(uint16_t));
+    results.rawbuf = actual;
+    results.rawlen = length;
+    irrecv.crudeNoiseFilter(&results, kNoiseFloor);
+    actual_len = results.rawlen;
+  }
+  double single_pass_us = std::chrono::duration<double, std::micro>(
+      std::chrono::steady_clock::now() - start).count() / kIterations;
+
+  bool same = expected_len == actual_len &&
+      memcmp(expected, actual, (actual_len + 1) * sizeof(uint16_t)) == 0;
+  printf("Capture: %d entries, %d after filtering\n", length, actual_len);
+  printf("Shifting:    %10.2f usecs\n", shifting_us);
+  printf("Single pass: %10.2f usecs\n", single_pass_us);
+  printf("Results are %s\n", same ? "identical" : "DIFFERENT");
+  delete[] original;
+  delete[] expected;
+  delete[] actual;
+  return same ? 0 : 1;
+}
@@ -0,0 +1,493 @@
+/**
+ * @file archive.cpp
+ *
+ * @author Marc Ubbelohde
+ *
+ * @brief In this file, the export and import of the whole signal and program library is defined.
+ *
+ * @details All signals and programs are packed into one binary archive so they can be moved
+ * from one device to another without recording every signal again. The archive is written
+ * straight from the LittleFS to the client and read back in the chunks the webserver hands
+ * over, so the whole library is never held in RAM.
+ *
+ * Format of the archive (all numbers little endian):\n
+ * "IRLA" + version (1 byte)\n
+ * for every file: kind ('S' or 'P', 1 byte) + name length (1 byte) + name + data length (4 bytes) + data\n
+ * 'E' (1 byte) to mark the end of the archive
+ */
+
+#include "base.h"
+
+/**
+ * @brief Size of the buffer that is used to copy files to the client.
+ *
+ */
+const size_t ARCHIVE_CHUNK_SIZE = 256;
+
+/**
+ * @brief Magic bytes and version that every archive starts with.
+ *
+ */
+const uint8_t ARCHIVE_HEADER[5] = {'I', 'R', 'L', 'A', 1};
+
+/**
+ * @brief Maximum length of a signal or program name (same limit as in save_signal()).
+ *
+ */
+const uint8_t ARCHIVE_MAX_NAME_LENGTH = 21;
+
+/**
+ * @brief File the data of an entry is written to before it replaces the old file.
+ *
+ * @details Kept outside of /signals and /programs, so a file left behind by a reset during the
+ * import is never listed or exported as a signal or program.
+ *
+ */
+const char ARCHIVE_TEMP_FILE[] = "/import.tmp";
+
+/**
+ * @brief Stages of the import state machine.
+ *
+ */
+enum archive_stage {
+  ARCHIVE_HEADER_STAGE,
+  ARCHIVE_KIND_STAGE,
+  ARCHIVE_NAME_LENGTH_STAGE,
+  ARCHIVE_NAME_STAGE,
+  ARCHIVE_DATA_LENGTH_STAGE,
+  ARCHIVE_DATA_STAGE,
+  ARCHIVE_DONE_STAGE,
+  ARCHIVE_ERROR_STAGE
+};
+
+/**
+ * @brief Holds the state of the running import between two chunks of the upload.
+ *
+ */
+struct archive_import_state {
+  archive_stage stage;
+  uint8_t position;
+  uint8_t kind;
+  uint8_t name_length;
+  char name[ARCHIVE_MAX_NAME_LENGTH + 1];
+  uint32_t data_length;
+  uint32_t data_written;
+  File file;
+  uint16_t signals;
+  uint16_t programs;
+  String error;
+  action_status status;
+};
+
+archive_import_state IMPORT;
+
+/**
+ * @brief Returns the file extension that belongs to the kind of an archive entry.
+ *
+ * @param kind - 'S' for signals, 'P' for programs
+ *
+ * @return String - ".json" or ".txt"
+ *
+ * @callgraph This function does not call any other function.
+ *
+ * @callergraph
+ */
+String archive_extension(uint8_t kind) {
+  if (kind == 'S') {
+    return(".json");
+  }
+  return(".txt");
+}
+
+/**
+ * @brief Returns the folder that belongs to the kind of an archive entry.
+ *
+ * @param kind - 'S' for signals, 'P' for programs
+ *
+ * @return String - "/signals/" or "/programs/"
+ *
+ * @callgraph This function does not call any other function.
+ *
+ * @callergraph
+ */
+String archive_folder(uint8_t kind) {
+  if (kind == 'S') {
+    return("/signals/");
+  }
+  return("/programs/");
+}
+
+/**
+ * @brief Writes a 32 bit number in little endian to the output.
+ *
+ * @param output - stream the number is written to
+ *
+ * @param value - number to be written
+ *
+ * @return size_t - number of bytes that were written
+ *
+ * @callgraph This function does not call any other function.
+ *
+ * @callergraph
+ */
+size_t write_archive_length(Print &output, uint32_t value) {
+  uint8_t bytes[4] = {(uint8_t)value, (uint8_t)(value >> 8), (uint8_t)(value >> 16), (uint8_t)(value >> 24)};
+  return output.write(bytes, 4);
+}
+
+/**
+ * @brief Calculates the size of the archive that write_archive() would produce.
+ *
+ * @param folder_signals - name of the folder containing the signals
+ *
+ * @param folder_programs - name of the folder containing the programs
+ *
+ * @return size_t - size of the archive in bytes
+ *
+ * @details The size is sent as Content-Length before the archive is streamed. It is
+ * calculated from the directory entries only, no file is opened.
+ *
+ * @callgraph This function does not call any other function.
+ *
+ * @callergraph
+ */
+size_t get_archive_size(String folder_signals, String folder_programs) {
+
+  // header and end marker
+  size_t size = sizeof(ARCHIVE_HEADER) + 1;
+
+  LittleFS.begin();
+
+  String folders[2] = {folder_signals, folder_programs};
+  unsigned int extension_lengths[2] = {5, 4};
+
+  for (int i = 0; i < 2; i++) {
+    Dir dir = LittleFS.openDir(folders[i]);
+    while (dir.next()) {
+      // kind, name length, name, data length, data
+      size += 1 + 1 + dir.fileName().length() - extension_lengths[i] + 4 + dir.fileSize();
+    }
+  }
+
+  LittleFS.end();
+  return size;
+}
+
+/**
+ * @brief Writes all signals and programs as one archive to the output.
+ *
+ * @param output - stream the archive is written to (e.g. the client of the webserver or a file)
+ *
+ * @param folder_signals - name of the folder containing the signals
+ *
+ * @param folder_programs - name of the folder containing the programs
+ *
+ * @return size_t - number of bytes that were written
+ *
+ * @details Every file is copied in chunks of ARCHIVE_CHUNK_SIZE bytes, so the memory usage
+ * does not depend on the size of the library. If a file can not be opened its data is
+ * replaced by zeros to keep the size calculated by get_archive_size() valid.
+ *
+ * @callgraph
+ *
+ * @callergraph
+ */
+size_t write_archive(Print &output, String folder_signals, String folder_programs) {
+
+  uint8_t buffer[ARCHIVE_CHUNK_SIZE];
+  size_t written = output.write(ARCHIVE_HEADER, sizeof(ARCHIVE_HEADER));
+
+  LittleFS.begin();
+
+  String folders[2] = {folder_signals, folder_programs};
+  uint8_t kinds[2] = {'S', 'P'};
+  unsigned int extension_lengths[2] = {5, 4};
+
+  for (int i = 0; i < 2; i++) {
+    Dir dir = LittleFS.openDir(folders[i]);
+    while (dir.next()) {
+      String filename = dir.fileName();
+      String name = filename.substring(0, filename.length() - extension_lengths[i]);
+      uint32_t length = dir.fileSize();
+
+      // entry header
+      uint8_t entry[2] = {kinds[i], (uint8_t)name.length()};
+      written += output.write(entry, 2);
+      written += output.write((const uint8_t *)name.c_str(), name.length());
+      written += write_archive_length(output, length);
+
+      // entry data
+      File file = LittleFS.open(folders[i] + "/" + filename, "r");
+      uint32_t remaining = length;
+      while (remaining > 0) {
+        size_t chunk = remaining < ARCHIVE_CHUNK_SIZE ? remaining : ARCHIVE_CHUNK_SIZE;
+        size_t read = 0;
+        if (file) {
+          read = file.read(buffer, chunk);
+        }
+        // pad with zeros if the file is shorter than announced
+        if (read < chunk) {
+          memset(buffer + read, 0, chunk - read);
+        }
+        written += output.write(buffer, chunk);
+        remaining -= chunk;
+        yield();
+      }
+      file.close();
+    }
+  }
+
+  LittleFS.end();
+
+  uint8_t end = 'E';
+  written += output.write(&end, 1);
+  return written;
+}
+
+/**
+ * @brief Aborts the running import with an error message.
+ *
+ * @param error - message that is returned by import_archive_end()
+ *
+ * @param status - status of the import (ACTION_INVALID for a broken archive, ACTION_FAILED if the
+ * filesystem failed, ACTION_BUSY if a job is running)
+ *
+ * @details The file of the entry that was written at that moment is removed, all
+ * entries that were completed before stay saved.
+ *
+ * @callgraph This function does not call any other function.
+ *
+ * @callergraph
+ */
+void import_archive_fail(String error, action_status status) {
+  if (IMPORT.file) {
+    IMPORT.file.close();
+    LittleFS.remove(ARCHIVE_TEMP_FILE);
+  }
+  IMPORT.error = error;
+  IMPORT.status = status;
+  IMPORT.stage = ARCHIVE_ERROR_STAGE;
+}
+
+/**
+ * @brief Starts a new import.
+ *
+ * @details Has to be called before the first chunk is passed to import_archive_chunk().
+ * LittleFS stays mounted until import_archive_end() is called. A temporary file that was left
+ * behind by a reset during an earlier import is removed.
+ *
+ * @callgraph This function does not call any other function.
+ *
+ * @callergraph
+ */
+void import_archive_begin() {
+  if (IMPORT.file) {
+    IMPORT.file.close();
+  }
+  IMPORT.stage = ARCHIVE_HEADER_STAGE;
+  IMPORT.position = 0;
+  IMPORT.signals = 0;
+  IMPORT.programs = 0;
+  IMPORT.error = "";
+  IMPORT.status = ACTION_OK;
+  LittleFS.begin();
+  LittleFS.remove(ARCHIVE_TEMP_FILE);
+}
+
+/**
+ * @brief Opens the temporary file for the entry whose header was just read.
+ *
+ * @callgraph
+ *
+ * @callergraph
+ */
+void import_archive_open_entry() {
+
+  IMPORT.name[IMPORT.name_length] = '\0';
+  String name = IMPORT.name;
+
+  if (check_if_string_is_alphanumeric(name) == false) {
+    import_archive_fail("Error: invalid name in archive: " + name, ACTION_INVALID);
+    return;
+  }
+
+  // check if the entry fits into the filesystem
+  FSInfo fs_info;
+  LittleFS.info(fs_info);
+  if (IMPORT.data_length > fs_info.totalBytes - fs_info.usedBytes) {
+    import_archive_fail("Error: not enough space for " + name, ACTION_FAILED);
+    return;
+  }
+
+  // data is written to a temporary file first so a broken upload does not destroy the old file
+  IMPORT.file = LittleFS.open(ARCHIVE_TEMP_FILE, "w");
+  if (!IMPORT.file) {
+    import_archive_fail("Error: failed to create file for " + name, ACTION_FAILED);
+    return;
+  }
+  IMPORT.data_written = 0;
+  IMPORT.stage = ARCHIVE_DATA_STAGE;
+}
+
+/**
+ * @brief Replaces the old file with the temporary file of the completed entry.
+ *
+ * @details The rename replaces the old file in one step, so a reset keeps either the old or the
+ * new file.
+ *
+ * @callgraph This function does not call any other function.
+ *
+ * @callergraph
+ */
+void import_archive_close_entry() {
+  IMPORT.file.close();
+
+  String filename = archive_folder(IMPORT.kind) + String(IMPORT.name) + archive_extension(IMPORT.kind);
+  if (LittleFS.rename(ARCHIVE_TEMP_FILE, filename) == false) {
+    LOG_ERROR("import: Failed to replace file: %s", filename.c_str());
+    LittleFS.remove(ARCHIVE_TEMP_FILE);
+  }
+  else if (IMPORT.kind == 'S') {
+    IMPORT.signals++;
+  }
+  else {
+    IMPORT.programs++;
+  }
+  IMPORT.stage = ARCHIVE_KIND_STAGE;
+}
+
+/**
+ * @brief Processes the next chunk of an uploaded archive.
+ *
+ * @param data - pointer to the received bytes
+ *
+ * @param length - number of received bytes
+ *
+ * @details The chunk is parsed byte by byte by a small state machine. Data of an entry
+ * is written directly to the LittleFS, so only the current chunk is held in RAM.
+ * Chunks can be split at any position of the archive.
+ *
+ * @callgraph
+ *
+ * @callergraph
+ */
+void import_archive_chunk(const uint8_t *data, size_t length) {
+
+  size_t i = 0;
+  while (i < length) {
+    switch (IMPORT.stage) {
+
+      case ARCHIVE_HEADER_STAGE:
+        if (data[i] != ARCHIVE_HEADER[IMPORT.position]) {
+          import_archive_fail("Error: file is not a valid archive", ACTION_INVALID);
+          return;
+        }
+        IMPORT.position++;
+        i++;
+        if (IMPORT.position == sizeof(ARCHIVE_HEADER)) {
+          IMPORT.stage = ARCHIVE_KIND_STAGE;
+        }
+        break;
+
+      case ARCHIVE_KIND_STAGE:
+        IMPORT.kind = data[i];
+        i++;
+        if (IMPORT.kind == 'E') {
+          IMPORT.stage = ARCHIVE_DONE_STAGE;
+        }
+        else if (IMPORT.kind == 'S' || IMPORT.kind == 'P') {
+          IMPORT.stage = ARCHIVE_NAME_LENGTH_STAGE;
+        }
+        else {
+          import_archive_fail("Error: unknown entry in archive", ACTION_INVALID);
+          return;
+        }
+        break;
+
+      case ARCHIVE_NAME_LENGTH_STAGE:
+        IMPORT.name_length = data[i];
+        i++;
+        if (IMPORT.name_length == 0 || IMPORT.name_length > ARCHIVE_MAX_NAME_LENGTH) {
+          import_archive_fail("Error: invalid name length in archive", ACTION_INVALID);
+          return;
+        }
+        IMPORT.position = 0;
+        IMPORT.stage = ARCHIVE_NAME_STAGE;
+        break;
+
+      case ARCHIVE_NAME_STAGE:
+        IMPORT.name[IMPORT.position] = data[i];
+        IMPORT.position++;
+        i++;
+        if (IMPORT.position == IMPORT.name_length) {
+          IMPORT.position = 0;
+          IMPORT.data_length = 0;
+          IMPORT.stage = ARCHIVE_DATA_LENGTH_STAGE;
+        }
+        break;
+
+      case ARCHIVE_DATA_LENGTH_STAGE:
+        IMPORT.data_length |= (uint32_t)data[i] << (8 * IMPORT.position);
+        IMPORT.position++;
+        i++;
+        if (IMPORT.position == 4) {
+          import_archive_open_entry();
+          // empty entries are completed immediately
+          if (IMPORT.stage == ARCHIVE_DATA_STAGE && IMPORT.data_length == 0) {
+            import_archive_close_entry();
+          }
+        }
+        break;
+
+      case ARCHIVE_DATA_STAGE: {
+        // write as much of the entry as this chunk contains at once
+        size_t chunk = length - i;
+        if (chunk > IMPORT.data_length - IMPORT.data_written) {
+          chunk = IMPORT.data_length - IMPORT.data_written;
+        }
+        if (IMPORT.file.write(data + i, chunk) != chunk) {
+          import_archive_fail("Error: failed to write " + String(IMPORT.name), ACTION_FAILED);
+          return;
+        }
+        IMPORT.data_written += chunk;
+        i += chunk;
+        if (IMPORT.data_written == IMPORT.data_length) {
+          import_archive_close_entry();
+        }
+        break;
+      }
+
+      // bytes after the end marker or after an error are ignored
+      case ARCHIVE_DONE_STAGE:
+      case ARCHIVE_ERROR_STAGE:
+        return;
+    }
+  }
+}
+
+/**
+ * @brief Finishes the import.
+ *
+ * @param status - set to the status of the import
+ *
+ * @return String - "successfully imported ..." if the archive was complete\n
+ *                  "Error: ..." if the archive was invalid or incomplete
+ *
+ * @callgraph
+ *
+ * @callergraph
+ */
+String import_archive_end(action_status &status) {
+
+  if (IMPORT.stage != ARCHIVE_DONE_STAGE && IMPORT.stage != ARCHIVE_ERROR_STAGE) {
+    import_archive_fail("Error: archive is incomplete", ACTION_INVALID);
+  }
+  LittleFS.end();
+
+  status = IMPORT.status;
+  if (IMPORT.stage == ARCHIVE_ERROR_STAGE) {
+    return(IMPORT.error);
+  }
+
+  return("successfully imported " + String(IMPORT.signals) + " signals and " + String(IMPORT.programs) + " programs");
+}
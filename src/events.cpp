@@ -0,0 +1,405 @@
+/**
+ * @file events.cpp
+ *
+ * @author Marc Ubbelohde
+ *
+ * @brief In this file, the event stream (/api/events) is defined.
+ *
+ * @details After every action the website redirected to / and then asked /error for the global
+ * MESSAGE, which was overwritten by concurrent actions, and a long program showed nothing until it
+ * finished. Now subsystems publish events (action results, job progress, capture state, learning
+ * progress and the clock) into a fixed ring of EVENT_RING_SIZE events. The background work
+ * (update_events()) writes the events every client has not seen yet, but only whole events and
+ * only as much as fits into the send buffer of the client without waiting. A client that falls
+ * more than the ring behind misses the oldest events, so the memory of the stream never grows.
+ */
+
+#include "base.h"
+
+/**
+ * @brief Ring of the last events (event id i is at i % EVENT_RING_SIZE).
+ *
+ */
+event EVENT_RING[EVENT_RING_SIZE];
+
+/**
+ * @brief Id of the next event (ids start at 1, 0 means no event).
+ *
+ */
+uint32_t EVENT_NEXT_ID = 1;
+
+/**
+ * @brief Names of the event types in the stream (same order as event_type).
+ *
+ */
+const char *const EVENT_NAMES[EVENT_TYPE_COUNT] = {"message", "job", "capture", "learn", "clock"};
+
+/**
+ * @brief Client of the event stream.
+ *
+ */
+struct event_client {
+  WiFiClient client;
+  boolean active;
+  uint32_t next_id;
+};
+
+/**
+ * @brief Connected clients.
+ *
+ */
+event_client EVENT_CLIENTS[EVENT_MAX_CLIENTS];
+
+/**
+ * @brief Time of the last clock event (millis()).
+ *
+ */
+unsigned long EVENT_LAST_CLOCK = 0;
+
+/**
+ * @brief Adds an event to the ring.
+ *
+ * @param type - type of the event
+ *
+ * @param format - printf format of the JSON data (in flash, see PSTR())
+ *
+ * @details Overwrites the oldest event once the ring is full. Data longer than EVENT_DATA_LENGTH
+ * is cut, so only publish data with a known maximum length.
+ *
+ * @callgraph This function does not call any other function.
+ *
+ * @callergraph
+ */
+void publish_event(event_type type, const char *format, ...) {
+  event &item = EVENT_RING[EVENT_NEXT_ID % EVENT_RING_SIZE];
+
+  va_list arguments;
+  va_start(arguments, format);
+  int length = vsnprintf_P(item.data, EVENT_DATA_LENGTH, format, arguments);
+  va_end(arguments);
+  if (length < 0) {
+    strcpy(item.data, "{}");
+  }
+
+  item.id = EVENT_NEXT_ID;
+  item.type = type;
+  EVENT_NEXT_ID++;
+}
+
+/**
+ * @brief Publishes a message for the website (e.g. the result of an action).
+ *
+ * @param message - message, characters that are not allowed in a JSON string are escaped
+ *
+ * @details The data is {"message":"..."}, long messages are cut.
+ *
+ * @callgraph
+ *
+ * @callergraph
+ */
+void publish_message(const String &message) {
+  char text[EVENT_DATA_LENGTH];
+  size_t length = 0;
+
+  // leave room for the escape, the end of the JSON ("}) and the terminating zero
+  for (size_t i = 0; i < message.length() && length + 2 < EVENT_DATA_LENGTH - 16; i++) {
+    char c = message[i];
+    if (c == '"' || c == '\\') {
+      text[length++] = '\\';
+    }
+    else if ((uint8_t)c < 0x20) {
+      c = ' ';
+    }
+    text[length++] = c;
+  }
+  text[length] = '\0';
+
+  publish_event(EVENT_MESSAGE, PSTR("{\"message\":\"%s\"}"), text);
+}
+
+/**
+ * @brief Returns the id of the last event.
+ *
+ * @return uint32_t - id of the last event (0 if none was published)
+ *
+ * @callgraph This function does not call any other function.
+ *
+ * @callergraph
+ */
+uint32_t get_last_event_id() {
+  return EVENT_NEXT_ID - 1;
+}
+
+/**
+ * @brief Looks up an event in the ring.
+ *
+ * @param id - id of the event
+ *
+ * @param result - the event if it is still in the ring
+ *
+ * @return boolean - true if the event is still in the ring, false if it was overwritten or not published yet
+ *
+ * @callgraph This function does not call any other function.
+ *
+ * @callergraph
+ */
+boolean get_event(uint32_t id, event &result) {
+  if (id == 0 || id >= EVENT_NEXT_ID || EVENT_NEXT_ID - id > EVENT_RING_SIZE) {
+    return false;
+  }
+  result = EVENT_RING[id % EVENT_RING_SIZE];
+  return true;
+}
+
+/**
+ * @brief Prints an event in the Server-Sent Events format.
+ *
+ * @param item - event
+ *
+ * @param output - Print to write to (e.g. the WiFiClient or a metrics_byte_counter)
+ *
+ * @return size_t - number of bytes written
+ *
+ * @details Format: "id: 12\nevent: job\ndata: {...}\n\n"
+ *
+ * @callgraph This function does not call any other function.
+ *
+ * @callergraph
+ */
+size_t print_event(const event &item, Print &output) {
+  size_t written = 0;
+  written += output.print("id: ");
+  written += output.print(item.id);
+  written += output.print("\nevent: ");
+  written += output.print(EVENT_NAMES[item.type]);
+  written += output.print("\ndata: ");
+  written += output.print(item.data);
+  written += output.print("\n\n");
+  return written;
+}
+
+/**
+ * @brief Prints the events a client has not seen yet, as far as they fit.
+ *
+ * @param next_id - id of the first event the client has not seen, is moved past the printed events
+ *
+ * @param output - Print to write to
+ *
+ * @param room - number of bytes that can be written without waiting
+ *
+ * @return size_t - number of bytes written
+ *
+ * @details Only whole events are printed. If events of the client were already overwritten it
+ * continues with the oldest event in the ring.
+ *
+ * @callgraph
+ *
+ * @callergraph
+ */
+size_t print_events(uint32_t &next_id, Print &output, size_t room) {
+  uint32_t oldest = EVENT_NEXT_ID > EVENT_RING_SIZE ? EVENT_NEXT_ID - EVENT_RING_SIZE : 1;
+  if (next_id < oldest) {
+    next_id = oldest;
+  }
+
+  size_t written = 0;
+  while (next_id < EVENT_NEXT_ID) {
+    const event &item = EVENT_RING[next_id % EVENT_RING_SIZE];
+
+    metrics_byte_counter counter;
+    print_event(item, counter);
+    if (counter.count > room - written) {
+      break;
+    }
+
+    written += print_event(item, output);
+    next_id++;
+  }
+  return written;
+}
+
+/**
+ * @brief Prints an event as JSON object.
+ *
+ * @param item - event
+ *
+ * @param output - Print to write to
+ *
+ * @return size_t - number of bytes written
+ *
+ * @details Format: {"id":12,"event":"job","data":{...}}
+ *
+ * @callgraph This function does not call any other function.
+ *
+ * @callergraph
+ */
+size_t print_event_json(const event &item, Print &output) {
+  size_t written = 0;
+  written += output.print("{\"id\":");
+  written += output.print(item.id);
+  written += output.print(",\"event\":\"");
+  written += output.print(EVENT_NAMES[item.type]);
+  written += output.print("\",\"data\":");
+  written += output.print(item.data);
+  written += output.print("}");
+  return written;
+}
+
+/**
+ * @brief Prints the events a client has not seen yet as JSON array, as far as they fit.
+ *
+ * @param next_id - id of the first event the client has not seen, is moved past the printed events
+ *
+ * @param output - Print to write to
+ *
+ * @param room - number of bytes that can be written (including the brackets)
+ *
+ * @return size_t - number of bytes written (0 if there is no event or the first one does not fit)
+ *
+ * @details Used to publish the events in batches (see mqtt.cpp). Format:
+ * [{"id":12,"event":"job","data":{...}},...]
+ *
+ * @callgraph
+ *
+ * @callergraph
+ */
+size_t print_events_json(uint32_t &next_id, Print &output, size_t room) {
+  uint32_t oldest = EVENT_NEXT_ID > EVENT_RING_SIZE ? EVENT_NEXT_ID - EVENT_RING_SIZE : 1;
+  if (next_id < oldest) {
+    next_id = oldest;
+  }
+
+  size_t written = 0;
+  while (next_id < EVENT_NEXT_ID) {
+    const event &item = EVENT_RING[next_id % EVENT_RING_SIZE];
+
+    // leave room for the "]" at the end
+    metrics_byte_counter counter;
+    print_event_json(item, counter);
+    if (written + 1 + counter.count + 1 > room) {
+      break;
+    }
+
+    written += output.print(written == 0 ? "[" : ",");
+    written += print_event_json(item, output);
+    next_id++;
+  }
+
+  if (written > 0) {
+    written += output.print("]");
+  }
+  return written;
+}
+
+/**
+ * @brief Deletes all events (the ids go on).
+ *
+ * @callgraph This function does not call any other function.
+ *
+ * @callergraph
+ */
+void reset_events() {
+  for (uint8_t i = 0; i < EVENT_RING_SIZE; i++) {
+    EVENT_RING[i].id = 0;
+  }
+  EVENT_NEXT_ID += EVENT_RING_SIZE;
+}
+
+/**
+ * @brief Returns the first event a (re)connecting client gets.
+ *
+ * @param last_id - id of the last event the client has seen (0 if none)
+ *
+ * @return uint32_t - id of the first event to write to the client
+ *
+ * @details A client that reconnects continues after its last event. A new client, or one whose
+ * last id is not from this boot (after a reset the ids start over, so it can be higher than any
+ * id that was handed out), starts with the last message that is still in the ring, so the website
+ * shows the result of the action that redirected it.
+ *
+ * @callgraph
+ *
+ * @callergraph
+ */
+uint32_t get_event_resume_id(uint32_t last_id) {
+  if (last_id != 0 && last_id < EVENT_NEXT_ID) {
+    return last_id + 1;
+  }
+
+  event item;
+  for (uint32_t id = get_last_event_id(); get_event(id, item); id--) {
+    if (item.type == EVENT_MESSAGE) {
+      return id;
+    }
+  }
+  return EVENT_NEXT_ID;
+}
+
+/**
+ * @brief Adds a client to the event stream.
+ *
+ * @param client - client of the request to /api/events (the response header has to be sent by the caller)
+ *
+ * @param last_id - id of the last event the client has seen (Last-Event-ID header when it reconnects, 0 if none)
+ *
+ * @return boolean - true if the client was added, false if EVENT_MAX_CLIENTS are connected
+ *
+ * @details The first event the client gets is chosen by get_event_resume_id().
+ *
+ * @callgraph
+ *
+ * @callergraph
+ */
+boolean add_event_client(WiFiClient &client, uint32_t last_id) {
+  for (uint8_t i = 0; i < EVENT_MAX_CLIENTS; i++) {
+    event_client &slot = EVENT_CLIENTS[i];
+    if (slot.active && slot.client.connected()) {
+      continue;
+    }
+
+    slot.client = client;
+    slot.client.setNoDelay(true);
+    slot.active = true;
+    slot.next_id = get_event_resume_id(last_id);
+    return true;
+  }
+  return false;
+}
+
+/**
+ * @brief Writes the events to the clients.
+ *
+ * @details Called from the background work. Every client only gets as much as fits into its send
+ * buffer, clients that disconnected are removed. While a client is connected the clock is published
+ * every EVENT_CLOCK_INTERVAL, which also keeps the connection alive.
+ *
+ * @callgraph
+ *
+ * @callergraph
+ */
+void update_events() {
+  boolean connected = false;
+
+  for (uint8_t i = 0; i < EVENT_MAX_CLIENTS; i++) {
+    event_client &slot = EVENT_CLIENTS[i];
+    if (slot.active == false) {
+      continue;
+    }
+    if (slot.client.connected() == false) {
+      slot.client.stop();
+      slot.active = false;
+      continue;
+    }
+    connected = true;
+
+    int room = slot.client.availableForWrite();
+    if (room > 0) {
+      print_events(slot.next_id, slot.client, room);
+    }
+  }
+
+  if (connected && millis() - EVENT_LAST_CLOCK >= EVENT_CLOCK_INTERVAL) {
+    EVENT_LAST_CLOCK = millis();
+    publish_event(EVENT_CLOCK, PSTR("{\"time\":\"%s\"}"), get_current_time().c_str());
+  }
+}
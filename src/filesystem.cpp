@@ -19,7 +19,8 @@
  * 
  * @return String - String containing the captured signal in the format:\n
  *                  "uint16_t rawData[67] = {1234, 5678, ...};" - if signal was receiver, format defined by resultToSourceCode() in IRremoteESP8266/src/IRutils.cpp\n 
- *                  "no_signal" - if no signal was captured
+ *                  "no_signal" - if no signal was captured\n
+ *                  "canceled" - if the running job was canceled (button or /api/jobs/{id}/cancel)
  * 
  * @details This function uses the IRremoteESP8266 library and is based on the IRrecvDumpV2 example from the library.
  * 
@@ -28,53 +29,197 @@
  * @callergraph
  */
 String capture_signal(){
+  return(receive_signal(NULL));
+}
 
-  // set the GPIOs for the IR-Receiver and output LED
-  int receive_pin = 14;
-  int led_pin = 5;
-  pinMode(led_pin, OUTPUT);
+/**
+ * @brief This function captures a signal and saves it.
+ * 
+ * @param name - name of the signal
+ * 
+ * @return String - "success" - if the signal was captured and saved\n
+ *                  "no_signal" - if no signal was captured\n
+ *                  "canceled" - if the running job was canceled (button or /api/jobs/{id}/cancel)\n
+ *                  "Error: ..." - if the signal could not be saved (see save_capture())
+ * 
+ * @details Unlike capture_signal() followed by save_signal(), the capture is saved straight from
+ * the decoded results without building and parsing its source code String.
+ * 
+ * @callgraph
+ * 
+ * @callergraph
+ */
+String capture_signal(String name){
+  return(receive_signal(&name));
+}
 
-  // set the parameters for the IR-Receiver
-  int capture_buffer_size = 1024;
-  int timeout_sequence = 50;
-  int min_unknown_size = 12;
-  int tolerance_percentage = kTolerance;  // 25%
+/**
+ * @brief Waits up to 10 s for a signal and returns or saves it.
+ * 
+ * @param name - name the signal is saved under, NULL to return it as source code instead
+ * 
+ * @return String - see capture_signal()
+ * 
+ * @details The results point into the capture pool of the receiver, so they are used before
+ * anything else can start it again.
+ * 
+ * @callgraph
+ * 
+ * @callergraph
+ */
+String receive_signal(const String *name){
+  metrics_scope scope(METRICS_CAPTURE);
+  TRACE_SPAN("capture_signal");
 
-  // initialize the IR-Receiver and results
-  IRrecv irrecv(receive_pin, capture_buffer_size, timeout_sequence, true);
+  // start the IR-Receiver and initialize the results
+  IRrecv *irrecv = start_receiver();
   decode_results results;
 
-  // Ignore messages with less than minimum on or off pulses
-  irrecv.setUnknownThreshold(min_unknown_size);
-  irrecv.setTolerance(tolerance_percentage);  
-  irrecv.enableIRIn();
-
   // initilize the 10s timer
   unsigned long start_time = millis();
   unsigned long timestamp = millis() - start_time;
 
   // turn on the LED to signalize the user that the capture process has started
-  digitalWrite(led_pin, HIGH);
-  
+  led_state previous_led_state = led_set_state(LED_CAPTURING);
+  publish_event(EVENT_CAPTURE, PSTR("{\"state\":\"waiting\"}"));
 
   // 10s timer (works also if overflow occurs)
+  String captured = "no_signal";
   while(timestamp < 10000){
+    // capture was canceled by the user:
+    if (job_cancelled()){
+      captured = "canceled";
+      break;
+    }
     // signal was captured:
-    if (irrecv.decode(&results)){
-      if (results.overflow == false){
-        // blink the LED to signalize the user that the capture process has finished
-        control_led_output("signal_received");
-        // return the captured signal as a String
-        return(resultToSourceCode(&results));
+    if (irrecv->decode(&results) && results.overflow == false){
+      // log the capture for debugging, streamed so no copy of it is built in the heap
+#if LOG_LEVEL >= LOG_LEVEL_DEBUG
+      resultToHumanReadableBasic(LOG_WRITER, &results);
+      resultToSourceCode(LOG_WRITER, &results);
+#endif
+      if (name == NULL) {
+        // the captured signal as a String (allocated once)
+        captured = resultToSourceCode(&results);
       }
+      else {
+        captured = save_capture(results, *name);
+      }
+      break;
     }
     timestamp = millis() - start_time;
     yield();
   }
+  stop_receiver();
+
+  // blink the LED to signalize the user that the capture process has finished (or no signal was captured in 10s)
+  led_set_state(previous_led_state);
+  if (captured == "no_signal") {
+    control_led_output("no_signal");
+    publish_event(EVENT_CAPTURE, PSTR("{\"state\":\"no_signal\"}"));
+  }
+  else if (captured == "canceled") {
+    publish_event(EVENT_CAPTURE, PSTR("{\"state\":\"canceled\"}"));
+  }
+  else {
+    control_led_output("signal_received");
+    publish_event(EVENT_CAPTURE, PSTR("{\"state\":\"received\"}"));
+  }
+  return(captured);
+}
+
+/**
+ * @brief IR-Receiver that is used for captures (NULL until the first capture).
+ * 
+ */
+IRrecv *CAPTURE_RECEIVER = NULL;
+
+/**
+ * @brief Size of a chunk of the capture pool of the IR-Receiver.
+ * 
+ */
+const uint16_t CAPTURE_CHUNK_SIZE = 128;
+
+/**
+ * @brief Longest capture (long multi-frame AC signals).
+ * 
+ */
+const uint16_t CAPTURE_MAX_SIZE = 1500;
+
+/**
+ * @brief Starts the IR-Receiver that is used for captures.
+ * 
+ * @return IRrecv* - enabled IR-Receiver, stop it with stop_receiver() (do not delete it)
+ * 
+ * @details The receiver is shared by capture_signal() and the learning session, so both capture
+ * with the same settings. It is created on the first capture and kept afterwards: its capture pool
+ * and early decode buffer take about 3.6 KB, allocating them again for every capture fragmented
+ * the heap. Only one capture can run at a time. The chunks are set up again on every start, so a
+ * signal that was captured after the last decode() is not reported to the next capture.
+ * 
+ * @callgraph
+ * 
+ * @callergraph
+ */
+IRrecv *start_receiver() {
+  if (CAPTURE_RECEIVER == NULL) {
+    CAPTURE_RECEIVER = create_receiver();
+  }
+  CAPTURE_RECEIVER->setChunkedCapture(CAPTURE_CHUNK_SIZE, CAPTURE_MAX_SIZE);
+  CAPTURE_RECEIVER->enableIRIn();
+  return CAPTURE_RECEIVER;
+}
+
+/**
+ * @brief Stops the IR-Receiver that is used for captures (it is kept for the next capture).
+ * 
+ * @callgraph This function does not call any other function.
+ * 
+ * @callergraph
+ */
+void stop_receiver() {
+  if (CAPTURE_RECEIVER != NULL) {
+    CAPTURE_RECEIVER->disableIRIn();
+  }
+}
+
+/**
+ * @brief Creates the IR-Receiver that is used for captures.
+ * 
+ * @return IRrecv* - configured IR-Receiver (not enabled yet)
+ * 
+ * @details Only called once by start_receiver().
+ * 
+ * @callgraph This function does not call any other function.
+ * 
+ * @callergraph
+ */
+IRrecv *create_receiver() {
+
+  // set the GPIO for the IR-Receiver
+  int receive_pin = 14;
+
+  // set the parameters for the IR-Receiver
+  // the capture buffer is a pool of chunks, each capture only keeps the chunks it needs
+  int capture_pool_size = 1536;
+  int timeout_sequence = 50;
+  int min_unknown_size = 12;
+  int tolerance_percentage = kTolerance;  // 25%
+  int early_decode_size = 300;  // remote controls and short AC frames
+  int early_decode_silence = 30000;  // us, longer than the gaps inside multi-frame signals
+
+  IRrecv *irrecv = new IRrecv(receive_pin, capture_pool_size, timeout_sequence);
 
-  // no signal was captured in 10s:
-  control_led_output("no_signal");
-  return("no_signal");
+  // Ignore messages with less than minimum on or off pulses
+  irrecv->setUnknownThreshold(min_unknown_size);
+  irrecv->setTolerance(tolerance_percentage);  
+  // decode captures in place while the next one is captured into the rest of the pool
+  irrecv->setChunkedCapture(CAPTURE_CHUNK_SIZE, CAPTURE_MAX_SIZE);
+  // keep the receive interrupt short: record cycle counts, convert them when decoding
+  irrecv->setCycleCountCapture();
+  // report signals of known protocols once they are complete instead of after the timeout
+  irrecv->setEarlyDecode(early_decode_size, early_decode_silence);
+  return irrecv;
 }
 
 /**
@@ -96,17 +241,9 @@ String capture_signal(){
  */
 String save_signal(String result_string, String name){
 
-  // check if name is specified
-  if (name == ""){
-    return("Error: name is empthy");
-  }
-
-  if (check_if_string_is_alphanumeric(name) == false){
-    return("Error: name is not alphanumeric");
-  }
-
-  if (name.length() > 21){
-    return("Error: name exceeds 32 characters");
+  String error = check_signal_name(name);
+  if (error != ""){
+    return(error);
   }
 
   // extract length from String
@@ -126,17 +263,129 @@ String save_signal(String result_string, String name){
   String sequence = result_string.substring (first +1,last);
 
   // creates JSON document from extracted data
-  DynamicJsonDocument doc(3096);
+  json_document doc(JSON_FILE_CAPACITY);
+  doc["name"] = name;
+
+  // try to describe the capture as header, data bits and footer instead of a list of timings
+  boolean generic = false;
+  int raw_length = length.toInt();
+  if (raw_length > 0) {
+    uint16_t *raw = new uint16_t[raw_length];
+    if (parse_sequence(sequence, raw, raw_length) == raw_length) {
+      generic = add_generic_signal(raw, raw_length, doc);
+    }
+    delete[] raw;
+  }
+
+  // otherwise store the raw timings
+  if (generic == false) {
+    doc["length"] = raw_length;
+    doc["sequence"] = sequence;
+  }
+  // save JSON document to file
+  save_json("/signals/" + name  + ".json", doc);
+  return("success");
+}
+
+/**
+ * @brief This function saves a captured signal from its decoded results
+ * 
+ * @param results - decoded capture
+ * 
+ * @param name - name of the signal
+ * 
+ * @return String - "success" - if signal was saved successfully\n
+ *                 "Error: ..." - if the name is not valid
+ * 
+ * @details Saves the same file as save_signal() without going through the source code String.
+ * 
+ * @callgraph
+ * 
+ * @callergraph
+ */
+String save_capture(const decode_results &results, String name){
+  metrics_scope scope(METRICS_STORAGE);
+
+  String error = check_signal_name(name);
+  if (error != ""){
+    return(error);
+  }
+
+  json_document doc(JSON_FILE_CAPACITY);
   doc["name"] = name;
-  doc["length"] = length.toInt();
-  doc["sequence"] = sequence;
-  doc.shrinkToFit();
+  String sequence;
+  build_signal_json(results, doc, sequence);
 
   // save JSON document to file
   save_json("/signals/" + name  + ".json", doc);
   return("success");
 }
 
+/**
+ * @brief Checks the name of a signal
+ * 
+ * @param name - name of the signal
+ * 
+ * @return String - "" if the name is valid, "Error: ..." if not
+ * 
+ * @callgraph
+ * 
+ * @callergraph
+ */
+String check_signal_name(const String &name){
+
+  // check if name is specified
+  if (name == ""){
+    return("Error: name is empthy");
+  }
+
+  if (check_if_string_is_alphanumeric(name) == false){
+    return("Error: name is not alphanumeric");
+  }
+
+  if (name.length() > 21){
+    return("Error: name exceeds 32 characters");
+  }
+  return("");
+}
+
+/**
+ * @brief Adds a decoded capture to the JSON document of a signal
+ * 
+ * @param results - decoded capture
+ * 
+ * @param doc - JSON document of the signal
+ * 
+ * @param sequence - buffer for the raw timings, it has to live as long as the document
+ * 
+ * @details The capture is described as generic signal if possible (see add_generic_signal()).
+ * Otherwise its raw timings are written into sequence ("1234, 5678, ..." like save_signal()
+ * stores them), which the document only links to instead of copying it.
+ * 
+ * @callgraph
+ * 
+ * @callergraph
+ */
+void build_signal_json(const decode_results &results, JsonDocument &doc, String &sequence){
+  uint16_t *raw = resultToRawArray(&results);
+  uint16_t length = getCorrectedRawLength(&results);
+
+  if (add_generic_signal(raw, length, doc) == false) {
+    // a timing has at most 5 digits and ", "
+    sequence = "";
+    sequence.reserve(7 * length);
+    for (uint16_t i = 0; i < length; i++) {
+      if (i > 0) {
+        sequence += ", ";
+      }
+      sequence += raw[i];
+    }
+    doc["length"] = length;
+    doc["sequence"] = sequence.c_str();
+  }
+  delete[] raw;
+}
+
 /**
  * @brief This function saves a JSON document to a specified file
  * 
@@ -144,28 +393,26 @@ String save_signal(String result_string, String name){
  * 
  * @param doc - JSON document containing unspecified data
  * 
- * @details This function uses LittleFS and the ArduinoJson library.
+ * @details This function uses LittleFS and the ArduinoJson library. The document is serialized
+ * directly into the file without being copied. It is written to REPLACE_TEMP_FILE first, which
+ * then replaces the old file in one rename, so a reset while writing keeps the old file.
  * 
  * @callgraph This function does not call any other function.
  * 
  * @callergraph
  */
-void save_json(String filename, DynamicJsonDocument doc) {
+void save_json(const String &filename, const JsonDocument &doc) {
+  metrics_scope scope(METRICS_STORAGE);
 
   // initialize LittleFS
   LittleFS.begin();
 
-  // check if file exists and delete it
-  if (LittleFS.exists(filename)) {
-    LittleFS.remove(filename);
-  }
-
-  // Open file for writing
-  File myfile = LittleFS.open(filename, "w");
+  // Open temporary file for writing
+  File myfile = LittleFS.open(REPLACE_TEMP_FILE, "w");
   
   // Check if the file was opened
   if (!myfile) {
-    Serial.println("/filesystem.cpp/save_json: Failed to create file: " + filename);
+    LOG_ERROR("save_json: Failed to create file: %s", filename.c_str());
     myfile.close();
     LittleFS.end();
     return;
@@ -173,14 +420,19 @@ void save_json(String filename, DynamicJsonDocument doc) {
 
   // Serialize JSON to file
   if (serializeJson(doc, myfile) == 0) {
-    Serial.println("/filesystem.cpp/save_json: Failed to write to file: " + filename);
+    LOG_ERROR("save_json: Failed to write to file: %s", filename.c_str());
     myfile.close();
+    LittleFS.remove(REPLACE_TEMP_FILE);
     LittleFS.end();
     return;
   }
 
-  // Close the file
+  // Close the file and replace the old one
   myfile.close();
+  if (LittleFS.rename(REPLACE_TEMP_FILE, filename) == false) {
+    LOG_ERROR("save_json: Failed to replace file: %s", filename.c_str());
+    LittleFS.remove(REPLACE_TEMP_FILE);
+  }
   LittleFS.end();
   return;
 }
@@ -190,15 +442,48 @@ void save_json(String filename, DynamicJsonDocument doc) {
  * 
  * @param filename - name of the file
  * 
- * @return DynamicJsonDocument - JSON document containing unspecified data
+ * @param doc - JSON document of the caller (e.g. a json_document), is cleared and filled with the file
+ * 
+ * @return boolean - true if the file was loaded, false if it does not exist or could not be read
+ * (the document is empty then)
+ * 
+ * @details This function uses LittleFS and the ArduinoJson library. The caller declares the document
+ * so it can be taken from the JSON arena (see json_arena.h) instead of the heap.
+ * 
+ * @callgraph
+ * 
+ * @callergraph
+ */
+boolean load_json(const String &filename, JsonDocument &doc) {
+  StaticJsonDocument<16> filter;
+  filter.set(true);
+  return load_json(filename, doc, filter);
+}
+
+/**
+ * @brief This function loads the fields of a JSON document from a specified file that are needed
+ * 
+ * @param filename - name of the file
+ * 
+ * @param doc - JSON document of the caller, is cleared and filled with the file
  * 
- * @details This function uses LittleFS and the ArduinoJson library.
+ * @param filter - fields that are needed, e.g. {"timezone": true} (see DeserializationOption::Filter)
+ * 
+ * @return boolean - true if the file was loaded, false if it does not exist or could not be read
+ * (the document is empty then)
+ * 
+ * @details Fields that are not in the filter are skipped while reading, so the document can be
+ * smaller than the file.
  * 
  * @callgraph This function does not call any other function.
  * 
  * @callergraph
  */
-DynamicJsonDocument load_json(String filename) {
+boolean load_json(const String &filename, JsonDocument &doc, const JsonDocument &filter) {
+  metrics_scope scope(METRICS_STORAGE);
+  TRACE_SPAN("load_json");
+
+  doc.clear();
 
   // initialize LittleFS
   LittleFS.begin();
@@ -206,96 +491,365 @@ DynamicJsonDocument load_json(String filename) {
   // Open file for reading
   File myfile = LittleFS.open(filename, "r");
 
-  // create JSON document
-  DynamicJsonDocument doc(3096);
-
   // Check if the file was opened
   if (!myfile) {
-    Serial.println("/filesystem.cpp/load_json: Failed to read file: " + filename);
+    LOG_WARN("load_json: Failed to read file: %s", filename.c_str());
     myfile.close();
     LittleFS.end();
-    return doc;
+    return false;
   }
 
   // Deserialize the JSON document
-  DeserializationError error = deserializeJson(doc, myfile);
+  DeserializationError error = deserializeJson(doc, myfile, DeserializationOption::Filter(filter.as<JsonVariantConst>()));
 
   // if deserialization failed, delete the file and return empty JSON document
   if (error) {
-    Serial.println("/filesystem.cpp/load_json: Failed to deserialize JSON from file: " + filename);
+    LOG_ERROR("load_json: Failed to deserialize JSON from file: %s", filename.c_str());
+    doc.clear();
     LittleFS.remove(filename);
     myfile.close();
     LittleFS.end();
-    return doc;
+    return false;
   }
 
-  // Close the file and return JSON document
-  doc.shrinkToFit();
+  // Close the file
   myfile.close();
   LittleFS.end();
-  return doc;
+  return true;
 }
 
 /**
  * @brief This function sends a signal provided in JSON format.
  * 
- * @param doc - JSON document containing the signal to be sent:\n 
+ * @param doc - JSON document containing the signal to be sent, either as raw timings:\n 
  *        {\n
  *        "name": "name",\n
  *        "length": 67,\n
  *        "sequence": "1234, 5678, ..."\n
+ *        }\n
+ *        or as a generic signal (see generic_to_json()):\n
+ *        {\n
+ *        "name": "name",\n
+ *        "generic": {"timings": [...], "headerless": 0, "bits": [32], "data": "20DF10EF"}\n
  *        }
  * 
  * @return String - "success" if sending was successful\n
  *                  "Error: ..." if sending failed
  * 
  * @details This function sends a signal provided in JSON format. It uses the IRremoteESP8266 library and is based
- * on the example code provided by the library.
+ * on the example code provided by the library. Generic signals are sent with IRsend::sendGeneric(), raw
+ * timings with IRsend::sendRaw().
  * 
- * @callgraph This function does not call any other function.
+ * @callgraph
  * 
  * @callergraph
  */
-String send_signal(DynamicJsonDocument doc) {
+String send_signal(const JsonDocument &doc) {
+  metrics_scope scope(METRICS_SEND);
+
+  // do not send if the running job was canceled
+  if (job_cancelled() == true) {
+    return("Error: sending was canceled by the user");
+  }
+
+  // set GPIO to be used for sending the signal
+  int kIrLed = 4;
+
+  // initialize IRsend object with GPIO
+  IRsend irsend(kIrLed);
+
+  // send generic signal (header, data bits and footer)
+  if (doc.containsKey("generic")) {
+    generic_signal_t signal;
+    if (json_to_generic(doc["generic"], &signal) == false) {
+      return("Error: invalid signal");
+    }
+    irsend.begin();
+    led_state previous_led_state = led_set_state(LED_TRANSMITTING);
+    {
+      TRACE_SPAN("sendGeneric");
+      irsend.sendGeneric(&signal, 38);
+    }
+    led_set_state(previous_led_state);
+    return("success");
+  }
 
   // extract data from JSON document
   int length = doc["length"];
   String sequence = doc["sequence"];
 
   // check if length and sequence are valid (non null)
-  if (length == 0 || sequence == "" || sequence == "null") {
+  if (length <= 0 || sequence == "" || sequence == "null") {
     return("Error: invalid signal");
   }
-  
+
+  // convert string to array of integers
+  uint16_t command[length];
+  int data_num;
+  {
+    TRACE_SPAN("send_signal_parse");
+    data_num = parse_sequence(sequence, command, length);
+  }
+
+  if (data_num != length) {
+    return("Error: length of sequence does not match length in JSON document! Please save signal again.");
+  }
+
+  // send signal with IRsend object
+  irsend.begin();
+  led_state previous_led_state = led_set_state(LED_TRANSMITTING);
+  {
+    TRACE_SPAN("sendRaw");
+    irsend.sendRaw(command, length, 38);
+  }
+  led_set_state(previous_led_state);
+  return("success");
+}
+
+/**
+ * @brief Sends a state of a known protocol (e.g. the whole state of an AC) without a saved signal.
+ * 
+ * @param protocol - protocol of the IRremoteESP8266 library (decode_type_t)
+ * 
+ * @param bits - number of bits of the value (0 for the default of the protocol, ignored for AC protocols)
+ * 
+ * @param state - state (AC protocols) or value (other protocols, big endian, at most 8 bytes)
+ * 
+ * @param length - length of the state in bytes
+ * 
+ * @return String - "success" if sending was successful\n
+ *                  "Error: ..." if the protocol or length is not supported or sending was canceled
+ * 
+ * @details Used by the UDP command port. The job, LED and cancellation are handled like in send_signal().
+ * 
+ * @callgraph
+ * 
+ * @callergraph
+ */
+String send_state(uint16_t protocol, uint16_t bits, const uint8_t *state, uint16_t length) {
+  metrics_scope scope(METRICS_SEND);
+  job_scope job(JOB_SEND);
+
+  // do not send if the running job was canceled
+  if (job_cancelled() == true) {
+    return("Error: sending was canceled by the user");
+  }
+
+  decode_type_t type = (decode_type_t)protocol;
+  if (length == 0 || (hasACState(type) == false && length > 8)) {
+    return("Error: invalid state length");
+  }
+
   // set GPIO to be used for sending the signal
   int kIrLed = 4;
-
-  // initialize IRsend object with GPIO
   IRsend irsend(kIrLed);
+  irsend.begin();
 
-  // convert string to array of integers (thanks to https://stackoverflow.com/questions/48409822/convert-a-string-to-an-integer-array)
+  boolean sent;
+  led_state previous_led_state = led_set_state(LED_TRANSMITTING);
+  {
+    TRACE_SPAN("send_state");
+    if (hasACState(type)) {
+      sent = irsend.send(type, state, length);
+    }
+    else {
+      uint64_t value = 0;
+      for (uint16_t i = 0; i < length; i++) {
+        value = (value << 8) | state[i];
+      }
+      sent = irsend.send(type, value, bits == 0 ? IRsend::defaultBits(type) : bits);
+    }
+  }
+  led_set_state(previous_led_state);
+
+  if (sent == false) {
+    return("Error: protocol " + String(protocol) + " can not be sent");
+  }
+  return("success");
+}
+
+/**
+ * @brief Converts a comma separated sequence of timings into an array of integers.
+ * 
+ * @param sequence - String containing the timings: "1234, 5678, ..."
+ * 
+ * @param command - array the timings are written to
+ * 
+ * @param length - size of the array
+ * 
+ * @return int - number of timings in the sequence (values beyond length are counted but not written)
+ * 
+ * @details Thanks to https://stackoverflow.com/questions/48409822/convert-a-string-to-an-integer-array
+ * 
+ * @callgraph This function does not call any other function.
+ * 
+ * @callergraph
+ */
+int parse_sequence(String sequence, uint16_t *command, int length) {
   int data_num = 0;
-  uint16_t command[length];
 
   // loop as long as a comma is found in the string
   while(sequence.indexOf(",")!=-1){
     // take the substring from the start to the first occurence of a comma, convert it to int and save it in the array
-    command[ data_num ] = sequence.substring(0,sequence.indexOf(",")).toInt();
+    if (data_num < length) {
+      command[ data_num ] = sequence.substring(0,sequence.indexOf(",")).toInt();
+    }
     data_num++; // increment our data counter
     //cut the data string after the first occurence of a comma
     sequence = sequence.substring(sequence.indexOf(",")+1);
   }
   // get the last value out of the string, which has no more commas in it
-  command[ data_num ] = sequence.toInt();
+  if (data_num < length) {
+    command[ data_num ] = sequence.toInt();
+  }
+  return data_num + 1;
+}
 
-  if (data_num != length-1) {
-    return("Error: length of sequence does not match length in JSON document! Please save signal again.");
+/**
+ * @brief Adds a capture to a signal document as generic signal if it can be described as one.
+ * 
+ * @param raw - timings of the capture
+ * 
+ * @param length - number of timings
+ * 
+ * @param doc - JSON document of the signal, gets the "generic" object (see generic_to_json())
+ * 
+ * @return boolean - true if the capture was added, false if it has to be stored as raw timings
+ * 
+ * @details Short captures are always kept raw.
+ * 
+ * @callgraph
+ * 
+ * @callergraph
+ */
+boolean add_generic_signal(const uint16_t *raw, int length, JsonDocument &doc) {
+
+  // minimum number of timings for a capture to be stored as a generic signal (shorter ones are kept raw)
+  int min_generic_length = 12;
+
+  generic_signal_t signal;
+  if (length < min_generic_length || rawToGeneric(raw, length, &signal) == false) {
+    return false;
   }
+  generic_to_json(signal, doc.createNestedObject("generic"));
+  return true;
+}
 
-  // send signal with IRsend object
-  irsend.begin();
-  irsend.sendRaw(command, length, 38);
-  return("success");
+/**
+ * @brief Writes a generic signal into a JSON object.
+ * 
+ * @param signal - generic signal as found by rawToGeneric() in IRremoteESP8266/src/IRutils.cpp
+ * 
+ * @param object - JSON object the signal is written to:\n
+ *        {\n
+ *        "timings": [hdrmark, hdrspace, onemark, onespace, zeromark, zerospace, footermark, gap],\n
+ *        "headerless": 0,\n
+ *        "bits": [32, ...],\n
+ *        "data": "20DF10EF..."\n
+ *        }
+ * 
+ * @details "bits" holds the number of bits of every section of the signal, "headerless" is a bitmask of
+ * the sections sent without header and "data" holds the bits of all sections as hex, every section
+ * starting on a new byte. This takes a few dozen bytes instead of the hundreds of timings of a raw capture.
+ * 
+ * @callgraph This function does not call any other function.
+ * 
+ * @callergraph
+ */
+void generic_to_json(const generic_signal_t &signal, JsonObject object) {
+  JsonArray timings = object.createNestedArray("timings");
+  timings.add(signal.hdrmark);
+  timings.add(signal.hdrspace);
+  timings.add(signal.onemark);
+  timings.add(signal.onespace);
+  timings.add(signal.zeromark);
+  timings.add(signal.zerospace);
+  timings.add(signal.footermark);
+  timings.add(signal.gap);
+  object["headerless"] = signal.headerless;
+
+  // number of bits per section and the number of bytes they take up
+  JsonArray bits = object.createNestedArray("bits");
+  int bytes = 0;
+  for (int i = 0; i < signal.sections; i++) {
+    bits.add(signal.nbits[i]);
+    bytes += (signal.nbits[i] + 7) / 8;
+  }
+
+  // data as hex
+  const char hex[] = "0123456789ABCDEF";
+  String data = "";
+  data.reserve(bytes * 2);
+  for (int i = 0; i < bytes; i++) {
+    data += hex[signal.data[i] >> 4];
+    data += hex[signal.data[i] & 0xF];
+  }
+  object["data"] = data;
+}
+
+/**
+ * @brief Reads a generic signal from a JSON object.
+ * 
+ * @param object - JSON object in the format written by generic_to_json()
+ * 
+ * @param signal - generic signal to be filled
+ * 
+ * @return boolean - true if the object holds a valid generic signal, false if not
+ * 
+ * @callgraph This function does not call any other function.
+ * 
+ * @callergraph
+ */
+boolean json_to_generic(JsonObjectConst object, generic_signal_t *signal) {
+  JsonArrayConst timings = object["timings"];
+  JsonArrayConst bits = object["bits"];
+  const char *data = object["data"];
+
+  // check if all parts are present and within the limits of generic_signal_t
+  if (timings.isNull() || timings.size() != 8 || bits.isNull() || bits.size() == 0 ||
+      bits.size() > kGenericSignalMaxSections || data == NULL) {
+    return false;
+  }
+
+  signal->hdrmark = timings[0];
+  signal->hdrspace = timings[1];
+  signal->onemark = timings[2];
+  signal->onespace = timings[3];
+  signal->zeromark = timings[4];
+  signal->zerospace = timings[5];
+  signal->footermark = timings[6];
+  signal->gap = timings[7];
+  signal->headerless = object["headerless"] | 0;
+  signal->sections = bits.size();
+
+  // number of bits per section and the number of bytes they take up
+  unsigned int bytes = 0;
+  for (int i = 0; i < signal->sections; i++) {
+    signal->nbits[i] = bits[i];
+    if (signal->nbits[i] == 0) {
+      return false;
+    }
+    bytes += (signal->nbits[i] + 7) / 8;
+  }
+  if (bytes > kGenericSignalMaxBytes || strlen(data) != bytes * 2) {
+    return false;
+  }
+
+  // data from hex
+  for (unsigned int i = 0; i < bytes * 2; i++) {
+    char c = toupper(data[i]);
+    if (isxdigit(c) == false) {
+      return false;
+    }
+    uint8_t nibble = (c <= '9') ? c - '0' : c - 'A' + 10;
+    if (i % 2 == 0) {
+      signal->data[i / 2] = nibble << 4;
+    }
+    else {
+      signal->data[i / 2] |= nibble;
+    }
+  }
+  return true;
 }
 
 /**
@@ -315,6 +869,7 @@ String send_signal(DynamicJsonDocument doc) {
  * @callergraph
  */
 String get_files(String folder_signals, String folder_programs){
+  metrics_scope scope(METRICS_STORAGE);
 
   // declare variables
   String files = "";
@@ -400,6 +955,7 @@ boolean check_if_file_exists(String filename) {
  * @callergraph
  */
 String read_program(String program_name){
+  metrics_scope scope(METRICS_STORAGE);
 
   // declare variables
   String filename = "/programs/" + program_name + ".txt";
@@ -436,55 +992,33 @@ String read_program(String program_name){
  * @details This function controls the LED output via codewords to specify the kind 
  * of signal to be send. The LED is connected to GPIO 5 (D1) on the ESP8266 and is 
  * ment as a way to communicate errors to the user and singal when the ESP is ready to 
- * receive a signal.
+ * receive a signal. The blinks are played in the background by led_play(), so this
+ * function returns immediately.
  * 
- * @callgraph This function does not call any other function.
+ * @callgraph
  * 
  * @callergraph
  */
 void control_led_output(String signal) {
 
-  // declare variables
-  int led_pin = 5;
-  pinMode(led_pin, OUTPUT);
+  // blink patterns (off/on 100 ms each, the LED returns to its current state afterwards)
+  const led_pattern three_blinks = {LOW, 6, false, {100, 100, 100, 100, 100, 100}};
+  const led_pattern two_blinks = {LOW, 4, false, {100, 100, 100, 100}};
+  const led_pattern one_blink = {LOW, 2, false, {100, 100}};
 
   // 3 blinks:
   if (signal == "no_signal" || signal == "no_mDNS" || signal == "no_wifi") {
-    digitalWrite(led_pin, LOW);
-    delay(100);
-    digitalWrite(led_pin, HIGH);
-    delay(100);
-    digitalWrite(led_pin, LOW);
-    delay(100);
-    digitalWrite(led_pin, HIGH);
-    delay(100);
-    digitalWrite(led_pin, LOW);
-    delay(100);
-    digitalWrite(led_pin, HIGH);
-    delay(100);
-    digitalWrite(led_pin, LOW);
+    led_play(three_blinks);
   }
 
   // 2 blinks:
   else if (signal == "AP_on") {
-    digitalWrite(led_pin, LOW);
-    delay(100);
-    digitalWrite(led_pin, HIGH);
-    delay(100);
-    digitalWrite(led_pin, LOW);
-    delay(100);
-    digitalWrite(led_pin, HIGH);
-    delay(100);
-    digitalWrite(led_pin, LOW);
+    led_play(two_blinks);
   }
 
   // 1 blink:
   else if (signal == "signal_received" || signal == "AP_off") {
-    digitalWrite(led_pin, LOW);
-    delay(100);
-    digitalWrite(led_pin, HIGH);
-    delay(100);
-    digitalWrite(led_pin, LOW);
+    led_play(one_blink);
   }
 
   return;
@@ -0,0 +1,275 @@
+/**
+ * @file jobs.cpp
+ *
+ * @author Marc Ubbelohde
+ *
+ * @brief In this file, the jobs and their cancellation are defined.
+ *
+ * @details The cancel button used to be polled with digitalRead() in the spin loops of the wait
+ * and time commands, so it only worked while one of them was spinning and kept the CPU busy.
+ * Now the button sets the cancellation token of the running job from a debounced interrupt, and
+ * the same token can be set on /api/jobs/{id}/cancel. Captures, the transmit path and the program
+ * executor check the token, and waits are real sleeps (job_sleep()) that end early once it is set.
+ */
+
+#include "base.h"
+
+/**
+ * @brief The running job (depth 0 if none is running).
+ *
+ */
+job CURRENT_JOB = {0, JOB_NONE, 0, false};
+
+/**
+ * @brief Id of the next job (ids start at 1).
+ *
+ */
+uint16_t JOB_NEXT_ID = 1;
+
+/**
+ * @brief Names of the kinds of jobs in the event stream (same order as job_kind).
+ *
+ */
+const char *const JOB_KIND_NAMES[] = {"none", "capture", "send", "program", "learn"};
+
+/**
+ * @brief Time of the last accepted button press (millis()).
+ *
+ */
+volatile unsigned long CANCEL_LAST_PRESS = 0;
+
+/**
+ * @brief Function that is called while job_sleep() waits (e.g. to keep the webserver running).
+ *
+ */
+void (*JOB_IDLE_HANDLER)() = NULL;
+
+/**
+ * @brief Interrupt handler of the cancel button.
+ *
+ * @details Presses within CANCEL_DEBOUNCE_TIME of the last one are ignored, presses while no
+ * job is running have no effect.
+ *
+ * @callgraph This function does not call any other function.
+ *
+ * @callergraph This function is called on a falling edge of CANCEL_BUTTON_PIN.
+ */
+IRAM_ATTR void cancel_button_interrupt() {
+  unsigned long now = millis();
+  if (now - CANCEL_LAST_PRESS < CANCEL_DEBOUNCE_TIME) {
+    return;
+  }
+  CANCEL_LAST_PRESS = now;
+
+  if (CURRENT_JOB.depth > 0) {
+    CURRENT_JOB.cancelled = true;
+  }
+}
+
+/**
+ * @brief Sets up the cancel button and its interrupt.
+ *
+ * @callgraph This function does not call any other function.
+ *
+ * @callergraph
+ */
+void init_cancel_button() {
+  pinMode(CANCEL_BUTTON_PIN, INPUT_PULLUP);
+  attachInterrupt(digitalPinToInterrupt(CANCEL_BUTTON_PIN), cancel_button_interrupt, FALLING);
+}
+
+/**
+ * @brief Starts a job.
+ *
+ * @param kind - kind of the job
+ *
+ * @return uint16_t - id of the job, the id of the running job if one is running
+ *
+ * @details A job that is started while one is running becomes part of it (e.g. a signal that
+ * is sent by a program), so canceling the program also cancels the signal.
+ *
+ * @callgraph
+ *
+ * @callergraph
+ */
+uint16_t job_begin(job_kind kind) {
+  if (CURRENT_JOB.depth > 0) {
+    CURRENT_JOB.depth++;
+    return CURRENT_JOB.id;
+  }
+
+  // the token is cleared before the job counts as running, so no press gets lost in between
+  CURRENT_JOB.cancelled = false;
+  CURRENT_JOB.id = JOB_NEXT_ID;
+  CURRENT_JOB.kind = kind;
+  CURRENT_JOB.depth = 1;
+
+  JOB_NEXT_ID++;
+  if (JOB_NEXT_ID == 0) {
+    JOB_NEXT_ID = 1;
+  }
+
+  publish_event(EVENT_JOB, PSTR("{\"job\":%u,\"kind\":\"%s\",\"state\":\"running\"}"), CURRENT_JOB.id, JOB_KIND_NAMES[kind]);
+  return CURRENT_JOB.id;
+}
+
+/**
+ * @brief Ends a job.
+ *
+ * @param id - id returned by job_begin()
+ *
+ * @callgraph
+ *
+ * @callergraph
+ */
+void job_end(uint16_t id) {
+  if (CURRENT_JOB.depth == 0 || CURRENT_JOB.id != id) {
+    return;
+  }
+  CURRENT_JOB.depth--;
+  if (CURRENT_JOB.depth == 0) {
+    publish_event(EVENT_JOB, PSTR("{\"job\":%u,\"kind\":\"%s\",\"state\":\"%s\"}"), CURRENT_JOB.id, JOB_KIND_NAMES[CURRENT_JOB.kind], CURRENT_JOB.cancelled ? "canceled" : "finished");
+    CURRENT_JOB.kind = JOB_NONE;
+  }
+}
+
+/**
+ * @brief Starts a job that ends with the enclosing block.
+ *
+ * @param kind - kind of the job
+ *
+ * @callgraph
+ *
+ * @callergraph
+ */
+job_scope::job_scope(job_kind kind) {
+  id = job_begin(kind);
+}
+
+/**
+ * @brief Ends the job of the scope.
+ *
+ * @callgraph
+ *
+ * @callergraph
+ */
+job_scope::~job_scope() {
+  job_end(id);
+}
+
+/**
+ * @brief Returns the running job.
+ *
+ * @return job - running job (depth 0 if none is running)
+ *
+ * @callgraph This function does not call any other function.
+ *
+ * @callergraph
+ */
+job get_current_job() {
+  job current = {CURRENT_JOB.id, CURRENT_JOB.kind, CURRENT_JOB.depth, CURRENT_JOB.cancelled};
+  return current;
+}
+
+/**
+ * @brief Checks if a job is running.
+ *
+ * @param message - set to "job {id} is still running" if a job is running
+ *
+ * @return boolean - true if a job is running
+ *
+ * @details Requests are also handled while a program waits, since job_sleep() calls the idle
+ * handler. Actions that change signals or programs (or start another job) call this function
+ * first and are refused with ACTION_BUSY instead of running nested inside of the job.
+ *
+ * @callgraph
+ *
+ * @callergraph
+ */
+boolean job_busy(String &message) {
+  if (CURRENT_JOB.depth == 0) {
+    return false;
+  }
+  message = "job " + String(CURRENT_JOB.id) + " is still running";
+  return true;
+}
+
+/**
+ * @brief Returns if the running job was canceled.
+ *
+ * @return boolean - true if a job is running and was canceled
+ *
+ * @callgraph This function does not call any other function.
+ *
+ * @callergraph
+ */
+boolean job_cancelled() {
+  return CURRENT_JOB.depth > 0 && CURRENT_JOB.cancelled;
+}
+
+/**
+ * @brief Cancels a job.
+ *
+ * @param id - id of the job
+ *
+ * @return boolean - true if the job is running and was canceled, false if it is not running
+ *
+ * @callgraph This function does not call any other function.
+ *
+ * @callergraph
+ */
+boolean job_cancel(uint16_t id) {
+  if (CURRENT_JOB.depth == 0 || CURRENT_JOB.id != id) {
+    return false;
+  }
+  CURRENT_JOB.cancelled = true;
+  return true;
+}
+
+/**
+ * @brief Sleeps until the time is over or the running job is canceled.
+ *
+ * @param time - time to sleep in milliseconds
+ *
+ * @return boolean - true if the whole time was slept, false if the job was canceled
+ *
+ * @details The time is slept with delay() in slices of at most JOB_SLEEP_SLICE, so the CPU idles
+ * and the Wi-Fi stack keeps running. Between the slices the idle handler is called. The time is
+ * measured as the difference of two millis() values and therefore also works over its overflow.
+ *
+ * @callgraph
+ *
+ * @callergraph
+ */
+boolean job_sleep(unsigned long time) {
+  unsigned long start = millis();
+
+  while (millis() - start < time) {
+    if (job_cancelled() == true) {
+      return false;
+    }
+    if (JOB_IDLE_HANDLER != NULL) {
+      JOB_IDLE_HANDLER();
+    }
+
+    unsigned long elapsed = millis() - start;
+    if (elapsed >= time) {
+      break;
+    }
+    delay(min(time - elapsed, JOB_SLEEP_SLICE));
+  }
+  return job_cancelled() == false;
+}
+
+/**
+ * @brief Sets the function that is called while job_sleep() waits.
+ *
+ * @param handler - function to be called, NULL for none
+ *
+ * @callgraph This function does not call any other function.
+ *
+ * @callergraph
+ */
+void job_set_idle_handler(void (*handler)()) {
+  JOB_IDLE_HANDLER = handler;
+}
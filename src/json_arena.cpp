@@ -0,0 +1,211 @@
+/**
+ * @file json_arena.cpp
+ *
+ * @author Marc Ubbelohde
+ *
+ * @brief In this file, the allocator of the stored JSON documents is defined.
+ *
+ * @details load_json() used to return a new DynamicJsonDocument(3096) by value, so every call
+ * allocated 3 KB in the heap, and get_current_time() and check_and_update_offset() load the time
+ * many times while a timed program waits. Now the documents are json_documents that are declared
+ * by the caller and passed by reference. Their memory is taken from a static arena that is used
+ * like a stack: a new document is put on top and the memory of the top document is given back
+ * when it goes out of scope. Memory of a document below the top is only marked as free and given
+ * back together with the documents above it. Only if the arena is full a document is allocated in
+ * the heap, which is counted in json_arena_stats.heap_allocations.
+ */
+
+#include "base.h"
+
+/**
+ * @brief Header in front of every block in the arena.
+ *
+ * @details Padded to 8 bytes so the blocks stay aligned for the memory pool of ArduinoJson.
+ *
+ */
+struct json_arena_block {
+  uint16_t previous;
+  uint16_t size;
+  boolean free;
+  uint8_t padding[3];
+};
+
+/**
+ * @brief Offset of no block (the arena is empty).
+ *
+ */
+const uint16_t JSON_ARENA_NONE = 0xffff;
+
+/**
+ * @brief Memory of the documents.
+ *
+ */
+alignas(8) uint8_t JSON_ARENA[JSON_ARENA_SIZE];
+
+/**
+ * @brief Offset of the first free byte.
+ *
+ */
+uint16_t JSON_ARENA_TOP = 0;
+
+/**
+ * @brief Offset of the header of the top block (JSON_ARENA_NONE if the arena is empty).
+ *
+ */
+uint16_t JSON_ARENA_LAST = JSON_ARENA_NONE;
+
+/**
+ * @brief Counters of the arena.
+ *
+ */
+json_arena_stats JSON_ARENA_STATS = {0, 0, 0, 0};
+
+/**
+ * @brief Returns the header of a block in the arena.
+ *
+ * @param pointer - memory of the block
+ *
+ * @return json_arena_block* - header of the block or NULL if the memory is not in the arena
+ *
+ * @callgraph This function does not call any other function.
+ *
+ * @callergraph
+ */
+json_arena_block *json_arena_find(void *pointer) {
+  uint8_t *memory = (uint8_t *)pointer;
+  if (memory < JSON_ARENA + sizeof(json_arena_block) || memory >= JSON_ARENA + JSON_ARENA_SIZE) {
+    return NULL;
+  }
+  return (json_arena_block *)(memory - sizeof(json_arena_block));
+}
+
+/**
+ * @brief Allocates the memory of a document.
+ *
+ * @param size - size in bytes
+ *
+ * @return void* - memory on top of the arena or in the heap if the arena is full
+ *
+ * @callgraph This function does not call any other function.
+ *
+ * @callergraph This function is called by BasicJsonDocument.
+ */
+void *json_arena_allocator::allocate(size_t size) {
+  size = (size + 7) & ~(size_t)7;
+  JSON_ARENA_STATS.allocations++;
+
+  if (JSON_ARENA_TOP + sizeof(json_arena_block) + size > JSON_ARENA_SIZE) {
+    JSON_ARENA_STATS.heap_allocations++;
+    return malloc(size);
+  }
+
+  json_arena_block *block = (json_arena_block *)(JSON_ARENA + JSON_ARENA_TOP);
+  block->previous = JSON_ARENA_LAST;
+  block->size = size;
+  block->free = false;
+  JSON_ARENA_LAST = JSON_ARENA_TOP;
+  JSON_ARENA_TOP += sizeof(json_arena_block) + size;
+
+  JSON_ARENA_STATS.used = JSON_ARENA_TOP;
+  if (JSON_ARENA_TOP > JSON_ARENA_STATS.peak) {
+    JSON_ARENA_STATS.peak = JSON_ARENA_TOP;
+  }
+  return block + 1;
+}
+
+/**
+ * @brief Gives back the memory of a document.
+ *
+ * @param pointer - memory from allocate()
+ *
+ * @details The arena shrinks over all free blocks on its top.
+ *
+ * @callgraph
+ *
+ * @callergraph This function is called by BasicJsonDocument.
+ */
+void json_arena_allocator::deallocate(void *pointer) {
+  json_arena_block *block = json_arena_find(pointer);
+  if (block == NULL) {
+    free(pointer);
+    return;
+  }
+  block->free = true;
+
+  while (JSON_ARENA_LAST != JSON_ARENA_NONE && ((json_arena_block *)(JSON_ARENA + JSON_ARENA_LAST))->free) {
+    JSON_ARENA_TOP = JSON_ARENA_LAST;
+    JSON_ARENA_LAST = ((json_arena_block *)(JSON_ARENA + JSON_ARENA_LAST))->previous;
+  }
+  JSON_ARENA_STATS.used = JSON_ARENA_TOP;
+}
+
+/**
+ * @brief Changes the size of the memory of a document.
+ *
+ * @param pointer - memory from allocate()
+ *
+ * @param new_size - new size in bytes
+ *
+ * @return void* - memory of the document (the same memory if it could be resized in place)
+ *
+ * @details Used by shrinkToFit(). Blocks below the top keep their memory when they shrink.
+ *
+ * @callgraph
+ *
+ * @callergraph This function is called by BasicJsonDocument.
+ */
+void *json_arena_allocator::reallocate(void *pointer, size_t new_size) {
+  json_arena_block *block = json_arena_find(pointer);
+  if (block == NULL) {
+    return realloc(pointer, new_size);
+  }
+  new_size = (new_size + 7) & ~(size_t)7;
+  uint16_t offset = (uint8_t *)block - JSON_ARENA;
+
+  // resize the top block in place
+  if (offset == JSON_ARENA_LAST && offset + sizeof(json_arena_block) + new_size <= JSON_ARENA_SIZE) {
+    block->size = new_size;
+    JSON_ARENA_TOP = offset + sizeof(json_arena_block) + new_size;
+    JSON_ARENA_STATS.used = JSON_ARENA_TOP;
+    if (JSON_ARENA_TOP > JSON_ARENA_STATS.peak) {
+      JSON_ARENA_STATS.peak = JSON_ARENA_TOP;
+    }
+    return pointer;
+  }
+  if (new_size <= block->size) {
+    return pointer;
+  }
+
+  void *moved = allocate(new_size);
+  if (moved != NULL) {
+    memcpy(moved, pointer, block->size);
+    deallocate(pointer);
+  }
+  return moved;
+}
+
+/**
+ * @brief Returns the counters of the arena.
+ *
+ * @return json_arena_stats - counters
+ *
+ * @callgraph This function does not call any other function.
+ *
+ * @callergraph
+ */
+json_arena_stats get_json_arena_stats() {
+  return JSON_ARENA_STATS;
+}
+
+/**
+ * @brief Resets the counters of the arena (used and the memory of the documents stay).
+ *
+ * @callgraph This function does not call any other function.
+ *
+ * @callergraph
+ */
+void reset_json_arena_stats() {
+  JSON_ARENA_STATS.allocations = 0;
+  JSON_ARENA_STATS.heap_allocations = 0;
+  JSON_ARENA_STATS.peak = JSON_ARENA_TOP;
+}
@@ -0,0 +1,696 @@
+/**
+ * @file kv_store.cpp
+ *
+ * @author Marc Ubbelohde
+ *
+ * @brief In this file, the journaled key-value store is defined.
+ *
+ * @details The AP mode, the password of the access point and the time used to be kept in
+ * /config.txt, /password.txt and /time.json, which were deleted and written again on every change,
+ * so a reset in between lost them. Now every change is one record appended to KV_JOURNAL_FILE.
+ * The journal is read once, the index in RAM keeps where the current value of every key is, and
+ * records that were torn by a reset or are damaged (CRC) end the journal. When most of the journal
+ * is outdated it is compacted: the current records are written to KV_COMPACT_FILE, which then
+ * replaces the journal in one rename, so either the old or the new journal survives a reset.
+ * The old files are moved into the store the first time it is loaded.
+ */
+
+#include "base.h"
+
+/**
+ * @brief Entry of the index.
+ *
+ */
+struct kv_entry {
+  char key[KV_KEY_LENGTH + 1];
+  uint32_t offset;  // position of the value in the journal
+  uint16_t length;
+  uint32_t crc;     // CRC of the record, equal CRCs of the same key mean equal values
+};
+
+/**
+ * @brief Index of the current values.
+ *
+ */
+kv_entry KV_INDEX[KV_MAX_KEYS];
+
+/**
+ * @brief Number of keys in the index.
+ *
+ */
+uint8_t KV_COUNT = 0;
+
+/**
+ * @brief True once the journal was read into the index.
+ *
+ */
+boolean KV_LOADED = false;
+
+/**
+ * @brief Counters of the store (journal_size is the end of the last valid record).
+ *
+ */
+kv_store_stats KV_STATS = {0, 0, 0, 0, 0, 0, 0};
+
+/**
+ * @brief Calculates the CRC-32 (as used by zip) of data.
+ *
+ * @param crc - CRC of the data before (0 for the first part)
+ *
+ * @param data - data
+ *
+ * @param length - length of the data
+ *
+ * @return uint32_t - CRC of all data so far
+ *
+ * @callgraph This function does not call any other function.
+ *
+ * @callergraph
+ */
+uint32_t kv_crc32(uint32_t crc, const uint8_t *data, size_t length) {
+  crc = ~crc;
+  for (size_t i = 0; i < length; i++) {
+    crc ^= data[i];
+    for (uint8_t bit = 0; bit < 8; bit++) {
+      crc = (crc >> 1) ^ (0xedb88320 & (0 - (crc & 1)));
+    }
+  }
+  return ~crc;
+}
+
+/**
+ * @brief Looks up a key in the index.
+ *
+ * @param key - key
+ *
+ * @param key_length - length of the key
+ *
+ * @return int - position in the index or -1 if the key is not in the index
+ *
+ * @callgraph This function does not call any other function.
+ *
+ * @callergraph
+ */
+int kv_find(const char *key, uint8_t key_length) {
+  for (uint8_t i = 0; i < KV_COUNT; i++) {
+    if (strlen(KV_INDEX[i].key) == key_length && memcmp(KV_INDEX[i].key, key, key_length) == 0) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+/**
+ * @brief Sets the entry of a key in the index or removes it.
+ *
+ * @param key - key
+ *
+ * @param key_length - length of the key
+ *
+ * @param offset - position of the value in the journal
+ *
+ * @param length - length of the value (KV_REMOVED removes the key)
+ *
+ * @param crc - CRC of the record
+ *
+ * @return boolean - false if the index is full
+ *
+ * @callgraph
+ *
+ * @callergraph
+ */
+boolean kv_index_set(const char *key, uint8_t key_length, uint32_t offset, uint16_t length, uint32_t crc) {
+  int position = kv_find(key, key_length);
+
+  if (length == KV_REMOVED) {
+    if (position >= 0) {
+      KV_INDEX[position] = KV_INDEX[KV_COUNT - 1];
+      KV_COUNT--;
+    }
+    return true;
+  }
+
+  if (position < 0) {
+    if (KV_COUNT == KV_MAX_KEYS) {
+      return false;
+    }
+    position = KV_COUNT++;
+    memcpy(KV_INDEX[position].key, key, key_length);
+    KV_INDEX[position].key[key_length] = '\0';
+  }
+  KV_INDEX[position].offset = offset;
+  KV_INDEX[position].length = length;
+  KV_INDEX[position].crc = crc;
+  return true;
+}
+
+/**
+ * @brief Builds the header of a record.
+ *
+ * @param header - KV_HEADER_LENGTH bytes
+ *
+ * @param key - key
+ *
+ * @param key_length - length of the key
+ *
+ * @param value - value (NULL if the key is removed)
+ *
+ * @param length - length of the value or KV_REMOVED
+ *
+ * @return uint32_t - CRC of the record
+ *
+ * @callgraph
+ *
+ * @callergraph
+ */
+uint32_t kv_build_header(uint8_t *header, const char *key, uint8_t key_length, const uint8_t *value, uint16_t length) {
+  header[0] = KV_RECORD_MAGIC;
+  header[1] = key_length;
+  header[2] = length & 0xff;
+  header[3] = length >> 8;
+
+  uint32_t crc = kv_crc32(0, header + 1, 3);
+  crc = kv_crc32(crc, (const uint8_t *)key, key_length);
+  if (length != KV_REMOVED) {
+    crc = kv_crc32(crc, value, length);
+  }
+
+  header[4] = crc & 0xff;
+  header[5] = (crc >> 8) & 0xff;
+  header[6] = (crc >> 16) & 0xff;
+  header[7] = crc >> 24;
+  return crc;
+}
+
+/**
+ * @brief Sum of the lengths of the current records.
+ *
+ * @return uint32_t - bytes a compacted journal would have
+ *
+ * @callgraph This function does not call any other function.
+ *
+ * @callergraph
+ */
+uint32_t kv_live_size() {
+  uint32_t size = 0;
+  for (uint8_t i = 0; i < KV_COUNT; i++) {
+    size += KV_HEADER_LENGTH + strlen(KV_INDEX[i].key) + KV_INDEX[i].length;
+  }
+  return size;
+}
+
+/**
+ * @brief Writes the current records into a new journal that replaces the old one.
+ *
+ * @return boolean - true if the journal was replaced
+ *
+ * @details The LittleFS has to be started. The index is only changed once the new journal
+ * replaced the old one.
+ *
+ * @callgraph
+ *
+ * @callergraph
+ */
+boolean kv_compact_journal() {
+  File journal = LittleFS.open(KV_JOURNAL_FILE, "r");
+  File compacted = LittleFS.open(KV_COMPACT_FILE, "w");
+  if (!compacted) {
+    journal.close();
+    return false;
+  }
+
+  uint32_t offsets[KV_MAX_KEYS];
+  uint32_t size = 0;
+  boolean ok = true;
+  for (uint8_t i = 0; i < KV_COUNT && ok; i++) {
+    kv_entry &entry = KV_INDEX[i];
+    uint8_t key_length = strlen(entry.key);
+    uint8_t value[KV_VALUE_LENGTH];
+    journal.seek(entry.offset, SeekSet);
+    ok = journal.read(value, entry.length) == entry.length;
+
+    uint8_t header[KV_HEADER_LENGTH];
+    kv_build_header(header, entry.key, key_length, value, entry.length);
+    ok = ok && compacted.write(header, KV_HEADER_LENGTH) == KV_HEADER_LENGTH;
+    ok = ok && compacted.write((const uint8_t *)entry.key, key_length) == key_length;
+    ok = ok && compacted.write(value, entry.length) == entry.length;
+    offsets[i] = size + KV_HEADER_LENGTH + key_length;
+    size += KV_HEADER_LENGTH + key_length + entry.length;
+  }
+  journal.close();
+  compacted.close();
+
+  if (ok == false || LittleFS.rename(KV_COMPACT_FILE, KV_JOURNAL_FILE) == false) {
+    LOG_ERROR("kv_store: could not compact %s", KV_JOURNAL_FILE);
+    LittleFS.remove(KV_COMPACT_FILE);
+    return false;
+  }
+
+  for (uint8_t i = 0; i < KV_COUNT; i++) {
+    KV_INDEX[i].offset = offsets[i];
+  }
+  KV_STATS.journal_size = size;
+  KV_STATS.compactions++;
+  return true;
+}
+
+/**
+ * @brief Appends a record to the journal.
+ *
+ * @param key - key
+ *
+ * @param key_length - length of the key
+ *
+ * @param value - value (NULL if the key is removed)
+ *
+ * @param length - length of the value or KV_REMOVED
+ *
+ * @return boolean - true if the record was written
+ *
+ * @details The LittleFS has to be started. If the record could not be written completely the
+ * journal is compacted, so the rest of the record does not hide the records after it.
+ *
+ * @callgraph
+ *
+ * @callergraph
+ */
+boolean kv_append(const char *key, uint8_t key_length, const uint8_t *value, uint16_t length) {
+  uint8_t header[KV_HEADER_LENGTH];
+  uint32_t crc = kv_build_header(header, key, key_length, value, length);
+  uint16_t value_length = length == KV_REMOVED ? 0 : length;
+
+  File journal = LittleFS.open(KV_JOURNAL_FILE, "a");
+  size_t written = 0;
+  if (journal) {
+    written += journal.write(header, KV_HEADER_LENGTH);
+    written += journal.write((const uint8_t *)key, key_length);
+    written += journal.write(value, value_length);
+    journal.close();
+  }
+  if (written != (size_t)KV_HEADER_LENGTH + key_length + value_length) {
+    LOG_ERROR("kv_store: could not append to %s", KV_JOURNAL_FILE);
+    kv_compact_journal();
+    return false;
+  }
+
+  kv_index_set(key, key_length, KV_STATS.journal_size + KV_HEADER_LENGTH + key_length, length, crc);
+  KV_STATS.journal_size += written;
+  KV_STATS.appends++;
+
+  // most of the journal is outdated
+  if (KV_STATS.journal_size > KV_COMPACT_SIZE && kv_live_size() * 2 < KV_STATS.journal_size) {
+    kv_compact_journal();
+  }
+  return true;
+}
+
+/**
+ * @brief Moves an old file into the store.
+ *
+ * @param filename - name of the old file
+ *
+ * @param key - key of its content
+ *
+ * @details The LittleFS has to be started. The file is only removed once its content is in the
+ * journal. /config.txt contained "AP: true" or "AP: false" and becomes "true" or "false".
+ *
+ * @callgraph
+ *
+ * @callergraph
+ */
+void kv_migrate_file(const char *filename, const char *key) {
+  if (LittleFS.exists(filename) == false) {
+    return;
+  }
+
+  File file = LittleFS.open(filename, "r");
+  String content = file.readString();
+  file.close();
+
+  if (strcmp(key, "ap") == 0) {
+    content = content == "AP: true" ? "true" : "false";
+  }
+
+  if (kv_find(key, strlen(key)) < 0 && content.length() > 0 && content.length() <= KV_VALUE_LENGTH) {
+    if (kv_append(key, strlen(key), (const uint8_t *)content.c_str(), content.length()) == false) {
+      return;
+    }
+  }
+  LittleFS.remove(filename);
+  LOG_INFO("kv_store: moved %s into the store", filename);
+}
+
+/**
+ * @brief Reads the journal into the index (once).
+ *
+ * @details Reading stops at the first record that is incomplete or whose CRC does not match.
+ * Such a tail is dropped by compacting the journal, so new records are not appended behind it.
+ *
+ * @callgraph
+ *
+ * @callergraph
+ */
+void kv_load() {
+  if (KV_LOADED) {
+    return;
+  }
+  metrics_scope scope(METRICS_STORAGE);
+  LittleFS.begin();
+
+  // a compaction that was interrupted by a reset (the old journal is still complete)
+  if (LittleFS.exists(KV_COMPACT_FILE)) {
+    LittleFS.remove(KV_COMPACT_FILE);
+  }
+
+  KV_COUNT = 0;
+  uint32_t position = 0;
+  uint32_t size = 0;
+  File journal = LittleFS.open(KV_JOURNAL_FILE, "r");
+  if (journal) {
+    size = journal.size();
+    uint8_t header[KV_HEADER_LENGTH];
+    uint8_t data[KV_KEY_LENGTH + KV_VALUE_LENGTH];
+
+    while (position + KV_HEADER_LENGTH <= size && journal.read(header, KV_HEADER_LENGTH) == KV_HEADER_LENGTH) {
+      uint8_t key_length = header[1];
+      uint16_t length = header[2] | (header[3] << 8);
+      uint16_t value_length = length == KV_REMOVED ? 0 : length;
+      if (header[0] != KV_RECORD_MAGIC || key_length == 0 || key_length > KV_KEY_LENGTH || value_length > KV_VALUE_LENGTH
+          || position + KV_HEADER_LENGTH + key_length + value_length > size
+          || journal.read(data, key_length + value_length) != (size_t)(key_length + value_length)) {
+        break;
+      }
+
+      uint32_t crc = kv_crc32(kv_crc32(0, header + 1, 3), data, key_length + value_length);
+      uint32_t stored_crc = header[4] | (header[5] << 8) | ((uint32_t)header[6] << 16) | ((uint32_t)header[7] << 24);
+      if (crc != stored_crc) {
+        break;
+      }
+
+      kv_index_set((const char *)data, key_length, position + KV_HEADER_LENGTH + key_length, length, crc);
+      position += KV_HEADER_LENGTH + key_length + value_length;
+    }
+    journal.close();
+  }
+
+  KV_STATS.journal_size = position;
+  KV_LOADED = true;
+
+  if (position < size) {
+    LOG_WARN("kv_store: dropped %u damaged bytes at the end of %s", (unsigned)(size - position), KV_JOURNAL_FILE);
+    KV_STATS.dropped_bytes += size - position;
+    kv_compact_journal();
+  }
+
+  kv_migrate_file("/config.txt", "ap");
+  kv_migrate_file("/password.txt", "password");
+  kv_migrate_file("/time.json", "time");
+
+  LittleFS.end();
+}
+
+/**
+ * @brief Reads the current value of a key.
+ *
+ * @param key - key
+ *
+ * @param value - KV_VALUE_LENGTH + 1 bytes, the value is terminated
+ *
+ * @return int - length of the value or -1 if the key is not in the store
+ *
+ * @callgraph
+ *
+ * @callergraph
+ */
+int kv_read(const String &key, char *value) {
+  kv_load();
+  int position = kv_find(key.c_str(), key.length());
+  if (position < 0) {
+    return -1;
+  }
+  metrics_scope scope(METRICS_STORAGE);
+
+  LittleFS.begin();
+  File journal = LittleFS.open(KV_JOURNAL_FILE, "r");
+  size_t length = 0;
+  if (journal && journal.seek(KV_INDEX[position].offset, SeekSet)) {
+    length = journal.read((uint8_t *)value, KV_INDEX[position].length);
+  }
+  journal.close();
+  LittleFS.end();
+
+  value[length] = '\0';
+  return length == KV_INDEX[position].length ? (int)length : -1;
+}
+
+/**
+ * @brief Writes a value or removes a key.
+ *
+ * @param key - key (at most KV_KEY_LENGTH bytes)
+ *
+ * @param value - value (NULL if the key is removed)
+ *
+ * @param length - length of the value (at most KV_VALUE_LENGTH bytes) or KV_REMOVED
+ *
+ * @return boolean - true if the store holds the value afterwards
+ *
+ * @details Nothing is written if the key already has this value.
+ *
+ * @callgraph
+ *
+ * @callergraph
+ */
+boolean kv_write(const String &key, const uint8_t *value, uint16_t length) {
+  if (key.length() == 0 || key.length() > KV_KEY_LENGTH || (length > KV_VALUE_LENGTH && length != KV_REMOVED)) {
+    LOG_ERROR("kv_store: invalid key or value: %s", key.c_str());
+    return false;
+  }
+  kv_load();
+  metrics_scope scope(METRICS_STORAGE);
+
+  int position = kv_find(key.c_str(), key.length());
+  if (length == KV_REMOVED && position < 0) {
+    return true;
+  }
+  if (length != KV_REMOVED && position < 0 && KV_COUNT == KV_MAX_KEYS) {
+    LOG_ERROR("kv_store: no room for key %s", key.c_str());
+    return false;
+  }
+  if (position >= 0 && length != KV_REMOVED) {
+    uint8_t header[KV_HEADER_LENGTH];
+    if (KV_INDEX[position].length == length && KV_INDEX[position].crc == kv_build_header(header, key.c_str(), key.length(), value, length)) {
+      KV_STATS.skipped_writes++;
+      return true;
+    }
+  }
+
+  LittleFS.begin();
+  boolean written = kv_append(key.c_str(), key.length(), value, length);
+  LittleFS.end();
+  return written;
+}
+
+/**
+ * @brief Writes a value.
+ *
+ * @param key - key (at most KV_KEY_LENGTH characters)
+ *
+ * @param value - value (at most KV_VALUE_LENGTH characters)
+ *
+ * @return boolean - true if the value was written
+ *
+ * @callgraph
+ *
+ * @callergraph
+ */
+boolean kv_put(const String &key, const String &value) {
+  return kv_write(key, (const uint8_t *)value.c_str(), value.length());
+}
+
+/**
+ * @brief Reads a value.
+ *
+ * @param key - key
+ *
+ * @return String - value or "" if the key is not in the store
+ *
+ * @callgraph
+ *
+ * @callergraph
+ */
+String kv_get(const String &key) {
+  char value[KV_VALUE_LENGTH + 1];
+  if (kv_read(key, value) < 0) {
+    return "";
+  }
+  return String(value);
+}
+
+/**
+ * @brief Checks if a key is in the store.
+ *
+ * @param key - key
+ *
+ * @return boolean - true if the key has a value
+ *
+ * @callgraph
+ *
+ * @callergraph
+ */
+boolean kv_contains(const String &key) {
+  kv_load();
+  return kv_find(key.c_str(), key.length()) >= 0;
+}
+
+/**
+ * @brief Removes a key.
+ *
+ * @param key - key
+ *
+ * @return boolean - true if the key is not in the store anymore
+ *
+ * @callgraph
+ *
+ * @callergraph
+ */
+boolean kv_remove(const String &key) {
+  return kv_write(key, NULL, KV_REMOVED);
+}
+
+/**
+ * @brief Writes a JSON document as value.
+ *
+ * @param key - key
+ *
+ * @param doc - JSON document (serialized at most KV_VALUE_LENGTH bytes)
+ *
+ * @return boolean - true if the document was written
+ *
+ * @callgraph
+ *
+ * @callergraph
+ */
+boolean kv_save_json(const String &key, const JsonDocument &doc) {
+  char value[KV_VALUE_LENGTH + 1];
+  size_t length = serializeJson(doc, value, sizeof(value));
+  if (length >= sizeof(value) - 1) {
+    LOG_ERROR("kv_store: %s is too long", key.c_str());
+    return false;
+  }
+  return kv_write(key, (const uint8_t *)value, length);
+}
+
+/**
+ * @brief Reads a JSON document from a value.
+ *
+ * @param key - key
+ *
+ * @param doc - JSON document of the caller, is cleared and filled with the value
+ *
+ * @return boolean - true if the key is in the store and holds valid JSON (the document is empty otherwise)
+ *
+ * @callgraph
+ *
+ * @callergraph
+ */
+boolean kv_load_json(const String &key, JsonDocument &doc) {
+  StaticJsonDocument<16> filter;
+  filter.set(true);
+  return kv_load_json(key, doc, filter);
+}
+
+/**
+ * @brief Reads the needed fields of a JSON document from a value.
+ *
+ * @param key - key
+ *
+ * @param doc - JSON document of the caller, is cleared and filled with the value
+ *
+ * @param filter - fields that are needed (see load_json())
+ *
+ * @return boolean - true if the key is in the store and holds valid JSON (the document is empty otherwise)
+ *
+ * @callgraph
+ *
+ * @callergraph
+ */
+boolean kv_load_json(const String &key, JsonDocument &doc, const JsonDocument &filter) {
+  doc.clear();
+  char value[KV_VALUE_LENGTH + 1];
+  int length = kv_read(key, value);
+  if (length < 0) {
+    return false;
+  }
+  if (deserializeJson(doc, (const char *)value, length, DeserializationOption::Filter(filter.as<JsonVariantConst>()))) {
+    LOG_ERROR("kv_store: %s is not valid JSON", key.c_str());
+    doc.clear();
+    return false;
+  }
+  return true;
+}
+
+/**
+ * @brief Compacts the journal now.
+ *
+ * @return boolean - true if the journal was compacted
+ *
+ * @callgraph
+ *
+ * @callergraph
+ */
+boolean kv_compact() {
+  kv_load();
+  metrics_scope scope(METRICS_STORAGE);
+  LittleFS.begin();
+  boolean compacted = kv_compact_journal();
+  LittleFS.end();
+  return compacted;
+}
+
+/**
+ * @brief Forgets the index, the journal is read again on the next access (like after a reset).
+ *
+ * @callgraph This function does not call any other function.
+ *
+ * @callergraph
+ */
+void kv_unload() {
+  KV_COUNT = 0;
+  KV_LOADED = false;
+}
+
+/**
+ * @brief Deletes the store (journal and index).
+ *
+ * @details The journal is read again on the next access, including the old files if they exist.
+ *
+ * @callgraph
+ *
+ * @callergraph
+ */
+void kv_reset() {
+  LittleFS.begin();
+  LittleFS.remove(KV_JOURNAL_FILE);
+  LittleFS.remove(KV_COMPACT_FILE);
+  LittleFS.end();
+
+  kv_unload();
+  KV_STATS = {0, 0, 0, 0, 0, 0, 0};
+}
+
+/**
+ * @brief Returns the counters of the store.
+ *
+ * @return kv_store_stats - counters
+ *
+ * @callgraph
+ *
+ * @callergraph
+ */
+kv_store_stats get_kv_stats() {
+  kv_load();
+  kv_store_stats stats = KV_STATS;
+  stats.keys = KV_COUNT;
+  stats.live_size = kv_live_size();
+  return stats;
+}
@@ -0,0 +1,418 @@
+/**
+ * @file learning.cpp
+ *
+ * @author Marc Ubbelohde
+ *
+ * @brief In this file, the learning session is defined.
+ *
+ * @details Recording a remote used to take one round trip per button, and every round trip
+ * created a new IR-Receiver, waited up to 10 s in capture_signal(), went through the
+ * resultToSourceCode() String and mounted the LittleFS. A learning session gets the names of all
+ * buttons at once and captures them in order with one receiver that stays enabled, polled from
+ * loop() so the webserver keeps running. Repeat frames of a held button are ignored and a button
+ * that was already learned in this session is reported as duplicate. The learned signals are kept
+ * in RAM and written in one go when the session ends (or when LEARN_MAX_PENDING is reached).
+ * The progress is served on GET /api/learn and published as learn events.
+ */
+
+#include "base.h"
+
+/**
+ * @brief Progress of the current (or last) session.
+ *
+ */
+learning_session LEARN_SESSION = {false, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, ""};
+
+/**
+ * @brief Signals of the current (or last) session.
+ *
+ */
+learn_signal *LEARN_SIGNALS = NULL;
+
+/**
+ * @brief IR-Receiver of the session (NULL if no session is active).
+ *
+ */
+IRrecv *LEARN_RECEIVER = NULL;
+
+/**
+ * @brief LED state before the session.
+ *
+ */
+led_state LEARN_PREVIOUS_LED_STATE = LED_IDLE;
+
+/**
+ * @brief Calculates a fingerprint of a decoded capture to recognize the same button.
+ *
+ * @param results - decoded capture
+ *
+ * @return uint32_t - FNV-1a hash of the protocol, the number of bits and the value or state
+ *
+ * @details Unknown protocols are decoded to a hash of their timings by IRremoteESP8266, so they
+ * can be compared the same way.
+ *
+ * @callgraph This function does not call any other function.
+ *
+ * @callergraph
+ */
+uint32_t capture_fingerprint(const decode_results &results) {
+  uint32_t hash = 2166136261UL;
+  uint8_t header[3] = {(uint8_t)results.decode_type, (uint8_t)(results.bits >> 8), (uint8_t)results.bits};
+
+  for (int i = 0; i < 3; i++) {
+    hash = (hash ^ header[i]) * 16777619UL;
+  }
+
+  if (hasACState(results.decode_type)) {
+    for (uint16_t i = 0; i < results.bits / 8; i++) {
+      hash = (hash ^ results.state[i]) * 16777619UL;
+    }
+  }
+  else {
+    for (int i = 0; i < 64; i += 8) {
+      hash = (hash ^ (uint8_t)(results.value >> i)) * 16777619UL;
+    }
+  }
+  return hash;
+}
+
+/**
+ * @brief Publishes the progress of the session as learn event.
+ *
+ * @details Names are alphanumeric and at most 21 characters long, so the data always fits.
+ *
+ * @callgraph
+ *
+ * @callergraph
+ */
+void publish_learning_progress() {
+  const char *current = "";
+  if (LEARN_SESSION.active && LEARN_SESSION.index < LEARN_SESSION.count) {
+    current = LEARN_SIGNALS[LEARN_SESSION.index].name.c_str();
+  }
+  publish_event(EVENT_LEARN, PSTR("{\"job\":%u,\"active\":%s,\"index\":%u,\"count\":%u,\"current\":\"%s\",\"learned\":%u,\"skipped\":%u,\"duplicates\":%u}"),
+    LEARN_SESSION.job_id, LEARN_SESSION.active ? "true" : "false", LEARN_SESSION.index, LEARN_SESSION.count, current,
+    LEARN_SESSION.learned, LEARN_SESSION.skipped, LEARN_SESSION.duplicates);
+}
+
+/**
+ * @brief Writes the learned signals that are still in RAM to the LittleFS.
+ *
+ * @details All files are written while the LittleFS is mounted once. Every file is written to
+ * REPLACE_TEMP_FILE first, which then replaces the old file in one rename, so a reset while
+ * writing keeps the old signal.
+ *
+ * @callgraph
+ *
+ * @callergraph
+ */
+void write_learned_signals() {
+  metrics_scope scope(METRICS_STORAGE);
+
+  if (LEARN_SESSION.pending == 0) {
+    return;
+  }
+
+  LittleFS.begin();
+  for (uint8_t i = 0; i < LEARN_SESSION.count; i++) {
+    learn_signal &signal = LEARN_SIGNALS[i];
+    if (signal.json == "") {
+      continue;
+    }
+
+    String filename = "/signals/" + signal.name + ".json";
+    File file = LittleFS.open(REPLACE_TEMP_FILE, "w");
+    boolean written = file && file.print(signal.json) == signal.json.length();
+    file.close();
+    if (written == false || LittleFS.rename(REPLACE_TEMP_FILE, filename) == false) {
+      LOG_ERROR("learning: Failed to write file: %s", filename.c_str());
+      LittleFS.remove(REPLACE_TEMP_FILE);
+    }
+    signal.json = "";
+  }
+  LittleFS.end();
+
+  LEARN_SESSION.pending = 0;
+}
+
+/**
+ * @brief Ends the session.
+ *
+ * @param message - message of the session
+ *
+ * @callgraph
+ *
+ * @callergraph
+ */
+void finish_learning(String message) {
+  stop_receiver();
+  LEARN_RECEIVER = NULL;
+
+  write_learned_signals();
+
+  job_end(LEARN_SESSION.job_id);
+  led_set_state(LEARN_PREVIOUS_LED_STATE);
+
+  LEARN_SESSION.active = false;
+  LEARN_SESSION.message = message;
+  LOG_INFO("learning: %s", message.c_str());
+  publish_learning_progress();
+}
+
+/**
+ * @brief Continues with the next signal or ends the session after the last one.
+ *
+ * @callgraph
+ *
+ * @callergraph
+ */
+void next_learning_signal() {
+  LEARN_SESSION.index++;
+  LEARN_SESSION.signal_start = millis();
+
+  if (LEARN_SESSION.pending > LEARN_MAX_PENDING) {
+    write_learned_signals();
+  }
+
+  if (LEARN_SESSION.index >= LEARN_SESSION.count) {
+    finish_learning("successfully learned " + String(LEARN_SESSION.learned) + " of " + String(LEARN_SESSION.count) + " signals");
+    return;
+  }
+  publish_learning_progress();
+}
+
+/**
+ * @brief Handles a capture of the session.
+ *
+ * @param results - decoded capture
+ *
+ * @details Repeat frames (and the same signal again within LEARN_REPEAT_TIME) are ignored. A signal
+ * that was already learned for another name is reported as duplicate and the session keeps waiting
+ * for the current name. Otherwise the signal file is built like save_signal() does (generic signal
+ * if possible, raw timings if not) and kept until it is written.
+ *
+ * @callgraph
+ *
+ * @callergraph
+ */
+void learn_capture(const decode_results &results) {
+
+  // repeat frames of a held button
+  if (results.overflow == true || results.repeat == true) {
+    return;
+  }
+  uint32_t fingerprint = capture_fingerprint(results);
+  unsigned long now = millis();
+  if (fingerprint == LEARN_SESSION.last_fingerprint && now - LEARN_SESSION.last_capture < LEARN_REPEAT_TIME) {
+    LEARN_SESSION.last_capture = now;
+    return;
+  }
+  LEARN_SESSION.last_fingerprint = fingerprint;
+  LEARN_SESSION.last_capture = now;
+
+  learn_signal &signal = LEARN_SIGNALS[LEARN_SESSION.index];
+
+  // button was already learned for another name
+  for (uint8_t i = 0; i < LEARN_SESSION.index; i++) {
+    if (LEARN_SIGNALS[i].state == LEARN_LEARNED && LEARN_SIGNALS[i].fingerprint == fingerprint) {
+      LEARN_SESSION.duplicates++;
+      LEARN_SESSION.message = "duplicate of " + LEARN_SIGNALS[i].name + ", waiting for " + signal.name;
+      control_led_output("no_signal");
+      publish_learning_progress();
+      return;
+    }
+  }
+
+  // build signal file like save_capture()
+  json_document doc(JSON_FILE_CAPACITY);
+  doc["name"] = signal.name;
+  String sequence;
+  build_signal_json(results, doc, sequence);
+
+  signal.json = "";
+  serializeJson(doc, signal.json);
+  signal.fingerprint = fingerprint;
+  signal.state = LEARN_LEARNED;
+  LEARN_SESSION.learned++;
+  LEARN_SESSION.pending += signal.json.length();
+  LEARN_SESSION.message = "learned " + signal.name;
+  control_led_output("signal_received");
+
+  next_learning_signal();
+}
+
+/**
+ * @brief Starts a learning session.
+ *
+ * @param names - names of the signals in the order they are captured, separated by commas
+ *
+ * @return String - message with the id of the job of the session or error message if a name is
+ * invalid or another job is running
+ *
+ * @details The session is continued by update_learning() and can be canceled on
+ * /api/jobs/{id}/cancel or with the button.
+ *
+ * @callgraph
+ *
+ * @callergraph
+ */
+String start_learning(String names) {
+
+  // only one job runs at a time
+  String busy;
+  if (job_busy(busy)) {
+    return("Error: " + busy);
+  }
+
+  // count and check names
+  names += ",";
+  int count = 0;
+  for (int start = 0; start < (int)names.length(); start = names.indexOf(",", start) + 1) {
+    String name = names.substring(start, names.indexOf(",", start));
+    name.trim();
+    if (name == "" || name.length() > 21 || check_if_string_is_alphanumeric(name) == false) {
+      return("Error: invalid signal name: \"" + name + "\"");
+    }
+    count++;
+  }
+  if (count > LEARN_MAX_SIGNALS) {
+    return("Error: more than " + String(LEARN_MAX_SIGNALS) + " signals");
+  }
+
+  // set up session
+  delete[] LEARN_SIGNALS;
+  LEARN_SIGNALS = new learn_signal[count];
+  int index = 0;
+  for (int start = 0; start < (int)names.length(); start = names.indexOf(",", start) + 1) {
+    LEARN_SIGNALS[index].name = names.substring(start, names.indexOf(",", start));
+    LEARN_SIGNALS[index].name.trim();
+    LEARN_SIGNALS[index].state = LEARN_WAITING;
+    LEARN_SIGNALS[index].fingerprint = 0;
+    LEARN_SIGNALS[index].json = "";
+    index++;
+  }
+
+  LEARN_SESSION.active = true;
+  LEARN_SESSION.job_id = job_begin(JOB_LEARN);
+  LEARN_SESSION.count = count;
+  LEARN_SESSION.index = 0;
+  LEARN_SESSION.learned = 0;
+  LEARN_SESSION.skipped = 0;
+  LEARN_SESSION.duplicates = 0;
+  LEARN_SESSION.signal_start = millis();
+  LEARN_SESSION.last_capture = 0;
+  LEARN_SESSION.last_fingerprint = 0;
+  LEARN_SESSION.pending = 0;
+  LEARN_SESSION.message = "";
+
+  // one receiver for the whole session
+  LEARN_RECEIVER = start_receiver();
+  LEARN_PREVIOUS_LED_STATE = led_set_state(LED_CAPTURING);
+  publish_learning_progress();
+
+  return("successfully started learning " + String(count) + " signals (job " + String(LEARN_SESSION.job_id) + ")");
+}
+
+/**
+ * @brief Continues the learning session.
+ *
+ * @return boolean - true if the session ended in this call (its message is in get_learning_session())
+ *
+ * @details Called from loop(). Checks the receiver for a capture, skips the current signal after
+ * LEARN_SIGNAL_TIMEOUT and ends the session if it was canceled.
+ *
+ * @callgraph
+ *
+ * @callergraph
+ */
+boolean update_learning() {
+  if (LEARN_SESSION.active == false) {
+    return false;
+  }
+
+  if (job_cancelled()) {
+    finish_learning("learning was canceled by the user (" + String(LEARN_SESSION.learned) + " of " + String(LEARN_SESSION.count) + " signals learned)");
+    return true;
+  }
+
+  decode_results results;
+  if (LEARN_RECEIVER->decode(&results)) {
+    learn_capture(results);
+  }
+  else if (millis() - LEARN_SESSION.signal_start > LEARN_SIGNAL_TIMEOUT) {
+    LEARN_SIGNALS[LEARN_SESSION.index].state = LEARN_SKIPPED;
+    LEARN_SESSION.skipped++;
+    LEARN_SESSION.message = "skipped " + LEARN_SIGNALS[LEARN_SESSION.index].name;
+    control_led_output("no_signal");
+    next_learning_signal();
+  }
+
+  return LEARN_SESSION.active == false;
+}
+
+/**
+ * @brief Returns the progress of the current (or last) learning session.
+ *
+ * @return learning_session - copy of the progress
+ *
+ * @callgraph This function does not call any other function.
+ *
+ * @callergraph
+ */
+learning_session get_learning_session() {
+  return LEARN_SESSION;
+}
+
+/**
+ * @brief Prints the progress of the current (or last) learning session as JSON.
+ *
+ * @param output - Print to write to (e.g. the WiFiClient or a metrics_byte_counter)
+ *
+ * @return size_t - number of bytes written
+ *
+ * @details Names are alphanumeric, so nothing has to be escaped. Format:
+ * {"active":true,"job":3,"count":2,"index":1,"current":"off","learned":1,"skipped":0,
+ * "duplicates":0,"message":"learned on","signals":[{"name":"on","state":"learned"},...]}
+ *
+ * @callgraph This function does not call any other function.
+ *
+ * @callergraph
+ */
+size_t print_learning_json(Print &output) {
+  const char *states[] = {"waiting", "learned", "skipped"};
+  size_t written = 0;
+
+  written += output.print("{\"active\":");
+  written += output.print(LEARN_SESSION.active ? "true" : "false");
+  written += output.print(",\"job\":");
+  written += output.print(LEARN_SESSION.job_id);
+  written += output.print(",\"count\":");
+  written += output.print(LEARN_SESSION.count);
+  written += output.print(",\"index\":");
+  written += output.print(LEARN_SESSION.index);
+  written += output.print(",\"current\":\"");
+  if (LEARN_SESSION.active) {
+    written += output.print(LEARN_SIGNALS[LEARN_SESSION.index].name);
+  }
+  written += output.print("\",\"learned\":");
+  written += output.print(LEARN_SESSION.learned);
+  written += output.print(",\"skipped\":");
+  written += output.print(LEARN_SESSION.skipped);
+  written += output.print(",\"duplicates\":");
+  written += output.print(LEARN_SESSION.duplicates);
+  written += output.print(",\"message\":\"");
+  written += output.print(LEARN_SESSION.message);
+  written += output.print("\",\"signals\":[");
+  for (uint8_t i = 0; i < LEARN_SESSION.count && LEARN_SIGNALS != NULL; i++) {
+    if (i > 0) {
+      written += output.print(",");
+    }
+    written += output.print("{\"name\":\"");
+    written += output.print(LEARN_SIGNALS[i].name);
+    written += output.print("\",\"state\":\"");
+    written += output.print(states[LEARN_SIGNALS[i].state]);
+    written += output.print("\"}");
+  }
+  written += output.print("]}");
+  return written;
+}
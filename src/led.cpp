@@ -0,0 +1,177 @@
+/**
+ * @file led.cpp
+ *
+ * @author Marc Ubbelohde
+ *
+ * @brief In this file, the LED pattern sequencer is defined.
+ *
+ * @details The status LED used to be blinked with chains of delay(100), which blocked the caller
+ * for up to 700 ms (e.g. between a capture and saving it, or on every boot). Patterns are now
+ * played step by step from a Ticker: every step switches the LED and schedules the next step after
+ * its duration, so starting a pattern returns immediately and no polling is needed while the LED
+ * does not change. Besides one-shot patterns (blinks) the LED shows an ongoing state such as
+ * "capturing", "transmitting" or "program running", which it returns to after a one-shot pattern.
+ */
+
+#include "base.h"
+#include <Ticker.h>
+
+/**
+ * @brief Patterns of the ongoing states (same order as led_state).
+ *
+ */
+const led_pattern LED_STATE_PATTERNS[LED_STATE_COUNT] = {
+  {LOW, 0, false, {}},           // idle: off
+  {HIGH, 0, false, {}},          // capturing: on
+  {HIGH, 0, false, {}},          // transmitting: on
+  {HIGH, 2, true, {100, 900}}    // program running: short flash every second
+};
+
+/**
+ * @brief Timer that calls update_led() at the end of the current step.
+ *
+ */
+Ticker LED_TICKER;
+
+/**
+ * @brief One-shot pattern that is played (copied, so callers can pass temporaries).
+ *
+ */
+led_pattern LED_ONE_SHOT;
+
+/**
+ * @brief True while the one-shot pattern is played.
+ *
+ */
+boolean LED_PLAYING = false;
+
+/**
+ * @brief Current ongoing state.
+ *
+ */
+led_state LED_STATE = LED_IDLE;
+
+/**
+ * @brief Step of the current pattern.
+ *
+ */
+uint8_t LED_STEP = 0;
+
+/**
+ * @brief Sets the LED to the current step and schedules the next step.
+ *
+ * @details Patterns without steps are steady levels and do not need the timer.
+ *
+ * @callgraph This function does not call any other function.
+ *
+ * @callergraph
+ */
+void apply_led_step() {
+  const led_pattern &pattern = LED_PLAYING ? LED_ONE_SHOT : LED_STATE_PATTERNS[LED_STATE];
+
+  pinMode(LED_PIN, OUTPUT);
+  digitalWrite(LED_PIN, (LED_STEP % 2 == 0) ? pattern.first_level : !pattern.first_level);
+
+  if (pattern.count == 0) {
+    LED_TICKER.detach();
+    return;
+  }
+  LED_TICKER.once_ms(pattern.steps[LED_STEP], update_led);
+}
+
+/**
+ * @brief Plays a one-shot pattern without blocking.
+ *
+ * @param pattern - pattern to be played, a pattern that is already playing is replaced
+ *
+ * @details After the last step the LED returns to the current state. Repeating patterns
+ * are played until the next call of led_play() or led_set_state().
+ *
+ * @callgraph
+ *
+ * @callergraph
+ */
+void led_play(const led_pattern &pattern) {
+  if (pattern.count == 0 || pattern.count > LED_MAX_STEPS) {
+    return;
+  }
+  LED_ONE_SHOT = pattern;
+  LED_PLAYING = true;
+  LED_STEP = 0;
+  apply_led_step();
+}
+
+/**
+ * @brief Sets the ongoing state of the LED.
+ *
+ * @param state - new state
+ *
+ * @return led_state - previous state, so callers can restore it when they are done
+ *
+ * @details A one-shot pattern that is playing is finished first.
+ *
+ * @callgraph
+ *
+ * @callergraph
+ */
+led_state led_set_state(led_state state) {
+  led_state previous = LED_STATE;
+  if (state == LED_STATE || state >= LED_STATE_COUNT) {
+    return previous;
+  }
+  LED_STATE = state;
+  if (LED_PLAYING == false) {
+    LED_STEP = 0;
+    apply_led_step();
+  }
+  return previous;
+}
+
+/**
+ * @brief Returns the ongoing state of the LED.
+ *
+ * @return led_state - current state
+ *
+ * @callgraph This function does not call any other function.
+ *
+ * @callergraph
+ */
+led_state led_get_state() {
+  return LED_STATE;
+}
+
+/**
+ * @brief Returns if a one-shot pattern is playing.
+ *
+ * @return boolean - true if a one-shot pattern is playing
+ *
+ * @callgraph This function does not call any other function.
+ *
+ * @callergraph
+ */
+boolean led_is_playing() {
+  return LED_PLAYING;
+}
+
+/**
+ * @brief Advances the current pattern by one step.
+ *
+ * @details Called by the Ticker at the end of every step. After the last step repeating
+ * patterns start over and one-shot patterns hand the LED back to the current state.
+ *
+ * @callgraph
+ *
+ * @callergraph
+ */
+void update_led() {
+  const led_pattern &pattern = LED_PLAYING ? LED_ONE_SHOT : LED_STATE_PATTERNS[LED_STATE];
+
+  LED_STEP++;
+  if (LED_STEP >= pattern.count) {
+    if (LED_PLAYING == true && pattern.repeat == false) {
+      LED_PLAYING = false;
+    }
+    LED_STEP = 0;
+  }
+  apply_led_step();
+}
@@ -0,0 +1,260 @@
+/**
+ * @file log.cpp
+ *
+ * @author Marc Ubbelohde
+ *
+ * @brief In this file, the leveled logger is defined.
+ *
+ * @details Printing to Serial blocks as soon as the UART FIFO is full, so every message used to
+ * cost about 87 us per character at 115200 baud, e.g. in the middle of recording a signal. Now
+ * messages are formatted on the stack and copied into a fixed ring buffer, without allocating. The
+ * background work (update_log()) only writes as much of the buffer to Serial as fits into the FIFO
+ * without waiting. The buffer also keeps the last messages for /api/log. If Serial can not keep up,
+ * the oldest messages are overwritten and counted as dropped.
+ */
+
+#include "base.h"
+
+/**
+ * @brief Ring buffer of the log (text, one message per line).
+ *
+ */
+char LOG_BUFFER[LOG_BUFFER_SIZE];
+
+/**
+ * @brief Number of bytes written to the log since the start (the position is LOG_WRITTEN % LOG_BUFFER_SIZE).
+ *
+ */
+uint32_t LOG_WRITTEN = 0;
+
+/**
+ * @brief Number of bytes of the log that were written to Serial or dropped.
+ *
+ */
+uint32_t LOG_SENT = 0;
+
+/**
+ * @brief Number of bytes that were overwritten before they were written to Serial.
+ *
+ */
+uint32_t LOG_DROPPED = 0;
+
+/**
+ * @brief Letter of every level in the output.
+ *
+ */
+const char LOG_LEVEL_LETTERS[] = "-EWID";
+
+/**
+ * @brief Writer for raw text.
+ *
+ */
+log_writer LOG_WRITER;
+
+/**
+ * @brief Appends text to the ring buffer.
+ *
+ * @param data - text to be appended
+ *
+ * @param length - length of the text
+ *
+ * @details If the text is longer than the buffer only its end is kept.
+ *
+ * @callgraph This function does not call any other function.
+ *
+ * @callergraph
+ */
+void append_log(const char *data, size_t length) {
+  if (length > LOG_BUFFER_SIZE) {
+    data += length - LOG_BUFFER_SIZE;
+    LOG_WRITTEN += length - LOG_BUFFER_SIZE;
+    length = LOG_BUFFER_SIZE;
+  }
+
+  while (length > 0) {
+    size_t position = LOG_WRITTEN % LOG_BUFFER_SIZE;
+    size_t chunk = min(length, LOG_BUFFER_SIZE - position);
+    memcpy(LOG_BUFFER + position, data, chunk);
+    LOG_WRITTEN += chunk;
+    data += chunk;
+    length -= chunk;
+  }
+}
+
+/**
+ * @brief Writes one character to the log.
+ *
+ * @param c - character
+ *
+ * @return size_t - 1
+ *
+ * @callgraph
+ *
+ * @callergraph
+ */
+size_t log_writer::write(uint8_t c) {
+  append_log((const char *)&c, 1);
+  return 1;
+}
+
+/**
+ * @brief Writes text to the log.
+ *
+ * @param buffer - text
+ *
+ * @param size - length of the text
+ *
+ * @return size_t - size
+ *
+ * @callgraph
+ *
+ * @callergraph
+ */
+size_t log_writer::write(const uint8_t *buffer, size_t size) {
+  append_log((const char *)buffer, size);
+  return size;
+}
+
+/**
+ * @brief Formats a message and adds it to the log.
+ *
+ * @param level - level of the message (LOG_LEVEL_ERROR ... LOG_LEVEL_DEBUG)
+ *
+ * @param format - printf format (in flash, see PSTR())
+ *
+ * @details Do not use directly, use LOG_ERROR(), LOG_WARN(), LOG_INFO() or LOG_DEBUG() instead so
+ * the message is compiled out below LOG_LEVEL. The message is prefixed with the time in ms and the
+ * letter of the level, e.g. "[1234] I AP started", and cut to LOG_LINE_LENGTH.
+ *
+ * @callgraph
+ *
+ * @callergraph
+ */
+void log_message(uint8_t level, const char *format, ...) {
+  char line[LOG_LINE_LENGTH];
+
+  int prefix = snprintf(line, sizeof(line), "[%lu] %c ", millis(), LOG_LEVEL_LETTERS[level <= LOG_LEVEL_DEBUG ? level : 0]);
+
+  // leave one byte for the newline
+  va_list arguments;
+  va_start(arguments, format);
+  int length = vsnprintf_P(line + prefix, sizeof(line) - prefix - 1, format, arguments);
+  va_end(arguments);
+  if (length < 0) {
+    return;
+  }
+
+  size_t total = prefix + min((size_t)length, sizeof(line) - prefix - 2);
+  line[total] = '\n';
+  append_log(line, total + 1);
+}
+
+/**
+ * @brief Deletes all messages.
+ *
+ * @callgraph This function does not call any other function.
+ *
+ * @callergraph
+ */
+void reset_log() {
+  LOG_WRITTEN = 0;
+  LOG_SENT = 0;
+  LOG_DROPPED = 0;
+}
+
+/**
+ * @brief Writes as much of the log to Serial as fits without waiting.
+ *
+ * @details Called from the background work. Messages that were overwritten before they could be
+ * written are counted in LOG_DROPPED.
+ *
+ * @callgraph
+ *
+ * @callergraph
+ */
+void update_log() {
+  if (LOG_WRITTEN - LOG_SENT > LOG_BUFFER_SIZE) {
+    LOG_DROPPED += LOG_WRITTEN - LOG_SENT - LOG_BUFFER_SIZE;
+    LOG_SENT = LOG_WRITTEN - LOG_BUFFER_SIZE;
+  }
+
+  int room = Serial.availableForWrite();
+  if (room <= 0) {
+    return;
+  }
+
+  size_t length = min((size_t)(LOG_WRITTEN - LOG_SENT), (size_t)room);
+  while (length > 0) {
+    size_t position = LOG_SENT % LOG_BUFFER_SIZE;
+    size_t chunk = min(length, LOG_BUFFER_SIZE - position);
+    Serial.write((const uint8_t *)LOG_BUFFER + position, chunk);
+    LOG_SENT += chunk;
+    length -= chunk;
+  }
+}
+
+/**
+ * @brief Writes the whole log to Serial and waits until it is written.
+ *
+ * @details Only for places where the background work does not run anymore (e.g. before the
+ * program stalls).
+ *
+ * @callgraph
+ *
+ * @callergraph
+ */
+void flush_log() {
+  while (LOG_SENT != LOG_WRITTEN) {
+    update_log();
+    yield();
+  }
+  Serial.flush();
+}
+
+/**
+ * @brief Prints the messages that are in the ring buffer.
+ *
+ * @param output - Print to write to (e.g. the WiFiClient or a metrics_byte_counter)
+ *
+ * @return size_t - number of bytes written
+ *
+ * @details If the buffer was overwritten the first, partly overwritten, message is skipped.
+ *
+ * @callgraph This function does not call any other function.
+ *
+ * @callergraph
+ */
+size_t print_log(Print &output) {
+  uint32_t start = LOG_WRITTEN > LOG_BUFFER_SIZE ? LOG_WRITTEN - LOG_BUFFER_SIZE : 0;
+
+  if (start > 0) {
+    while (start != LOG_WRITTEN && LOG_BUFFER[start % LOG_BUFFER_SIZE] != '\n') {
+      start++;
+    }
+    if (start != LOG_WRITTEN) {
+      start++;
+    }
+  }
+
+  size_t written = 0;
+  while (start != LOG_WRITTEN) {
+    size_t position = start % LOG_BUFFER_SIZE;
+    size_t chunk = min((size_t)(LOG_WRITTEN - start), LOG_BUFFER_SIZE - position);
+    written += output.write((const uint8_t *)LOG_BUFFER + position, chunk);
+    start += chunk;
+  }
+  return written;
+}
+
+/**
+ * @brief Returns the number of bytes that were overwritten before they were written to Serial.
+ *
+ * @return uint32_t - number of dropped bytes
+ *
+ * @callgraph This function does not call any other function.
+ *
+ * @callergraph
+ */
+uint32_t get_log_dropped() {
+  return LOG_DROPPED;
+}
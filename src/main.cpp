@@ -18,7 +18,9 @@
  * @details This function is called once at the start of the program. It
  * checks the configuration file and start either the Access Point or
  * the WFiManager. It also starts the webserver and initializes the
- * time file. Optionally, unit tests can be run.
+ * time file. The time and the running program are restored from the RTC user
+ * memory first, so they are back after a reset before the Wi-Fi is up.
+ * Optionally, unit tests can be run.
  * 
  * @callgraph
  * 
@@ -27,6 +29,7 @@
 void setup() {
   Serial.begin(115200);
   Serial.setDebugOutput(true);
+  init_cancel_button();
   delay(500);
 
   // optional: run tests (uncomment "include tests.h" in main.h before production)
@@ -34,25 +37,13 @@ void setup() {
   //run_all_tests(false);
   //run_all_empirical_tests(false);
 
-  // start LittleFS
-  LittleFS.begin();
-
-  // read config file (if ESP is in AP mode or not)
-  File configFile = LittleFS.open("/config.txt", "r");
-
-  // get content of file
-  String content = configFile.readString();
-  configFile.close();
-
-  // end LittleFS
-  LittleFS.end();
+  // continue the clock and the program from before a reset
+  boolean restored = restore_rtc_state() && (get_rtc_state().flags & RTC_CLOCK_VALID);
 
   // AP is true
-  if (content == "AP: true") {
-    // read password file
-    File passwordFile = LittleFS.open("/password.txt", "r");
-    String password = passwordFile.readString();
-    passwordFile.close();
+  if (kv_get("ap") == "true") {
+    // read password
+    String password = kv_get("password");
 
     // set password to default if empty
     if(password == "") {
@@ -61,14 +52,19 @@ void setup() {
 
     WiFi.mode(WIFI_AP);
     WiFi.softAP("IR-Remote", password);
-    Serial.println("AP started");
+    LOG_INFO("AP started");
 
     // set session variable
     SESSION_AP = true;
     AP_SETTING = true;
 
     // notify user to synchronize time (not automatic since no NTP server is available)
-    MESSAGE = "Device in AP-Mode. Please synchronize time before using timed Programs!";
+    if (restored == true) {
+      set_message("Device in AP-Mode. The time was restored after a reset: " + get_current_time());
+    }
+    else {
+      set_message("Device in AP-Mode. Please synchronize time before using timed Programs!");
+    }
     control_led_output("AP_on");
   }
 
@@ -95,20 +91,21 @@ void setup() {
     SESSION_AP = false;
     AP_SETTING = false;
     
-    MESSAGE = "Please synchronize timezone if not done yet!";
+    set_message("Please synchronize timezone if not done yet!");
     control_led_output("AP_off");
   }
 
   // start mDNS
   if (MDNS.begin("irr") == false) {
-	Serial.println("Error setting up MDNS responder!");
+	LOG_ERROR("Error setting up MDNS responder!");
 	control_led_output("no_mDNS");
   // reset wifi credentials
   ESP.eraseConfig();
-	// stalls program execution if mDNS fails
+	// stalls program execution if mDNS fails (the LED keeps blinking in the background)
+	flush_log();
 	while (1) { delay(1000); }
   }
-  Serial.println("mDNS responder started!");
+  LOG_INFO("mDNS responder started!");
 
   // initiate time via NTP (00:00:20 4 if no internet connection)
   init_time();
@@ -125,33 +122,296 @@ void setup() {
   server.on("/apmode", handle_apmode);
   server.on("/apinfo", handle_apinfo);
 	server.on("/password", handle_password);
+  server.on("/api/export", HTTP_GET, handle_export);
+  server.on("/api/import", HTTP_POST, handle_import, handle_import_upload);
+  server.on("/api/routes", HTTP_GET, handle_api_stats);
+  server.on("/api/metrics", HTTP_GET, handle_metrics);
+  server.on("/api/trace", HTTP_GET, handle_trace);
+  server.on("/api/log", HTTP_GET, handle_log);
+  server.on("/api/learn", handle_learn);
+  server.on("/api/events", HTTP_GET, handle_events);
+
+  // declare REST routes from the route table
+  for (size_t i = 0; i < API_ROUTE_COUNT; i++) {
+    if (API_ROUTES[i].uri != NULL) {
+      server.on(UriBraces(API_ROUTES[i].uri), API_ROUTES[i].method, [i]() { handle_api_route(i); });
+    }
+  }
   server.onNotFound(handle_not_found);
 
+  // reconnecting event clients tell the last event they have seen
+  const char *collected_headers[] = {"Last-Event-ID"};
+  server.collectHeaders(collected_headers, 1);
+
   // start server
   server.begin();
   MDNS.addService("http", "tcp", 80);
+  UDP_COMMANDS.begin(UDP_COMMAND_PORT);
+  // replayed commands stay refused after a restart, the sequence resumes above the reserved numbers
+  UDP_RESERVED_SEQUENCE = strtoul(kv_get(UDP_SEQUENCE_KEY).c_str(), NULL, 10);
+  UDP_LAST_SEQUENCE = UDP_RESERVED_SEQUENCE;
+#if MQTT_ENABLED
+  init_mqtt();
+#endif
+
+  // keep the server running while programs wait
+  job_set_idle_handler(handle_background);
+
+  // continue the program that was running before a reset
+  rtc_state state = get_rtc_state();
+  if ((state.flags & RTC_PROGRAM_RUNNING) && check_if_file_exists("/programs/" + String(state.program) + ".txt")) {
+    strncpy(PENDING_PROGRAM, state.program, API_NAME_LENGTH);
+    PENDING_PROGRAM[API_NAME_LENGTH] = '\0';
+    PENDING_PROGRAM_LINE = state.program_line;
+    PENDING_PROGRAM_JOB = job_begin(JOB_PROGRAM);
+    LOG_INFO("continuing program %s in line %d", PENDING_PROGRAM, PENDING_PROGRAM_LINE);
+  }
+  else if (state.flags & RTC_PROGRAM_RUNNING) {
+    rtc_set_program(NULL);
+  }
 }
 
 /**
  * @brief Arduino Loop function
  * 
- * @details This function is called repeatedly. It updates the mDNS, 
- * handles clients and checks for a millis() overflow every 5 minutes.
+ * @details This function is called repeatedly. It does the background work,
+ * plays the program that was started on the website or the REST API and continues the learning session.
  * 
  * @callgraph
  * 
  * @callergraph This function is called by the Arduino framework. 
  */
 void loop() {
+  handle_background();
+  run_pending_program();
+  if (update_learning()) {
+    set_message(get_learning_session().message);
+  }
+}
+
+/**
+ * @brief Background work that has to go on while a program waits.
+ * 
+ * @details Updates the mDNS, handles clients, UDP and MQTT commands, writes the log to Serial and the
+ * events to their clients and the broker, checkpoints the clock in the RTC user memory and checks
+ * for a millis() overflow every 5 minutes.
+ * 
+ * @callgraph
+ * 
+ * @callergraph This function is called by loop() and by job_sleep() while a program waits.
+ */
+void handle_background() {
   MDNS.update();
   server.handleClient();
+  update_metrics();
+  update_log();
+  update_events();
+  handle_udp_commands();
+#if MQTT_ENABLED
+  update_mqtt();
+#endif
+  handle_mqtt_commands();
+  update_rtc_state();
+  update_ntp_sync();
   if (millis() % 300000 == 0) {
     // update time every second
     check_and_update_offset();
-    Serial.println("updating time");
+    LOG_DEBUG("updating time");
   }
 }
 
+/**
+ * @brief Executes a command that was received on the UDP command port and acknowledges it.
+ * 
+ * @details At most one datagram is read per call. Commands that can not be read, are not
+ * authenticated (if the firmware was built with UDP_COMMAND_KEY) or have a sequence number that
+ * is not higher than the last accepted one are not executed. With a key every command needs a
+ * sequence number, so a recorded command can not be sent again. To hold this also after a
+ * restart, UDP_SEQUENCE_RESERVE numbers above an accepted one are reserved in the key-value store
+ * once the previous reservation is used up, and after a restart only numbers above the reserved
+ * one are accepted. The reservation is written after the command was executed and acknowledged,
+ * so the flash write does not delay the command. Every command is answered with one
+ * acknowledgement to the sender (see build_udp_ack()).
+ * 
+ * @callgraph
+ * 
+ * @callergraph This function is called by handle_background().
+ */
+void handle_udp_commands() {
+  int size = UDP_COMMANDS.parsePacket();
+  if (size <= 0) {
+    return;
+  }
+  metrics_scope scope(METRICS_WEB);
+
+  uint8_t packet[UDP_MAX_PACKET];
+  udp_command command = {0, 0, 0, 0, NULL};
+  udp_status status = UDP_BAD_PACKET;
+  String message = "invalid packet";
+
+  if (size <= (int)UDP_MAX_PACKET) {
+    UDP_COMMANDS.read(packet, size);
+    const char key[] = UDP_COMMAND_KEY;
+    status = parse_udp_command(packet, size, (const uint8_t *)key, strlen(key), command);
+  }
+
+  if (status == UDP_UNAUTHORIZED) {
+    message = "unauthorized";
+  }
+  else if (status == UDP_OK && command.sequence == 0 && strlen(UDP_COMMAND_KEY) > 0) {
+    status = UDP_REPLAYED;
+    message = "sequence number is missing";
+  }
+  else if (status == UDP_OK && command.sequence != 0 && command.sequence <= UDP_LAST_SEQUENCE) {
+    status = UDP_REPLAYED;
+    message = "sequence number " + String(command.sequence) + " was already used";
+  }
+  else if (status == UDP_OK) {
+    if (command.sequence != 0) {
+      UDP_LAST_SEQUENCE = command.sequence;
+    }
+    message = run_udp_command(command, status);
+  }
+
+  // answer to the sender
+  uint8_t ack[UDP_MAX_PACKET];
+  size_t ack_size = build_udp_ack(command, status, message.c_str(), ack);
+  UDP_COMMANDS.beginPacket(UDP_COMMANDS.remoteIP(), UDP_COMMANDS.remotePort());
+  UDP_COMMANDS.write(ack, ack_size);
+  UDP_COMMANDS.endPacket();
+
+  // reserve the next sequence numbers once the reserved ones are used up
+  if (UDP_LAST_SEQUENCE > UDP_RESERVED_SEQUENCE) {
+    if (UDP_LAST_SEQUENCE > UINT32_MAX - UDP_SEQUENCE_RESERVE) {
+      UDP_RESERVED_SEQUENCE = UINT32_MAX;
+    }
+    else {
+      UDP_RESERVED_SEQUENCE = UDP_LAST_SEQUENCE + UDP_SEQUENCE_RESERVE;
+    }
+    if (kv_put(UDP_SEQUENCE_KEY, String(UDP_RESERVED_SEQUENCE)) == false) {
+      LOG_WARN("udp: could not reserve sequence number %u", UDP_RESERVED_SEQUENCE);
+    }
+  }
+}
+
+/**
+ * @brief Executes a command that was received from the MQTT broker.
+ * 
+ * @details At most one command of the queue is executed per call, like on the UDP command port.
+ * The result is published as message event, which reaches the broker with the next events.
+ * 
+ * @callgraph
+ * 
+ * @callergraph This function is called by handle_background().
+ */
+void handle_mqtt_commands() {
+  mqtt_command queued;
+  if (mqtt_next_command(queued) == false) {
+    return;
+  }
+  metrics_scope scope(METRICS_WEB);
+
+  udp_command command = {0, 0, queued.type, queued.length, queued.payload};
+  udp_status status = UDP_OK;
+  run_udp_command(command, status);
+}
+
+/**
+ * @brief Executes a command of the UDP command port.
+ * 
+ * @param command - authenticated command
+ * 
+ * @param status - set to the status of the acknowledgement
+ * 
+ * @return String - message of the action
+ * 
+ * @details Signals and states are sent right away, programs are started like on the website
+ * (see action_play_program()).
+ * 
+ * @callgraph
+ * 
+ * @callergraph
+ */
+String run_udp_command(const udp_command &command, udp_status &status) {
+  String message;
+  action_status result;
+
+  if (command.type == UDP_SEND_STATE) {
+    if (command.length < 5) {
+      status = UDP_BAD_PACKET;
+      return("no state given");
+    }
+    uint16_t protocol = ((uint16_t)command.payload[0] << 8) | command.payload[1];
+    uint16_t bits = ((uint16_t)command.payload[2] << 8) | command.payload[3];
+    message = send_state(protocol, bits, command.payload + 4, command.length - 4);
+    result = message == "success" ? ACTION_OK : ACTION_FAILED;
+  }
+  else {
+    // names are copied so they are terminated
+    if (command.length == 0 || command.length > API_NAME_LENGTH) {
+      status = UDP_BAD_PACKET;
+      return("invalid name");
+    }
+    char name[API_NAME_LENGTH + 1];
+    memcpy(name, command.payload, command.length);
+    name[command.length] = '\0';
+
+    if (command.type == UDP_SEND_SIGNAL) {
+      message = sending_workflow(name, result);
+    }
+    else if (command.type == UDP_PLAY_PROGRAM) {
+      result = action_play_program(name, message);
+    }
+    else {
+      status = UDP_BAD_PACKET;
+      return("unknown command");
+    }
+  }
+
+  if (result == ACTION_OK) {
+    status = UDP_OK;
+  }
+  else if (result == ACTION_NOT_FOUND) {
+    status = UDP_NOT_FOUND;
+  }
+  else if (result == ACTION_BUSY) {
+    status = UDP_BUSY;
+  }
+  else {
+    status = UDP_FAILED;
+  }
+
+  publish_message(message);
+  return(message);
+}
+
+/**
+ * @brief Plays the program that was started by action_play_program().
+ * 
+ * @details The message of the program is shown on the website after the next reload.
+ * A program that was restored after a reset continues at PENDING_PROGRAM_LINE.
+ * 
+ * @callgraph
+ * 
+ * @callergraph
+ */
+void run_pending_program() {
+  if (PENDING_PROGRAM_JOB == 0) {
+    return;
+  }
+
+  uint16_t job_id = PENDING_PROGRAM_JOB;
+  PENDING_PROGRAM_JOB = 0;
+
+  // the program is kept in the RTC user memory while it runs, to be continued after a reset
+  rtc_set_program(PENDING_PROGRAM);
+  set_message(playing_workflow(PENDING_PROGRAM, PENDING_PROGRAM_LINE));
+  PENDING_PROGRAM_LINE = 0;
+  rtc_set_program(NULL);
+  job_end(job_id);
+  LOG_INFO("%s", MESSAGE.c_str());
+}
+
 
 
 
@@ -212,7 +472,7 @@ void handle_program() {
   String PROGRAMCODE = read_program(PROGRAMNAME);
 
   if (PROGRAMCODE.indexOf("Error") != -1) {
-    MESSAGE = PROGRAMCODE;
+    set_message(PROGRAMCODE);
   }
 
   // send name and code of selected program
@@ -224,8 +484,9 @@ void handle_program() {
 /**
  * @brief Handler function to display the error message.
  * 
- * @details Similarly to handle_program(), the website will send a get request on /error to
- * update the error message on reload. The MESSAGE is then written again by handle_form().
+ * @details Similarly to handle_program(), the website used to send a get request on /error to
+ * update the error message on reload. The website now gets the messages from /api/events, the
+ * route is kept for clients that still ask for the last message.
  * 
  * @callgraph
  * 
@@ -246,6 +507,7 @@ void handle_error() {
  * 
  */
 void handle_files() {
+  metrics_scope scope(METRICS_WEB);
 
   // generate list of files in /signals and /programs
   String files = get_files("/signals", "/programs");
@@ -275,13 +537,13 @@ void handle_time() {
   // time in format: "weekday hh:mm:ss timezone"
   String time = server.arg("weekday_time");
 
-  Serial.println(time);
+  LOG_DEBUG("time from client: %s", time.c_str());
 
   // update time (update only timezone when not in AP-mode because NTP time is more precise)
   update_time(time, SESSION_AP);  
 
   // update MESSAGE
-  MESSAGE = "Time synchronized!";
+  set_message("Time synchronized!");
 
   // redirect to root
   server.sendHeader("Location", "/");
@@ -303,7 +565,7 @@ void handle_credentials() {
 
   ESP.eraseConfig();
 
-  MESSAGE = "Credentials erased! You will need to reconnect to the Wifi on reboot (if you are not in AP-Mode).";
+  set_message("Credentials erased! You will need to reconnect to the Wifi on reboot (if you are not in AP-Mode).");
 
   // redirect to root
   server.sendHeader("Location", "/");
@@ -313,7 +575,7 @@ void handle_credentials() {
 /**
  * @brief Handler function to switch between AP mode and normal mode.
  * 
- * @details Checks the config file and switches between AP mode and normal mode.
+ * @details Checks the "ap" value of the key-value store and switches between AP mode and normal mode.
  * The possibel reconfiguration of the wifi credentails is done after restart.
  * 
  * @callgraph
@@ -322,50 +584,31 @@ void handle_credentials() {
  */
 void handle_apmode() {
 
-  // start LittleFS
-  LittleFS.begin();
-
-  // open config file
-  File configFile = LittleFS.open("/config.txt", "r");
-  if (!configFile) {
-	MESSAGE = "Failed to open config file";
-  }
-
-  // read config file
-  String config = configFile.readString();
-
-  // close config file
-  configFile.close();
-
   // switch value:
 
-  if (config == "AP: false"){
+  if (kv_get("ap") == "false"){
     // write new config
-    File configFile = LittleFS.open("/config.txt", "w");
-    if (!configFile) {
-      MESSAGE = "Failed to open config file";
+    if (kv_put("ap", "true") == false) {
+      set_message("Failed to save config");
+    }
+    else {
+      // set variable for frontend
+      AP_SETTING = true;
+      set_message("AP mode enabled! Dont forget to synchronize your time on next reboot.");
     }
-    configFile.print("AP: true");
-    configFile.close();
-
-    // set variable for frontend
-    AP_SETTING = true;
-    MESSAGE = "AP mode enabled! Dont forget to synchronize your time on next reboot.";
   }
 
   // includes case when no config exists
   else {
     // update config
-    File configFile = LittleFS.open("/config.txt", "w");
-    if (!configFile) {
-      MESSAGE = "Failed to open config file";
+    if (kv_put("ap", "false") == false) {
+      set_message("Failed to save config");
+    }
+    else {
+      // set variable for frontend
+      AP_SETTING = false;
+      set_message("AP mode disabled! You will need to reconfigure the ESP the your Wifi on reboot if no credentials are saved already.");
     }
-    configFile.print("AP: false");
-    configFile.close();
-
-    // set variable for frontend
-    AP_SETTING = false;
-    MESSAGE = "AP mode disabled! You will need to reconfigure the ESP the your Wifi on reboot if no credentials are saved already.";
   }
 
   // redirect to root
@@ -394,7 +637,7 @@ void handle_apinfo() {
 		server.send(200, "text/plain", "false");
   }
 	else {
-		MESSAGE = "undefined AP-mode";
+		set_message("undefined AP-mode");
 	}
 }
 
@@ -417,7 +660,7 @@ void handle_password() {
 
   // check if password is long enough
   if(first_entry.length() < 8) {
-    MESSAGE = "Password must be at least 8 characters long!";
+    set_message("Password must be at least 8 characters long!");
     server.sendHeader("Location", "/");
     server.send(302, "text/plain", "Updated– Press Back Button");
     return;
@@ -425,29 +668,17 @@ void handle_password() {
 
   // check if entries are the same
   if(first_entry == second_entry) {
-    // write new password to password file
-    LittleFS.begin();
-
-    File passwordFile = LittleFS.open("/password.txt", "w");
-
-    // handle error
-    if (!passwordFile) {
-      LittleFS.end();
-      MESSAGE = "Failed to open password file";
+    // write new password
+    if (kv_put("password", first_entry) == false) {
+      set_message("Failed to save password");
     }
-
     else {
-      // write new password
-      passwordFile.print(first_entry);
-      passwordFile.close();
-
-      MESSAGE = "Password changed successfully!"; 
-      LittleFS.end();
+      set_message("Password changed successfully!");
     }
   }
 
   else {
-    MESSAGE = "Passwords do not match!"; 
+    set_message("Passwords do not match!");
   }
 	
   // redirect to root
@@ -460,8 +691,9 @@ void handle_password() {
  * related to signals and programs.
  * 
  * @details Handles all form elements on the website (signals and programs) also
- * updates the error message and PROGRAMNAME. All the user interaction with the
- * website is handled here and the functions from workflows.h are called.
+ * updates the error message and PROGRAMNAME. The pressed button is looked up in
+ * API_ROUTES and only the form field that holds the name for this action is read.
+ * The action itself is executed by run_api_route().
  * 
  * @callgraph
  * 
@@ -470,135 +702,629 @@ void handle_password() {
  */
 void handle_form() {
 
-  String selected_signal = server.arg("selected_signal");
-  String send_signal_button = server.arg("send_signal_button"); 
-  String delete_signal_button = server.arg("delete_signal_button"); 
-  String signal_name = server.arg("signal_name"); 
-  String add_signal_button = server.arg("add_signal_button");
-  String selected_program = server.arg("selected_program");
-  String play_program_button = server.arg("play_program_button"); 
-  String program_code = server.arg("program_code");
-  String program_name = server.arg("program_name"); 
-  String add_program_button = server.arg("add_program_button");
-  String delete_programs_button = server.arg("delete_program_button");
-  String edit_program_button = server.arg("edit_program_button");
-
-  /*
-  Serial.println("signal: " + signal);
-  Serial.println("send_signal_button: " + send_signal_button);
-  Serial.println("delete_signal_button: " + delete_signal_button);
-  Serial.println("signal_name: " + signal_name);
-  Serial.println("add_signal_button: " + add_signal_button);
-  Serial.println("program: " + program);
-  Serial.println("play_program_button: " + play_program_button);
-  Serial.println("program_code: " + program_code);
-  Serial.println("program_name: " + program_name);
-  Serial.println("add_program_button: " + add_program_button);
-  Serial.println("delete_programs_button: " + delete_programs_button);
-  Serial.println("edit_program_button: " + edit_program_button);
-  */
-
-  // SIGNAL LOGIC:
-  // signal is added
-  if (signal_name != "" && add_signal_button != "") {
-	// check if signal name is alphanumeric
-	if (check_if_string_is_alphanumeric (signal_name) == true) {
-	  MESSAGE = recording_workflow(signal_name);
-	}
-	else {
-	  MESSAGE = "signal name must be alphanumeric";
-	}
+  // find the pressed button in the route table
+  for (size_t i = 0; i < API_ROUTE_COUNT; i++) {
+    if (API_ROUTES[i].button != NULL && server.hasArg(API_ROUTES[i].button)) {
+      String message;
+      run_api_route(i, server.arg(API_ROUTES[i].name_field).c_str(), false, message);
+      set_message(message);
+      break;
+    }
+  }
+  
+  // sends user back to root
+  server.sendHeader("Location", "/");
+  server.send(302, "text/plain", "Updated– Press Back Button");
+}
+
+/**
+ * @brief Handler function for all REST routes in API_ROUTES.
+ * 
+ * @param route_index - index of the route in API_ROUTES
+ * 
+ * @details The name is taken from the path (e.g. /api/signals/{name}/send) and the message of the
+ * action is sent back with the HTTP status of its action_status (see action_http_status()).
+ * 
+ * @callgraph
+ * 
+ * @callergraph This function is called on a request to one of the REST routes in API_ROUTES.
+ * 
+ */
+void handle_api_route(size_t route_index) {
+
+  // names with spaces arrive url encoded in the path, they are decoded into the buffer of the action
+  String message;
+  action_status status = run_api_route(route_index, server.pathArg(0).c_str(), true, message);
+
+  publish_message(message);
+  server.send(action_http_status(status), "text/plain", message);
+}
+
+/**
+ * @brief Handler function that sends the measurements of all routes.
+ * 
+ * @details Sends a JSON array with the number of calls, the average and maximum latency in
+ * microseconds and the heap delta (free heap before minus free heap after) of every route.
+ * 
+ * @callgraph
+ * 
+ * @callergraph This function is called on a GET request to /api/routes.
+ * 
+ */
+void handle_api_stats() {
+
+  json_document doc(256 * API_ROUTE_COUNT);
+
+  for (size_t i = 0; i < API_ROUTE_COUNT; i++) {
+    JsonObject route = doc.createNestedObject();
+    route["uri"] = API_ROUTES[i].uri;
+    route["button"] = API_ROUTES[i].button;
+    route["calls"] = API_ROUTE_STATS[i].calls;
+    route["avg_us"] = API_ROUTE_STATS[i].calls == 0 ? 0 : API_ROUTE_STATS[i].total_us / API_ROUTE_STATS[i].calls;
+    route["max_us"] = API_ROUTE_STATS[i].max_us;
+    route["last_heap_delta"] = API_ROUTE_STATS[i].last_heap_delta;
+    route["max_heap_delta"] = API_ROUTE_STATS[i].max_heap_delta;
   }
 
-  // signal name is missing
-  else if (signal_name == "" && add_signal_button != "") {
-	MESSAGE = "no signal name given";
+  // printed directly to the client (the document is in the arena, see json_arena.h)
+  server.setContentLength(measureJson(doc));
+  server.send(200, "application/json", "");
+  WiFiClient client = server.client();
+  serializeJson(doc, client);
+}
+
+/**
+ * @brief Handler function that sends the heap and stack telemetry.
+ *
+ * @details The JSON is printed twice: once to count its length and once directly to the client,
+ * so the response does not need a buffer on the heap.
+ *
+ * @callgraph
+ *
+ * @callergraph This function is called on a GET request to /api/metrics.
+ *
+ */
+void handle_metrics() {
+
+  metrics_sample now = read_metrics();
+  metrics_byte_counter counter;
+  print_metrics_json(counter, now);
+
+  server.setContentLength(counter.count);
+  server.send(200, "application/json", "");
+  WiFiClient client = server.client();
+  print_metrics_json(client, now);
+}
+
+/**
+ * @brief Handler function that sends the recorded spans as Chrome trace-event JSON.
+ *
+ * @details The spans are removed afterwards so the next download only contains new spans.
+ * If tracing is compiled out (TRACE_ENABLED not set) a 404 is sent.
+ *
+ * @callgraph
+ *
+ * @callergraph This function is called on a GET request to /api/trace.
+ *
+ */
+void handle_trace() {
+#if TRACE_ENABLED
+  metrics_byte_counter counter;
+  print_trace_json(counter);
+
+  server.setContentLength(counter.count);
+  server.sendHeader("Content-Disposition", "attachment; filename=\"trace.json\"");
+  server.send(200, "application/json", "");
+  WiFiClient client = server.client();
+  print_trace_json(client);
+  reset_trace();
+#else
+  server.send(404, "text/plain", "Error: tracing is disabled (build with -D TRACE_ENABLED=1)");
+#endif
+}
+
+/**
+ * @brief Handler function that sends the last log messages.
+ *
+ * @details Like handle_metrics() the log is printed twice: once to count its length and once
+ * directly from the ring buffer to the client.
+ *
+ * @callgraph
+ *
+ * @callergraph This function is called on a GET request to /api/log.
+ *
+ */
+void handle_log() {
+  metrics_byte_counter counter;
+  print_log(counter);
+
+  server.setContentLength(counter.count);
+  server.send(200, "text/plain", "");
+  WiFiClient client = server.client();
+  print_log(client);
+}
+
+/**
+ * @brief Handler function that starts a learning session or sends its progress.
+ *
+ * @details A POST request starts a session with the names in the argument "names" and answers
+ * with the message of start_learning(). Any other request gets the progress as JSON, printed like
+ * handle_log() without building it in the heap.
+ *
+ * @callgraph
+ *
+ * @callergraph This function is called on a request to /api/learn.
+ *
+ */
+void handle_learn() {
+  if (server.method() == HTTP_POST) {
+    String message;
+    if (job_busy(message)) {
+      server.send(409, "text/plain", message);
+      return;
+    }
+    message = start_learning(server.arg("names"));
+    publish_message(message);
+    server.send(message.startsWith("Error") ? 400 : 200, "text/plain", message);
+    return;
   }
 
-  // signal is selcted
-  else if (selected_signal != "") {
+  metrics_byte_counter counter;
+  print_learning_json(counter);
 
-	// send button is pressed
-	if (send_signal_button != "") {
-	  MESSAGE = sending_workflow(selected_signal);
-	}
+  server.setContentLength(counter.count);
+  server.send(200, "application/json", "");
+  WiFiClient client = server.client();
+  print_learning_json(client);
+}
 
-	// delete button is pressed
-	else if (delete_signal_button != "") {
-	  MESSAGE = deleting_workflow("signals", selected_signal);
-	}
+/**
+ * @brief Handler function that connects a client to the event stream.
+ *
+ * @details The response header is written here and the connection is kept open, the events are
+ * written by update_events() from the background work (see events.cpp). At most
+ * EVENT_MAX_CLIENTS can be connected, further clients get status 503.
+ *
+ * @callgraph
+ *
+ * @callergraph This function is called on a GET request to /api/events.
+ *
+ */
+void handle_events() {
+  WiFiClient client = server.client();
+  uint32_t last_id = server.header("Last-Event-ID").toInt();
+
+  if (add_event_client(client, last_id) == false) {
+    server.send(503, "text/plain", "Error: too many clients on /api/events");
+    return;
+  }
+
+  // the payload goes on until the client disconnects
+  server.setContentLength(CONTENT_LENGTH_UNKNOWN);
+  server.sendContent_P(PSTR("HTTP/1.1 200 OK\r\nContent-Type: text/event-stream\r\nCache-Control: no-cache\r\nConnection: keep-alive\r\nAccess-Control-Allow-Origin: *\r\n\r\nretry: 5000\n\n"));
+}
+
+/**
+ * @brief Sets the message that is displayed on the website and publishes it to the event stream.
+ *
+ * @param message - message
+ *
+ * @callgraph
+ *
+ * @callergraph
+ */
+void set_message(String message) {
+  MESSAGE = message;
+  publish_message(message);
+}
+
+//------------------ actions ------------------//
+
+/**
+ * @brief Copies the name of a request into a fixed buffer.
+ * 
+ * @param input - argument as the web server keeps it
+ * 
+ * @param url_encoded - true for an argument of the path ("%xx" and "+" are decoded), the web server
+ * already decodes form fields
+ * 
+ * @param name - buffer of API_NAME_LENGTH + 1 characters
+ * 
+ * @return int - length of the name or -1 if it is longer than API_NAME_LENGTH
+ * 
+ * @details The name is read without building a String. An invalid "%" sequence is kept as it is.
+ * 
+ * @callgraph This function does not call any other function.
+ * 
+ * @callergraph
+ */
+int read_api_name(const char *input, boolean url_encoded, char *name) {
+  size_t length = 0;
+  for (size_t i = 0; input[i] != '\0'; i++) {
+    if (length == API_NAME_LENGTH) {
+      name[length] = '\0';
+      return(-1);
+    }
+
+    char c = input[i];
+    if (url_encoded && c == '+') {
+      c = ' ';
+    }
+    else if (url_encoded && c == '%' && isxdigit((unsigned char)input[i + 1]) && isxdigit((unsigned char)input[i + 2])) {
+      char hex[3] = {input[i + 1], input[i + 2], '\0'};
+      c = (char)strtol(hex, NULL, 16);
+      i += 2;
+    }
+    name[length++] = c;
   }
+  name[length] = '\0';
+  return(length);
+}
 
-  // no signal is selected
-  else if (selected_signal == "" && send_signal_button != "") {
-	MESSAGE = "no signal selected";
+/**
+ * @brief Executes the action of a route and measures it.
+ * 
+ * @param route_index - index of the route in API_ROUTES
+ * 
+ * @param input - name of the signal or program (from the path or the form field)
+ * 
+ * @param url_encoded - true if the name is from the path (see read_api_name())
+ * 
+ * @param message - set to the message of the action or an error message if the name is missing or too long
+ * 
+ * @return action_status - status of the action
+ * 
+ * @details The name is read into a fixed buffer before the action is called. Exclusive actions
+ * are refused while a job runs (requests are also handled while a program waits). Latency and
+ * heap delta of the action are added to API_ROUTE_STATS.
+ * 
+ * @callgraph
+ * 
+ * @callergraph
+ */
+action_status run_api_route(size_t route_index, const char *input, boolean url_encoded, String &message) {
+  metrics_scope scope(METRICS_WEB);
+
+  const api_route &route = API_ROUTES[route_index];
+
+  // read and check name
+  char name_buffer[API_NAME_LENGTH + 1];
+  int name_length = read_api_name(input, url_encoded, name_buffer);
+  if (name_length == 0) {
+    message = route.missing_name;
+    return(ACTION_INVALID);
+  }
+  if (name_length < 0) {
+    message = "name exceeds " + String(API_NAME_LENGTH) + " characters";
+    return(ACTION_INVALID);
   }
 
-  // no signal is selected
-  else if (selected_signal == "" && delete_signal_button != "") {
-	MESSAGE = "no signal selected";
+  // do not change signals or programs while a program runs or a signal is captured
+  if (route.exclusive && job_busy(message)) {
+    return(ACTION_BUSY);
   }
 
-  // PROGRAM LOGIC:
-  // program is added
-  else if (program_name != "" && add_program_button != "" && program_code != "") {
-	// check if program name is alphanumeric
-	if (check_if_string_is_alphanumeric (program_name) == true) {
-	  MESSAGE = adding_workflow(program_name, program_code);
-	}
-	else {
-	  MESSAGE = "program name must be alphanumeric";
-	}
+  // run action and measure latency and heap delta
+  uint32_t heap_before = ESP.getFreeHeap();
+  uint32_t start = micros();
+
+  action_status status = route.action(name_buffer, message);
+
+  uint32_t elapsed = micros() - start;
+  int32_t heap_delta = (int32_t)heap_before - (int32_t)ESP.getFreeHeap();
+
+  api_route_stats &stats = API_ROUTE_STATS[route_index];
+  stats.calls++;
+  stats.total_us += elapsed;
+  if (elapsed > stats.max_us) {
+    stats.max_us = elapsed;
+  }
+  stats.last_heap_delta = heap_delta;
+  if (heap_delta > stats.max_heap_delta) {
+    stats.max_heap_delta = heap_delta;
   }
 
-  // program name is missing
-  else if (program_name == "" && add_program_button != "") {
-	MESSAGE = "no program name given";
+  return(status);
+}
+
+/**
+ * @brief Converts the status of an action to the HTTP status of its REST route.
+ * 
+ * @param status - status of the action
+ * 
+ * @return int - 200 (ok), 400 (invalid), 404 (not found), 409 (busy) or 500 (failed)
+ * 
+ * @callgraph This function does not call any other function.
+ * 
+ * @callergraph
+ */
+int action_http_status(action_status status) {
+  switch (status) {
+    case ACTION_OK:
+      return(200);
+    case ACTION_NOT_FOUND:
+      return(404);
+    case ACTION_BUSY:
+      return(409);
+    case ACTION_FAILED:
+      return(500);
+    default:
+      return(400);
   }
+}
 
-  // program code is missing
-  else if (program_code == "" && add_program_button != "") {
-	MESSAGE = "no program code given";
+/**
+ * @brief Records a new signal.
+ * 
+ * @param name - name of the signal
+ * 
+ * @param message - set to the message of recording_workflow() or an error message if the name is not alphanumeric
+ * 
+ * @return action_status - status of the action
+ * 
+ * @callgraph
+ * 
+ * @callergraph
+ */
+action_status action_record_signal(const char *name, String &message) {
+  // check if signal name is alphanumeric
+  if (check_if_string_is_alphanumeric(name) == false) {
+    message = "signal name must be alphanumeric";
+    return(ACTION_INVALID);
   }
+  action_status status;
+  message = recording_workflow(name, status);
+  return(status);
+}
 
-  // program is selected
-  else if (selected_program != "") {
+/**
+ * @brief Sends a saved signal.
+ * 
+ * @param name - name of the signal
+ * 
+ * @param message - set to the message of sending_workflow()
+ * 
+ * @return action_status - status of the action
+ * 
+ * @callgraph
+ * 
+ * @callergraph
+ */
+action_status action_send_signal(const char *name, String &message) {
+  action_status status;
+  message = sending_workflow(name, status);
+  return(status);
+}
 
-	// play button is pressed
-	if (play_program_button != "") {
-	  MESSAGE = playing_workflow(selected_program);
-	}
+/**
+ * @brief Deletes a saved signal.
+ * 
+ * @param name - name of the signal
+ * 
+ * @param message - set to the message of deleting_workflow()
+ * 
+ * @return action_status - status of the action
+ * 
+ * @callgraph
+ * 
+ * @callergraph
+ */
+action_status action_delete_signal(const char *name, String &message) {
+  action_status status;
+  message = deleting_workflow("signals", name, status);
+  return(status);
+}
 
-	// delete button is pressed
-	else if (delete_programs_button != "") {
-	  MESSAGE = deleting_workflow("programs", selected_program);
-	}
+/**
+ * @brief Saves a program. The code is read from the "program_code" argument.
+ * 
+ * @param name - name of the program
+ * 
+ * @param message - set to the message of adding_workflow() or an error message if the name is not alphanumeric or the code is missing
+ * 
+ * @return action_status - status of the action
+ * 
+ * @callgraph
+ * 
+ * @callergraph
+ */
+action_status action_save_program(const char *name, String &message) {
+  // check if program name is alphanumeric
+  if (check_if_string_is_alphanumeric(name) == false) {
+    message = "program name must be alphanumeric";
+    return(ACTION_INVALID);
+  }
+  // the code is the only argument that is not a name
+  String program_code = server.arg("program_code");
+  if (program_code == "") {
+    message = "no program code given";
+    return(ACTION_INVALID);
+  }
+  action_status status;
+  message = adding_workflow(name, program_code, status);
+  return(status);
+}
 
-	// edit button is pressed
-	else if (edit_program_button != "") {
+/**
+ * @brief Starts a saved program.
+ * 
+ * @param name - name of the program
+ * 
+ * @param message - set to a message with the id of the job that plays the program or an error
+ * message if the program does not exist or another job is running
+ * 
+ * @return action_status - status of the action
+ * 
+ * @details The program is played by run_pending_program() from loop(), the job id can be used
+ * to cancel it on /api/jobs/{id}/cancel.
+ * 
+ * @callgraph
+ * 
+ * @callergraph
+ */
+action_status action_play_program(const char *name, String &message) {
+  // only one job runs at a time
+  if (job_busy(message)) {
+    return(ACTION_BUSY);
+  }
 
-	  // data is saved in global variable PROGRAMNAME and is used in handle_program() to display on website
-	  PROGRAMNAME = selected_program;
-	  MESSAGE = "successfully loaded program: " + selected_program;
-	}
+  // check if file exists
+  if (check_if_file_exists("/programs/" + String(name) + ".txt") == false) {
+    message = "could not find program: " + String(name);
+    return(ACTION_NOT_FOUND);
   }
 
-  // no program is selected
-  else if (selected_program == "" && play_program_button != "") {
-	MESSAGE = "no program selected";
+  strcpy(PENDING_PROGRAM, name);
+  PENDING_PROGRAM_JOB = job_begin(JOB_PROGRAM);
+  message = "successfully started program: " + String(name) + " (job " + String(PENDING_PROGRAM_JOB) + ")";
+  return(ACTION_OK);
+}
+
+/**
+ * @brief Deletes a saved program.
+ * 
+ * @param name - name of the program
+ * 
+ * @param message - set to the message of deleting_workflow()
+ * 
+ * @return action_status - status of the action
+ * 
+ * @callgraph
+ * 
+ * @callergraph
+ */
+action_status action_delete_program(const char *name, String &message) {
+  action_status status;
+  message = deleting_workflow("programs", name, status);
+  return(status);
+}
+
+/**
+ * @brief Selects a program to be displayed in the editor of the website.
+ * 
+ * @param name - name of the program
+ * 
+ * @param message - set to a success message
+ * 
+ * @return action_status - ACTION_OK
+ * 
+ * @details The name is saved in PROGRAMNAME and is used in handle_program() to display the code on the website.
+ * 
+ * @callgraph
+ * 
+ * @callergraph
+ */
+action_status action_edit_program(const char *name, String &message) {
+  PROGRAMNAME = name;
+  message = "successfully loaded program: " + PROGRAMNAME;
+  return(ACTION_OK);
+}
+
+/**
+ * @brief Cancels a running job.
+ * 
+ * @param name - id of the job (as returned when the job was started)
+ * 
+ * @param message - set to a success message or an error message if the job is not running
+ * 
+ * @return action_status - status of the action
+ * 
+ * @callgraph
+ * 
+ * @callergraph
+ */
+action_status action_cancel_job(const char *name, String &message) {
+  uint16_t job_id = String(name).toInt();
+  if (job_id == 0 || job_cancel(job_id) == false) {
+    message = "could not find running job: " + String(name);
+    return(ACTION_NOT_FOUND);
   }
+  message = "successfully canceled job: " + String(job_id);
+  return(ACTION_OK);
+}
+
+/**
+ * @brief Handler function that sends all signals and programs as one archive.
+ * 
+ * @details The size of the archive is calculated beforehand and sent as Content-Length.
+ * Afterwards the archive is written directly from the LittleFS to the client in small
+ * chunks, so the library is never loaded into RAM as a whole.
+ * 
+ * @callgraph
+ * 
+ * @callergraph This function is called on a GET request to /api/export.
+ * 
+ */
+void handle_export() {
+
+  size_t archive_size = get_archive_size("/signals", "/programs");
+
+  server.setContentLength(archive_size);
+  server.sendHeader("Content-Disposition", "attachment; filename=\"ir_library.irla\"");
+  server.send(200, "application/octet-stream", "");
+
+  write_archive(server.client(), "/signals", "/programs");
+}
+
+/**
+ * @brief Handler function that receives the chunks of an uploaded archive.
+ * 
+ * @details The webserver calls this function for every chunk of the upload. Each chunk
+ * is handed to the import which writes the contained files directly to the LittleFS.
+ * While a job runs the import is refused and the chunks are ignored.
+ * 
+ * @callgraph
+ * 
+ * @callergraph This function is called during a POST request to /api/import.
+ * 
+ */
+void handle_import_upload() {
+
+  HTTPUpload& upload = server.upload();
 
-  // no program is selected
-  else if (selected_program == "" && delete_programs_button != "") {
-	MESSAGE = "no program selected";
+  if (upload.status == UPLOAD_FILE_START) {
+    import_archive_begin();
+    // the archive replaces signals and programs, which a running job may use
+    String busy;
+    if (job_busy(busy)) {
+      import_archive_fail("Error: " + busy, ACTION_BUSY);
+    }
+  }
+  else if (upload.status == UPLOAD_FILE_WRITE) {
+    import_archive_chunk(upload.buf, upload.currentSize);
+  }
+  else if (upload.status == UPLOAD_FILE_END || upload.status == UPLOAD_FILE_ABORTED) {
+    IMPORT_MESSAGE = import_archive_end(IMPORT_STATUS);
+    set_message(IMPORT_MESSAGE);
   }
+}
+
+/**
+ * @brief Handler function that is called after an archive was uploaded.
+ * 
+ * @details The result of the import was already written to MESSAGE by handle_import_upload().
+ * A complete import redirects to the root, a failed one is answered with the message and the HTTP
+ * status of its action_status (see action_http_status()), so a script can tell them apart.
+ * 
+ * @callgraph
+ * 
+ * @callergraph This function is called after a POST request to /api/import.
+ * 
+ */
+void handle_import() {
+
+  action_status status = IMPORT_STATUS;
+  String message = IMPORT_MESSAGE;
+  IMPORT_STATUS = ACTION_INVALID;
+  IMPORT_MESSAGE = "Error: no archive was uploaded";
 
-  // no program is selected
-  else if (selected_program == "" && edit_program_button != "") {
-	MESSAGE = "no program selected";
+  if (status != ACTION_OK) {
+    publish_message(message);
+    server.send(action_http_status(status), "text/plain", message);
+    return;
   }
-  
-  // sends user back to root
+
+  // redirect to root
   server.sendHeader("Location", "/");
   server.send(302, "text/plain", "Updated– Press Back Button");
-}
\ No newline at end of file
+}
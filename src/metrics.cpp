@@ -0,0 +1,328 @@
+/**
+ * @file metrics.cpp
+ * 
+ * @author Marc Ubbelohde
+ * 
+ * @brief In this file, the heap and stack telemetry is defined.
+ * 
+ * @details The firmware uses a lot of short lived Strings and JSON documents. Over long runs
+ * this can fragment the heap until a large allocation (e.g. a capture) fails. To be able to see
+ * this coming, the free heap, the largest free block, the fragmentation and the stack high-water
+ * mark are sampled periodically into a small ring buffer. Additionally every subsystem counts
+ * its calls and how much heap it did not give back. The data is served on /api/metrics and
+ * optionally printed to the serial monitor.
+ */
+
+#include "base.h"
+
+/**
+ * @brief Ring buffer of the last METRICS_SAMPLE_COUNT samples.
+ * 
+ */
+metrics_sample METRICS_SAMPLES[METRICS_SAMPLE_COUNT];
+
+/**
+ * @brief Index where the next sample is written to.
+ * 
+ */
+uint8_t METRICS_NEXT = 0;
+
+/**
+ * @brief Number of valid samples in the ring buffer.
+ * 
+ */
+uint8_t METRICS_FILLED = 0;
+
+/**
+ * @brief Time of the last sample (millis()).
+ * 
+ */
+unsigned long METRICS_LAST_SAMPLE = 0;
+
+/**
+ * @brief Heap usage of every subsystem.
+ * 
+ */
+metrics_counter METRICS_COUNTERS[METRICS_SUBSYSTEM_COUNT];
+
+/**
+ * @brief Names of the subsystems as they appear in the output.
+ * 
+ */
+const char *METRICS_SUBSYSTEM_NAMES[METRICS_SUBSYSTEM_COUNT] = {"capture", "send", "storage", "time", "parser", "web"};
+
+/**
+ * @brief Innermost running measurement (NULL if none runs).
+ * 
+ */
+metrics_scope *METRICS_CURRENT_SCOPE = NULL;
+
+/**
+ * @brief Length of the buffer one JSON object of the output is formatted in.
+ * 
+ */
+const size_t METRICS_LINE_LENGTH = 160;
+
+/**
+ * @brief Starts the measurement of a subsystem.
+ * 
+ * @param subsystem - subsystem the measured code belongs to
+ * 
+ * @callgraph This function does not call any other function.
+ * 
+ * @callergraph
+ */
+metrics_scope::metrics_scope(metrics_subsystem subsystem) : subsystem(subsystem) {
+  parent = METRICS_CURRENT_SCOPE;
+  child_heap_delta = 0;
+  METRICS_CURRENT_SCOPE = this;
+  free_heap_before = ESP.getFreeHeap();
+}
+
+/**
+ * @brief Ends the measurement of a subsystem and adds it to its counter.
+ * 
+ * @details The heap delta of measurements that ran inside of this one (e.g. the storage of a
+ * capture or the web requests handled while a program waits) is only counted for their own
+ * subsystem, not again for this one.
+ * 
+ * @callgraph This function does not call any other function.
+ * 
+ * @callergraph
+ */
+metrics_scope::~metrics_scope() {
+  uint32_t free_heap = ESP.getFreeHeap();
+  int32_t total_heap_delta = (int32_t)free_heap_before - (int32_t)free_heap;
+  int32_t heap_delta = total_heap_delta - child_heap_delta;
+
+  METRICS_CURRENT_SCOPE = parent;
+  if (parent != NULL) {
+    parent->child_heap_delta += total_heap_delta;
+  }
+
+  metrics_counter &counter = METRICS_COUNTERS[subsystem];
+  if (counter.calls == 0 || heap_delta > counter.max_heap_delta) {
+    counter.max_heap_delta = heap_delta;
+  }
+  if (counter.calls == 0 || free_heap < counter.min_free_heap) {
+    counter.min_free_heap = free_heap;
+  }
+  counter.calls++;
+  counter.total_heap_delta += heap_delta;
+}
+
+/**
+ * @brief Deletes all samples and counters.
+ * 
+ * @callgraph This function does not call any other function.
+ * 
+ * @callergraph
+ */
+void reset_metrics() {
+  METRICS_NEXT = 0;
+  METRICS_FILLED = 0;
+  METRICS_LAST_SAMPLE = millis();
+  memset(METRICS_COUNTERS, 0, sizeof(METRICS_COUNTERS));
+}
+
+/**
+ * @brief Reads the current heap and stack state.
+ * 
+ * @return metrics_sample - current state
+ * 
+ * @details The stack value is the lowest amount of free stack since boot (high-water mark)
+ * as reported by ESP.getFreeContStack().
+ * 
+ * @callgraph This function does not call any other function.
+ * 
+ * @callergraph
+ */
+metrics_sample read_metrics() {
+
+  metrics_sample sample;
+  uint32_t free_heap;
+  uint16_t max_free_block;
+  uint8_t fragmentation;
+  ESP.getHeapStats(&free_heap, &max_free_block, &fragmentation);
+
+  sample.timestamp = millis();
+  sample.free_heap = free_heap;
+  sample.max_free_block = max_free_block;
+  sample.fragmentation = fragmentation;
+  sample.free_stack = ESP.getFreeContStack();
+
+  return sample;
+}
+
+/**
+ * @brief Takes one sample of the heap and stack state and writes it to the ring buffer.
+ * 
+ * @details The oldest sample is overwritten when the ring buffer is full.
+ * 
+ * @callgraph
+ * 
+ * @callergraph
+ */
+void sample_metrics() {
+
+  metrics_sample sample = read_metrics();
+  METRICS_SAMPLES[METRICS_NEXT] = sample;
+
+  METRICS_NEXT = (METRICS_NEXT + 1) % METRICS_SAMPLE_COUNT;
+  if (METRICS_FILLED < METRICS_SAMPLE_COUNT) {
+    METRICS_FILLED++;
+  }
+
+  if (METRICS_SERIAL_DUMP == true) {
+    LOG_INFO("metrics: t=%lu heap=%lu block=%u frag=%u%% stack=%lu",
+             (unsigned long)sample.timestamp, (unsigned long)sample.free_heap,
+             sample.max_free_block, sample.fragmentation, (unsigned long)sample.free_stack);
+  }
+}
+
+/**
+ * @brief Takes a sample if METRICS_INTERVAL passed since the last one.
+ * 
+ * @details Called from loop(). Works also if millis() overflows.
+ * 
+ * @callgraph
+ * 
+ * @callergraph
+ */
+void update_metrics() {
+  if (millis() - METRICS_LAST_SAMPLE >= METRICS_INTERVAL) {
+    METRICS_LAST_SAMPLE = millis();
+    sample_metrics();
+  }
+}
+
+/**
+ * @brief Returns the number of valid samples in the ring buffer.
+ * 
+ * @return uint8_t - number of samples (at most METRICS_SAMPLE_COUNT)
+ * 
+ * @callgraph This function does not call any other function.
+ * 
+ * @callergraph
+ */
+uint8_t get_metrics_sample_count() {
+  return METRICS_FILLED;
+}
+
+/**
+ * @brief Returns a sample from the ring buffer.
+ * 
+ * @param age - 0 for the newest sample, 1 for the one before and so on
+ * 
+ * @return metrics_sample - the sample (all zero if there is no sample of that age)
+ * 
+ * @callgraph This function does not call any other function.
+ * 
+ * @callergraph
+ */
+metrics_sample get_metrics_sample(uint8_t age) {
+  metrics_sample empty = {0, 0, 0, 0, 0};
+  if (age >= METRICS_FILLED) {
+    return empty;
+  }
+  return METRICS_SAMPLES[(METRICS_NEXT + METRICS_SAMPLE_COUNT - 1 - age) % METRICS_SAMPLE_COUNT];
+}
+
+/**
+ * @brief Returns the heap usage counter of a subsystem.
+ * 
+ * @param subsystem - subsystem to be returned
+ * 
+ * @return metrics_counter - calls and heap deltas of the subsystem
+ * 
+ * @callgraph This function does not call any other function.
+ * 
+ * @callergraph
+ */
+metrics_counter get_metrics_counter(metrics_subsystem subsystem) {
+  return METRICS_COUNTERS[subsystem];
+}
+
+/**
+ * @brief Writes one sample as JSON object.
+ * 
+ * @param output - stream the JSON is written to
+ * 
+ * @param sample - sample to be written
+ * 
+ * @return size_t - number of written bytes
+ * 
+ * @details Formatted in a buffer on the stack, Print::printf() would allocate its buffer in the heap.
+ * 
+ * @callgraph This function does not call any other function.
+ * 
+ * @callergraph
+ */
+size_t print_metrics_sample(Print &output, const metrics_sample &sample) {
+  char line[METRICS_LINE_LENGTH];
+  snprintf(line, sizeof(line), "{\"timestamp\":%lu,\"free_heap\":%lu,\"max_free_block\":%u,\"fragmentation\":%u,\"free_stack\":%lu}",
+           (unsigned long)sample.timestamp, (unsigned long)sample.free_heap,
+           sample.max_free_block, sample.fragmentation, (unsigned long)sample.free_stack);
+  return output.print(line);
+}
+
+/**
+ * @brief Writes the current state, all samples and all subsystem counters as JSON.
+ * 
+ * @param output - stream the JSON is written to (e.g. the client of the webserver or Serial)
+ * 
+ * @param now - current state (from read_metrics()), passed in so that printing twice gives the same length
+ * 
+ * @return size_t - number of written bytes
+ * 
+ * @details The JSON is printed piece by piece from a buffer on the stack so no document or String
+ * has to be allocated, which would distort the values it reports. Format:\n
+ * {"now":{...sample...},"samples":[{...},...],"subsystems":{"capture":{"calls":..,...},...}}\n
+ * The samples are sorted from oldest to newest.
+ * 
+ * @callgraph
+ * 
+ * @callergraph
+ */
+size_t print_metrics_json(Print &output, metrics_sample now) {
+
+  size_t written = 0;
+
+  // current state
+  written += output.print("{\"now\":");
+  written += print_metrics_sample(output, now);
+
+  // samples from oldest to newest
+  written += output.print(",\"samples\":[");
+  for (int age = METRICS_FILLED - 1; age >= 0; age--) {
+    written += print_metrics_sample(output, get_metrics_sample(age));
+    if (age > 0) {
+      written += output.print(",");
+    }
+  }
+  written += output.print("],");
+
+  // subsystem counters
+  written += output.print("\"subsystems\":{");
+  char line[METRICS_LINE_LENGTH];
+  for (int i = 0; i < METRICS_SUBSYSTEM_COUNT; i++) {
+    metrics_counter &counter = METRICS_COUNTERS[i];
+    snprintf(line, sizeof(line), "\"%s\":{\"calls\":%lu,\"total_heap_delta\":%ld,\"max_heap_delta\":%ld,\"min_free_heap\":%lu}",
+             METRICS_SUBSYSTEM_NAMES[i], (unsigned long)counter.calls, (long)counter.total_heap_delta,
+             (long)counter.max_heap_delta, (unsigned long)counter.min_free_heap);
+    written += output.print(line);
+    if (i < METRICS_SUBSYSTEM_COUNT - 1) {
+      written += output.print(",");
+    }
+  }
+  written += output.print("},");
+
+  // documents of the storage functions (see json_arena.h)
+  json_arena_stats arena = get_json_arena_stats();
+  snprintf(line, sizeof(line), "\"json_arena\":{\"allocations\":%lu,\"heap_allocations\":%lu,\"used\":%u,\"peak\":%u,\"size\":%u}}",
+           (unsigned long)arena.allocations, (unsigned long)arena.heap_allocations,
+           (unsigned)arena.used, (unsigned)arena.peak, (unsigned)JSON_ARENA_SIZE);
+  written += output.print(line);
+
+  return written;
+}
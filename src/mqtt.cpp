@@ -0,0 +1,388 @@
+/**
+ * @file mqtt.cpp
+ *
+ * @author Marc Ubbelohde
+ *
+ * @brief In this file, the MQTT bridge is defined.
+ *
+ * @details Devices on a home automation bus used to be driven by polling the website. With the
+ * bridge enabled the device subscribes to command topics and publishes its events and metrics.
+ * Received commands are not executed in the callback of the client (which runs inside its loop())
+ * but put into a fixed queue and executed one per call of the background work with the same code
+ * as the UDP command port (run_udp_command()). Their results reach the broker as message events.
+ * Events are not published one by one: they are read from the event ring every
+ * MQTT_PUBLISH_INTERVAL and published as one message. Publishing is QoS 0 and only happens if the
+ * message fits into the send buffer of the connection without waiting. Otherwise the events stay
+ * in the ring until the next attempt and the oldest are lost if the broker can not keep up, the
+ * same back-pressure as for the clients of /api/events. Commands are subscribed with QoS 1 in a
+ * persistent session (no clean session), so the broker keeps them while the device is not
+ * connected.
+ */
+
+#include "base.h"
+
+#if MQTT_ENABLED
+#include <PubSubClient.h>
+#endif
+
+/**
+ * @brief Queue of received commands (ring, MQTT_QUEUE_COUNT are waiting from MQTT_QUEUE_START on).
+ *
+ */
+mqtt_command MQTT_QUEUE[MQTT_QUEUE_SIZE];
+
+/**
+ * @brief Index of the oldest command in the queue.
+ *
+ */
+uint8_t MQTT_QUEUE_START = 0;
+
+/**
+ * @brief Number of commands in the queue.
+ *
+ */
+uint8_t MQTT_QUEUE_COUNT = 0;
+
+/**
+ * @brief Converts a hex digit to its value.
+ *
+ * @return int - value of the digit or -1 if it is not a hex digit
+ *
+ * @callgraph This function does not call any other function.
+ *
+ * @callergraph
+ */
+int hex_digit_value(char c) {
+  if (c >= '0' && c <= '9') {
+    return c - '0';
+  }
+  if (c >= 'a' && c <= 'f') {
+    return c - 'a' + 10;
+  }
+  if (c >= 'A' && c <= 'F') {
+    return c - 'A' + 10;
+  }
+  return -1;
+}
+
+/**
+ * @brief Reads a received message into a command.
+ *
+ * @param topic - topic of the message without MQTT_TOPIC (e.g. "signal/send")
+ *
+ * @param payload - payload of the message (not terminated)
+ *
+ * @param length - length of the payload
+ *
+ * @param command - the command with the payload of the UDP command port (see udp_command.h)
+ *
+ * @return boolean - true if the message is a valid command
+ *
+ * @details State commands are written as "protocol,hex state[,bits]" (e.g. "3,20DF10EF,32" or
+ * "DAIKIN,11DA27...") like in the IRMQTTServer example of the IRremoteESP8266 library.
+ *
+ * @callgraph
+ *
+ * @callergraph
+ */
+boolean parse_mqtt_command(const char *topic, const uint8_t *payload, size_t length, mqtt_command &command) {
+  if (strcmp(topic, "signal/send") == 0 || strcmp(topic, "program/play") == 0) {
+    if (length == 0 || length > 32) {
+      return false;
+    }
+    command.type = topic[0] == 's' ? UDP_SEND_SIGNAL : UDP_PLAY_PROGRAM;
+    command.length = length;
+    memcpy(command.payload, payload, length);
+    return true;
+  }
+
+  if (strcmp(topic, "state/send") != 0) {
+    return false;
+  }
+
+  // protocol (number or name)
+  char protocol_text[24];
+  size_t position = 0;
+  while (position < length && payload[position] != ',' && position < sizeof(protocol_text) - 1) {
+    protocol_text[position] = payload[position];
+    position++;
+  }
+  protocol_text[position] = '\0';
+  if (position == 0 || position >= length || payload[position] != ',') {
+    return false;
+  }
+  int protocol;
+  if (isdigit(protocol_text[0])) {
+    protocol = atoi(protocol_text);
+  }
+  else {
+    protocol = strToDecodeType(protocol_text);
+    if (protocol == UNKNOWN) {
+      return false;
+    }
+  }
+  position++;
+
+  // state (hex, with or without "0x")
+  if (position + 1 < length && payload[position] == '0' && (payload[position + 1] == 'x' || payload[position + 1] == 'X')) {
+    position += 2;
+  }
+  uint8_t state_length = 0;
+  while (position + 1 < length && payload[position] != ',') {
+    int high = hex_digit_value(payload[position]);
+    int low = hex_digit_value(payload[position + 1]);
+    if (high < 0 || low < 0 || 4 + state_length >= UDP_MAX_PAYLOAD) {
+      return false;
+    }
+    command.payload[4 + state_length] = (high << 4) | low;
+    state_length++;
+    position += 2;
+  }
+
+  // number of bits (optional)
+  unsigned long bits = 0;
+  if (position < length && payload[position] == ',') {
+    for (position++; position < length; position++) {
+      if (isdigit(payload[position]) == false) {
+        return false;
+      }
+      bits = bits * 10 + (payload[position] - '0');
+    }
+  }
+  if (position != length || state_length == 0 || bits > 0xffff) {
+    return false;
+  }
+
+  command.type = UDP_SEND_STATE;
+  command.length = 4 + state_length;
+  command.payload[0] = protocol >> 8;
+  command.payload[1] = protocol;
+  command.payload[2] = bits >> 8;
+  command.payload[3] = bits;
+  return true;
+}
+
+/**
+ * @brief Adds a command to the queue.
+ *
+ * @param command - command
+ *
+ * @return boolean - false if the queue is full
+ *
+ * @callgraph This function does not call any other function.
+ *
+ * @callergraph
+ */
+boolean mqtt_queue_command(const mqtt_command &command) {
+  if (MQTT_QUEUE_COUNT == MQTT_QUEUE_SIZE) {
+    return false;
+  }
+  MQTT_QUEUE[(MQTT_QUEUE_START + MQTT_QUEUE_COUNT) % MQTT_QUEUE_SIZE] = command;
+  MQTT_QUEUE_COUNT++;
+  return true;
+}
+
+/**
+ * @brief Takes the oldest command from the queue.
+ *
+ * @param command - the command
+ *
+ * @return boolean - false if the queue is empty
+ *
+ * @callgraph This function does not call any other function.
+ *
+ * @callergraph
+ */
+boolean mqtt_next_command(mqtt_command &command) {
+  if (MQTT_QUEUE_COUNT == 0) {
+    return false;
+  }
+  command = MQTT_QUEUE[MQTT_QUEUE_START];
+  MQTT_QUEUE_START = (MQTT_QUEUE_START + 1) % MQTT_QUEUE_SIZE;
+  MQTT_QUEUE_COUNT--;
+  return true;
+}
+
+#if MQTT_ENABLED
+
+/**
+ * @brief Connection to the broker.
+ *
+ */
+WiFiClient MQTT_CONNECTION;
+
+/**
+ * @brief MQTT client.
+ *
+ */
+PubSubClient MQTT_CLIENT(MQTT_CONNECTION);
+
+/**
+ * @brief Id of the first event that was not published yet.
+ *
+ */
+uint32_t MQTT_NEXT_EVENT = 1;
+
+/**
+ * @brief Time of the last attempt to connect, to publish the events and the metrics (millis()).
+ *
+ */
+unsigned long MQTT_LAST_CONNECT = 0;
+unsigned long MQTT_LAST_PUBLISH = 0;
+unsigned long MQTT_LAST_METRICS = 0;
+
+/**
+ * @brief Time (ms) until the next attempt to connect (grows while the broker can not be reached).
+ *
+ */
+unsigned long MQTT_RECONNECT_DELAY = MQTT_RECONNECT_INTERVAL;
+
+/**
+ * @brief Handles a received message.
+ *
+ * @param topic - full topic
+ *
+ * @param payload - payload
+ *
+ * @param length - length of the payload
+ *
+ * @details Only reads the command and puts it into the queue, invalid commands and commands that
+ * do not fit into the queue are rejected with a message event.
+ *
+ * @callgraph
+ *
+ * @callergraph This function is called by MQTT_CLIENT.loop().
+ */
+void mqtt_callback(char *topic, uint8_t *payload, unsigned int length) {
+  size_t prefix = strlen(MQTT_TOPIC);
+  if (strncmp(topic, MQTT_TOPIC, prefix) != 0 || topic[prefix] != '/') {
+    return;
+  }
+
+  mqtt_command command;
+  if (parse_mqtt_command(topic + prefix + 1, payload, length, command) == false) {
+    publish_message("mqtt: invalid command on " + String(topic));
+  }
+  else if (mqtt_queue_command(command) == false) {
+    publish_message("mqtt: command queue is full");
+  }
+}
+
+/**
+ * @brief Publishes a message that is printed by a function (without building it in the heap).
+ *
+ * @param topic - topic below MQTT_TOPIC
+ *
+ * @param length - length of the message (counted with a metrics_byte_counter)
+ *
+ * @param print - prints the message
+ *
+ * @return boolean - true if the message was published
+ *
+ * @callgraph
+ *
+ * @callergraph
+ */
+template <typename F>
+boolean mqtt_publish(const char *topic, size_t length, F print) {
+  String full_topic = String(MQTT_TOPIC) + "/" + topic;
+  if (MQTT_CLIENT.beginPublish(full_topic.c_str(), length, false) == false) {
+    return false;
+  }
+  print(MQTT_CLIENT);
+  return MQTT_CLIENT.endPublish();
+}
+
+/**
+ * @brief Sets up the MQTT client.
+ *
+ * @callgraph
+ *
+ * @callergraph
+ */
+void init_mqtt() {
+  MQTT_CLIENT.setServer(MQTT_HOST, MQTT_PORT);
+  MQTT_CLIENT.setCallback(mqtt_callback);
+  // the connection attempt blocks the background work, so it is kept short (the TCP connect
+  // waits for the timeout of the connection, the MQTT handshake for the socket timeout)
+  MQTT_CONNECTION.setTimeout(MQTT_CONNECT_TIMEOUT);
+  MQTT_CLIENT.setSocketTimeout(1);
+  MQTT_NEXT_EVENT = get_last_event_id() + 1;
+  // build the index of the protocol names now instead of in the first command
+  strToDecodeType("");
+}
+
+/**
+ * @brief Keeps the connection to the broker and publishes events and metrics.
+ *
+ * @details Called from the background work. Reconnects after MQTT_RECONNECT_INTERVAL while the
+ * broker can not be reached, the interval is doubled after every failed attempt up to
+ * MQTT_MAX_RECONNECT_INTERVAL. Events are published in batches of at most MQTT_BATCH_SIZE bytes,
+ * and only if the batch fits into the send buffer of the connection.
+ *
+ * @callgraph
+ *
+ * @callergraph
+ */
+void update_mqtt() {
+  if (String(MQTT_HOST) == "" || WiFi.status() != WL_CONNECTED) {
+    return;
+  }
+
+  if (MQTT_CLIENT.connected() == false) {
+    if (millis() - MQTT_LAST_CONNECT < MQTT_RECONNECT_DELAY && MQTT_LAST_CONNECT != 0) {
+      return;
+    }
+    MQTT_LAST_CONNECT = millis();
+
+    String client_id = "ir-controller-" + String(ESP.getChipId(), HEX);
+    String status_topic = String(MQTT_TOPIC) + "/status";
+    // no clean session, the broker keeps the subscriptions and the QoS 1 commands while offline
+    if (MQTT_CLIENT.connect(client_id.c_str(), NULL, NULL, status_topic.c_str(), 1, true, "offline", false) == false) {
+      MQTT_RECONNECT_DELAY = min(MQTT_RECONNECT_DELAY * 2, MQTT_MAX_RECONNECT_INTERVAL);
+      LOG_WARN("mqtt: could not connect to %s (state %d), next attempt in %lu s", MQTT_HOST, MQTT_CLIENT.state(), MQTT_RECONNECT_DELAY / 1000);
+      return;
+    }
+    MQTT_RECONNECT_DELAY = MQTT_RECONNECT_INTERVAL;
+    MQTT_CLIENT.publish(status_topic.c_str(), "online", true);
+    const char *topics[] = {"signal/send", "program/play", "state/send"};
+    for (uint8_t i = 0; i < 3; i++) {
+      MQTT_CLIENT.subscribe((String(MQTT_TOPIC) + "/" + topics[i]).c_str(), 1);
+    }
+    LOG_INFO("mqtt: connected to %s", MQTT_HOST);
+  }
+
+  MQTT_CLIENT.loop();
+
+  // batch of events (back-pressure: wait while the connection can not take it)
+  if (MQTT_NEXT_EVENT <= get_last_event_id() && millis() - MQTT_LAST_PUBLISH >= MQTT_PUBLISH_INTERVAL) {
+    MQTT_LAST_PUBLISH = millis();
+
+    int room = MQTT_CONNECTION.availableForWrite() - (int)strlen(MQTT_TOPIC) - 16;
+    uint32_t next_id = MQTT_NEXT_EVENT;
+    metrics_byte_counter counter;
+    print_events_json(next_id, counter, min((size_t)max(room, 0), MQTT_BATCH_SIZE));
+
+    if (counter.count > 0) {
+      uint32_t published_id = MQTT_NEXT_EVENT;
+      size_t batch_room = counter.count;
+      if (mqtt_publish("events", counter.count, [&](Print &output) { print_events_json(published_id, output, batch_room); })) {
+        MQTT_NEXT_EVENT = published_id;
+      }
+    }
+  }
+
+  // metrics
+  if (millis() - MQTT_LAST_METRICS >= MQTT_METRICS_INTERVAL) {
+    metrics_sample now = read_metrics();
+    metrics_byte_counter counter;
+    print_metrics_sample(counter, now);
+
+    if ((size_t)MQTT_CONNECTION.availableForWrite() >= counter.count + strlen(MQTT_TOPIC) + 16) {
+      MQTT_LAST_METRICS = millis();
+      mqtt_publish("metrics", counter.count, [&](Print &output) { print_metrics_sample(output, now); });
+    }
+  }
+}
+
+#endif  // MQTT_ENABLED
@@ -0,0 +1,371 @@
+/**
+ * @file rtc_state.cpp
+ *
+ * @author Marc Ubbelohde
+ *
+ * @brief In this file, the state in the RTC user memory is defined.
+ *
+ * @details After a reset millis() starts at 0 again, so the time in the key-value store can not be
+ * continued and init_time() had to wait for NTP. In AP mode the time was lost until the user
+ * synchronized it and a running program was forgotten. The RTC user memory keeps its content
+ * over a reset (not over a power loss), so the clock and the running program are checkpointed
+ * there: every RTC_CHECKPOINT_INTERVAL from the background work and whenever they change. On
+ * boot the state is read back before the Wi-Fi is started. A checksum tells a valid state from
+ * the random content after a power loss. NTP corrects the restored clock later and measures its
+ * drift, which is then taken out of the time (see correct_clock_drift()). The clock keeps its
+ * milliseconds, so the checkpoints do not cut off a part of a second every time.
+ */
+
+#include "base.h"
+
+/**
+ * @brief State in RAM (clock and sync_age at RTC_ANCHOR).
+ *
+ */
+rtc_state RTC_STATE = {RTC_STATE_MAGIC, 0, 0, 0, 0, 0, 0, 0, 0, "", 0};
+
+/**
+ * @brief millis() at the time RTC_STATE.clock was set.
+ *
+ */
+unsigned long RTC_ANCHOR = 0;
+
+/**
+ * @brief millis() of the last checkpoint.
+ *
+ */
+unsigned long RTC_LAST_CHECKPOINT = 0;
+
+/**
+ * @brief Calculates the checksum of a state.
+ *
+ * @param state - state
+ *
+ * @return uint32_t - CRC-32 of all fields before the checksum
+ *
+ * @callgraph
+ *
+ * @callergraph
+ */
+uint32_t rtc_checksum(const rtc_state &state) {
+  return kv_crc32(0, (const uint8_t *)&state, offsetof(rtc_state, checksum));
+}
+
+/**
+ * @brief Reads the state from the RTC user memory.
+ *
+ * @param state - the state
+ *
+ * @return boolean - true if the state is valid (magic and checksum)
+ *
+ * @callgraph
+ *
+ * @callergraph
+ */
+boolean read_rtc_state(rtc_state &state) {
+  if (ESP.rtcUserMemoryRead(RTC_STATE_OFFSET, (uint32_t *)&state, sizeof(state)) == false) {
+    return false;
+  }
+  return state.magic == RTC_STATE_MAGIC && state.checksum == rtc_checksum(state);
+}
+
+/**
+ * @brief Writes a state to the RTC user memory.
+ *
+ * @param state - state (its checksum is set)
+ *
+ * @callgraph
+ *
+ * @callergraph
+ */
+void write_rtc_state(rtc_state &state) {
+  state.magic = RTC_STATE_MAGIC;
+  state.checksum = rtc_checksum(state);
+  ESP.rtcUserMemoryWrite(RTC_STATE_OFFSET, (uint32_t *)&state, sizeof(state));
+}
+
+/**
+ * @brief Time since the anchor without the drift.
+ *
+ * @return unsigned long - time in ms
+ *
+ * @callgraph
+ *
+ * @callergraph
+ */
+unsigned long rtc_elapsed() {
+  return correct_clock_drift(millis() - RTC_ANCHOR);
+}
+
+/**
+ * @brief Advances the clock of a state.
+ *
+ * @param state - state
+ *
+ * @param elapsed - time in ms (without the drift)
+ *
+ * @callgraph This function does not call any other function.
+ *
+ * @callergraph
+ */
+void rtc_advance(rtc_state &state, unsigned long elapsed) {
+  unsigned long clock_ms = state.clock_ms + elapsed;
+  state.clock = (state.clock + clock_ms / 1000) % WEEK_SECONDS;
+  state.clock_ms = clock_ms % 1000;
+  state.sync_age += elapsed / 1000;
+}
+
+/**
+ * @brief Writes the current state to the RTC user memory.
+ *
+ * @callgraph
+ *
+ * @callergraph
+ */
+void checkpoint_rtc_state() {
+  rtc_state state = RTC_STATE;
+  rtc_advance(state, rtc_elapsed());
+  write_rtc_state(state);
+  RTC_LAST_CHECKPOINT = millis();
+}
+
+/**
+ * @brief Reads the state after a reset.
+ *
+ * @return boolean - true if a state was restored
+ *
+ * @details The checkpoint was at most RTC_CHECKPOINT_INTERVAL before the reset, the clock is
+ * continued from the start of millis(). If the clock is valid it is written to the key-value
+ * store, so get_current_time() works before NTP is reached. A program that was reset
+ * RTC_MAX_RESUMES times on the same line is not continued anymore.
+ *
+ * @callgraph
+ *
+ * @callergraph
+ */
+boolean restore_rtc_state() {
+  rtc_state state;
+  if (read_rtc_state(state) == false) {
+    LOG_INFO("rtc: no state to restore");
+    return false;
+  }
+
+  RTC_STATE = state;
+  RTC_ANCHOR = 0;
+
+  if (RTC_STATE.flags & RTC_PROGRAM_RUNNING) {
+    RTC_STATE.resumes++;
+    if (RTC_STATE.resumes > RTC_MAX_RESUMES) {
+      LOG_ERROR("rtc: program %s was reset %d times in line %d", RTC_STATE.program, RTC_MAX_RESUMES, RTC_STATE.program_line);
+      RTC_STATE.flags &= ~RTC_PROGRAM_RUNNING;
+      RTC_STATE.program[0] = '\0';
+    }
+  }
+  checkpoint_rtc_state();
+
+  if (RTC_STATE.flags & RTC_CLOCK_VALID) {
+    save_clock(get_rtc_clock(), RTC_STATE.timezone, RTC_ANCHOR);
+    LOG_INFO("rtc: restored time %s", get_current_time().c_str());
+  }
+  return true;
+}
+
+/**
+ * @brief Checkpoints the state every RTC_CHECKPOINT_INTERVAL.
+ *
+ * @details Called from the background work. The clock is anchored again every RTC_ANCHOR_INTERVAL,
+ * so the time since the anchor never overflows.
+ *
+ * @callgraph
+ *
+ * @callergraph
+ */
+void update_rtc_state() {
+  if (millis() - RTC_ANCHOR >= RTC_ANCHOR_INTERVAL) {
+    rtc_advance(RTC_STATE, rtc_elapsed());
+    RTC_ANCHOR = millis();
+  }
+
+  if (millis() - RTC_LAST_CHECKPOINT >= RTC_CHECKPOINT_INTERVAL) {
+    checkpoint_rtc_state();
+  }
+}
+
+/**
+ * @brief Returns the current state.
+ *
+ * @return rtc_state - state as it would be checkpointed now
+ *
+ * @callgraph
+ *
+ * @callergraph
+ */
+rtc_state get_rtc_state() {
+  rtc_state state = RTC_STATE;
+  rtc_advance(state, rtc_elapsed());
+  return state;
+}
+
+/**
+ * @brief Returns the current time of the clock.
+ *
+ * @return uint32_t - seconds since Sunday 00:00
+ *
+ * @callgraph
+ *
+ * @callergraph
+ */
+uint32_t get_rtc_clock() {
+  return (RTC_STATE.clock + (RTC_STATE.clock_ms + rtc_elapsed()) / 1000) % WEEK_SECONDS;
+}
+
+/**
+ * @brief Returns the measured drift of millis().
+ *
+ * @return int32_t - ppm millis() runs faster than NTP
+ *
+ * @callgraph This function does not call any other function.
+ *
+ * @callergraph
+ */
+int32_t get_clock_drift() {
+  return RTC_STATE.drift;
+}
+
+/**
+ * @brief Sets the clock.
+ *
+ * @param clock - seconds since Sunday 00:00
+ *
+ * @param clock_ms - milliseconds of the current second
+ *
+ * @param timezone - timezone in seconds
+ *
+ * @param synced - true if the time is from NTP, false if it is from the user
+ *
+ * @details If the clock ran at least RTC_DRIFT_MIN_AGE since the last NTP sync, the difference
+ * to NTP is the error of the drift that was taken out so far, the drift is corrected by it. A
+ * reset in between adds at most RTC_CHECKPOINT_INTERVAL to the difference.
+ *
+ * @callgraph
+ *
+ * @callergraph
+ */
+void rtc_set_clock(uint32_t clock, uint16_t clock_ms, int32_t timezone, boolean synced) {
+  clock = (clock + clock_ms / 1000) % WEEK_SECONDS;
+  clock_ms = clock_ms % 1000;
+
+  rtc_state current = get_rtc_state();
+  if (synced == true && (current.flags & RTC_CLOCK_SYNCED) && current.sync_age >= RTC_DRIFT_MIN_AGE) {
+    // error in ms (a week has 604800000 ms, which fits into int32_t)
+    const int32_t week_ms = WEEK_SECONDS * 1000;
+    int32_t error = ((int32_t)clock * 1000 + clock_ms) - ((int32_t)current.clock * 1000 + current.clock_ms);
+    if (error > week_ms / 2) {
+      error -= week_ms;
+    }
+    else if (error < -week_ms / 2) {
+      error += week_ms;
+    }
+
+    int32_t drift = current.drift - (int32_t)((int64_t)error * 1000 / current.sync_age);
+    if (drift >= -RTC_DRIFT_LIMIT && drift <= RTC_DRIFT_LIMIT) {
+      RTC_STATE.drift = drift;
+      LOG_INFO("rtc: clock was %d ms off after %u s, drift %d ppm", -error, current.sync_age, drift);
+    }
+    else {
+      LOG_WARN("rtc: ignored drift of %d ppm", drift);
+    }
+  }
+
+  RTC_STATE.clock = clock;
+  RTC_STATE.clock_ms = clock_ms;
+  RTC_STATE.timezone = timezone;
+  RTC_STATE.sync_age = 0;
+  RTC_STATE.flags |= RTC_CLOCK_VALID;
+  if (synced == true) {
+    RTC_STATE.flags |= RTC_CLOCK_SYNCED;
+  }
+  else {
+    RTC_STATE.flags &= ~RTC_CLOCK_SYNCED;
+  }
+  RTC_ANCHOR = millis();
+  checkpoint_rtc_state();
+}
+
+/**
+ * @brief Sets the timezone of the clock.
+ *
+ * @param timezone - timezone in seconds
+ *
+ * @callgraph
+ *
+ * @callergraph
+ */
+void rtc_set_timezone(int32_t timezone) {
+  RTC_STATE.timezone = timezone;
+  checkpoint_rtc_state();
+}
+
+/**
+ * @brief Sets the running program.
+ *
+ * @param name - name of the program or NULL if no program runs anymore
+ *
+ * @details If the program is already set it was restored after a reset, its line and the number
+ * of resets are kept.
+ *
+ * @callgraph
+ *
+ * @callergraph
+ */
+void rtc_set_program(const char *name) {
+  if (name == NULL || name[0] == '\0') {
+    RTC_STATE.flags &= ~RTC_PROGRAM_RUNNING;
+    RTC_STATE.program[0] = '\0';
+    RTC_STATE.program_line = 0;
+    RTC_STATE.resumes = 0;
+  }
+  else if ((RTC_STATE.flags & RTC_PROGRAM_RUNNING) == 0 || strncmp(RTC_STATE.program, name, RTC_PROGRAM_LENGTH) != 0) {
+    RTC_STATE.flags |= RTC_PROGRAM_RUNNING;
+    strncpy(RTC_STATE.program, name, RTC_PROGRAM_LENGTH);
+    RTC_STATE.program[RTC_PROGRAM_LENGTH] = '\0';
+    RTC_STATE.program_line = 0;
+    RTC_STATE.resumes = 0;
+  }
+  checkpoint_rtc_state();
+}
+
+/**
+ * @brief Sets the line the running program is at.
+ *
+ * @param line - line number (starting at 1)
+ *
+ * @callgraph
+ *
+ * @callergraph
+ */
+void rtc_set_program_line(uint16_t line) {
+  if ((RTC_STATE.flags & RTC_PROGRAM_RUNNING) == 0 || line == RTC_STATE.program_line) {
+    return;
+  }
+  RTC_STATE.program_line = line;
+  RTC_STATE.resumes = 0;
+  checkpoint_rtc_state();
+}
+
+/**
+ * @brief Deletes the state in RAM and in the RTC user memory (like after a power loss).
+ *
+ * @callgraph
+ *
+ * @callergraph
+ */
+void rtc_clear() {
+  RTC_STATE = {RTC_STATE_MAGIC, 0, 0, 0, 0, 0, 0, 0, 0, "", 0};
+  RTC_ANCHOR = millis();
+  rtc_state state = RTC_STATE;
+  write_rtc_state(state);
+  // an invalid checksum
+  state.checksum = ~state.checksum;
+  ESP.rtcUserMemoryWrite(RTC_STATE_OFFSET, (uint32_t *)&state, sizeof(state));
+}
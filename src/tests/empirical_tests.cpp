@@ -44,7 +44,8 @@ boolean empirical_test_get_NTP_time() {
 	// get reference time (checked manually):
 	init_time();
 
-	DynamicJsonDocument current_doc = load_json("/time.json");
+	DynamicJsonDocument current_doc(1024);
+	kv_load_json("time", current_doc);
 
 	// print current_doc
 	serializeJson(current_doc, Serial);
@@ -76,7 +77,7 @@ boolean empirical_test_get_NTP_time() {
 		init_time();
 		unsigned long execution_time = millis() - start_time;
 
-		current_doc = load_json("/time.json");
+		kv_load_json("time", current_doc);
 
 		// retrieve data from json's
 		int current_hours = current_doc["hours"];
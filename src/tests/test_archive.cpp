@@ -0,0 +1,195 @@
+/**
+ * @file test_archive.cpp
+ * @author Marc Ubbelohde
+ * @brief This file contains unit tests for all functions from the archive.cpp.
+ *
+ */
+
+
+#include "tests.h"
+
+/**
+ * @brief Unit test for the function "get_archive_size"
+ *
+ * @return boolean - true if the test passed, false if the test failed
+ *
+ * @details - Setup: Clean LittleFS
+ * -# checks the size of an empty library (header and end marker)
+ * -# checks the size of a library with one signal and one program
+ *
+ * @see get_archive_size
+ */
+boolean test_get_archive_size() {
+
+	// Clean LittleFS
+	clean_LittleFS();
+
+	// empty library: 5 bytes header + 1 byte end marker
+	size_t size = get_archive_size("/signals", "/programs");
+	if (size != 6) {
+		Serial.println("\e[0;31mtest_get_archive_size: FAILED");
+		Serial.println("expected size: 6 , actual size: " + String(size) + "\e[0;37m");
+		clean_LittleFS();
+		return(false);
+	}
+
+	// one signal ("abc", 10 bytes) and one program ("de", 4 bytes)
+	LittleFS.begin();
+	File file = LittleFS.open("/signals/abc.json", "w");
+	file.print("0123456789");
+	file.close();
+	file = LittleFS.open("/programs/de.txt", "w");
+	file.print("wait");
+	file.close();
+	LittleFS.end();
+
+	// 6 + (1 + 1 + 3 + 4 + 10) + (1 + 1 + 2 + 4 + 4)
+	size = get_archive_size("/signals", "/programs");
+	if (size != 37) {
+		Serial.println("\e[0;31mtest_get_archive_size: FAILED");
+		Serial.println("expected size: 37 , actual size: " + String(size) + "\e[0;37m");
+		clean_LittleFS();
+		return(false);
+	}
+
+	// prints success message and returns true
+	Serial.println("\e[0;32mtest_get_archive_size: PASSED\e[0;37m");
+	clean_LittleFS();
+	return(true);
+}
+
+/**
+ * @brief Unit test for the function "write_archive"
+ *
+ * @return boolean - true if the test passed, false if the test failed
+ *
+ * @details - Setup: Clean LittleFS, save one signal and one program
+ * -# checks if the archive is written byte by byte as specified
+ * -# checks if the number of written bytes matches get_archive_size()
+ *
+ * @see write_archive
+ */
+boolean test_write_archive() {
+
+	// Clean LittleFS
+	clean_LittleFS();
+
+	LittleFS.begin();
+	File file = LittleFS.open("/signals/abc.json", "w");
+	file.print("{}");
+	file.close();
+	file = LittleFS.open("/programs/de.txt", "w");
+	file.print("x");
+	file.close();
+	LittleFS.end();
+
+	size_t expected_size = get_archive_size("/signals", "/programs");
+
+	// write archive to a String (test only)
+	StreamString content;
+	size_t written = write_archive(content, "/signals", "/programs");
+
+	const char expected[] = "IRLA\x01" "S\x03" "abc\x02\x00\x00\x00{}" "P\x02" "de\x01\x00\x00\x00x" "E";
+	String expected_content = "";
+	for (unsigned int i = 0; i < sizeof(expected) - 1; i++) {
+		expected_content += expected[i];
+	}
+
+	if (written != expected_size || content != expected_content) {
+		Serial.println("\e[0;31mtest_write_archive: FAILED");
+		Serial.println("expected size: " + String(expected_size) + " , written: " + String(written) + " , archive length: " + String(content.length()) + "\e[0;37m");
+		clean_LittleFS();
+		return(false);
+	}
+
+	// prints success message and returns true
+	Serial.println("\e[0;32mtest_write_archive: PASSED\e[0;37m");
+	clean_LittleFS();
+	return(true);
+}
+
+/**
+ * @brief Unit test for the functions "import_archive_begin", "import_archive_chunk" and "import_archive_end"
+ *
+ * @return boolean - true if the test passed, false if the test failed
+ *
+ * @details - Setup: Clean LittleFS, write archive with one signal and one program
+ * -# checks if an archive that is split in small chunks is imported correctly
+ * -# checks if an archive with invalid header is rejected
+ * -# checks if an incomplete archive is rejected
+ *
+ * @see import_archive_chunk
+ */
+boolean test_import_archive() {
+
+	// Clean LittleFS
+	clean_LittleFS();
+
+	LittleFS.begin();
+	File file = LittleFS.open("/signals/abc.json", "w");
+	file.print("{\"length\":3,\"sequence\":\"1234, 5678, 412\"}");
+	file.close();
+	file = LittleFS.open("/programs/de.txt", "w");
+	file.print("play abc");
+	file.close();
+	LittleFS.end();
+
+	// write archive to a String (test only) and remove the library
+	StreamString content;
+	write_archive(content, "/signals", "/programs");
+
+	LittleFS.begin();
+	LittleFS.remove("/signals/abc.json");
+	LittleFS.remove("/programs/de.txt");
+	LittleFS.end();
+
+	// import archive in chunks of 7 bytes
+	import_archive_begin();
+	for (unsigned int i = 0; i < content.length(); i += 7) {
+		unsigned int chunk = content.length() - i < 7 ? content.length() - i : 7;
+		import_archive_chunk((const uint8_t *)content.c_str() + i, chunk);
+	}
+	action_status status = ACTION_FAILED;
+	String message = import_archive_end(status);
+
+	LittleFS.begin();
+	file = LittleFS.open("/signals/abc.json", "r");
+	String signal = file.readString();
+	file.close();
+	LittleFS.end();
+	String program = read_program("de");
+
+	if (message != "successfully imported 1 signals and 1 programs" || status != ACTION_OK || signal != "{\"length\":3,\"sequence\":\"1234, 5678, 412\"}" || program != "play abc") {
+		Serial.println("\e[0;31mtest_import_archive: FAILED");
+		Serial.println("message: " + message + " , signal: " + signal + " , program: " + program + "\e[0;37m");
+		clean_LittleFS();
+		return(false);
+	}
+
+	// invalid header
+	import_archive_begin();
+	import_archive_chunk((const uint8_t *)"abcdef", 6);
+	message = import_archive_end(status);
+	if (message != "Error: file is not a valid archive" || status != ACTION_INVALID) {
+		Serial.println("\e[0;31mtest_import_archive: FAILED");
+		Serial.println("expected: Error: file is not a valid archive , actual: " + message + "\e[0;37m");
+		clean_LittleFS();
+		return(false);
+	}
+
+	// incomplete archive (end marker and last byte missing)
+	import_archive_begin();
+	import_archive_chunk((const uint8_t *)content.c_str(), content.length() - 2);
+	message = import_archive_end(status);
+	if (message != "Error: archive is incomplete" || status != ACTION_INVALID || check_if_file_exists("/import.tmp") == true || get_files("/signals", "/programs").indexOf("tmp") != -1) {
+		Serial.println("\e[0;31mtest_import_archive: FAILED");
+		Serial.println("expected: Error: archive is incomplete , actual: " + message + "\e[0;37m");
+		clean_LittleFS();
+		return(false);
+	}
+
+	// prints success message and returns true
+	Serial.println("\e[0;32mtest_import_archive: PASSED\e[0;37m");
+	clean_LittleFS();
+	return(true);
+}
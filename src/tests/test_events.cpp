@@ -0,0 +1,260 @@
+/**
+ * @file test_events.cpp
+ * @author Marc Ubbelohde
+ * @brief This file contains unit tests for all functions from the events.cpp.
+ *
+ */
+
+
+#include "tests.h"
+
+/**
+ * @brief Unit test for the function "publish_event"
+ *
+ * @return boolean - true if the test passed, false if the test failed
+ *
+ * @details - Setup: events are reset
+ * -# checks if an event is formatted into the ring
+ * -# checks if the oldest events are overwritten once the ring is full
+ * -# checks if too long data is cut
+ *
+ * @see publish_event
+ */
+boolean test_publish_event() {
+	reset_events();
+
+	// test if an event is formatted into the ring
+	publish_event(EVENT_JOB, PSTR("{\"job\":%u,\"line\":%d}"), 7, 3);
+	uint32_t first = get_last_event_id();
+	event item;
+	if (get_event(first, item) == false || item.type != EVENT_JOB || String(item.data) != "{\"job\":7,\"line\":3}") {
+		Serial.println("\e[0;31mtest_publish_event: FAILED");
+		Serial.println("event was not published correctly\e[0;37m");
+		return(false);
+	}
+
+	// test if the oldest events are overwritten once the ring is full
+	for (int i = 0; i < EVENT_RING_SIZE; i++) {
+		publish_event(EVENT_CAPTURE, PSTR("{\"state\":\"waiting\"}"));
+	}
+	if (get_event(first, item) == true || get_event(first + 1, item) == false || get_last_event_id() != first + EVENT_RING_SIZE) {
+		Serial.println("\e[0;31mtest_publish_event: FAILED");
+		Serial.println("ring did not overwrite the oldest event\e[0;37m");
+		return(false);
+	}
+
+	// test if too long data is cut
+	String text = "";
+	for (size_t i = 0; i < EVENT_DATA_LENGTH; i++) {
+		text += "x";
+	}
+	publish_event(EVENT_MESSAGE, PSTR("%s"), text.c_str());
+	get_event(get_last_event_id(), item);
+	if (strlen(item.data) != EVENT_DATA_LENGTH - 1) {
+		Serial.println("\e[0;31mtest_publish_event: FAILED");
+		Serial.println("expected length: " + String(EVENT_DATA_LENGTH - 1));
+		Serial.println("actual length: " + String(strlen(item.data)) + "\e[0;37m");
+		return(false);
+	}
+
+	Serial.println("\e[0;32mtest_publish_event: PASSED\e[0;37m");
+	return(true);
+}
+
+/**
+ * @brief Unit test for the function "publish_message"
+ *
+ * @return boolean - true if the test passed, false if the test failed
+ *
+ * @details - Setup: events are reset
+ * -# checks if quotes, backslashes and newlines are escaped
+ * -# checks if a long message is cut into valid JSON
+ *
+ * @see publish_message
+ */
+boolean test_publish_message() {
+	reset_events();
+
+	// test if quotes, backslashes and newlines are escaped
+	publish_message("Error: invalid signal name: \"a\\b\"\nnext");
+	event item;
+	get_event(get_last_event_id(), item);
+	DynamicJsonDocument doc(512);
+	if (item.type != EVENT_MESSAGE || deserializeJson(doc, (const char *)item.data) || doc["message"] != "Error: invalid signal name: \"a\\b\" next") {
+		Serial.println("\e[0;31mtest_publish_message: FAILED");
+		Serial.println("message was not escaped correctly: " + String(item.data) + "\e[0;37m");
+		return(false);
+	}
+
+	// test if a long message is cut into valid JSON
+	String message = "";
+	for (size_t i = 0; i < EVENT_DATA_LENGTH; i++) {
+		message += "\"";
+	}
+	publish_message(message);
+	get_event(get_last_event_id(), item);
+	if (deserializeJson(doc, (const char *)item.data) || String((const char *)doc["message"]).length() == 0) {
+		Serial.println("\e[0;31mtest_publish_message: FAILED");
+		Serial.println("long message was not cut into valid JSON: " + String(item.data) + "\e[0;37m");
+		return(false);
+	}
+
+	Serial.println("\e[0;32mtest_publish_message: PASSED\e[0;37m");
+	return(true);
+}
+
+/**
+ * @brief Unit test for the function "get_event_resume_id"
+ *
+ * @return boolean - true if the test passed, false if the test failed
+ *
+ * @details - Setup: events are reset, a message and a job event are published
+ * -# checks if a new client starts with the last message
+ * -# checks if a reconnecting client continues after its last event
+ * -# checks if a client with an id from before a reset starts with the last message
+ *
+ * @see get_event_resume_id
+ */
+boolean test_get_event_resume_id() {
+	reset_events();
+	publish_message("first");
+	uint32_t message_id = get_last_event_id();
+	publish_event(EVENT_JOB, PSTR("{\"job\":%u,\"line\":%d}"), 7, 3);
+	uint32_t job_id = get_last_event_id();
+
+	// test if a new client starts with the last message
+	if (get_event_resume_id(0) != message_id) {
+		Serial.println("\e[0;31mtest_get_event_resume_id: FAILED");
+		Serial.println("new client: expected " + String(message_id) + ", actual " + String(get_event_resume_id(0)) + "\e[0;37m");
+		return(false);
+	}
+
+	// test if a reconnecting client continues after its last event
+	if (get_event_resume_id(message_id) != job_id || get_event_resume_id(job_id) != job_id + 1) {
+		Serial.println("\e[0;31mtest_get_event_resume_id: FAILED");
+		Serial.println("reconnecting client: expected " + String(job_id) + ", actual " + String(get_event_resume_id(message_id)) + "\e[0;37m");
+		return(false);
+	}
+
+	// test if a client with an id from before a reset starts with the last message
+	if (get_event_resume_id(job_id + 1) != message_id || get_event_resume_id(job_id + 1000) != message_id) {
+		Serial.println("\e[0;31mtest_get_event_resume_id: FAILED");
+		Serial.println("client from before a reset: expected " + String(message_id) + ", actual " + String(get_event_resume_id(job_id + 1000)) + "\e[0;37m");
+		return(false);
+	}
+
+	Serial.println("\e[0;32mtest_get_event_resume_id: PASSED\e[0;37m");
+	return(true);
+}
+
+/**
+ * @brief Unit test for the function "print_events"
+ *
+ * @return boolean - true if the test passed, false if the test failed
+ *
+ * @details - Setup: events are reset and two events are published
+ * -# checks if the events are printed in the Server-Sent Events format
+ * -# checks if only whole events that fit into the room are printed
+ * -# checks if a client that fell behind continues with the oldest event in the ring
+ *
+ * @see print_events
+ */
+boolean test_print_events() {
+	reset_events();
+	uint32_t first = get_last_event_id() + 1;
+	publish_event(EVENT_CAPTURE, PSTR("{\"state\":\"waiting\"}"));
+	publish_event(EVENT_CAPTURE, PSTR("{\"state\":\"received\"}"));
+
+	// test if the events are printed in the Server-Sent Events format
+	uint32_t next_id = first;
+	StreamString content1;
+	size_t written = print_events(next_id, content1, 1024);
+	String expected1 = "id: " + String(first) + "\nevent: capture\ndata: {\"state\":\"waiting\"}\n\n";
+	expected1 += "id: " + String(first + 1) + "\nevent: capture\ndata: {\"state\":\"received\"}\n\n";
+	if (content1 != expected1 || written != expected1.length() || next_id != first + 2) {
+		Serial.println("\e[0;31mtest_print_events: FAILED");
+		Serial.println("expected: " + expected1);
+		Serial.println("actual: " + content1 + "\e[0;37m");
+		return(false);
+	}
+
+	// test if only whole events that fit into the room are printed
+	next_id = first;
+	StreamString content2;
+	print_events(next_id, content2, expected1.length() - 1);
+	if (next_id != first + 1 || content2.endsWith("\n\n") == false || content2.length() >= expected1.length()) {
+		Serial.println("\e[0;31mtest_print_events: FAILED");
+		Serial.println("printed part of an event or too much: " + content2 + "\e[0;37m");
+		return(false);
+	}
+
+	// test if a client that fell behind continues with the oldest event in the ring
+	for (int i = 0; i < EVENT_RING_SIZE; i++) {
+		publish_event(EVENT_JOB, PSTR("{\"job\":%d,\"line\":1}"), i);
+	}
+	next_id = first;
+	StreamString content3;
+	print_events(next_id, content3, 4096);
+	if (content3.startsWith("id: " + String(first + 2) + "\n") == false || next_id != get_last_event_id() + 1) {
+		Serial.println("\e[0;31mtest_print_events: FAILED");
+		Serial.println("client that fell behind did not continue with the oldest event\e[0;37m");
+		return(false);
+	}
+
+	Serial.println("\e[0;32mtest_print_events: PASSED\e[0;37m");
+	return(true);
+}
+
+/**
+ * @brief Unit test for the function "print_events_json"
+ *
+ * @return boolean - true if the test passed, false if the test failed
+ *
+ * @details - Setup: events are reset and two events are published
+ * -# checks if the events are printed as valid JSON array
+ * -# checks if only whole events that fit into the room are printed
+ * -# checks if nothing is printed when there is no new event
+ *
+ * @see print_events_json
+ */
+boolean test_print_events_json() {
+	reset_events();
+	uint32_t first = get_last_event_id() + 1;
+	publish_event(EVENT_JOB, PSTR("{\"job\":3,\"kind\":\"program\",\"state\":\"running\"}"));
+	publish_message("success");
+
+	// test if the events are printed as valid JSON array
+	uint32_t next_id = first;
+	StreamString content1;
+	size_t written = print_events_json(next_id, content1, 1024);
+	DynamicJsonDocument doc(1024);
+	if (deserializeJson(doc, content1.c_str()) || doc.size() != 2 || written != content1.length() || next_id != first + 2
+			|| doc[0]["id"] != first || doc[0]["event"] != "job" || doc[0]["data"]["kind"] != "program"
+			|| doc[1]["event"] != "message" || doc[1]["data"]["message"] != "success") {
+		Serial.println("\e[0;31mtest_print_events_json: FAILED");
+		Serial.println("events were not printed correctly: " + content1 + "\e[0;37m");
+		return(false);
+	}
+
+	// test if only whole events that fit into the room are printed
+	next_id = first;
+	StreamString content2;
+	print_events_json(next_id, content2, content1.length() - 1);
+	if (next_id != first + 1 || deserializeJson(doc, content2.c_str()) || doc.size() != 1) {
+		Serial.println("\e[0;31mtest_print_events_json: FAILED");
+		Serial.println("printed part of an event or too much: " + content2 + "\e[0;37m");
+		return(false);
+	}
+
+	// test if nothing is printed when there is no new event
+	next_id = get_last_event_id() + 1;
+	StreamString content3;
+	if (print_events_json(next_id, content3, 1024) != 0 || content3.length() != 0) {
+		Serial.println("\e[0;31mtest_print_events_json: FAILED");
+		Serial.println("printed without new events: " + content3 + "\e[0;37m");
+		return(false);
+	}
+
+	Serial.println("\e[0;32mtest_print_events_json: PASSED\e[0;37m");
+	return(true);
+}
@@ -113,6 +113,57 @@ boolean test_save_signal() {
 	return(true);
 }
 
+/**
+ * @brief Unit test for the function "save_capture"
+ * 
+ * @return boolean - true if the test passed, false if the test failed
+ * 
+ * @details - Setup: Clean LittleFS, decoded results of an unknown signal
+ * -# checks if an invalid name is refused
+ * -# checks if the raw timings are saved like save_signal() saves them
+ * 
+ * @see save_capture
+ */
+boolean test_save_capture() {
+
+	// Clean LittleFS
+	clean_LittleFS();
+
+	uint16_t rawbuf[6] = {0, 617, 1203, 311, 2402, 0};
+	decode_results results;
+	results.decode_type = UNKNOWN;
+	results.rawbuf = rawbuf;
+	results.rawlen = 5;
+	results.overflow = false;
+	results.repeat = false;
+
+	// test if an invalid name is refused
+	String return_value = save_capture(results, "___/");
+	if (return_value != "Error: name is not alphanumeric") {
+		Serial.println("\e[0;31mtest_save_capture: FAILED");
+		Serial.println("expected: Error: name is not alphanumeric, actual: " + return_value + "\e[0;37m");
+		clean_LittleFS();
+		return(false);
+	}
+
+	// test if the raw timings are saved like save_signal() saves them
+	return_value = save_capture(results, "___test123");
+	DynamicJsonDocument doc(1024);
+	load_json("/signals/___test123.json", doc);
+	String sequence = doc["sequence"].as<String>();
+	if (return_value != "success" || doc["name"] != "___test123" || doc["length"] != 4 || sequence != "1234, 2406, 622, 4804") {
+		Serial.println("\e[0;31mtest_save_capture: FAILED");
+		Serial.println("return value: " + return_value + " , length: " + doc["length"].as<String>() + " , sequence: " + sequence + "\e[0;37m");
+		clean_LittleFS();
+		return(false);
+	}
+
+	// prints success message and return true
+	Serial.println("\e[0;32mtest_save_capture: PASSED\e[0;37m");
+	clean_LittleFS();
+	return(true);
+}
+
 /**
  * @brief Unit test for the function "save_json"
  * 
@@ -206,6 +257,7 @@ boolean test_save_json() {
  * 
  * @details - Setup: Clean LittleFS
  * -# checks if data is correctly loaded from file
+ * -# checks if only the fields of the filter are loaded
  * -# checks if empthy JSON Doc is returned if file does not exist
  * -# checks if empthy JSON Doc is returned if file is empthy
  * -# checks if empthy JSON Doc is returned if file is not in JSON format
@@ -245,8 +297,8 @@ boolean test_load_json() {
 	LittleFS.end();
 
 	// test if data is correctly loaded from file
-	DynamicJsonDocument doc2 = load_json(name1);
-	if (doc2["length"] != 3 || doc2["sequence"] != "1234, 5678, 412") {
+	json_document doc2(JSON_FILE_CAPACITY);
+	if (load_json(name1, doc2) == false || doc2["length"] != 3 || doc2["sequence"] != "1234, 5678, 412") {
 		Serial.println("\e[0;31mtest_load_json: FAILED");
 		Serial.println("file " + name2 + " was not loaded correctly");
 		Serial.println("expected: {\"length\":3,\"sequence\":\"1234, 5678, 412\"}");
@@ -255,9 +307,21 @@ boolean test_load_json() {
 		return(false);
 	}
 
+	// test if only the fields of the filter are loaded
+	StaticJsonDocument<JSON_OBJECT_SIZE(1)> filter;
+	filter["length"] = true;
+	if (load_json(name1, doc2, filter) == false || doc2.size() != 1 || doc2["length"] != 3) {
+		Serial.println("\e[0;31mtest_load_json: FAILED");
+		Serial.println("filter was not applied");
+		Serial.println("expected: {\"length\":3}");
+		Serial.println("actual: " + doc2.as<String>() + "\e[0;37m");
+		clean_LittleFS();
+		return(false);
+	}
+
 	// test if empthy JSON Doc is returned if file does not exist
-	DynamicJsonDocument doc3 = load_json("abc");
-	if (doc3.size() != 0) {
+	json_document doc3(JSON_FILE_CAPACITY);
+	if (load_json("abc", doc3) == true || doc3.size() != 0) {
 		Serial.println("\e[0;31mtest_load_json: FAILED");
 		Serial.println("empthy JSON Doc was not returned if file does not exist");
 		Serial.println("expected: {}");
@@ -267,8 +331,8 @@ boolean test_load_json() {
 	}
 
 	// test if empthy JSON Doc is returned if file is empthy
-	DynamicJsonDocument doc4 = load_json(name2);
-	if (doc4.size() != 0) {
+	json_document doc4(JSON_FILE_CAPACITY);
+	if (load_json(name2, doc4) == true || doc4.size() != 0) {
 		Serial.println("\e[0;31mtest_load_json: FAILED");
 		Serial.println("empthy JSON Doc was not returned if file is empthy");
 		Serial.println("expected: {}");
@@ -278,8 +342,8 @@ boolean test_load_json() {
 	}
 
 	// test if empthy JSON Doc is returned if file is not in JSON format
-	DynamicJsonDocument doc5 = load_json(name3);
-	if (doc5.size() != 0) {
+	json_document doc5(JSON_FILE_CAPACITY);
+	if (load_json(name3, doc5) == true || doc5.size() != 0) {
 		Serial.println("\e[0;31mtest_load_json: FAILED");
 		Serial.println("empthy JSON Doc was not returned if file is not in JSON format");
 		Serial.println("expected: {}");
@@ -373,6 +437,84 @@ boolean test_send_signal() {
 	return(true);
 }
 
+/**
+ * @brief Unit test for the functions "generic_to_json" and "json_to_generic"
+ * 
+ * @return boolean - true if the test passed, false if the test failed
+ * 
+ * @details - Setup: generic signal with two sections (NEC like timings)
+ * -# checks if the signal is written to JSON correctly
+ * -# checks if the signal is read back from JSON correctly
+ * -# checks if JSON with invalid data is not accepted
+ * 
+ * @see generic_to_json
+ * @see json_to_generic
+ */
+boolean test_generic_signal_json() {
+
+	// test signal
+	generic_signal_t signal1;
+	memset(&signal1, 0, sizeof(signal1));
+	signal1.hdrmark = 9000;
+	signal1.hdrspace = 4500;
+	signal1.onemark = 560;
+	signal1.onespace = 1690;
+	signal1.zeromark = 560;
+	signal1.zerospace = 560;
+	signal1.footermark = 560;
+	signal1.gap = 40000;
+	signal1.sections = 2;
+	signal1.headerless = 0b10;
+	signal1.nbits[0] = 32;
+	signal1.nbits[1] = 4;
+	signal1.data[0] = 0x20;
+	signal1.data[1] = 0xDF;
+	signal1.data[2] = 0x10;
+	signal1.data[3] = 0xEF;
+	signal1.data[4] = 0xA0;
+
+	// test if signal is written to JSON correctly
+	DynamicJsonDocument doc1(512);
+	generic_to_json(signal1, doc1.createNestedObject("generic"));
+	String output1 = "";
+	serializeJson(doc1, output1);
+	String expected1 = "{\"generic\":{\"timings\":[9000,4500,560,1690,560,560,560,40000],\"headerless\":2,\"bits\":[32,4],\"data\":\"20DF10EFA0\"}}";
+	if (output1 != expected1) {
+		Serial.println("\e[0;31mtest_generic_signal_json: FAILED");
+		Serial.println("signal was not written to JSON correctly");
+		Serial.println("expected: " + expected1);
+		Serial.println("actual: " + output1 + "\e[0;37m");
+		return(false);
+	}
+
+	// test if signal is read back from JSON correctly
+	generic_signal_t signal2;
+	memset(&signal2, 0, sizeof(signal2));
+	if (json_to_generic(doc1["generic"], &signal2) == false || memcmp(&signal1, &signal2, sizeof(signal1)) != 0) {
+		Serial.println("\e[0;31mtest_generic_signal_json: FAILED");
+		Serial.println("signal was not read from JSON correctly\e[0;37m");
+		return(false);
+	}
+
+	// test if JSON with invalid data is not accepted
+	doc1["generic"]["data"] = "20DF10EF";
+	DynamicJsonDocument doc2(512);
+	doc2["generic"]["bits"][0] = 8;
+	doc2["generic"]["data"] = "20";
+	DynamicJsonDocument doc3(512);
+	deserializeJson(doc3, "{\"timings\":[9000,4500,560,1690,560,560,560,40000],\"bits\":[8],\"data\":\"2G\"}");
+	if (json_to_generic(doc1["generic"], &signal2) == true || json_to_generic(doc2["generic"], &signal2) == true ||
+			json_to_generic(doc3.as<JsonObject>(), &signal2) == true) {
+		Serial.println("\e[0;31mtest_generic_signal_json: FAILED");
+		Serial.println("JSON with invalid data was accepted\e[0;37m");
+		return(false);
+	}
+
+	// prints success message and returns true
+	Serial.println("\e[0;32mtest_generic_signal_json: PASSED\e[0;37m");
+	return(true);
+}
+
 /**
  * @brief Unit test for the function "get_files"
  * 
@@ -537,12 +679,42 @@ boolean test_read_program() {
  * 
  * @return boolean - true if the test passed, false if the test failed
  * 
- * @details The functionality of this function is manually tested.
+ * @details The blink patterns themselves are manually tested.
+ * -# checks if the codewords start a pattern without blocking
+ * -# checks if an unknown codeword is ignored
  * 
  * @see test_control_led_output
  */
 boolean test_control_led_output() {
-  return(true);
+
+	// test if the codewords start a pattern without blocking
+	String signals[5] = {"no_signal", "no_mDNS", "no_wifi", "AP_on", "signal_received"};
+	for (int i = 0; i < 5; i++) {
+		led_set_state(LED_IDLE);
+		unsigned long start = millis();
+		control_led_output(signals[i]);
+		if (millis() != start || led_is_playing() == false) {
+			Serial.println("\e[0;31mtest_control_led_output: FAILED");
+			Serial.println("no pattern was started without blocking for " + signals[i] + "\e[0;37m");
+			return(false);
+		}
+		// finish the pattern
+		while (led_is_playing() == true) {
+			update_led();
+		}
+	}
+
+	// test if an unknown codeword is ignored
+	control_led_output("abc");
+	if (led_is_playing() == true) {
+		Serial.println("\e[0;31mtest_control_led_output: FAILED");
+		Serial.println("unknown codeword started a pattern\e[0;37m");
+		return(false);
+	}
+
+	// prints success message and returns true
+	Serial.println("\e[0;32mtest_control_led_output: PASSED\e[0;37m");
+	return(true);
 }
 
 /**
@@ -0,0 +1,212 @@
+/**
+ * @file test_jobs.cpp
+ * @author Marc Ubbelohde
+ * @brief This file contains unit tests for all functions from the jobs.cpp.
+ *
+ */
+
+
+#include "tests.h"
+
+/**
+ * @brief Cancels the running job (idle handler for test_job_sleep).
+ *
+ */
+void cancel_current_job() {
+	job_cancel(get_current_job().id);
+}
+
+/**
+ * @brief Unit test for the function "job_begin"
+ *
+ * @return boolean - true if the test passed, false if the test failed
+ *
+ * @details - Setup: -
+ * -# checks if a job is running after it was started
+ * -# checks if a job that is started while one is running becomes part of it
+ * -# checks if the job ends after all parts ended
+ * -# checks if the next job gets a new id
+ *
+ * @see job_begin
+ */
+boolean test_job_begin() {
+
+	// test if a job is running after it was started
+	uint16_t id1 = job_begin(JOB_PROGRAM);
+	job current = get_current_job();
+	if (id1 == 0 || current.id != id1 || current.kind != JOB_PROGRAM || current.depth != 1) {
+		Serial.println("\e[0;31mtest_job_begin: FAILED");
+		Serial.println("job was not started correctly\e[0;37m");
+		job_end(id1);
+		return(false);
+	}
+
+	// test if a job that is started while one is running becomes part of it
+	uint16_t id2 = job_begin(JOB_SEND);
+	current = get_current_job();
+	if (id2 != id1 || current.kind != JOB_PROGRAM || current.depth != 2) {
+		Serial.println("\e[0;31mtest_job_begin: FAILED");
+		Serial.println("nested job did not become part of the running job\e[0;37m");
+		job_end(id2);
+		job_end(id1);
+		return(false);
+	}
+
+	// test if the job ends after all parts ended
+	job_end(id2);
+	job_end(id1);
+	current = get_current_job();
+	if (current.depth != 0 || current.kind != JOB_NONE) {
+		Serial.println("\e[0;31mtest_job_begin: FAILED");
+		Serial.println("job did not end\e[0;37m");
+		return(false);
+	}
+
+	// test if the next job gets a new id
+	uint16_t id3;
+	{
+		job_scope scope(JOB_CAPTURE);
+		id3 = scope.id;
+	}
+	if (id3 == id1 || get_current_job().depth != 0) {
+		Serial.println("\e[0;31mtest_job_begin: FAILED");
+		Serial.println("job_scope did not start a new job or did not end it\e[0;37m");
+		return(false);
+	}
+
+	// prints success message and returns true
+	Serial.println("\e[0;32mtest_job_begin: PASSED\e[0;37m");
+	return(true);
+}
+
+/**
+ * @brief Unit test for the function "job_cancel"
+ *
+ * @return boolean - true if the test passed, false if the test failed
+ *
+ * @details - Setup: -
+ * -# checks if only the running job can be canceled
+ * -# checks if the program executor stops a canceled job
+ * -# checks if the next job is not canceled
+ *
+ * @see job_cancel
+ */
+boolean test_job_cancel() {
+
+	// test if only the running job can be canceled
+	uint16_t id1 = job_begin(JOB_PROGRAM);
+	if (job_cancel(id1 + 1) == true || job_cancelled() == true || job_cancel(id1) == false || job_cancelled() == false) {
+		Serial.println("\e[0;31mtest_job_cancel: FAILED");
+		Serial.println("wrong job was canceled\e[0;37m");
+		job_end(id1);
+		return(false);
+	}
+
+	// test if the program executor stops a canceled job
+	String output = program_parser("wait 1000\n");
+	if (output != "program was canceled by the user.") {
+		Serial.println("\e[0;31mtest_job_cancel: FAILED");
+		Serial.println("program was not canceled");
+		Serial.println("expected: program was canceled by the user.");
+		Serial.println("actual: " + output + "\e[0;37m");
+		job_end(id1);
+		return(false);
+	}
+	job_end(id1);
+
+	// test if the next job is not canceled
+	uint16_t id2 = job_begin(JOB_PROGRAM);
+	boolean cancelled = job_cancelled();
+	job_end(id2);
+	if (cancelled == true || job_cancel(id2) == true) {
+		Serial.println("\e[0;31mtest_job_cancel: FAILED");
+		Serial.println("token was not cleared or ended job was canceled\e[0;37m");
+		return(false);
+	}
+
+	// prints success message and returns true
+	Serial.println("\e[0;32mtest_job_cancel: PASSED\e[0;37m");
+	return(true);
+}
+
+/**
+ * @brief Unit test for the function "job_busy"
+ *
+ * @return boolean - true if the test passed, false if the test failed
+ *
+ * @details - Setup: -
+ * -# checks if no job is reported while none runs
+ * -# checks if the running job is reported
+ *
+ * @see job_busy
+ */
+boolean test_job_busy() {
+
+	// test if no job is reported while none runs
+	String message = "";
+	if (job_busy(message) == true || message != "") {
+		Serial.println("\e[0;31mtest_job_busy: FAILED");
+		Serial.println("job reported while none runs: " + message + "\e[0;37m");
+		return(false);
+	}
+
+	// test if the running job is reported
+	uint16_t id = job_begin(JOB_PROGRAM);
+	boolean busy = job_busy(message);
+	job_end(id);
+	if (busy == false || message != "job " + String(id) + " is still running") {
+		Serial.println("\e[0;31mtest_job_busy: FAILED");
+		Serial.println("expected: job " + String(id) + " is still running");
+		Serial.println("actual: " + message + "\e[0;37m");
+		return(false);
+	}
+
+	// prints success message and returns true
+	Serial.println("\e[0;32mtest_job_busy: PASSED\e[0;37m");
+	return(true);
+}
+
+/**
+ * @brief Unit test for the function "job_sleep"
+ *
+ * @return boolean - true if the test passed, false if the test failed
+ *
+ * @details - Setup: -
+ * -# checks if the whole time is slept
+ * -# checks if the sleep ends early when the job is canceled
+ *
+ * @see job_sleep
+ */
+boolean test_job_sleep() {
+
+	// test if the whole time is slept
+	unsigned long start_time = millis();
+	boolean output1 = job_sleep(250);
+	unsigned long slept = millis() - start_time;
+	if (output1 == false || slept < 250 || slept > 250 + JOB_SLEEP_SLICE) {
+		Serial.println("\e[0;31mtest_job_sleep: FAILED");
+		Serial.println("wrong time was slept");
+		Serial.println("expected: 250");
+		Serial.println("actual: " + String(slept) + "\e[0;37m");
+		return(false);
+	}
+
+	// test if the sleep ends early when the job is canceled (by the idle handler)
+	uint16_t id = job_begin(JOB_PROGRAM);
+	job_set_idle_handler(cancel_current_job);
+	start_time = millis();
+	boolean output2 = job_sleep(5000);
+	slept = millis() - start_time;
+	job_set_idle_handler(NULL);
+	job_end(id);
+	if (output2 == true || slept > JOB_SLEEP_SLICE) {
+		Serial.println("\e[0;31mtest_job_sleep: FAILED");
+		Serial.println("sleep did not end when the job was canceled");
+		Serial.println("slept: " + String(slept) + "\e[0;37m");
+		return(false);
+	}
+
+	// prints success message and returns true
+	Serial.println("\e[0;32mtest_job_sleep: PASSED\e[0;37m");
+	return(true);
+}
@@ -0,0 +1,146 @@
+/**
+ * @file test_json_arena.cpp
+ * @author Marc Ubbelohde
+ * @brief This file contains unit tests for all functions from the json_arena.cpp.
+ *
+ */
+
+
+#include "tests.h"
+
+/**
+ * @brief Unit test for the class "json_arena_allocator"
+ *
+ * @return boolean - true if the test passed, false if the test failed
+ *
+ * @details - Setup: the counters are reset
+ * -# checks if nested documents are taken from the arena and given back when they go out of scope
+ * -# checks if memory that is given back below the top is reused once the top is given back
+ * -# checks if a document that does not fit into the arena is allocated in the heap and counted
+ *
+ * @see json_arena_allocator
+ */
+boolean test_json_arena_allocator() {
+	reset_json_arena_stats();
+	size_t used_before = get_json_arena_stats().used;
+
+	// test if nested documents are taken from the arena and given back when they go out of scope
+	{
+		json_document outer(JSON_FILE_CAPACITY);
+		outer["name"] = "tv";
+		{
+			json_document inner(JSON_TIME_CAPACITY);
+			inner["hours"] = 12;
+			if (get_json_arena_stats().used < used_before + JSON_FILE_CAPACITY + JSON_TIME_CAPACITY || outer["name"] != "tv" || inner["hours"] != 12) {
+				Serial.println("\e[0;31mtest_json_arena_allocator: FAILED");
+				Serial.println("nested documents were not taken from the arena\e[0;37m");
+				return(false);
+			}
+		}
+	}
+	json_arena_stats stats = get_json_arena_stats();
+	if (stats.used != used_before || stats.allocations != 2 || stats.heap_allocations != 0) {
+		Serial.println("\e[0;31mtest_json_arena_allocator: FAILED");
+		Serial.println("expected: used " + String(used_before) + ", 2 allocations, 0 in the heap");
+		Serial.println("actual: used " + String(stats.used) + ", " + String(stats.allocations) + " allocations, " + String(stats.heap_allocations) + " in the heap\e[0;37m");
+		return(false);
+	}
+
+	// test if memory that is given back below the top is reused once the top is given back
+	json_document *lower = new json_document(JSON_TIME_CAPACITY);
+	json_document *upper = new json_document(JSON_TIME_CAPACITY);
+	delete lower;
+	if (get_json_arena_stats().used == used_before) {
+		Serial.println("\e[0;31mtest_json_arena_allocator: FAILED");
+		Serial.println("block below the top was given back before the top\e[0;37m");
+		delete upper;
+		return(false);
+	}
+	delete upper;
+	if (get_json_arena_stats().used != used_before) {
+		Serial.println("\e[0;31mtest_json_arena_allocator: FAILED");
+		Serial.println("free blocks were not given back with the top\e[0;37m");
+		return(false);
+	}
+
+	// test if a document that does not fit into the arena is allocated in the heap and counted
+	{
+		json_document large(JSON_ARENA_SIZE);
+		large["name"] = "large";
+		if (get_json_arena_stats().heap_allocations != 1 || large["name"] != "large") {
+			Serial.println("\e[0;31mtest_json_arena_allocator: FAILED");
+			Serial.println("large document was not allocated in the heap\e[0;37m");
+			return(false);
+		}
+	}
+	if (get_json_arena_stats().used != used_before) {
+		Serial.println("\e[0;31mtest_json_arena_allocator: FAILED");
+		Serial.println("heap document changed the arena\e[0;37m");
+		return(false);
+	}
+
+	Serial.println("\e[0;32mtest_json_arena_allocator: PASSED\e[0;37m");
+	return(true);
+}
+
+/**
+ * @brief Unit test for the heap usage of the storage functions
+ *
+ * @return boolean - true if the test passed, false if the test failed
+ *
+ * @details - Setup: the time and a signal are written, the counters are reset
+ * -# checks if loading the time and a signal many times allocates nothing in the heap
+ * -# checks if the arena is empty again afterwards
+ *
+ * @see load_json
+ * @see get_current_time
+ * @see check_and_update_offset
+ */
+boolean test_json_arena_storage() {
+	clean_LittleFS();
+	update_time("1 12:00:00 0", true);
+	// load the saved time in get_current_time() instead of taking the clock of the RTC state
+	rtc_clear();
+	DynamicJsonDocument signal(512);
+	signal["name"] = "tv";
+	signal["length"] = 3;
+	signal["sequence"] = "1234, 5678, 412";
+	save_json("/signals/tv.json", signal);
+
+	reset_json_arena_stats();
+	size_t used_before = get_json_arena_stats().used;
+
+	// test if loading the time and a signal many times allocates nothing in the heap
+	for (int i = 0; i < 50; i++) {
+		get_current_time();
+		check_and_update_offset();
+		json_document doc(JSON_FILE_CAPACITY);
+		json_document time_json(JSON_TIME_CAPACITY);
+		if (load_json("/signals/tv.json", doc) == false || kv_load_json("time", time_json) == false || time_json["hours"] != 12) {
+			Serial.println("\e[0;31mtest_json_arena_storage: FAILED");
+			Serial.println("files were not loaded\e[0;37m");
+			clean_LittleFS();
+			return(false);
+		}
+	}
+	json_arena_stats stats = get_json_arena_stats();
+	if (stats.heap_allocations != 0 || stats.allocations < 200) {
+		Serial.println("\e[0;31mtest_json_arena_storage: FAILED");
+		Serial.println("expected: at least 200 allocations, 0 in the heap");
+		Serial.println("actual: " + String(stats.allocations) + " allocations, " + String(stats.heap_allocations) + " in the heap\e[0;37m");
+		clean_LittleFS();
+		return(false);
+	}
+
+	// test if the arena is empty again afterwards
+	if (stats.used != used_before) {
+		Serial.println("\e[0;31mtest_json_arena_storage: FAILED");
+		Serial.println("arena was not given back: " + String(stats.used) + " bytes are used\e[0;37m");
+		clean_LittleFS();
+		return(false);
+	}
+
+	Serial.println("\e[0;32mtest_json_arena_storage: PASSED\e[0;37m");
+	clean_LittleFS();
+	return(true);
+}
@@ -0,0 +1,261 @@
+/**
+ * @file test_kv_store.cpp
+ * @author Marc Ubbelohde
+ * @brief This file contains unit tests for all functions from the kv_store.cpp.
+ *
+ */
+
+
+#include "tests.h"
+
+/**
+ * @brief Unit test for the function "kv_crc32"
+ *
+ * @return boolean - true if the test passed, false if the test failed
+ *
+ * @details
+ * -# checks the check value of CRC-32 ("123456789")
+ * -# checks if the CRC can be calculated in parts
+ *
+ * @see kv_crc32
+ */
+boolean test_kv_crc32() {
+	const uint8_t data[] = "123456789";
+
+	// test the check value of CRC-32 ("123456789")
+	uint32_t crc = kv_crc32(0, data, 9);
+	if (crc != 0xcbf43926) {
+		Serial.println("\e[0;31mtest_kv_crc32: FAILED");
+		Serial.println("expected: cbf43926");
+		Serial.println("actual: " + String(crc, HEX) + "\e[0;37m");
+		return(false);
+	}
+
+	// test if the CRC can be calculated in parts
+	if (kv_crc32(kv_crc32(0, data, 4), data + 4, 5) != crc) {
+		Serial.println("\e[0;31mtest_kv_crc32: FAILED");
+		Serial.println("CRC in parts differs\e[0;37m");
+		return(false);
+	}
+
+	Serial.println("\e[0;32mtest_kv_crc32: PASSED\e[0;37m");
+	return(true);
+}
+
+/**
+ * @brief Unit test for the functions "kv_put", "kv_get" and "kv_remove"
+ *
+ * @return boolean - true if the test passed, false if the test failed
+ *
+ * @details - Setup: Clean LittleFS
+ * -# checks if values are written, overwritten and removed
+ * -# checks if writing the same value again appends nothing
+ * -# checks if the values are read again from the journal after a reset
+ * -# checks if too long keys and values are rejected
+ *
+ * @see kv_put
+ * @see kv_get
+ * @see kv_remove
+ */
+boolean test_kv_put() {
+	clean_LittleFS();
+
+	// test if values are written, overwritten and removed
+	kv_put("ap", "false");
+	kv_put("password", "12345678");
+	kv_put("ap", "true");
+	kv_put("old", "value");
+	kv_remove("old");
+	if (kv_get("ap") != "true" || kv_get("password") != "12345678" || kv_contains("old") || kv_get("old") != "" || get_kv_stats().keys != 2) {
+		Serial.println("\e[0;31mtest_kv_put: FAILED");
+		Serial.println("values were not written correctly: ap " + kv_get("ap") + ", password " + kv_get("password") + "\e[0;37m");
+		clean_LittleFS();
+		return(false);
+	}
+
+	// test if writing the same value again appends nothing
+	kv_store_stats before = get_kv_stats();
+	kv_put("ap", "true");
+	kv_store_stats after = get_kv_stats();
+	if (after.journal_size != before.journal_size || after.skipped_writes != before.skipped_writes + 1) {
+		Serial.println("\e[0;31mtest_kv_put: FAILED");
+		Serial.println("same value was appended again\e[0;37m");
+		clean_LittleFS();
+		return(false);
+	}
+
+	// test if the values are read again from the journal after a reset
+	kv_unload();
+	if (kv_get("ap") != "true" || kv_get("password") != "12345678" || kv_contains("old") || get_kv_stats().journal_size != after.journal_size) {
+		Serial.println("\e[0;31mtest_kv_put: FAILED");
+		Serial.println("values were not read again from the journal\e[0;37m");
+		clean_LittleFS();
+		return(false);
+	}
+
+	// test if too long keys and values are rejected
+	String long_value = "";
+	for (int i = 0; i <= KV_VALUE_LENGTH; i++) {
+		long_value += "x";
+	}
+	if (kv_put("a_key_that_is_too_long", "1") == true || kv_put("long", long_value) == true || kv_put("", "1") == true) {
+		Serial.println("\e[0;31mtest_kv_put: FAILED");
+		Serial.println("too long key or value was accepted\e[0;37m");
+		clean_LittleFS();
+		return(false);
+	}
+
+	Serial.println("\e[0;32mtest_kv_put: PASSED\e[0;37m");
+	clean_LittleFS();
+	return(true);
+}
+
+/**
+ * @brief Unit test for loading a damaged journal
+ *
+ * @return boolean - true if the test passed, false if the test failed
+ *
+ * @details - Setup: Clean LittleFS and write two values
+ * -# checks if a torn record at the end is dropped and the values before are kept
+ * -# checks if records written afterwards are not hidden behind the torn record
+ * -# checks if a record with a wrong CRC is dropped and the value before is used
+ *
+ * @see kv_load
+ */
+boolean test_kv_load() {
+	clean_LittleFS();
+	kv_put("ap", "true");
+	kv_put("password", "12345678");
+
+	// test if a torn record at the end is dropped and the values before are kept
+	LittleFS.begin();
+	File journal = LittleFS.open(KV_JOURNAL_FILE, "a");
+	const uint8_t torn[] = {KV_RECORD_MAGIC, 2, 5, 0, 1};
+	journal.write(torn, sizeof(torn));
+	journal.close();
+	LittleFS.end();
+
+	kv_unload();
+	if (kv_get("ap") != "true" || kv_get("password") != "12345678" || get_kv_stats().dropped_bytes != sizeof(torn)) {
+		Serial.println("\e[0;31mtest_kv_load: FAILED");
+		Serial.println("torn record was not dropped: dropped " + String(get_kv_stats().dropped_bytes) + " bytes\e[0;37m");
+		clean_LittleFS();
+		return(false);
+	}
+
+	// test if records written afterwards are not hidden behind the torn record
+	kv_put("ap", "false");
+	kv_unload();
+	if (kv_get("ap") != "false") {
+		Serial.println("\e[0;31mtest_kv_load: FAILED");
+		Serial.println("record after the torn record was lost\e[0;37m");
+		clean_LittleFS();
+		return(false);
+	}
+
+	// test if a record with a wrong CRC is dropped and the value before is used
+	kv_put("password", "abcdefgh");
+	LittleFS.begin();
+	journal = LittleFS.open(KV_JOURNAL_FILE, "r+");
+	journal.seek(journal.size() - 1, SeekSet);
+	journal.write('x');
+	journal.close();
+	LittleFS.end();
+
+	kv_unload();
+	if (kv_get("password") != "12345678" || kv_get("ap") != "false") {
+		Serial.println("\e[0;31mtest_kv_load: FAILED");
+		Serial.println("damaged record was used: " + kv_get("password") + "\e[0;37m");
+		clean_LittleFS();
+		return(false);
+	}
+
+	Serial.println("\e[0;32mtest_kv_load: PASSED\e[0;37m");
+	clean_LittleFS();
+	return(true);
+}
+
+/**
+ * @brief Unit test for the compaction of the journal
+ *
+ * @return boolean - true if the test passed, false if the test failed
+ *
+ * @details - Setup: Clean LittleFS
+ * -# checks if the journal is compacted once most of it is outdated
+ * -# checks if the values are kept after the compaction and a reset
+ *
+ * @see kv_compact
+ */
+boolean test_kv_compact() {
+	clean_LittleFS();
+	kv_put("password", "12345678");
+
+	// test if the journal is compacted once most of it is outdated
+	for (int i = 0; i < 200; i++) {
+		kv_put("time", "{\"hours\":12,\"minutes\":0,\"seconds\":0,\"weekday\":3,\"last_offset\":" + String(i) + "}");
+	}
+	kv_store_stats stats = get_kv_stats();
+	if (stats.compactions == 0 || stats.journal_size > KV_COMPACT_SIZE + KV_HEADER_LENGTH + KV_KEY_LENGTH + KV_VALUE_LENGTH) {
+		Serial.println("\e[0;31mtest_kv_compact: FAILED");
+		Serial.println("journal was not compacted: " + String(stats.journal_size) + " bytes, " + String(stats.compactions) + " compactions\e[0;37m");
+		clean_LittleFS();
+		return(false);
+	}
+
+	// test if the values are kept after the compaction and a reset
+	kv_compact();
+	kv_unload();
+	if (get_kv_stats().journal_size != get_kv_stats().live_size || kv_get("password") != "12345678" || kv_get("time").endsWith("\"last_offset\":199}") == false) {
+		Serial.println("\e[0;31mtest_kv_compact: FAILED");
+		Serial.println("values were not kept: " + kv_get("time") + "\e[0;37m");
+		clean_LittleFS();
+		return(false);
+	}
+
+	Serial.println("\e[0;32mtest_kv_compact: PASSED\e[0;37m");
+	clean_LittleFS();
+	return(true);
+}
+
+/**
+ * @brief Unit test for moving the old files into the store
+ *
+ * @return boolean - true if the test passed, false if the test failed
+ *
+ * @details - Setup: Clean LittleFS and write /config.txt, /password.txt and /time.json
+ * -# checks if the content of the files is in the store and the files are removed
+ *
+ * @see kv_migrate_file
+ */
+boolean test_kv_migrate_file() {
+	clean_LittleFS();
+
+	LittleFS.begin();
+	File file = LittleFS.open("/config.txt", "w");
+	file.print("AP: true");
+	file.close();
+	file = LittleFS.open("/password.txt", "w");
+	file.print("12345678");
+	file.close();
+	file = LittleFS.open("/time.json", "w");
+	file.print("{\"hours\":12,\"timezone\":3600}");
+	file.close();
+	LittleFS.end();
+
+	// test if the content of the files is in the store and the files are removed
+	DynamicJsonDocument doc(256);
+	kv_load_json("time", doc);
+	LittleFS.begin();
+	boolean removed = !LittleFS.exists("/config.txt") && !LittleFS.exists("/password.txt") && !LittleFS.exists("/time.json");
+	LittleFS.end();
+	if (kv_get("ap") != "true" || kv_get("password") != "12345678" || doc["timezone"] != 3600 || removed == false) {
+		Serial.println("\e[0;31mtest_kv_migrate_file: FAILED");
+		Serial.println("files were not moved: ap " + kv_get("ap") + ", password " + kv_get("password") + ", time " + doc.as<String>() + "\e[0;37m");
+		clean_LittleFS();
+		return(false);
+	}
+
+	Serial.println("\e[0;32mtest_kv_migrate_file: PASSED\e[0;37m");
+	clean_LittleFS();
+	return(true);
+}
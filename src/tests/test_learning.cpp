@@ -0,0 +1,96 @@
+/**
+ * @file test_learning.cpp
+ * @author Marc Ubbelohde
+ * @brief This file contains unit tests for all functions from the learning.cpp.
+ *
+ */
+
+
+#include "tests.h"
+
+/**
+ * @brief Unit test for the function "start_learning"
+ *
+ * @return boolean - true if the test passed, false if the test failed
+ *
+ * @details - Setup: -
+ * -# checks if empty and non alphanumeric names are rejected
+ * -# checks if too many names are rejected
+ * -# checks if no session is started while another job is running
+ *
+ * @see start_learning
+ */
+boolean test_start_learning() {
+
+	// test if empty and non alphanumeric names are rejected
+	String names[] = {"", "on,,off", "on, of/f", "on,off!", "on,a234567890123456789012"};
+	for (int i = 0; i < 5; i++) {
+		if (start_learning(names[i]).startsWith("Error: invalid signal name") == false || get_learning_session().active) {
+			Serial.println("\e[0;31mtest_start_learning: FAILED");
+			Serial.println("invalid names were accepted: " + names[i] + "\e[0;37m");
+			return(false);
+		}
+	}
+
+	// test if too many names are rejected
+	String many = "s0";
+	for (int i = 1; i <= LEARN_MAX_SIGNALS; i++) {
+		many += ",s" + String(i);
+	}
+	if (start_learning(many).startsWith("Error: more than") == false || get_learning_session().active) {
+		Serial.println("\e[0;31mtest_start_learning: FAILED");
+		Serial.println("too many names were accepted\e[0;37m");
+		return(false);
+	}
+
+	// test if no session is started while another job is running
+	uint16_t id = job_begin(JOB_PROGRAM);
+	String result = start_learning("on,off");
+	job_end(id);
+	if (result != "Error: job " + String(id) + " is still running" || get_learning_session().active) {
+		Serial.println("\e[0;31mtest_start_learning: FAILED");
+		Serial.println("session was started while another job was running: " + result + "\e[0;37m");
+		return(false);
+	}
+
+	Serial.println("\e[0;32mtest_start_learning: PASSED\e[0;37m");
+	return(true);
+}
+
+/**
+ * @brief Unit test for the function "print_learning_json"
+ *
+ * @return boolean - true if the test passed, false if the test failed
+ *
+ * @details - Setup: no session was started
+ * -# checks if the progress is printed as valid JSON
+ * -# checks if the returned length matches the printed text
+ *
+ * @see print_learning_json
+ */
+boolean test_print_learning_json() {
+
+	metrics_byte_counter counter;
+	size_t length = print_learning_json(counter);
+
+	StreamString json;
+	print_learning_json(json);
+
+	// test if the progress is printed as valid JSON
+	DynamicJsonDocument doc(1024);
+	if (deserializeJson(doc, json.c_str()) || doc["active"] != false || doc["count"] != 0 || doc["signals"].size() != 0) {
+		Serial.println("\e[0;31mtest_print_learning_json: FAILED");
+		Serial.println("progress was not printed correctly: " + json + "\e[0;37m");
+		return(false);
+	}
+
+	// test if the returned length matches the printed text
+	if (length != json.length() || counter.count != length) {
+		Serial.println("\e[0;31mtest_print_learning_json: FAILED");
+		Serial.println("returned length does not match the printed text\e[0;37m");
+		return(false);
+	}
+
+	Serial.println("\e[0;32mtest_print_learning_json: PASSED\e[0;37m");
+	return(true);
+}
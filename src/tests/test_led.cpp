@@ -0,0 +1,126 @@
+/**
+ * @file test_led.cpp
+ * @author Marc Ubbelohde
+ * @brief This file contains unit tests for all functions from the led.cpp.
+ *
+ */
+
+
+#include "tests.h"
+
+/**
+ * @brief Unit test for the function "led_play"
+ *
+ * @return boolean - true if the test passed, false if the test failed
+ *
+ * @details - Setup: Set LED state to idle
+ * -# checks if playing a pattern returns immediately
+ * -# checks if every step of the pattern switches the LED
+ * -# checks if the LED returns to the state after the last step
+ *
+ * @see led_play
+ */
+boolean test_led_play() {
+
+	// Set LED state to idle
+	led_set_state(LED_IDLE);
+	const led_pattern pattern = {LOW, 4, false, {100, 100, 100, 100}};
+
+	// test if playing a pattern returns immediately
+	unsigned long start = millis();
+	led_play(pattern);
+	if (millis() != start || led_is_playing() == false || digitalRead(LED_PIN) != LOW) {
+		Serial.println("\e[0;31mtest_led_play: FAILED");
+		Serial.println("pattern was not started without blocking\e[0;37m");
+		return(false);
+	}
+
+	// test if every step of the pattern switches the LED
+	int expected[3] = {HIGH, LOW, HIGH};
+	for (int i = 0; i < 3; i++) {
+		update_led();
+		if (digitalRead(LED_PIN) != expected[i] || led_is_playing() == false) {
+			Serial.println("\e[0;31mtest_led_play: FAILED");
+			Serial.println("wrong LED level in step " + String(i + 1));
+			Serial.println("expected: " + String(expected[i]));
+			Serial.println("actual: " + String(digitalRead(LED_PIN)) + "\e[0;37m");
+			return(false);
+		}
+	}
+
+	// test if the LED returns to the state after the last step
+	update_led();
+	if (led_is_playing() == true || digitalRead(LED_PIN) != LOW) {
+		Serial.println("\e[0;31mtest_led_play: FAILED");
+		Serial.println("LED did not return to idle after the pattern\e[0;37m");
+		return(false);
+	}
+
+	// prints success message and returns true
+	Serial.println("\e[0;32mtest_led_play: PASSED\e[0;37m");
+	return(true);
+}
+
+/**
+ * @brief Unit test for the function "led_set_state"
+ *
+ * @return boolean - true if the test passed, false if the test failed
+ *
+ * @details - Setup: Set LED state to idle
+ * -# checks if the previous state is returned and the LED shows the new state
+ * -# checks if the pattern of a state repeats
+ * -# checks if the LED returns to the state after a one-shot pattern
+ * -# checks if the state can be restored
+ *
+ * @see led_set_state
+ */
+boolean test_led_set_state() {
+
+	// Set LED state to idle
+	led_set_state(LED_IDLE);
+
+	// test if the previous state is returned and the LED shows the new state
+	led_state previous = led_set_state(LED_PROGRAM_RUNNING);
+	if (previous != LED_IDLE || led_get_state() != LED_PROGRAM_RUNNING || digitalRead(LED_PIN) != HIGH) {
+		Serial.println("\e[0;31mtest_led_set_state: FAILED");
+		Serial.println("state was not set correctly\e[0;37m");
+		led_set_state(LED_IDLE);
+		return(false);
+	}
+
+	// test if the pattern of a state repeats
+	update_led();
+	int level1 = digitalRead(LED_PIN);
+	update_led();
+	int level2 = digitalRead(LED_PIN);
+	if (level1 != LOW || level2 != HIGH) {
+		Serial.println("\e[0;31mtest_led_set_state: FAILED");
+		Serial.println("pattern of state was not repeated\e[0;37m");
+		led_set_state(LED_IDLE);
+		return(false);
+	}
+
+	// test if the LED returns to the state after a one-shot pattern
+	const led_pattern pattern = {LOW, 2, false, {100, 100}};
+	led_play(pattern);
+	update_led();
+	update_led();
+	if (led_is_playing() == true || led_get_state() != LED_PROGRAM_RUNNING || digitalRead(LED_PIN) != HIGH) {
+		Serial.println("\e[0;31mtest_led_set_state: FAILED");
+		Serial.println("LED did not return to the state after a one-shot pattern\e[0;37m");
+		led_set_state(LED_IDLE);
+		return(false);
+	}
+
+	// test if the state can be restored
+	led_set_state(previous);
+	if (led_get_state() != LED_IDLE || digitalRead(LED_PIN) != LOW) {
+		Serial.println("\e[0;31mtest_led_set_state: FAILED");
+		Serial.println("state was not restored\e[0;37m");
+		return(false);
+	}
+
+	// prints success message and returns true
+	Serial.println("\e[0;32mtest_led_set_state: PASSED\e[0;37m");
+	return(true);
+}
@@ -0,0 +1,118 @@
+/**
+ * @file test_log.cpp
+ * @author Marc Ubbelohde
+ * @brief This file contains unit tests for all functions from the log.cpp.
+ *
+ */
+
+
+#include "tests.h"
+
+/**
+ * @brief Unit test for the function "log_message"
+ *
+ * @return boolean - true if the test passed, false if the test failed
+ *
+ * @details - Setup: Reset log
+ * -# checks if a message is formatted with time and level
+ * -# checks if a long message is cut to LOG_LINE_LENGTH
+ *
+ * @see log_message
+ */
+boolean test_log_message() {
+
+	// Reset log
+	reset_log();
+
+	// test if a message is formatted with time and level
+	log_message(LOG_LEVEL_WARN, "value %d of %s", 42, "test");
+	StreamString content1;
+	print_log(content1);
+	String expected1 = "[" + String(millis()) + "] W value 42 of test\n";
+	if (content1 != expected1) {
+		Serial.println("\e[0;31mtest_log_message: FAILED");
+		Serial.println("message was not formatted correctly");
+		Serial.println("expected: " + expected1);
+		Serial.println("actual: " + content1 + "\e[0;37m");
+		reset_log();
+		return(false);
+	}
+
+	// test if a long message is cut to LOG_LINE_LENGTH
+	reset_log();
+	char long_text[LOG_LINE_LENGTH * 2];
+	memset(long_text, 'a', sizeof(long_text) - 1);
+	long_text[sizeof(long_text) - 1] = '\0';
+	log_message(LOG_LEVEL_INFO, "%s", long_text);
+	StreamString content2;
+	print_log(content2);
+	if (content2.length() != LOG_LINE_LENGTH - 1 || content2.endsWith("a\n") == false) {
+		Serial.println("\e[0;31mtest_log_message: FAILED");
+		Serial.println("long message was not cut correctly");
+		Serial.println("expected length: " + String(LOG_LINE_LENGTH - 1));
+		Serial.println("actual length: " + String(content2.length()) + "\e[0;37m");
+		reset_log();
+		return(false);
+	}
+
+	// prints success message and returns true
+	Serial.println("\e[0;32mtest_log_message: PASSED\e[0;37m");
+	reset_log();
+	return(true);
+}
+
+/**
+ * @brief Unit test for the function "print_log"
+ *
+ * @return boolean - true if the test passed, false if the test failed
+ *
+ * @details - Setup: Reset log
+ * -# checks if an empty log prints nothing
+ * -# checks if only whole messages are printed after the ring buffer wrapped
+ * -# checks if the messages that were not written to Serial are counted as dropped
+ *
+ * @see print_log
+ */
+boolean test_print_log() {
+
+	// Reset log
+	reset_log();
+
+	// test if an empty log prints nothing
+	StreamString content1;
+	if (print_log(content1) != 0) {
+		Serial.println("\e[0;31mtest_print_log: FAILED");
+		Serial.println("empty log printed: " + content1 + "\e[0;37m");
+		return(false);
+	}
+
+	// test if only whole messages are printed after the ring buffer wrapped
+	uint32_t count = LOG_BUFFER_SIZE / 10 + 50;
+	for (uint32_t i = 0; i < count; i++) {
+		LOG_WRITER.print("message " + String(i % 10) + "\n");
+	}
+	StreamString content2;
+	size_t written = print_log(content2);
+	if (written != content2.length() || written > LOG_BUFFER_SIZE || content2.startsWith("message ") == false ||
+			content2.endsWith("message " + String((count - 1) % 10) + "\n") == false) {
+		Serial.println("\e[0;31mtest_print_log: FAILED");
+		Serial.println("log was not printed correctly after wrapping\e[0;37m");
+		reset_log();
+		return(false);
+	}
+
+	// test if the messages that were not written to Serial are counted as dropped
+	update_log();
+	if (get_log_dropped() != count * 10 - LOG_BUFFER_SIZE) {
+		Serial.println("\e[0;31mtest_print_log: FAILED");
+		Serial.println("expected dropped: " + String(count * 10 - LOG_BUFFER_SIZE));
+		Serial.println("actual dropped: " + String(get_log_dropped()) + "\e[0;37m");
+		reset_log();
+		return(false);
+	}
+
+	// prints success message and returns true
+	Serial.println("\e[0;32mtest_print_log: PASSED\e[0;37m");
+	reset_log();
+	return(true);
+}
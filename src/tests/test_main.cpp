@@ -35,6 +35,10 @@ boolean run_all_filesystem_tests(boolean stop_on_error) {
   if(!check && stop_on_error) return check;
 	if(!check) {set_check = false;}
 
+  check = test_save_capture();
+  if(!check && stop_on_error) return check;
+	if(!check) {set_check = false;}
+
   check = test_save_json();
   if(!check && stop_on_error) return check;
 	if(!check) {set_check = false;}
@@ -47,6 +51,10 @@ boolean run_all_filesystem_tests(boolean stop_on_error) {
 	if(!check && stop_on_error) return check;
 	if(!check) {set_check = false;}
 
+	check = test_generic_signal_json();
+	if(!check && stop_on_error) return check;
+	if(!check) {set_check = false;}
+
 	check = test_get_files();
 	if(!check && stop_on_error) return check;
 	if(!check) {set_check = false;}
@@ -120,6 +128,10 @@ boolean run_all_time_management_tests(boolean stop_on_error) {
 	if(!check && stop_on_error) return check;
 	if(!check) {set_check = false;}
 
+	check = test_read_ntp_time();
+	if(!check && stop_on_error) return check;
+	if(!check) {set_check = false;}
+
   return set_check;
 }
 
@@ -161,6 +173,10 @@ boolean run_all_workflows_tests(boolean stop_on_error) {
 	if(!check && stop_on_error) return check;
 	if(!check) {set_check = false;}
 
+	check = test_playing_workflow_resume();
+	if(!check && stop_on_error) return check;
+	if(!check) {set_check = false;}
+
 	check = test_program_parser();
 	if(!check && stop_on_error) return check;
 	if(!check) {set_check = false;}
@@ -177,6 +193,460 @@ boolean run_all_workflows_tests(boolean stop_on_error) {
 }
 
 
+/**
+ * @brief runs all tests for archive.cpp
+ * 
+ * @param stop_on_error - if true, the function stops after the first failed test if false, the function continues to run all following tests
+ * 
+ * @return boolean - true if all tests passed, false if at least one test failed
+ * 
+ * @callgraph
+ * 
+ * @callergraph
+ */
+boolean run_all_archive_tests(boolean stop_on_error) {
+  Serial.println("\nTesting archive.cpp");
+
+  boolean check = true;
+	boolean set_check = true;
+  
+	check = test_get_archive_size();
+	if(!check && stop_on_error) return check;
+	if(!check) {set_check = false;}
+
+	check = test_write_archive();
+	if(!check && stop_on_error) return check;
+	if(!check) {set_check = false;}
+
+	check = test_import_archive();
+	if(!check && stop_on_error) return check;
+	if(!check) {set_check = false;}
+
+  return set_check;
+}
+
+
+/**
+ * @brief runs all tests for metrics.cpp
+ * 
+ * @param stop_on_error - if true, the function stops after the first failed test if false, the function continues to run all following tests
+ * 
+ * @return boolean - true if all tests passed, false if at least one test failed
+ * 
+ * @callgraph
+ * 
+ * @callergraph
+ */
+boolean run_all_metrics_tests(boolean stop_on_error) {
+  Serial.println("\nTesting metrics.cpp");
+
+  boolean check = true;
+	boolean set_check = true;
+  
+	check = test_sample_metrics();
+	if(!check && stop_on_error) return check;
+	if(!check) {set_check = false;}
+
+	check = test_metrics_scope();
+	if(!check && stop_on_error) return check;
+	if(!check) {set_check = false;}
+
+	check = test_print_metrics_json();
+	if(!check && stop_on_error) return check;
+	if(!check) {set_check = false;}
+
+  return set_check;
+}
+
+
+/**
+ * @brief runs all tests for trace.cpp
+ * 
+ * @param stop_on_error - if true, the function stops after the first failed test if false, the function continues to run all following tests
+ * 
+ * @return boolean - true if all tests passed or tracing is disabled, false if at least one test failed
+ * 
+ * @callgraph
+ * 
+ * @callergraph
+ */
+boolean run_all_trace_tests(boolean stop_on_error) {
+  Serial.println("\nTesting trace.cpp");
+
+  boolean check = true;
+	boolean set_check = true;
+
+#if TRACE_ENABLED
+	check = test_trace_span();
+	if(!check && stop_on_error) return check;
+	if(!check) {set_check = false;}
+
+	check = test_print_trace_json();
+	if(!check && stop_on_error) return check;
+	if(!check) {set_check = false;}
+#else
+	Serial.println("tracing is disabled, skipping tests");
+#endif
+
+  return set_check;
+}
+
+
+/**
+ * @brief runs all tests for tokenizer.cpp
+ * 
+ * @param stop_on_error - if true, the function stops after the first failed test if false, the function continues to run all following tests
+ * 
+ * @return boolean - true if all tests passed, false if at least one test failed
+ * 
+ * @callgraph
+ * 
+ * @callergraph
+ */
+boolean run_all_tokenizer_tests(boolean stop_on_error) {
+  Serial.println("\nTesting tokenizer.cpp");
+
+  boolean check = true;
+	boolean set_check = true;
+  
+	check = test_tokenize_program_line();
+	if(!check && stop_on_error) return check;
+	if(!check) {set_check = false;}
+
+  return set_check;
+}
+
+
+/**
+ * @brief runs all tests for led.cpp
+ * 
+ * @param stop_on_error - if true, the function stops after the first failed test if false, the function continues to run all following tests
+ * 
+ * @return boolean - true if all tests passed, false if at least one test failed
+ * 
+ * @callgraph
+ * 
+ * @callergraph
+ */
+boolean run_all_led_tests(boolean stop_on_error) {
+  Serial.println("\nTesting led.cpp");
+
+  boolean check = true;
+	boolean set_check = true;
+
+	check = test_led_play();
+	if(!check && stop_on_error) return check;
+	if(!check) {set_check = false;}
+
+	check = test_led_set_state();
+	if(!check && stop_on_error) return check;
+	if(!check) {set_check = false;}
+
+  return set_check;
+}
+
+
+/**
+ * @brief runs all tests for jobs.cpp
+ * 
+ * @param stop_on_error - if true, the function stops after the first failed test if false, the function continues to run all following tests
+ * 
+ * @return boolean - true if all tests passed, false if at least one test failed
+ * 
+ * @callgraph
+ * 
+ * @callergraph
+ */
+boolean run_all_jobs_tests(boolean stop_on_error) {
+  Serial.println("\nTesting jobs.cpp");
+
+  boolean check = true;
+	boolean set_check = true;
+
+	check = test_job_begin();
+	if(!check && stop_on_error) return check;
+	if(!check) {set_check = false;}
+
+	check = test_job_cancel();
+	if(!check && stop_on_error) return check;
+	if(!check) {set_check = false;}
+
+	check = test_job_busy();
+	if(!check && stop_on_error) return check;
+	if(!check) {set_check = false;}
+
+	check = test_job_sleep();
+	if(!check && stop_on_error) return check;
+	if(!check) {set_check = false;}
+
+  return set_check;
+}
+
+
+/**
+ * @brief runs all tests for log.cpp
+ * 
+ * @param stop_on_error - if true, the function stops after the first failed test if false, the function continues to run all following tests
+ * 
+ * @return boolean - true if all tests passed, false if at least one test failed
+ * 
+ * @callgraph
+ * 
+ * @callergraph
+ */
+boolean run_all_log_tests(boolean stop_on_error) {
+  Serial.println("\nTesting log.cpp");
+
+  boolean check = true;
+	boolean set_check = true;
+
+	check = test_log_message();
+	if(!check && stop_on_error) return check;
+	if(!check) {set_check = false;}
+
+	check = test_print_log();
+	if(!check && stop_on_error) return check;
+	if(!check) {set_check = false;}
+
+  return set_check;
+}
+
+
+/**
+ * @brief runs all tests for learning.cpp
+ * 
+ * @param stop_on_error - if true, the function stops after the first failed test if false, the function continues to run all following tests
+ * 
+ * @return boolean - true if all tests passed, false if at least one test failed
+ * 
+ * @callgraph
+ * 
+ * @callergraph
+ */
+boolean run_all_learning_tests(boolean stop_on_error) {
+  Serial.println("\nTesting learning.cpp");
+
+  boolean check = true;
+	boolean set_check = true;
+
+	check = test_start_learning();
+	if(!check && stop_on_error) return check;
+	if(!check) {set_check = false;}
+
+	check = test_print_learning_json();
+	if(!check && stop_on_error) return check;
+	if(!check) {set_check = false;}
+
+  return set_check;
+}
+
+
+/**
+ * @brief runs all tests for events.cpp
+ * 
+ * @param stop_on_error - if true, the function stops after the first failed test if false, the function continues to run all following tests
+ * 
+ * @return boolean - true if all tests passed, false if at least one test failed
+ * 
+ * @callgraph
+ * 
+ * @callergraph
+ */
+boolean run_all_events_tests(boolean stop_on_error) {
+  Serial.println("\nTesting events.cpp");
+
+  boolean check = true;
+	boolean set_check = true;
+
+	check = test_publish_event();
+	if(!check && stop_on_error) return check;
+	if(!check) {set_check = false;}
+
+	check = test_publish_message();
+	if(!check && stop_on_error) return check;
+	if(!check) {set_check = false;}
+
+	check = test_get_event_resume_id();
+	if(!check && stop_on_error) return check;
+	if(!check) {set_check = false;}
+
+	check = test_print_events();
+	if(!check && stop_on_error) return check;
+	if(!check) {set_check = false;}
+
+	check = test_print_events_json();
+	if(!check && stop_on_error) return check;
+	if(!check) {set_check = false;}
+
+  return set_check;
+}
+
+
+/**
+ * @brief runs all tests for udp_command.cpp
+ * 
+ * @param stop_on_error - if true, the function stops after the first failed test if false, the function continues to run all following tests
+ * 
+ * @return boolean - true if all tests passed, false if at least one test failed
+ * 
+ * @callgraph
+ * 
+ * @callergraph
+ */
+boolean run_all_udp_command_tests(boolean stop_on_error) {
+  Serial.println("\nTesting udp_command.cpp");
+
+  boolean check = true;
+	boolean set_check = true;
+
+	check = test_hmac_sha256();
+	if(!check && stop_on_error) return check;
+	if(!check) {set_check = false;}
+
+	check = test_parse_udp_command();
+	if(!check && stop_on_error) return check;
+	if(!check) {set_check = false;}
+
+	check = test_build_udp_ack();
+	if(!check && stop_on_error) return check;
+	if(!check) {set_check = false;}
+
+  return set_check;
+}
+
+
+/**
+ * @brief runs all tests for mqtt.cpp
+ * 
+ * @param stop_on_error - if true, the function stops after the first failed test if false, the function continues to run all following tests
+ * 
+ * @return boolean - true if all tests passed, false if at least one test failed
+ * 
+ * @callgraph
+ * 
+ * @callergraph
+ */
+boolean run_all_mqtt_tests(boolean stop_on_error) {
+  Serial.println("\nTesting mqtt.cpp");
+
+  boolean check = true;
+	boolean set_check = true;
+
+	check = test_parse_mqtt_command();
+	if(!check && stop_on_error) return check;
+	if(!check) {set_check = false;}
+
+	check = test_mqtt_queue_command();
+	if(!check && stop_on_error) return check;
+	if(!check) {set_check = false;}
+
+  return set_check;
+}
+
+
+/**
+ * @brief runs all tests for json_arena.cpp
+ * 
+ * @param stop_on_error - if true, the function stops after the first failed test if false, the function continues to run all following tests
+ * 
+ * @return boolean - true if all tests passed, false if at least one test failed
+ * 
+ * @callgraph
+ * 
+ * @callergraph
+ */
+boolean run_all_json_arena_tests(boolean stop_on_error) {
+  Serial.println("\nTesting json_arena.cpp");
+
+  boolean check = true;
+	boolean set_check = true;
+
+	check = test_json_arena_allocator();
+	if(!check && stop_on_error) return check;
+	if(!check) {set_check = false;}
+
+	check = test_json_arena_storage();
+	if(!check && stop_on_error) return check;
+	if(!check) {set_check = false;}
+
+  return set_check;
+}
+
+
+/**
+ * @brief runs all tests for kv_store.cpp
+ * 
+ * @param stop_on_error - if true, the function stops after the first failed test if false, the function continues to run all following tests
+ * 
+ * @return boolean - true if all tests passed, false if at least one test failed
+ * 
+ * @callgraph
+ * 
+ * @callergraph
+ */
+boolean run_all_kv_store_tests(boolean stop_on_error) {
+  Serial.println("\nTesting kv_store.cpp");
+
+  boolean check = true;
+	boolean set_check = true;
+
+	check = test_kv_crc32();
+	if(!check && stop_on_error) return check;
+	if(!check) {set_check = false;}
+
+	check = test_kv_put();
+	if(!check && stop_on_error) return check;
+	if(!check) {set_check = false;}
+
+	check = test_kv_load();
+	if(!check && stop_on_error) return check;
+	if(!check) {set_check = false;}
+
+	check = test_kv_compact();
+	if(!check && stop_on_error) return check;
+	if(!check) {set_check = false;}
+
+	check = test_kv_migrate_file();
+	if(!check && stop_on_error) return check;
+	if(!check) {set_check = false;}
+
+  return set_check;
+}
+
+
+/**
+ * @brief runs all tests for rtc_state.cpp
+ * 
+ * @param stop_on_error - if true, the function stops after the first failed test if false, the function continues to run all following tests
+ * 
+ * @return boolean - true if all tests passed, false if at least one test failed
+ * 
+ * @callgraph
+ * 
+ * @callergraph
+ */
+boolean run_all_rtc_state_tests(boolean stop_on_error) {
+  Serial.println("\nTesting rtc_state.cpp");
+
+  boolean check = true;
+	boolean set_check = true;
+
+	check = test_rtc_state_checkpoint();
+	if(!check && stop_on_error) return check;
+	if(!check) {set_check = false;}
+
+	check = test_restore_rtc_state();
+	if(!check && stop_on_error) return check;
+	if(!check) {set_check = false;}
+
+	check = test_rtc_set_clock();
+	if(!check && stop_on_error) return check;
+	if(!check) {set_check = false;}
+
+  return set_check;
+}
+
+
 /**
  * @brief runs all tests for all files
  * 
@@ -199,6 +669,34 @@ void run_all_tests(boolean stop_on_error) {
 	if(check == false) {set_check = false;}
   if(check == true || !stop_on_error) {check = run_all_workflows_tests(stop_on_error);}
 	if(check == false) {set_check = false;}
+  if(check == true || !stop_on_error) {check = run_all_archive_tests(stop_on_error);}
+	if(check == false) {set_check = false;}
+  if(check == true || !stop_on_error) {check = run_all_metrics_tests(stop_on_error);}
+	if(check == false) {set_check = false;}
+  if(check == true || !stop_on_error) {check = run_all_trace_tests(stop_on_error);}
+	if(check == false) {set_check = false;}
+  if(check == true || !stop_on_error) {check = run_all_tokenizer_tests(stop_on_error);}
+	if(check == false) {set_check = false;}
+  if(check == true || !stop_on_error) {check = run_all_led_tests(stop_on_error);}
+	if(check == false) {set_check = false;}
+  if(check == true || !stop_on_error) {check = run_all_jobs_tests(stop_on_error);}
+	if(check == false) {set_check = false;}
+  if(check == true || !stop_on_error) {check = run_all_log_tests(stop_on_error);}
+	if(check == false) {set_check = false;}
+  if(check == true || !stop_on_error) {check = run_all_learning_tests(stop_on_error);}
+	if(check == false) {set_check = false;}
+  if(check == true || !stop_on_error) {check = run_all_events_tests(stop_on_error);}
+	if(check == false) {set_check = false;}
+  if(check == true || !stop_on_error) {check = run_all_udp_command_tests(stop_on_error);}
+	if(check == false) {set_check = false;}
+  if(check == true || !stop_on_error) {check = run_all_mqtt_tests(stop_on_error);}
+	if(check == false) {set_check = false;}
+  if(check == true || !stop_on_error) {check = run_all_json_arena_tests(stop_on_error);}
+	if(check == false) {set_check = false;}
+  if(check == true || !stop_on_error) {check = run_all_kv_store_tests(stop_on_error);}
+	if(check == false) {set_check = false;}
+  if(check == true || !stop_on_error) {check = run_all_rtc_state_tests(stop_on_error);}
+	if(check == false) {set_check = false;}
   
 
   if(set_check != true) {
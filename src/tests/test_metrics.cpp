@@ -0,0 +1,161 @@
+/**
+ * @file test_metrics.cpp
+ * @author Marc Ubbelohde
+ * @brief This file contains unit tests for all functions from the metrics.cpp.
+ *
+ */
+
+
+#include "tests.h"
+
+/**
+ * @brief Unit test for the function "sample_metrics"
+ *
+ * @return boolean - true if the test passed, false if the test failed
+ *
+ * @details - Setup: Reset metrics
+ * -# checks if a sample is stored and returned as newest sample
+ * -# checks if the number of samples stops at METRICS_SAMPLE_COUNT when the ring buffer wraps
+ * -# checks if a sample that does not exist is returned empty
+ *
+ * @see sample_metrics
+ */
+boolean test_sample_metrics() {
+
+	// Reset metrics
+	reset_metrics();
+
+	sample_metrics();
+	metrics_sample sample = get_metrics_sample(0);
+	if (get_metrics_sample_count() != 1 || sample.free_heap == 0 || sample.free_heap != ESP.getFreeHeap()) {
+		Serial.println("\e[0;31mtest_sample_metrics: FAILED");
+		Serial.println("expected count: 1 , actual count: " + String(get_metrics_sample_count()) + " , free heap: " + String(sample.free_heap) + "\e[0;37m");
+		reset_metrics();
+		return(false);
+	}
+
+	for (int i = 0; i < METRICS_SAMPLE_COUNT + 5; i++) {
+		sample_metrics();
+	}
+	if (get_metrics_sample_count() != METRICS_SAMPLE_COUNT || get_metrics_sample(METRICS_SAMPLE_COUNT - 1).free_heap == 0) {
+		Serial.println("\e[0;31mtest_sample_metrics: FAILED");
+		Serial.println("expected count: " + String(METRICS_SAMPLE_COUNT) + " , actual count: " + String(get_metrics_sample_count()) + "\e[0;37m");
+		reset_metrics();
+		return(false);
+	}
+
+	if (get_metrics_sample(METRICS_SAMPLE_COUNT).free_heap != 0) {
+		Serial.println("\e[0;31mtest_sample_metrics: FAILED");
+		Serial.println("sample out of range is not empty\e[0;37m");
+		reset_metrics();
+		return(false);
+	}
+
+	// prints success message and returns true
+	Serial.println("\e[0;32mtest_sample_metrics: PASSED\e[0;37m");
+	reset_metrics();
+	return(true);
+}
+
+/**
+ * @brief Unit test for the struct "metrics_scope"
+ *
+ * @return boolean - true if the test passed, false if the test failed
+ *
+ * @details - Setup: Reset metrics
+ * -# checks if every scope is counted for its subsystem only
+ * -# checks if the minimum free heap is recorded
+ * -# checks if the heap of a nested scope is not counted for the outer one
+ *
+ * @see metrics_scope
+ */
+boolean test_metrics_scope() {
+
+	// Reset metrics
+	reset_metrics();
+
+	for (int i = 0; i < 3; i++) {
+		metrics_scope scope(METRICS_PARSER);
+	}
+	{
+		metrics_scope scope(METRICS_SEND);
+	}
+
+	metrics_counter parser = get_metrics_counter(METRICS_PARSER);
+	metrics_counter send = get_metrics_counter(METRICS_SEND);
+	metrics_counter capture = get_metrics_counter(METRICS_CAPTURE);
+	if (parser.calls != 3 || send.calls != 1 || capture.calls != 0 || parser.min_free_heap == 0) {
+		Serial.println("\e[0;31mtest_metrics_scope: FAILED");
+		Serial.println("expected calls: 3, 1, 0 , actual calls: " + String(parser.calls) + ", " + String(send.calls) + ", " + String(capture.calls) + "\e[0;37m");
+		reset_metrics();
+		return(false);
+	}
+
+	// test if the heap of a nested scope is not counted for the outer one
+	reset_metrics();
+	char *buffer = NULL;
+	{
+		metrics_scope outer(METRICS_CAPTURE);
+		{
+			metrics_scope inner(METRICS_STORAGE);
+			buffer = new char[512];
+		}
+	}
+	delete[] buffer;
+	capture = get_metrics_counter(METRICS_CAPTURE);
+	metrics_counter storage = get_metrics_counter(METRICS_STORAGE);
+	if (capture.calls != 1 || storage.calls != 1 || capture.total_heap_delta != 0) {
+		Serial.println("\e[0;31mtest_metrics_scope: FAILED");
+		Serial.println("expected heap delta of the outer scope: 0, actual: " + String(capture.total_heap_delta) + " (inner: " + String(storage.total_heap_delta) + ")\e[0;37m");
+		reset_metrics();
+		return(false);
+	}
+
+	// prints success message and returns true
+	Serial.println("\e[0;32mtest_metrics_scope: PASSED\e[0;37m");
+	reset_metrics();
+	return(true);
+}
+
+/**
+ * @brief Unit test for the function "print_metrics_json"
+ *
+ * @return boolean - true if the test passed, false if the test failed
+ *
+ * @details - Setup: Reset metrics, take two samples and count one storage call
+ * -# checks if the output is valid JSON with the expected content
+ * -# checks if the returned length matches the output and the metrics_byte_counter
+ *
+ * @see print_metrics_json
+ */
+boolean test_print_metrics_json() {
+
+	// Reset metrics
+	reset_metrics();
+	sample_metrics();
+	sample_metrics();
+	{
+		metrics_scope scope(METRICS_STORAGE);
+	}
+
+	metrics_sample now = read_metrics();
+	StreamString content;
+	size_t written = print_metrics_json(content, now);
+	metrics_byte_counter counter;
+	print_metrics_json(counter, now);
+
+	DynamicJsonDocument doc(2048);
+	DeserializationError error = deserializeJson(doc, content.c_str());
+
+	if (error || written != content.length() || counter.count != written || doc["samples"].size() != 2 || doc["subsystems"]["storage"]["calls"] != 1 || doc["now"]["free_heap"] != now.free_heap) {
+		Serial.println("\e[0;31mtest_print_metrics_json: FAILED");
+		Serial.println("output: " + content + " , written: " + String(written) + " , counted: " + String(counter.count) + "\e[0;37m");
+		reset_metrics();
+		return(false);
+	}
+
+	// prints success message and returns true
+	Serial.println("\e[0;32mtest_print_metrics_json: PASSED\e[0;37m");
+	reset_metrics();
+	return(true);
+}
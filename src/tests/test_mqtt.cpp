@@ -0,0 +1,122 @@
+/**
+ * @file test_mqtt.cpp
+ * @author Marc Ubbelohde
+ * @brief This file contains unit tests for all functions from the mqtt.cpp.
+ *
+ */
+
+
+#include "tests.h"
+
+/**
+ * @brief Unit test for the function "parse_mqtt_command"
+ *
+ * @return boolean - true if the test passed, false if the test failed
+ *
+ * @details
+ * -# checks if names of signals and programs are read
+ * -# checks if a state with protocol number, "0x" and number of bits is read
+ * -# checks if invalid commands are rejected
+ *
+ * @see parse_mqtt_command
+ */
+boolean test_parse_mqtt_command() {
+	mqtt_command command;
+
+	// test if names of signals and programs are read
+	const char name[] = "tv on";
+	if (parse_mqtt_command("signal/send", (const uint8_t *)name, 5, command) == false || command.type != UDP_SEND_SIGNAL
+			|| command.length != 5 || memcmp(command.payload, name, 5) != 0
+			|| parse_mqtt_command("program/play", (const uint8_t *)name, 5, command) == false || command.type != UDP_PLAY_PROGRAM) {
+		Serial.println("\e[0;31mtest_parse_mqtt_command: FAILED");
+		Serial.println("name was not read\e[0;37m");
+		return(false);
+	}
+
+	// test if a state with protocol number, "0x" and number of bits is read
+	const char state[] = "3,0x20DF10ef,32";
+	const uint8_t expected[] = {0, 3, 0, 32, 0x20, 0xdf, 0x10, 0xef};
+	if (parse_mqtt_command("state/send", (const uint8_t *)state, strlen(state), command) == false || command.type != UDP_SEND_STATE
+			|| command.length != sizeof(expected) || memcmp(command.payload, expected, sizeof(expected)) != 0) {
+		Serial.println("\e[0;31mtest_parse_mqtt_command: FAILED");
+		Serial.println("expected: " + bytes_to_hex(expected, sizeof(expected)));
+		Serial.println("actual: " + bytes_to_hex(command.payload, command.length) + "\e[0;37m");
+		return(false);
+	}
+
+	// test if invalid commands are rejected
+	const char *invalid_states[] = {"3", "3,", "3,20D", "3,20DG", "3,20DF,x", "3,20DF,70000", ",20DF"};
+	for (size_t i = 0; i < sizeof(invalid_states) / sizeof(invalid_states[0]); i++) {
+		if (parse_mqtt_command("state/send", (const uint8_t *)invalid_states[i], strlen(invalid_states[i]), command) == true) {
+			Serial.println("\e[0;31mtest_parse_mqtt_command: FAILED");
+			Serial.println("invalid state was accepted: " + String(invalid_states[i]) + "\e[0;37m");
+			return(false);
+		}
+	}
+	String long_name = "";
+	for (int i = 0; i < 33; i++) {
+		long_name += "x";
+	}
+	if (parse_mqtt_command("signal/send", (const uint8_t *)long_name.c_str(), long_name.length(), command) == true
+			|| parse_mqtt_command("signal/send", (const uint8_t *)name, 0, command) == true
+			|| parse_mqtt_command("signal/delete", (const uint8_t *)name, 5, command) == true) {
+		Serial.println("\e[0;31mtest_parse_mqtt_command: FAILED");
+		Serial.println("invalid name or topic was accepted\e[0;37m");
+		return(false);
+	}
+
+	Serial.println("\e[0;32mtest_parse_mqtt_command: PASSED\e[0;37m");
+	return(true);
+}
+
+/**
+ * @brief Unit test for the functions "mqtt_queue_command" and "mqtt_next_command"
+ *
+ * @return boolean - true if the test passed, false if the test failed
+ *
+ * @details - Setup: the queue is emptied
+ * -# checks if commands come out in the order they were queued
+ * -# checks if commands are rejected while the queue is full
+ *
+ * @see mqtt_queue_command
+ * @see mqtt_next_command
+ */
+boolean test_mqtt_queue_command() {
+	mqtt_command command;
+	while (mqtt_next_command(command)) {}
+
+	// test if commands come out in the order they were queued
+	for (uint8_t i = 0; i < MQTT_QUEUE_SIZE; i++) {
+		command.type = UDP_SEND_SIGNAL;
+		command.length = 1;
+		command.payload[0] = i;
+		if (mqtt_queue_command(command) == false) {
+			Serial.println("\e[0;31mtest_mqtt_queue_command: FAILED");
+			Serial.println("command " + String(i) + " was rejected\e[0;37m");
+			return(false);
+		}
+	}
+
+	// test if commands are rejected while the queue is full
+	if (mqtt_queue_command(command) == true) {
+		Serial.println("\e[0;31mtest_mqtt_queue_command: FAILED");
+		Serial.println("full queue accepted a command\e[0;37m");
+		return(false);
+	}
+
+	for (uint8_t i = 0; i < MQTT_QUEUE_SIZE; i++) {
+		if (mqtt_next_command(command) == false || command.payload[0] != i) {
+			Serial.println("\e[0;31mtest_mqtt_queue_command: FAILED");
+			Serial.println("command " + String(i) + " did not come out in order\e[0;37m");
+			return(false);
+		}
+	}
+	if (mqtt_next_command(command) == true) {
+		Serial.println("\e[0;31mtest_mqtt_queue_command: FAILED");
+		Serial.println("empty queue returned a command\e[0;37m");
+		return(false);
+	}
+
+	Serial.println("\e[0;32mtest_mqtt_queue_command: PASSED\e[0;37m");
+	return(true);
+}
@@ -0,0 +1,211 @@
+/**
+ * @file test_rtc_state.cpp
+ * @author Marc Ubbelohde
+ * @brief This file contains unit tests for all functions from the rtc_state.cpp.
+ *
+ */
+
+
+#include "tests.h"
+
+/**
+ * @brief Unit test for the functions "write_rtc_state" and "read_rtc_state"
+ *
+ * @return boolean - true if the test passed, false if the test failed
+ *
+ * @details - Setup: Clear the RTC user memory
+ * -# checks if a cleared state is not valid
+ * -# checks if the clock is checkpointed when it is set
+ * -# checks if the milliseconds of the clock are checkpointed
+ * -# checks if a changed byte is found by the checksum
+ *
+ * @see read_rtc_state
+ * @see write_rtc_state
+ */
+boolean test_rtc_state_checkpoint() {
+	rtc_clear();
+	rtc_state state;
+
+	// test if a cleared state is not valid
+	if (read_rtc_state(state) == true) {
+		Serial.println("\e[0;31mtest_rtc_state_checkpoint: FAILED");
+		Serial.println("cleared state is valid\e[0;37m");
+		return(false);
+	}
+
+	// test if the clock is checkpointed when it is set
+	rtc_set_clock(3 * 86400 + 12 * 3600, 0, 3600, false);
+	if (read_rtc_state(state) == false || state.clock / 10 != (3 * 86400 + 12 * 3600) / 10 || state.timezone != 3600 || state.flags != RTC_CLOCK_VALID) {
+		Serial.println("\e[0;31mtest_rtc_state_checkpoint: FAILED");
+		Serial.println("expected: clock " + String(3 * 86400 + 12 * 3600) + ", timezone 3600, flags " + String(RTC_CLOCK_VALID));
+		Serial.println("actual: clock " + String(state.clock) + ", timezone " + String(state.timezone) + ", flags " + String(state.flags) + "\e[0;37m");
+		rtc_clear();
+		return(false);
+	}
+
+	// test if the milliseconds of the clock are checkpointed
+	rtc_set_clock(3 * 86400 + 12 * 3600, 900, 3600, false);
+	delay(200);
+	checkpoint_rtc_state();
+	if (read_rtc_state(state) == false || state.clock != 3 * 86400 + 12 * 3600 + 1 || state.clock_ms < 100 || state.clock_ms > 300) {
+		Serial.println("\e[0;31mtest_rtc_state_checkpoint: FAILED");
+		Serial.println("expected: clock " + String(3 * 86400 + 12 * 3600 + 1) + ", about 100 ms");
+		Serial.println("actual: clock " + String(state.clock) + ", " + String(state.clock_ms) + " ms\e[0;37m");
+		rtc_clear();
+		return(false);
+	}
+
+	// test if a changed byte is found by the checksum
+	state.clock++;
+	ESP.rtcUserMemoryWrite(RTC_STATE_OFFSET, (uint32_t *)&state, sizeof(state));
+	if (read_rtc_state(state) == true) {
+		Serial.println("\e[0;31mtest_rtc_state_checkpoint: FAILED");
+		Serial.println("changed state is valid\e[0;37m");
+		rtc_clear();
+		return(false);
+	}
+
+	Serial.println("\e[0;32mtest_rtc_state_checkpoint: PASSED\e[0;37m");
+	rtc_clear();
+	return(true);
+}
+
+/**
+ * @brief Unit test for the function "restore_rtc_state"
+ *
+ * @return boolean - true if the test passed, false if the test failed
+ *
+ * @details - Setup: Clean LittleFS and clear the RTC user memory
+ * -# checks if nothing is restored after a power loss
+ * -# checks if the time and the running program are restored
+ * -# checks if a program that is reset too often in the same line is not continued
+ *
+ * @see restore_rtc_state
+ */
+boolean test_restore_rtc_state() {
+	clean_LittleFS();
+	rtc_clear();
+
+	// test if nothing is restored after a power loss
+	if (restore_rtc_state() == true) {
+		Serial.println("\e[0;31mtest_restore_rtc_state: FAILED");
+		Serial.println("state was restored after a power loss\e[0;37m");
+		clean_LittleFS();
+		return(false);
+	}
+
+	// test if the time and the running program are restored
+	rtc_set_clock(3 * 86400 + 12 * 3600, 0, 0, true);
+	rtc_set_program("test_program");
+	rtc_set_program_line(4);
+	restore_rtc_state();
+	rtc_state state = get_rtc_state();
+	String time = get_current_time();
+	if (time.startsWith("12:0") == false || time.endsWith(" 3") == false || (state.flags & RTC_CLOCK_SYNCED) == 0 || String(state.program) != "test_program" || state.program_line != 4 || state.resumes != 1) {
+		Serial.println("\e[0;31mtest_restore_rtc_state: FAILED");
+		Serial.println("expected: 12:0x:xx 3, program test_program in line 4, 1 reset");
+		Serial.println("actual: " + time + ", program " + String(state.program) + " in line " + String(state.program_line) + ", " + String(state.resumes) + " resets\e[0;37m");
+		rtc_clear();
+		clean_LittleFS();
+		return(false);
+	}
+
+	// test if a program that is reset too often in the same line is not continued
+	for (uint8_t i = 0; i < RTC_MAX_RESUMES; i++) {
+		restore_rtc_state();
+	}
+	state = get_rtc_state();
+	if ((state.flags & RTC_PROGRAM_RUNNING) != 0 || (state.flags & RTC_CLOCK_VALID) == 0) {
+		Serial.println("\e[0;31mtest_restore_rtc_state: FAILED");
+		Serial.println("program was continued after " + String(state.resumes) + " resets\e[0;37m");
+		rtc_clear();
+		clean_LittleFS();
+		return(false);
+	}
+
+	Serial.println("\e[0;32mtest_restore_rtc_state: PASSED\e[0;37m");
+	rtc_clear();
+	clean_LittleFS();
+	return(true);
+}
+
+/**
+ * @brief Unit test for the function "rtc_set_clock"
+ *
+ * @return boolean - true if the test passed, false if the test failed
+ *
+ * @details - Setup: Clean LittleFS and restore a clock that was synced one day ago
+ * -# checks if the drift is measured when NTP corrects the clock
+ * -# checks if the drift is taken out of times measured with millis()
+ * -# checks if a too large drift is ignored
+ * -# checks if a time from the user is not used to measure the drift
+ *
+ * @see rtc_set_clock
+ * @see correct_clock_drift
+ */
+boolean test_rtc_set_clock() {
+	clean_LittleFS();
+	rtc_clear();
+
+	// state of a clock that ran one day since the last NTP sync (millis() since the start is added)
+	rtc_state state = get_rtc_state();
+	state.clock = 3 * 86400 + 12 * 3600;
+	state.sync_age = 86400;
+	state.flags = RTC_CLOCK_VALID | RTC_CLOCK_SYNCED;
+	write_rtc_state(state);
+	restore_rtc_state();
+
+	// test if the drift is measured when NTP corrects the clock (9.5 s fast in one day are about 110 ppm)
+	state = get_rtc_state();
+	uint32_t age = state.sync_age;
+	rtc_set_clock(state.clock - 10, state.clock_ms + 500, 0, true);
+	int32_t expected = (int64_t)9500 * 1000 / age;
+	if (get_clock_drift() != expected || get_rtc_state().sync_age != 0) {
+		Serial.println("\e[0;31mtest_rtc_set_clock: FAILED");
+		Serial.println("expected: drift " + String(expected) + " ppm");
+		Serial.println("actual: drift " + String(get_clock_drift()) + " ppm\e[0;37m");
+		rtc_clear();
+		clean_LittleFS();
+		return(false);
+	}
+
+	// test if the drift is taken out of times measured with millis()
+	if (correct_clock_drift(1000000) != (unsigned long)(1000000 - expected)) {
+		Serial.println("\e[0;31mtest_rtc_set_clock: FAILED");
+		Serial.println("expected: " + String(1000000 - expected));
+		Serial.println("actual: " + String(correct_clock_drift(1000000)) + "\e[0;37m");
+		rtc_clear();
+		clean_LittleFS();
+		return(false);
+	}
+
+	// test if a too large drift is ignored (one hour off, e.g. a changed timezone)
+	state = get_rtc_state();
+	state.sync_age = 86400;
+	write_rtc_state(state);
+	restore_rtc_state();
+	rtc_set_clock(get_rtc_clock() + 3600, 0, 0, true);
+	if (get_clock_drift() != expected) {
+		Serial.println("\e[0;31mtest_rtc_set_clock: FAILED");
+		Serial.println("too large drift was used: " + String(get_clock_drift()) + " ppm\e[0;37m");
+		rtc_clear();
+		clean_LittleFS();
+		return(false);
+	}
+
+	// test if a time from the user is not used to measure the drift
+	rtc_set_clock(get_rtc_clock() + 60, 0, 0, false);
+	state = get_rtc_state();
+	if ((state.flags & RTC_CLOCK_SYNCED) != 0 || get_clock_drift() != expected) {
+		Serial.println("\e[0;31mtest_rtc_set_clock: FAILED");
+		Serial.println("time from the user was used as NTP time\e[0;37m");
+		rtc_clear();
+		clean_LittleFS();
+		return(false);
+	}
+
+	Serial.println("\e[0;32mtest_rtc_set_clock: PASSED\e[0;37m");
+	rtc_clear();
+	clean_LittleFS();
+	return(true);
+}
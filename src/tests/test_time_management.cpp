@@ -51,7 +51,7 @@ boolean test_weekday_to_num() {
  * 
  * @return boolean - true if the test passed, false if the test failed
  * 
- * @details - Setup: Clean LittleFS and initialize time.json with test data
+ * @details - Setup: Clean LittleFS and the RTC state and save test data as time
  * -# checks with loop if true is returned when times match
  * -# checks if false is returned when times do not match
  * 
@@ -59,8 +59,9 @@ boolean test_weekday_to_num() {
  */
 boolean test_compare_time() {
 
-	// clean LittleFS
+	// clean LittleFS and the RTC state (the time is taken from the saved time)
 	clean_LittleFS();
+	rtc_clear();
 
 	// test data
 	String time1 = "00:00:02 0";
@@ -75,12 +76,8 @@ boolean test_compare_time() {
 	doc["last_offset"] = millis();
 	doc.shrinkToFit();
 
-	// serialize json to time.json
-	LittleFS.begin();
-	File file1 = LittleFS.open("/time.json", "w");
-	serializeJson(doc, file1);
-	file1.close();
-	LittleFS.end();
+	// save json as time
+	kv_save_json("time", doc);
 
 	// test in loop that waits 3 seconds if value of function changes to true
 	unsigned long start_time = millis();
@@ -90,6 +87,7 @@ boolean test_compare_time() {
 			checker = true;
 			break;
 		}
+		delay(100);
 	}
 
 	if (checker == false) {
@@ -124,7 +122,7 @@ boolean test_compare_time() {
  * 
  * @return boolean - true if the test passed, false if the test failed
  * 
- * @details - Setup: Clean LittleFS and initialize time.json with test data
+ * @details - Setup: Clean LittleFS and save test data as time
  * -# checks if the time is updated correctly in Station mode
  * -# checks if the time is updated correctly in AP mode
  * 
@@ -148,23 +146,15 @@ boolean test_update_time() {
 
 	String time = "3 19:13:30 -60";
 
-	// serialize json to time.json
-	LittleFS.begin();
-	File file1 = LittleFS.open("/time.json", "w");
-	serializeJson(write_doc, file1);
-	file1.close();
-	LittleFS.end();
+	// save json as time
+	kv_save_json("time", write_doc);
 
 	// test if the time is updated correctly in Station mode
 	update_time(time, false);
 	
-	// read time.json
-	LittleFS.begin();
-	File file2 = LittleFS.open("/time.json", "r");
+	// read saved time
 	DynamicJsonDocument read_doc1(512);
-	deserializeJson(read_doc1, file2);
-	file2.close();
-	LittleFS.end();
+	kv_load_json("time", read_doc1);
 
 	int hours1 = read_doc1["hours"];
 	int minutes1 = read_doc1["minutes"];
@@ -189,13 +179,9 @@ boolean test_update_time() {
 	update_time(time, true);
 	
 	
-	// read time.json
-	LittleFS.begin();
-	File file3 = LittleFS.open("/time.json", "r");
+	// read saved time
 	DynamicJsonDocument read_doc2(512);
-	deserializeJson(read_doc2, file3);
-	file3.close();
-	LittleFS.end();
+	kv_load_json("time", read_doc2);
 	
 
 	// check if all values were updated
@@ -228,15 +214,17 @@ boolean test_update_time() {
  * 
  * @return boolean - true if the test passed, false if the test failed
  * 
- * @details - Setup: Clean LittleFS and initialize time.json with test data
+ * @details - Setup: Clean LittleFS and the RTC state and save test data as time
  * -# checks twice if time is returned correctly
+ * -# checks if the time is taken from the clock of the RTC state once it is set
  * 
  * @see get_current_time
  */
 boolean test_get_current_time() {
 
-	// clean LittleFS
+	// clean LittleFS and the RTC state
 	clean_LittleFS();
+	rtc_clear();
 
 	// test data
 	DynamicJsonDocument doc(512);
@@ -249,12 +237,8 @@ boolean test_get_current_time() {
 	doc["last_offset"] = millis();
 	doc.shrinkToFit();
 
-	// serialize json to time.json
-	LittleFS.begin();
-	File file1 = LittleFS.open("/time.json", "w");
-	serializeJson(doc, file1);
-	file1.close();
-	LittleFS.end();
+	// save json as time
+	kv_save_json("time", doc);
 
 	delay(1000);
 
@@ -284,6 +268,21 @@ boolean test_get_current_time() {
 		return(false);
 	}
 
+	// test if the time is taken from the clock of the RTC state once it is set
+	rtc_set_clock(2 * 86400 + 13 * 3600 + 5 * 60 + 7, 0, 0, false);
+	String output3 = get_current_time();
+
+	if (output3 != "13:05:07 2") {
+		Serial.println("\e[0;31mtest_get_current_time: FAILED");
+		Serial.println("time was not taken from the RTC state");
+		Serial.println("expected: 13:05:07 2");
+		Serial.println("actual: " + output3 + "\e[0;37m");
+		rtc_clear();
+		clean_LittleFS();
+		return(false);
+	}
+	rtc_clear();
+
 	// print success message and return true
 	Serial.println("\e[0;32mtest_get_current_time: PASSED\e[0;37m");
 	clean_LittleFS();
@@ -377,7 +376,7 @@ boolean test_add_time() {
  * 
  * @return boolean - true if the test passed, false if the test failed
  * 
- * @details - Setup: -
+ * @details - Setup: clear the RTC user memory (a restored time is kept without NTP)
  * -# checks if the document is empty (since Wifi is not available)
  * -# functionality is tested empirically
  * 
@@ -385,9 +384,11 @@ boolean test_add_time() {
  */
 boolean test_init_time() {
 
+	rtc_clear();
 	init_time();
 
-	DynamicJsonDocument doc = load_json("/time.json");
+	json_document doc(JSON_TIME_CAPACITY);
+	kv_load_json("time", doc);
 
 	int hours = doc["hours"];
 	int minutes = doc["minutes"];
@@ -421,8 +422,9 @@ boolean test_init_time() {
  * 
  * @return boolean - true if the test passed, false if the test failed
  * 
- * @details - Setup: clean LittleFS and initialize time.json with test data
- * -# check if the offset is updated correctly
+ * @details - Setup: clean LittleFS and save test data as time
+ * -# check if the offset is not written again before TIME_OFFSET_STEP passed
+ * -# check if the offset is updated correctly afterwards
  * 
  * @see check_and_update_offset
  */
@@ -431,7 +433,6 @@ boolean test_check_and_update_offset() {
 	// clean LittleFS
 	clean_LittleFS();
 
-	// initialize time.json
 	// test data
 	DynamicJsonDocument write_doc(512);
 	write_doc["hours"] = 0;
@@ -439,27 +440,31 @@ boolean test_check_and_update_offset() {
 	write_doc["seconds"] = 0;
 	write_doc["weekday"] = 0;
 	write_doc["timezone"] = 0;
-	write_doc["init_offset"] = 0;
-	write_doc["last_offset"] = 0;
+	write_doc["init_offset"] = millis();
+	write_doc["last_offset"] = millis();
 	write_doc.shrinkToFit();
 
-	// serialize json to time.json
-	LittleFS.begin();
-	File file1 = LittleFS.open("/time.json", "w");
-	serializeJson(write_doc, file1);
-	file1.close();
-	LittleFS.end();
+	// save json as time
+	kv_save_json("time", write_doc);
 
-	// execute function
+	// check if the offset is not written again before TIME_OFFSET_STEP passed
+	uint32_t appends = get_kv_stats().appends;
+	delay(1000);
+	check_and_update_offset();
+	if (get_kv_stats().appends != appends) {
+		Serial.println("\e[0;31mtest_check_and_update_offset: FAILED");
+		Serial.println("offset was written before TIME_OFFSET_STEP passed\e[0;37m");
+		clean_LittleFS();
+		return(false);
+	}
+
+	// execute function after TIME_OFFSET_STEP
+	delay(TIME_OFFSET_STEP);
 	check_and_update_offset();
 
-	// read time.json
-	LittleFS.begin();
-	File file2 = LittleFS.open("/time.json", "r");
+	// read saved time
 	DynamicJsonDocument read_doc(512);
-	deserializeJson(read_doc, file2);
-	file2.close();
-	LittleFS.end();
+	kv_load_json("time", read_doc);
 
 	// check if the offset is updated correctly (by comparing the last_offset with the current time)
 	unsigned long last_offset = read_doc["last_offset"];
@@ -476,3 +481,57 @@ boolean test_check_and_update_offset() {
 	clean_LittleFS();
 	return(true);
 }
+
+/**
+ * @brief Unit test for the function "read_ntp_time"
+ * 
+ * @return boolean - true if the test passed, false if the test failed
+ * 
+ * @details - Setup: NTP answer of Tuesday 2023-11-14 22:13:20.5 UTC
+ * -# check if the time and its milliseconds are read in the timezone
+ * -# check if the weekday changes with the timezone
+ * -# check if a packet that is not an answer of a server is rejected
+ * 
+ * @see read_ntp_time
+ */
+boolean test_read_ntp_time() {
+
+	// NTP answer (mode 4, stratum 2) with the transmit timestamp 3908988800.5
+	uint8_t packet[NTP_PACKET_LENGTH] = {0x24, 2};
+	uint32_t seconds = 3908988800UL;
+	for (int i = 0; i < 4; i++) {
+		packet[40 + i] = seconds >> (24 - 8 * i);
+	}
+	packet[44] = 0x80;
+
+	uint32_t clock = 0;
+	uint16_t clock_ms = 0;
+
+	// check if the time and its milliseconds are read in the timezone (23:13:20 2)
+	if (read_ntp_time(packet, NTP_PACKET_LENGTH, 3600, clock, clock_ms) == false || clock != 2 * 86400 + 83600 || clock_ms != 500) {
+		Serial.println("\e[0;31mtest_read_ntp_time: FAILED");
+		Serial.println("expected: " + String(2 * 86400 + 83600) + " s 500 ms");
+		Serial.println("actual: " + String(clock) + " s " + String(clock_ms) + " ms\e[0;37m");
+		return(false);
+	}
+
+	// check if the weekday changes with the timezone (00:13:20 3)
+	if (read_ntp_time(packet, NTP_PACKET_LENGTH, 7200, clock, clock_ms) == false || clock != 3 * 86400 + 800) {
+		Serial.println("\e[0;31mtest_read_ntp_time: FAILED");
+		Serial.println("expected: " + String(3 * 86400 + 800) + " s");
+		Serial.println("actual: " + String(clock) + " s\e[0;37m");
+		return(false);
+	}
+
+	// check if a packet that is not an answer of a server is rejected
+	packet[0] = 0xE3;
+	if (read_ntp_time(packet, NTP_PACKET_LENGTH, 0, clock, clock_ms) == true) {
+		Serial.println("\e[0;31mtest_read_ntp_time: FAILED");
+		Serial.println("request was read as answer\e[0;37m");
+		return(false);
+	}
+
+	// print success message and return true
+	Serial.println("\e[0;32mtest_read_ntp_time: PASSED\e[0;37m");
+	return(true);
+}
@@ -0,0 +1,70 @@
+/**
+ * @file test_tokenizer.cpp
+ * @author Marc Ubbelohde
+ * @brief This file contains unit tests for all functions from the tokenizer.cpp.
+ *
+ */
+
+
+#include "tests.h"
+
+/**
+ * @brief Unit test for the function "tokenize_program_line"
+ *
+ * @return boolean - true if the test passed, false if the test failed
+ *
+ * @details - Setup: -
+ * -# checks if every command is recognized and its tokens are read
+ * -# checks if invalid lines are rejected with the correct column and error
+ *
+ * @see tokenize_program_line
+ */
+boolean test_tokenize_program_line() {
+
+	program_line tokens;
+
+	// valid lines
+	const char *play = "play test _-signal";
+	boolean check = tokenize_program_line(play, strlen(play), tokens) && tokens.command == PROGRAM_PLAY
+		&& tokens.name_start == 5 && tokens.name_length == 13;
+
+	check = check && tokenize_program_line("wait 100 ", 9, tokens) && tokens.command == PROGRAM_WAIT && tokens.number == 100;
+	check = check && tokenize_program_line("skip 3", 6, tokens) && tokens.command == PROGRAM_SKIP && tokens.number == 3;
+	check = check && tokenize_program_line("loop 12", 7, tokens) && tokens.command == PROGRAM_LOOP && tokens.number == 12 && tokens.infinite == false;
+	check = check && tokenize_program_line("loop inf", 8, tokens) && tokens.command == PROGRAM_LOOP && tokens.infinite == true;
+	check = check && tokenize_program_line("  ", 2, tokens) && tokens.command == PROGRAM_EMPTY;
+	check = check && tokenize_program_line("", 0, tokens) && tokens.command == PROGRAM_EMPTY;
+
+	const char *time = "23:05:59 lamp";
+	check = check && tokenize_program_line(time, strlen(time), tokens) && tokens.command == PROGRAM_TIME
+		&& tokens.hour == 23 && tokens.minute == 5 && tokens.second == 59 && tokens.name_start == 9;
+
+	const char *day = "Sunday 07:00:00 coffee";
+	check = check && tokenize_program_line(day, strlen(day), tokens) && tokens.command == PROGRAM_DAY
+		&& tokens.weekday == 0 && tokens.hour == 7 && tokens.name_start == 16 && tokens.name_length == 6;
+
+	if (check == false) {
+		Serial.println("\e[0;31mtest_tokenize_program_line: FAILED");
+		Serial.println("valid line was not tokenized correctly\e[0;37m");
+		return(false);
+	}
+
+	// invalid lines with expected column and error
+	const char *lines[] = {"blah blah", "wait abc", "wait 99999999999999999999", "play ", "play a.b", "24:00:00 x", "12:3:00 x", "Mondays 10:00:00 x", "loop 3x", " play x"};
+	size_t columns[] = {1, 6, 6, 6, 7, 1, 4, 1, 7, 1};
+	const char *errors[] = {"unknown command", "expected a number", "number is too large", "expected a signal name", "invalid character in signal name",
+		"time is out of range", "expected a time in the format hh:mm:ss", "unknown command", "unexpected character after the command", "unknown command"};
+
+	for (int i = 0; i < 10; i++) {
+		boolean valid = tokenize_program_line(lines[i], strlen(lines[i]), tokens);
+		if (valid == true || tokens.command != PROGRAM_INVALID || tokens.error_column != columns[i] || strcmp(tokens.error, errors[i]) != 0) {
+			Serial.println("\e[0;31mtest_tokenize_program_line: FAILED");
+			Serial.println("line: " + String(lines[i]) + " , expected column: " + String(columns[i]) + " , actual column: " + String(tokens.error_column) + "\e[0;37m");
+			return(false);
+		}
+	}
+
+	// prints success message and returns true
+	Serial.println("\e[0;32mtest_tokenize_program_line: PASSED\e[0;37m");
+	return(true);
+}
@@ -0,0 +1,117 @@
+/**
+ * @file test_trace.cpp
+ * @author Marc Ubbelohde
+ * @brief This file contains unit tests for all functions from the trace.cpp.
+ *
+ * @details The tests are only compiled if TRACE_ENABLED is set.
+ *
+ */
+
+
+#include "tests.h"
+
+#if TRACE_ENABLED
+
+/**
+ * @brief Unit test for the macro "TRACE_SPAN"
+ *
+ * @return boolean - true if the test passed, false if the test failed
+ *
+ * @details - Setup: Reset trace
+ * -# checks if nested spans are written in the order they end
+ * -# checks if the outer span lasts at least as long as the inner span
+ * -# checks if the number of events stops at TRACE_EVENT_COUNT when the ring buffer wraps
+ *
+ * @see trace_span
+ */
+boolean test_trace_span() {
+
+	// Reset trace
+	reset_trace();
+
+	{
+		TRACE_SPAN("outer");
+		{
+			TRACE_SPAN("inner");
+			delayMicroseconds(10);
+		}
+	}
+
+	trace_event inner = get_trace_event(1);
+	trace_event outer = get_trace_event(0);
+	if (get_trace_event_count() != 2 || String(inner.name) != "inner" || String(outer.name) != "outer" || outer.cycles < inner.cycles || outer.start_us > inner.start_us) {
+		Serial.println("\e[0;31mtest_trace_span: FAILED");
+		Serial.println("expected events: inner, outer , actual count: " + String(get_trace_event_count()) + "\e[0;37m");
+		reset_trace();
+		return(false);
+	}
+
+	for (int i = 0; i < TRACE_EVENT_COUNT + 3; i++) {
+		TRACE_SPAN("loop");
+	}
+	if (get_trace_event_count() != TRACE_EVENT_COUNT || get_trace_event(TRACE_EVENT_COUNT).name != NULL || String(get_trace_event(TRACE_EVENT_COUNT - 1).name) != "loop") {
+		Serial.println("\e[0;31mtest_trace_span: FAILED");
+		Serial.println("expected count: " + String(TRACE_EVENT_COUNT) + " , actual count: " + String(get_trace_event_count()) + "\e[0;37m");
+		reset_trace();
+		return(false);
+	}
+
+	// prints success message and returns true
+	Serial.println("\e[0;32mtest_trace_span: PASSED\e[0;37m");
+	reset_trace();
+	return(true);
+}
+
+/**
+ * @brief Unit test for the function "print_trace_json"
+ *
+ * @return boolean - true if the test passed, false if the test failed
+ *
+ * @details - Setup: Reset trace, record two spans
+ * -# checks if the output is valid JSON in the Chrome trace-event format
+ * -# checks if the events are sorted from oldest to newest
+ * -# checks if the returned length matches the output
+ * -# checks if the longest span from the cycle counter ends before its overflow at 80 and 160 MHz
+ *
+ * @see print_trace_json
+ * @see trace_max_cycle_span
+ */
+boolean test_print_trace_json() {
+
+	// Reset trace
+	reset_trace();
+	{
+		TRACE_SPAN("first");
+	}
+	{
+		TRACE_SPAN("second");
+	}
+
+	StreamString content;
+	size_t written = print_trace_json(content);
+
+	DynamicJsonDocument doc(1024);
+	DeserializationError error = deserializeJson(doc, content.c_str());
+
+	if (error || written != content.length() || doc["traceEvents"].size() != 2 || doc["traceEvents"][0]["name"] != "first" || doc["traceEvents"][1]["name"] != "second" || doc["traceEvents"][0]["ph"] != "X") {
+		Serial.println("\e[0;31mtest_print_trace_json: FAILED");
+		Serial.println("output: " + content + " , written: " + String(written) + "\e[0;37m");
+		reset_trace();
+		return(false);
+	}
+
+	// test if the longest span from the cycle counter ends before its overflow (53 s at 80 MHz, 26 s at 160 MHz)
+	if (trace_max_cycle_span(80) >= 53687091 || trace_max_cycle_span(160) >= 26843545 || trace_max_cycle_span(160) < 20000000) {
+		Serial.println("\e[0;31mtest_print_trace_json: FAILED");
+		Serial.println("longest span at 80 MHz: " + String(trace_max_cycle_span(80)) + " us, at 160 MHz: " + String(trace_max_cycle_span(160)) + " us\e[0;37m");
+		reset_trace();
+		return(false);
+	}
+
+	// prints success message and returns true
+	Serial.println("\e[0;32mtest_print_trace_json: PASSED\e[0;37m");
+	reset_trace();
+	return(true);
+}
+
+#endif  // TRACE_ENABLED
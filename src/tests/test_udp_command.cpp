@@ -0,0 +1,165 @@
+/**
+ * @file test_udp_command.cpp
+ * @author Marc Ubbelohde
+ * @brief This file contains unit tests for all functions from the udp_command.cpp.
+ *
+ */
+
+
+#include "tests.h"
+
+/**
+ * @brief Converts bytes to lower case hex (for comparing digests).
+ *
+ */
+String bytes_to_hex(const uint8_t *data, size_t length) {
+	const char digits[] = "0123456789abcdef";
+	String hex = "";
+	for (size_t i = 0; i < length; i++) {
+		hex += digits[data[i] >> 4];
+		hex += digits[data[i] & 0x0f];
+	}
+	return hex;
+}
+
+/**
+ * @brief Unit test for the function "hmac_sha256"
+ *
+ * @return boolean - true if the test passed, false if the test failed
+ *
+ * @details - Setup: -
+ * -# checks test case 2 of RFC 4231 (short key)
+ * -# checks test case 6 of RFC 4231 (key longer than a block)
+ *
+ * @see hmac_sha256
+ */
+boolean test_hmac_sha256() {
+	uint8_t digest[32];
+
+	// test case 2 of RFC 4231 (short key)
+	const char *data1 = "what do ya want for nothing?";
+	hmac_sha256((const uint8_t *)"Jefe", 4, (const uint8_t *)data1, strlen(data1), digest);
+	String expected1 = "5bdcc146bf60754e6a042426089575c75a003f089d2739839dec58b964ec3843";
+	if (bytes_to_hex(digest, 32) != expected1) {
+		Serial.println("\e[0;31mtest_hmac_sha256: FAILED");
+		Serial.println("expected: " + expected1);
+		Serial.println("actual: " + bytes_to_hex(digest, 32) + "\e[0;37m");
+		return(false);
+	}
+
+	// test case 6 of RFC 4231 (key longer than a block)
+	uint8_t key[131];
+	memset(key, 0xaa, sizeof(key));
+	const char *data2 = "Test Using Larger Than Block-Size Key - Hash Key First";
+	hmac_sha256(key, sizeof(key), (const uint8_t *)data2, strlen(data2), digest);
+	String expected2 = "60e431591ee0b67f0d8a26aacbf5b77f8e0bc6213728c5140546040f0ee37f54";
+	if (bytes_to_hex(digest, 32) != expected2) {
+		Serial.println("\e[0;31mtest_hmac_sha256: FAILED");
+		Serial.println("expected: " + expected2);
+		Serial.println("actual: " + bytes_to_hex(digest, 32) + "\e[0;37m");
+		return(false);
+	}
+
+	Serial.println("\e[0;32mtest_hmac_sha256: PASSED\e[0;37m");
+	return(true);
+}
+
+/**
+ * @brief Unit test for the function "parse_udp_command"
+ *
+ * @return boolean - true if the test passed, false if the test failed
+ *
+ * @details - Setup: a command is built with build_udp_command()
+ * -# checks if an authenticated command is read back
+ * -# checks if a wrong or missing tag is rejected when a key is set
+ * -# checks if broken packets and acknowledgements are rejected
+ *
+ * @see parse_udp_command
+ */
+boolean test_parse_udp_command() {
+	const uint8_t *key = (const uint8_t *)"secret";
+	const char *name = "tv on";
+	udp_command command = {0, 42, UDP_SEND_SIGNAL, (uint8_t)strlen(name), (const uint8_t *)name};
+	uint8_t packet[UDP_MAX_PACKET];
+	size_t size = build_udp_command(command, key, 6, packet);
+
+	// test if an authenticated command is read back
+	udp_command result;
+	if (size != UDP_HEADER_LENGTH + strlen(name) + UDP_TAG_LENGTH || parse_udp_command(packet, size, key, 6, result) != UDP_OK ||
+			result.sequence != 42 || result.type != UDP_SEND_SIGNAL || result.length != strlen(name) || memcmp(result.payload, name, result.length) != 0) {
+		Serial.println("\e[0;31mtest_parse_udp_command: FAILED");
+		Serial.println("authenticated command was not read back\e[0;37m");
+		return(false);
+	}
+
+	// test if a wrong or missing tag is rejected when a key is set
+	boolean wrong_key = parse_udp_command(packet, size, (const uint8_t *)"Secret", 6, result) != UDP_UNAUTHORIZED;
+	packet[UDP_HEADER_LENGTH] ^= 1;
+	boolean changed = parse_udp_command(packet, size, key, 6, result) != UDP_UNAUTHORIZED;
+	size_t plain_size = build_udp_command(command, NULL, 0, packet);
+	boolean missing = parse_udp_command(packet, plain_size, key, 6, result) != UDP_UNAUTHORIZED;
+	boolean no_key = parse_udp_command(packet, plain_size, NULL, 0, result) != UDP_OK;
+	if (wrong_key || changed || missing || no_key) {
+		Serial.println("\e[0;31mtest_parse_udp_command: FAILED");
+		Serial.println("tag was not checked correctly\e[0;37m");
+		return(false);
+	}
+
+	// test if broken packets and acknowledgements are rejected
+	boolean short_packet = parse_udp_command(packet, UDP_HEADER_LENGTH - 1, NULL, 0, result) != UDP_BAD_PACKET;
+	boolean wrong_length = parse_udp_command(packet, plain_size - 1, NULL, 0, result) != UDP_BAD_PACKET;
+	uint8_t ack[UDP_MAX_PACKET];
+	size_t ack_size = build_udp_ack(command, UDP_OK, NULL, ack);
+	boolean acknowledgement = parse_udp_command(ack, ack_size, NULL, 0, result) != UDP_BAD_PACKET;
+	packet[0] = 'X';
+	boolean magic = parse_udp_command(packet, plain_size, NULL, 0, result) != UDP_BAD_PACKET;
+	if (short_packet || wrong_length || acknowledgement || magic) {
+		Serial.println("\e[0;31mtest_parse_udp_command: FAILED");
+		Serial.println("broken packet was accepted\e[0;37m");
+		return(false);
+	}
+
+	Serial.println("\e[0;32mtest_parse_udp_command: PASSED\e[0;37m");
+	return(true);
+}
+
+/**
+ * @brief Unit test for the function "build_udp_ack"
+ *
+ * @return boolean - true if the test passed, false if the test failed
+ *
+ * @details - Setup: -
+ * -# checks if sequence number, command, status and message are written
+ * -# checks if a long message is cut
+ *
+ * @see build_udp_ack
+ */
+boolean test_build_udp_ack() {
+	udp_command command = {0, 0x01020304, UDP_PLAY_PROGRAM, 0, NULL};
+	uint8_t ack[UDP_MAX_PACKET];
+
+	// test if sequence number, command, status and message are written
+	size_t size = build_udp_ack(command, UDP_BUSY, "busy", ack);
+	const uint8_t expected[] = {'I', 'R', UDP_COMMAND_VERSION, UDP_FLAG_ACK, 1, 2, 3, 4, UDP_PLAY_PROGRAM, UDP_BUSY, 'b', 'u', 's', 'y'};
+	if (size != sizeof(expected) || memcmp(ack, expected, size) != 0) {
+		Serial.println("\e[0;31mtest_build_udp_ack: FAILED");
+		Serial.println("expected: " + bytes_to_hex(expected, sizeof(expected)));
+		Serial.println("actual: " + bytes_to_hex(ack, size) + "\e[0;37m");
+		return(false);
+	}
+
+	// test if a long message is cut
+	String message = "";
+	for (size_t i = 0; i < UDP_MAX_PACKET; i++) {
+		message += "x";
+	}
+	size = build_udp_ack(command, UDP_FAILED, message.c_str(), ack);
+	if (size != UDP_HEADER_LENGTH + UDP_MAX_PAYLOAD) {
+		Serial.println("\e[0;31mtest_build_udp_ack: FAILED");
+		Serial.println("long message was not cut\e[0;37m");
+		return(false);
+	}
+
+	Serial.println("\e[0;32mtest_build_udp_ack: PASSED\e[0;37m");
+	return(true);
+}
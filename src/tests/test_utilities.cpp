@@ -8,9 +8,9 @@
 #include "tests.h"
 
 /**
- * @brief Deletes all files in "/", "/signals" and "/programs" in the LittleFS
+ * @brief Deletes all files in "/", "/signals" and "/programs" in the LittleFS and the key-value store
  * 
- * @callgraph This function does not call any other function.
+ * @callgraph
  * 
  * @callergraph
  */
@@ -30,4 +30,7 @@ void clean_LittleFS() {
     LittleFS.remove("/signals/" + dir.fileName());
   }
   LittleFS.end();
+
+  // the index of the store would still point into the deleted journal
+  kv_reset();
 }
\ No newline at end of file
@@ -13,9 +13,9 @@
  * @return boolean - true if the test passed, false if the test failed
  * 
  * @details - Setup: clean LittleFS and create test signal file
- * -# check if function returns correct error message when file does not exist
+ * -# check if function returns correct error message and status when file does not exist
  * -# check if no other file is deleted
- * -# check if file is deleted correctly
+ * -# check if file is deleted correctly (with status ACTION_OK)
  * -# check again if no other file is deleted
  * 
  * @see deleting_workflow
@@ -46,10 +46,11 @@ boolean test_deleting_workflow() {
 	String name2 = "test_program1";
 
 	String output1;
+	action_status status = ACTION_OK;
 
 	// tests if error message is correct when file does not exist
-	output1 = deleting_workflow(test_directory, name_fake);
-	if (output1 != "could not find " + test_directory + ": " + name_fake) {
+	output1 = deleting_workflow(test_directory, name_fake, status);
+	if (output1 != "could not find " + test_directory + ": " + name_fake || status != ACTION_NOT_FOUND) {
 		Serial.println("\e[0;31mtest_deleting_workflow: FAILED");
 		Serial.println("function did not return correct error message when file does not exist");
 		Serial.println("expected: could not find " + test_directory + ": " + name_fake);
@@ -72,8 +73,8 @@ boolean test_deleting_workflow() {
 	LittleFS.end();
 
 	// tests if file is deleted correctly
-	String output2 = deleting_workflow(test_directory, name);
-	if (output2 != "successfully deleted " + test_directory + ": " + name) {
+	String output2 = deleting_workflow(test_directory, name, status);
+	if (output2 != "successfully deleted " + test_directory + ": " + name || status != ACTION_OK) {
 		Serial.println("\e[0;31mtest_deleting_workflow: FAILED");
 		Serial.println("function did not return correct message when file was deleted");
 		Serial.println("expected: successfully deleted " + test_directory + ": " + name);
@@ -121,6 +122,7 @@ boolean test_deleting_workflow() {
  * @details - Setup: clean LittleFS
  * -# check if error message is correct when nothing was recorded
  * -# check if no file is written when nothing was recorded
+ * -# check if nothing is recorded while a learning session runs
  * 
  * @see recording_workflow
  */
@@ -154,6 +156,26 @@ boolean test_recording_workflow() {
 		clean_LittleFS();
 		return(false);
 	}
+	LittleFS.end();
+
+	// tests if nothing is recorded while a learning session runs (both would use the receiver)
+	start_learning("on,off");
+	learning_session session = get_learning_session();
+	action_status status = ACTION_OK;
+	unsigned long start_time = millis();
+	String output2 = recording_workflow(test_name1, status);
+	unsigned long elapsed_time = millis() - start_time;
+	job_cancel(session.job_id);
+	update_learning();
+	if (session.active == false || status != ACTION_BUSY || output2 != "Error: job " + String(session.job_id) + " is still running" || elapsed_time > 1000) {
+		Serial.println("\e[0;31mtest_recording_workflow: FAILED");
+		Serial.println("function recorded while a learning session was running");
+		Serial.println("expected: Error: job " + String(session.job_id) + " is still running");
+		Serial.println("actual: " + output2 + " after " + String(elapsed_time) + " ms\e[0;37m");
+		clean_LittleFS();
+		return(false);
+	}
+	LittleFS.begin();
 
 	// print success message and return true
 	Serial.println("\e[0;32mtest_recording_workflow: PASSED\e[0;37m");
@@ -367,6 +389,82 @@ boolean test_playing_workflow() {
 	return(true);
 }
 
+/**
+ * @brief Unit test for the function "playing_workflow" with a line to continue at
+ * 
+ * @return boolean - true if the test passed, false if the test failed
+ * 
+ * @details - Setup: clean LittleFS and save a program with missing signals before and in a loop
+ * -# check if the program fails when it starts at the beginning
+ * -# check if the lines and the loop before the line to continue at are skipped
+ * -# check if a loop that contains the line to continue at is entered
+ * 
+ * @see playing_workflow
+ */
+boolean test_playing_workflow_resume() {
+
+	// clean LittleFS
+	clean_LittleFS();
+
+	// program (line 1: missing signal, lines 2-4: loop with missing signal, line 5: wait)
+	LittleFS.begin();
+	File file = LittleFS.open("/programs/test_program.txt", "w");
+	file.println("play abc");
+	file.println("loop 2");
+	file.println("wait 10");
+	file.println("end");
+	file.println("wait 10");
+	file.close();
+
+	// program (line 1: missing signal, lines 2-4: loop with a wait)
+	file = LittleFS.open("/programs/test_program2.txt", "w");
+	file.println("play abc");
+	file.println("loop 2");
+	file.println("wait 10");
+	file.println("end");
+	file.close();
+	LittleFS.end();
+
+	// tests if the program fails when it starts at the beginning
+	String output1 = playing_workflow("test_program", 0);
+
+	if (output1 != "could not find signal: abc") {
+		Serial.println("\e[0;31mtest_playing_workflow_resume: FAILED");
+		Serial.println("expected: could not find signal: abc");
+		Serial.println("actual: " + output1 + "\e[0;37m");
+		clean_LittleFS();
+		return(false);
+	}
+
+	// tests if the lines and the loop before the line to continue at are skipped
+	String output2 = playing_workflow("test_program", 5);
+
+	if (output2 != "successfully played program: test_program") {
+		Serial.println("\e[0;31mtest_playing_workflow_resume: FAILED");
+		Serial.println("expected: successfully played program: test_program");
+		Serial.println("actual: " + output2 + "\e[0;37m");
+		clean_LittleFS();
+		return(false);
+	}
+
+	// tests if a loop that contains the line to continue at is entered
+	unsigned long start = millis();
+	String output3 = playing_workflow("test_program2", 3);
+
+	if (output3 != "successfully played program: test_program2" || millis() - start < 20) {
+		Serial.println("\e[0;31mtest_playing_workflow_resume: FAILED");
+		Serial.println("expected: successfully played program: test_program2 (after 20 ms)");
+		Serial.println("actual: " + output3 + " (after " + String(millis() - start) + " ms)\e[0;37m");
+		clean_LittleFS();
+		return(false);
+	}
+
+	// print success message and return true
+	Serial.println("\e[0;32mtest_playing_workflow_resume: PASSED\e[0;37m");
+	clean_LittleFS();
+	return(true);
+}
+
 /**
  * @brief Unit test for the function "program_parser"
  * 
@@ -423,10 +521,10 @@ boolean test_program_parser() {
 	// tests if error message is correct when program is faulty
 	String output2 = program_parser(code2);
 
-	if (output2 != "invalid command: blah blah") {
+	if (output2 != "invalid command: blah blah (column 1: unknown command)") {
 		Serial.println("\e[0;31mtest_program_parser: FAILED");
 		Serial.println("function did not return correct error message when program 2 is faulty");
-		Serial.println("expected: could not find command: blah");
+		Serial.println("expected: invalid command: blah blah (column 1: unknown command)");
 		Serial.println("actual: " + output2 + "\e[0;37m");
 		clean_LittleFS();
 		return(false);
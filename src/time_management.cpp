@@ -5,13 +5,32 @@
  * 
  * @details The time functions are exlusively used in the timed programs. The complexity of some of the functions
  * is due to the fact that the device does not use an external RTC and that the millis() function overflows after about 49 days.
- * The different functions utilize functions from the filesystem.cpp file to load and save time information to the LittleFS.
+ * The time information is kept under the key "time" of the key-value store (kv_store.cpp) in the LittleFS,
+ * the clock is also checkpointed in the RTC user memory (rtc_state.cpp) to be continued after a reset.
  * They provide functionality to each other and the higher level functions in workflows.cpp and main.cpp where fronend functionalities
  * are implemented.
  */
 
 #include "base.h"
 
+/**
+ * @brief Socket of the NTP requests in the background (see update_ntp_sync()).
+ * 
+ */
+WiFiUDP NTP_UDP;
+
+/**
+ * @brief millis() of the last NTP request or sync in the background and the time (ms) until the next one.
+ * 
+ */
+unsigned long NTP_LAST_REQUEST = 0;
+unsigned long NTP_SYNC_DELAY = NTP_SYNC_INTERVAL;
+
+/**
+ * @brief True while a NTP request waits for its answer.
+ * 
+ */
+boolean NTP_WAITING = false;
 
 
 /**
@@ -74,17 +93,14 @@ String weekday_to_num (String weekday){
  * @return boolean - true if time is equal to current time, false if not
  * 
  * @details This elementary function checks if the current time is equal to the time in the program.
- * It is used in timed programs and handles millis() overflow. The function has a delay of 500ms
- * to reduce the number of operations inside the while(true) loop.
+ * It is used in timed programs and handles millis() overflow. The function does not wait, the caller
+ * sleeps between the calls (job_sleep()).
  * 
  * @callgraph
  * 
  * @callergraph
  */
 boolean compare_time (String time, boolean weekday_included) {
-  
-  // delay to reduce the number of operations inside the while(true) loop
-  delay(500);
 
   // check for millis() overflow
   check_and_update_offset();
@@ -127,12 +143,13 @@ void update_time(String time, boolean AP_mode){
   timezone = timezone * (-60);
 
   // load time from LittleFS
-  DynamicJsonDocument time_json = load_json("/time.json");
+  json_document time_json(JSON_TIME_CAPACITY);
+  kv_load_json("time", time_json);
 
   // update only timezon when not in AP mode
   if(AP_mode == false) {
     time_json["timezone"] = timezone;
-    time_json.shrinkToFit();
+    rtc_set_timezone(timezone);
   }
 
   else {
@@ -144,31 +161,55 @@ void update_time(String time, boolean AP_mode){
     time_json["timezone"] = timezone;
     time_json["init_offset"] = millis();
     time_json["last_offset"] = millis();
-    time_json.shrinkToFit();
+
+    // checkpoint the time in the RTC user memory
+    uint32_t clock = weekday * 86400 + time_json["hours"].as<uint32_t>() * 3600 + time_json["minutes"].as<uint32_t>() * 60 + time_json["seconds"].as<uint32_t>();
+    rtc_set_clock(clock, 0, timezone, false);
   }
   
 
   // save updated time to LittleFS
-  save_json("/time.json", time_json);
+  kv_save_json("time", time_json);
+
+  // let the clients of the event stream know the new time
+  publish_event(EVENT_CLOCK, PSTR("{\"time\":\"%s\"}"), get_current_time().c_str());
   return;
 }
 
 /**
- * @brief Loads the current time from LittleFS
+ * @brief Returns the current time
  * 
  * @return String  - current time in format "hh:mm:ss weekday"
  * 
- * @details This function loads the time from the LittleFS, adds the relative offset between the offset
- * of initialization and the current offset and returns the current time.
+ * @details The time is taken from the clock of the RTC state if it is valid. Otherwise this function
+ * loads the time from the LittleFS, adds the relative offset between the offset of initialization
+ * and the current offset and returns the current time.
  * 
  * @callgraph
  * 
  * @callergraph
  */
 String get_current_time(){
+  metrics_scope scope(METRICS_TIME);
+
+  // take the time from the clock of the RTC state if it was set
+  if (get_rtc_state().flags & RTC_CLOCK_VALID) {
+    uint32_t clock = get_rtc_clock();
+    String time = turn_seconds_in_time(clock % 86400);
+    time += " ";
+    time += clock / 86400;
+    return time;
+  }
 
-  // load time from LittleFS
-  DynamicJsonDocument time_json = load_json("/time.json");
+  // load only the fields that are needed from LittleFS
+  StaticJsonDocument<JSON_OBJECT_SIZE(5)> filter;
+  filter["hours"] = true;
+  filter["minutes"] = true;
+  filter["seconds"] = true;
+  filter["weekday"] = true;
+  filter["init_offset"] = true;
+  json_document time_json(JSON_TIME_CAPACITY);
+  kv_load_json("time", time_json, filter);
 
   // convert json to string
   String time =  time_json["hours"].as<String>();
@@ -182,8 +223,8 @@ String get_current_time(){
   // check initial offset
   unsigned long init_offset = time_json["init_offset"].as<unsigned long>();
 
-  // calculate effective offset in seconds (time since time initialization)
-  unsigned long effective_offset = millis() - init_offset;
+  // calculate effective offset in seconds (time since time initialization without the drift of millis())
+  unsigned long effective_offset = correct_clock_drift(millis() - init_offset);
   unsigned long effective_offset_seconds = effective_offset / 1000;
 
   // add offset to time
@@ -320,18 +361,36 @@ String add_time(String time, String offset_time){
  * @details This function initiates the time by getting the time from the NTP server. 
  * It then saves it ot the LittlfeFS. It also passes the saved timezone to the NTP server
  * or 0 if no timezone is saved.
+ * If the time was restored after a reset (restore_rtc_state()), the restored time is kept and the
+ * boot does not wait for the NTP server, the clock is corrected by the next NTP sync in the
+ * background (update_ntp_sync()) instead.
  * 
  * @callgraph
  * 
  * @callergraph
  */
 void init_time(){
+  metrics_scope scope(METRICS_TIME);
+
+  // the restored time is corrected by NTP in the background
+  if (get_rtc_state().flags & RTC_CLOCK_VALID) {
+    LOG_INFO("keeping restored time %s until the NTP sync", get_current_time().c_str());
+    NTP_LAST_REQUEST = millis();
+    NTP_SYNC_DELAY = 0;
+    return;
+  }
 
   // read timezone from LittleFS
-  DynamicJsonDocument saved_time = load_json("/time.json");
-  int timezone = saved_time["timezone"];
+  int timezone;
+  {
+    StaticJsonDocument<JSON_OBJECT_SIZE(1)> filter;
+    filter["timezone"] = true;
+    json_document saved_time(JSON_TIME_CAPACITY);
+    kv_load_json("time", saved_time, filter);
+    timezone = saved_time["timezone"];
+  }
 
-  Serial.println("Timezone: " + String(timezone));
+  LOG_INFO("Timezone: %d", timezone);
 
   // initialize NTP client
   WiFiUDP ntpUDP;
@@ -340,9 +399,11 @@ void init_time(){
 
   // try to retrieve time from NTP server for 5s
   unsigned long startTime = millis();
+  boolean synced = timeClient.update();
 
-  while (!timeClient.update() && (millis() - startTime) < 5000) {
+  while (synced == false && (millis() - startTime) < 5000) {
     delay(10);
+    synced = timeClient.update();
   }
 
   // get time and weekday
@@ -350,27 +411,179 @@ void init_time(){
   int weekday = timeClient.getDay();
   timeClient.end();
 
-  Serial.println("Time: " + time + " " + weekday);
-
-  // build json
-  DynamicJsonDocument time_json(1024);
+  LOG_INFO("Time: %s %d", time.c_str(), weekday);
 
   int hours = time.substring(0, time.indexOf(":")).toInt();
   int minutes = time.substring(time.indexOf(":") + 1, time.indexOf(":") + 3).toInt();
   int seconds = time.substring(time.indexOf(":") + 4, time.indexOf(":") + 6).toInt();
+  uint32_t clock = weekday * 86400 + hours * 3600 + minutes * 60 + seconds;
+
+  // the time from NTP corrects the clock in the RTC user memory (and measures its drift)
+  if (synced == true) {
+    rtc_set_clock(clock, 0, timezone, true);
+  }
+  save_clock(clock, timezone, millis());
+
+  // the next sync (or the next attempt) is done in the background
+  NTP_LAST_REQUEST = millis();
+  NTP_SYNC_DELAY = synced ? NTP_SYNC_INTERVAL : NTP_RETRY_INTERVAL;
+  return;
+}
+
+/**
+ * @brief Reads the time of a NTP answer
+ * 
+ * @param packet - NTP answer
+ * 
+ * @param size - length of the answer in bytes
+ * 
+ * @param timezone - timezone in seconds
+ * 
+ * @param clock - set to the local time as seconds since Sunday 00:00
+ * 
+ * @param clock_ms - set to the milliseconds of the current second
+ * 
+ * @return boolean - true if the answer contains a time
+ * 
+ * @details The transmit timestamp (bytes 40-47) is used, its fraction gives the milliseconds.
+ * 
+ * @callgraph This function does not call any other function.
+ * 
+ * @callergraph
+ */
+boolean read_ntp_time(const uint8_t *packet, size_t size, int32_t timezone, uint32_t &clock, uint16_t &clock_ms){
+  // answer of a server (mode 4) that is not a kiss-o'-death (stratum 0)
+  if (size < NTP_PACKET_LENGTH || (packet[0] & 0x07) != 4 || packet[1] == 0) {
+    return false;
+  }
+
+  uint32_t seconds = ((uint32_t)packet[40] << 24) | ((uint32_t)packet[41] << 16) | ((uint32_t)packet[42] << 8) | packet[43];
+  uint32_t fraction = ((uint32_t)packet[44] << 24) | ((uint32_t)packet[45] << 16) | ((uint32_t)packet[46] << 8) | packet[47];
+  if (seconds == 0) {
+    return false;
+  }
+
+  // seconds since 1970 (also after the NTP era ends in 2036) in the timezone
+  int64_t local = (int64_t)(uint32_t)(seconds - 2208988800UL) + timezone;
+  clock = (uint32_t)((((local / 86400) + 4) % 7) * 86400 + local % 86400);
+  clock_ms = ((uint64_t)fraction * 1000) >> 32;
+  return true;
+}
+
+/**
+ * @brief Corrects the clock with NTP in the background
+ * 
+ * @details Called from the background work. A request is sent NTP_SYNC_INTERVAL after the last
+ * sync (or NTP_RETRY_INTERVAL after a failed one) and its answer is read in later calls, so only
+ * the lookup of the server blocks. Half of the round trip is added to the time of the answer.
+ * The time corrects the clock in the RTC user memory, which measures its drift (rtc_set_clock()).
+ * 
+ * @callgraph
+ * 
+ * @callergraph
+ */
+void update_ntp_sync(){
+  if (NTP_WAITING == true) {
+    int size = NTP_UDP.parsePacket();
+    if (size >= (int)NTP_PACKET_LENGTH) {
+      uint8_t packet[NTP_PACKET_LENGTH];
+      NTP_UDP.read(packet, NTP_PACKET_LENGTH);
+      unsigned long round_trip = millis() - NTP_LAST_REQUEST;
+      NTP_UDP.stop();
+      NTP_WAITING = false;
+
+      int32_t timezone = get_rtc_state().timezone;
+      uint32_t clock;
+      uint16_t clock_ms;
+      if (round_trip < NTP_TIMEOUT && read_ntp_time(packet, NTP_PACKET_LENGTH, timezone, clock, clock_ms) == true) {
+        metrics_scope scope(METRICS_TIME);
+        rtc_set_clock(clock, clock_ms + round_trip / 2, timezone, true);
+        rtc_state state = get_rtc_state();
+        save_clock(state.clock, timezone, millis() - state.clock_ms);
+        NTP_LAST_REQUEST = millis();
+        NTP_SYNC_DELAY = NTP_SYNC_INTERVAL;
+        LOG_INFO("NTP sync: %s (round trip %lu ms)", get_current_time().c_str(), round_trip);
+        publish_event(EVENT_CLOCK, PSTR("{\"time\":\"%s\"}"), get_current_time().c_str());
+        return;
+      }
+    }
+    else if (size > 0) {
+      NTP_UDP.flush();
+    }
+
+    if (millis() - NTP_LAST_REQUEST >= NTP_TIMEOUT) {
+      LOG_WARN("NTP server not reached, next attempt in %lu s", NTP_RETRY_INTERVAL / 1000);
+      NTP_UDP.stop();
+      NTP_WAITING = false;
+      NTP_SYNC_DELAY = NTP_RETRY_INTERVAL;
+    }
+    return;
+  }
+
+  if (millis() - NTP_LAST_REQUEST < NTP_SYNC_DELAY || WiFi.status() != WL_CONNECTED) {
+    return;
+  }
+
+  // request of a client (version 4, mode 3)
+  uint8_t request[NTP_PACKET_LENGTH] = {0xE3, 0, 6, 0xEC};
+  NTP_UDP.begin(NTP_LOCAL_PORT);
+  NTP_LAST_REQUEST = millis();
+  if (NTP_UDP.beginPacket("pool.ntp.org", 123) == 0) {
+    NTP_UDP.stop();
+    NTP_SYNC_DELAY = NTP_RETRY_INTERVAL;
+    return;
+  }
+  NTP_UDP.write(request, NTP_PACKET_LENGTH);
+  NTP_UDP.endPacket();
+  NTP_LAST_REQUEST = millis();
+  NTP_WAITING = true;
+}
+
+/**
+ * @brief Saves the time to the LittleFS
+ * 
+ * @param clock - time as seconds since Sunday 00:00
+ * 
+ * @param timezone - timezone in seconds
+ * 
+ * @param offset - millis() at the given time
+ * 
+ * @details Used by init_time() and by restore_rtc_state() after a reset.
+ * 
+ * @callgraph
+ * 
+ * @callergraph
+ */
+void save_clock(uint32_t clock, int timezone, unsigned long offset){
+  // build json
+  json_document time_json(JSON_TIME_CAPACITY);
 
-  time_json["hours"] = hours;
-  time_json["minutes"] = minutes;
-  time_json["seconds"] = seconds;
-  time_json["weekday"] = weekday;
-  time_json["init_offset"] = millis();
+  time_json["hours"] = (clock % 86400) / 3600;
+  time_json["minutes"] = (clock % 3600) / 60;
+  time_json["seconds"] = clock % 60;
+  time_json["weekday"] = (clock / 86400) % 7;
+  time_json["init_offset"] = offset;
   time_json["last_offset"] = millis();
   time_json["timezone"] = timezone;
-  time_json.shrinkToFit();
 
-  // return json
-  save_json("/time.json", time_json);
-  return;
+  kv_save_json("time", time_json);
+}
+
+/**
+ * @brief Takes the measured drift out of a time measured with millis()
+ * 
+ * @param elapsed - time in ms measured with millis()
+ * 
+ * @return unsigned long - time in ms as NTP would have measured it
+ * 
+ * @details The drift is measured by rtc_set_clock() every time NTP corrects the clock. It is 0 until then.
+ * 
+ * @callgraph
+ * 
+ * @callergraph
+ */
+unsigned long correct_clock_drift(unsigned long elapsed){
+  return elapsed - (unsigned long)((int64_t)elapsed * get_clock_drift() / 1000000);
 }
 
 
@@ -379,28 +592,34 @@ void init_time(){
  * @brief Checks if millis() overflowed and updates time if necessary
  * 
  * @details Since millis() overflows after 49.7 days, this function checks if an overflow occured and updates 
- * the time saved in "time.json" every time it happens to still be able to calculate teh current time. 
+ * the saved time every time it happens to still be able to calculate teh current time. 
  * This function is used whenever long waiting times are expected (e.g. in timed programs, wait/skip 
  * command or user inactivity). It is important to note that this function has to be able to work offline 
  * (no NTP call) since it should be possible to run programs without internet connection.
+ * Without an overflow last_offset is only written once millis() advanced TIME_OFFSET_STEP since the
+ * saved one, which is enough to notice the next overflow.
  * 
  * @callgraph
  * 
  * @callergraph
  */
 void check_and_update_offset() {
+  metrics_scope scope(METRICS_TIME);
 
-  // load time from time.json
-  DynamicJsonDocument current_values = load_json("/time.json");
+  // load saved time
+  json_document current_values(JSON_TIME_CAPACITY);
+  kv_load_json("time", current_values);
 
   // get offsets
   unsigned long last_offset = current_values["last_offset"];
   unsigned long current_offset = millis();
 
-  // if no overflow occured update last_offset
+  // if no overflow occured update last_offset (only every TIME_OFFSET_STEP to save writes)
   if (current_offset > last_offset){
-    current_values["last_offset"] = current_offset;
-    save_json("/time.json", current_values);
+    if (current_offset - last_offset >= TIME_OFFSET_STEP) {
+      current_values["last_offset"] = current_offset;
+      kv_save_json("time", current_values);
+    }
     return;
   }
 
@@ -411,26 +630,24 @@ void check_and_update_offset() {
     unsigned long overflow_seconds = 4294967;
     unsigned long init_offset = current_values["init_offset"];
     unsigned long init_offset_seconds = init_offset/1000;
-    overflow_seconds = overflow_seconds - init_offset_seconds;
+    overflow_seconds = correct_clock_drift((overflow_seconds - init_offset_seconds) * 1000) / 1000;
     String overflow_time = turn_seconds_in_time(overflow_seconds);
 
     // turn initial time into string
-    DynamicJsonDocument init_values = load_json("/time.json");
-
-    String init_time = init_values["hours"].as<String>();
+    String init_time = current_values["hours"].as<String>();
     init_time += ":";
-    init_time += init_values["minutes"].as<String>();
+    init_time += current_values["minutes"].as<String>();
     init_time += ":";
-    init_time += init_values["seconds"].as<String>();
+    init_time += current_values["seconds"].as<String>();
     init_time += " ";
-    init_time += init_values["weekday"].as<String>();
+    init_time += current_values["weekday"].as<String>();
 
     // add overflow time to initial time (result is time at moment of overflow)
     String current_time = add_time(init_time, overflow_time);
 
     // calculate time since overflow
     unsigned long current_offset = millis();
-    unsigned long current_offset_seconds = current_offset/1000;
+    unsigned long current_offset_seconds = correct_clock_drift(current_offset) / 1000;
     String overflowed_time = turn_seconds_in_time(current_offset_seconds);
 
     // add overflowed time to time at moment of overflow (result is current time)
@@ -443,10 +660,9 @@ void check_and_update_offset() {
     current_values["weekday"] = current_time.substring(current_time.indexOf(" ") + 1).toInt();
     current_values["last_offset"] = current_offset;
     current_values["init_offset"] = current_offset;
-    current_values["timezone"] = current_values["timezone"];
 
     // save json
-    save_json("/time.json", current_values);
+    kv_save_json("time", current_values);
     return;
   }
   
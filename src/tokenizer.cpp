@@ -0,0 +1,285 @@
+/**
+ * @file tokenizer.cpp
+ * 
+ * @author Marc Ubbelohde
+ * 
+ * @brief In this file, the scanner for the lines of a program is defined.
+ * 
+ * @details A line is read once from left to right: the first word decides the command, then
+ * the expected tokens (integers, a time or a signal name) are read behind it. No memory is
+ * allocated and no character is looked at twice, so the run time only depends on the length of
+ * the line. When a token does not fit, the column and a description of the problem are returned.
+ * 
+ * Grammar (tokens are separated by exactly one space, spaces at the end of number commands
+ * are ignored):\n
+ * play name\n
+ * wait number\n
+ * skip number\n
+ * loop number | loop inf\n
+ * hh:mm:ss name\n
+ * weekday hh:mm:ss name (weekday in lower case or starting with an upper case letter)\n
+ * with name consisting of letters, digits, spaces, "-" and "_".
+ */
+
+#include "tokenizer.h"
+
+#include <string.h>
+
+/**
+ * @brief Names of the weekdays in lower case, index is the number of the weekday.
+ * 
+ */
+static const char *const TOKENIZER_WEEKDAYS[7] = {"sunday", "monday", "tuesday", "wednesday", "thursday", "friday", "saturday"};
+
+/**
+ * @brief Position in the line that is currently scanned.
+ * 
+ */
+struct tokenizer_state {
+  const char *line;
+  size_t length;
+  size_t pos;
+};
+
+static bool is_digit(char c) {
+  return c >= '0' && c <= '9';
+}
+
+static bool is_letter(char c) {
+  return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+}
+
+static bool is_space(char c) {
+  return c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == '\f' || c == '\v';
+}
+
+static bool is_name_char(char c) {
+  return is_letter(c) || is_digit(c) || is_space(c) || c == '-' || c == '_';
+}
+
+/**
+ * @brief Marks the line as invalid at the current position.
+ * 
+ * @return bool - always false (to be returned by the caller)
+ * 
+ */
+static bool tokenizer_fail(const tokenizer_state &state, program_line &result, const char *error) {
+  result.command = PROGRAM_INVALID;
+  result.error_column = state.pos + 1;
+  result.error = error;
+  return false;
+}
+
+/**
+ * @brief Reads the single space between two tokens.
+ * 
+ */
+static bool scan_separator(tokenizer_state &state, program_line &result) {
+  if (state.pos >= state.length || state.line[state.pos] != ' ') {
+    return tokenizer_fail(state, result, "expected a space");
+  }
+  state.pos++;
+  return true;
+}
+
+/**
+ * @brief Checks that only spaces follow until the end of the line.
+ * 
+ */
+static bool scan_end(tokenizer_state &state, program_line &result) {
+  while (state.pos < state.length && is_space(state.line[state.pos])) {
+    state.pos++;
+  }
+  if (state.pos < state.length) {
+    return tokenizer_fail(state, result, "unexpected character after the command");
+  }
+  return true;
+}
+
+/**
+ * @brief Reads a non-negative integer that fits into an unsigned long.
+ * 
+ */
+static bool scan_number(tokenizer_state &state, program_line &result) {
+  size_t start = state.pos;
+  unsigned long value = 0;
+
+  while (state.pos < state.length && is_digit(state.line[state.pos])) {
+    unsigned long digit = state.line[state.pos] - '0';
+    if (value > ((unsigned long)-1 - digit) / 10) {
+      state.pos = start;
+      return tokenizer_fail(state, result, "number is too large");
+    }
+    value = value * 10 + digit;
+    state.pos++;
+  }
+
+  if (state.pos == start) {
+    return tokenizer_fail(state, result, "expected a number");
+  }
+  result.number = value;
+  return true;
+}
+
+/**
+ * @brief Reads two digits with a value of at most max.
+ * 
+ */
+static bool scan_time_field(tokenizer_state &state, program_line &result, uint8_t max, uint8_t &field) {
+  if (state.pos + 1 >= state.length || !is_digit(state.line[state.pos]) || !is_digit(state.line[state.pos + 1])) {
+    return tokenizer_fail(state, result, "expected a time in the format hh:mm:ss");
+  }
+  uint8_t value = (state.line[state.pos] - '0') * 10 + (state.line[state.pos + 1] - '0');
+  if (value > max) {
+    return tokenizer_fail(state, result, "time is out of range");
+  }
+  field = value;
+  state.pos += 2;
+  return true;
+}
+
+/**
+ * @brief Reads a time in the format hh:mm:ss.
+ * 
+ */
+static bool scan_time(tokenizer_state &state, program_line &result) {
+  if (!scan_time_field(state, result, 23, result.hour)) {
+    return false;
+  }
+  if (state.pos >= state.length || state.line[state.pos] != ':') {
+    return tokenizer_fail(state, result, "expected a time in the format hh:mm:ss");
+  }
+  state.pos++;
+  if (!scan_time_field(state, result, 59, result.minute)) {
+    return false;
+  }
+  if (state.pos >= state.length || state.line[state.pos] != ':') {
+    return tokenizer_fail(state, result, "expected a time in the format hh:mm:ss");
+  }
+  state.pos++;
+  return scan_time_field(state, result, 59, result.second);
+}
+
+/**
+ * @brief Reads the name of a signal (rest of the line).
+ * 
+ */
+static bool scan_name(tokenizer_state &state, program_line &result) {
+  if (state.pos >= state.length) {
+    return tokenizer_fail(state, result, "expected a signal name");
+  }
+  result.name_start = state.pos;
+  while (state.pos < state.length) {
+    if (!is_name_char(state.line[state.pos])) {
+      return tokenizer_fail(state, result, "invalid character in signal name");
+    }
+    state.pos++;
+  }
+  result.name_length = state.pos - result.name_start;
+  return true;
+}
+
+/**
+ * @brief Compares a word of the line with a keyword in lower case.
+ * 
+ * @details The first letter of the word may also be upper case (e.g. "Monday").
+ * 
+ */
+static bool word_equals(const char *word, size_t length, const char *keyword, bool capital_allowed) {
+  if (strlen(keyword) != length) {
+    return false;
+  }
+  char first = word[0];
+  if (capital_allowed && first >= 'A' && first <= 'Z') {
+    first = first - 'A' + 'a';
+  }
+  return first == keyword[0] && memcmp(word + 1, keyword + 1, length - 1) == 0;
+}
+
+/**
+ * @brief Splits one line of a program into its tokens.
+ * 
+ * @param line - line to be scanned (does not have to be null terminated)
+ * 
+ * @param length - number of characters in the line
+ * 
+ * @param result - tokens of the line (see program_line)
+ * 
+ * @return bool - true if the line is a valid command or empty, false if not (error and error_column are set)
+ * 
+ * @details The line is scanned in a single pass without allocating memory. Lines that only
+ * contain spaces are returned as PROGRAM_EMPTY. Range checks that depend on the command
+ * (e.g. the maximum amount of days for "skip") are left to program_parser().
+ * 
+ * @callgraph
+ * 
+ * @callergraph
+ */
+bool tokenize_program_line(const char *line, size_t length, program_line &result) {
+
+  memset(&result, 0, sizeof(result));
+  tokenizer_state state = {line, length, 0};
+
+  // lines with only spaces are empty, otherwise the command has to start in the first column
+  while (state.pos < length && is_space(line[state.pos])) {
+    state.pos++;
+  }
+  if (state.pos == length) {
+    result.command = PROGRAM_EMPTY;
+    return true;
+  }
+  state.pos = 0;
+
+  // time command
+  if (is_digit(line[state.pos])) {
+    result.command = PROGRAM_TIME;
+    return scan_time(state, result) && scan_separator(state, result) && scan_name(state, result);
+  }
+
+  if (!is_letter(line[state.pos])) {
+    return tokenizer_fail(state, result, "unknown command");
+  }
+
+  // read keyword
+  size_t word_start = state.pos;
+  while (state.pos < length && is_letter(line[state.pos])) {
+    state.pos++;
+  }
+  const char *word = line + word_start;
+  size_t word_length = state.pos - word_start;
+
+  if (word_equals(word, word_length, "play", false)) {
+    result.command = PROGRAM_PLAY;
+    return scan_separator(state, result) && scan_name(state, result);
+  }
+  if (word_equals(word, word_length, "wait", false)) {
+    result.command = PROGRAM_WAIT;
+    return scan_separator(state, result) && scan_number(state, result) && scan_end(state, result);
+  }
+  if (word_equals(word, word_length, "skip", false)) {
+    result.command = PROGRAM_SKIP;
+    return scan_separator(state, result) && scan_number(state, result) && scan_end(state, result);
+  }
+  if (word_equals(word, word_length, "loop", false)) {
+    result.command = PROGRAM_LOOP;
+    if (!scan_separator(state, result)) {
+      return false;
+    }
+    if (state.pos + 3 <= length && memcmp(line + state.pos, "inf", 3) == 0) {
+      result.infinite = true;
+      state.pos += 3;
+      return scan_end(state, result);
+    }
+    return scan_number(state, result) && scan_end(state, result);
+  }
+  for (uint8_t day = 0; day < 7; day++) {
+    if (word_equals(word, word_length, TOKENIZER_WEEKDAYS[day], true)) {
+      result.command = PROGRAM_DAY;
+      result.weekday = day;
+      return scan_separator(state, result) && scan_time(state, result) && scan_separator(state, result) && scan_name(state, result);
+    }
+  }
+
+  state.pos = word_start;
+  return tokenizer_fail(state, result, "unknown command");
+}
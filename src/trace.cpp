@@ -0,0 +1,185 @@
+/**
+ * @file trace.cpp
+ * 
+ * @author Marc Ubbelohde
+ * 
+ * @brief In this file, the latency tracing is defined.
+ * 
+ * @details Every TRACE_SPAN writes one event with its start time and its duration in CPU cycles
+ * into a ring buffer when it goes out of scope. Reading the cycle counter takes only a few cycles
+ * so the hot paths can be measured without distorting them. The events are exported in the
+ * Chrome trace-event format ("complete" events) on /api/trace. Nothing in this file is compiled
+ * unless TRACE_ENABLED is set.
+ */
+
+#include "base.h"
+
+#if TRACE_ENABLED
+
+/**
+ * @brief Ring buffer of the last TRACE_EVENT_COUNT spans.
+ * 
+ */
+trace_event TRACE_EVENTS[TRACE_EVENT_COUNT];
+
+/**
+ * @brief Index where the next event is written to.
+ * 
+ */
+uint16_t TRACE_NEXT = 0;
+
+/**
+ * @brief Number of valid events in the ring buffer.
+ * 
+ */
+uint16_t TRACE_FILLED = 0;
+
+/**
+ * @brief Length of the buffer one event of the output is formatted in.
+ * 
+ */
+const size_t TRACE_LINE_LENGTH = 128;
+
+/**
+ * @brief Starts a span.
+ * 
+ * @param name - name of the span (string literal)
+ * 
+ * @callgraph This function does not call any other function.
+ * 
+ * @callergraph
+ */
+trace_span::trace_span(const char *name) : name(name) {
+  start_us = micros();
+  start_cycles = ESP.getCycleCount();
+}
+
+/**
+ * @brief Ends a span and writes it to the ring buffer.
+ * 
+ * @callgraph This function does not call any other function.
+ * 
+ * @callergraph
+ */
+trace_span::~trace_span() {
+  uint32_t cycles = ESP.getCycleCount() - start_cycles;
+
+  trace_event &event = TRACE_EVENTS[TRACE_NEXT];
+  event.name = name;
+  event.start_us = start_us;
+  event.end_us = micros();
+  event.cycles = cycles;
+
+  TRACE_NEXT = (TRACE_NEXT + 1) % TRACE_EVENT_COUNT;
+  if (TRACE_FILLED < TRACE_EVENT_COUNT) {
+    TRACE_FILLED++;
+  }
+}
+
+/**
+ * @brief Deletes all events.
+ * 
+ * @callgraph This function does not call any other function.
+ * 
+ * @callergraph
+ */
+void reset_trace() {
+  TRACE_NEXT = 0;
+  TRACE_FILLED = 0;
+}
+
+/**
+ * @brief Returns the number of valid events in the ring buffer.
+ * 
+ * @return uint16_t - number of events (at most TRACE_EVENT_COUNT)
+ * 
+ * @callgraph This function does not call any other function.
+ * 
+ * @callergraph
+ */
+uint16_t get_trace_event_count() {
+  return TRACE_FILLED;
+}
+
+/**
+ * @brief Returns an event from the ring buffer.
+ * 
+ * @param age - 0 for the newest event (the span that ended last), 1 for the one before and so on
+ * 
+ * @return trace_event - the event (name is NULL if there is no event of that age)
+ * 
+ * @callgraph This function does not call any other function.
+ * 
+ * @callergraph
+ */
+trace_event get_trace_event(uint16_t age) {
+  trace_event empty = {NULL, 0, 0, 0};
+  if (age >= TRACE_FILLED) {
+    return empty;
+  }
+  return TRACE_EVENTS[(TRACE_NEXT + TRACE_EVENT_COUNT - 1 - age) % TRACE_EVENT_COUNT];
+}
+
+/**
+ * @brief Calculates the longest span whose duration is taken from the cycle counter.
+ * 
+ * @param cycles_per_us - CPU frequency in MHz
+ * 
+ * @return uint32_t - longest span in microseconds
+ * 
+ * @details The cycle counter overflows after 2^32 cycles, the time that takes depends on the CPU
+ * frequency. TRACE_CYCLE_SPAN_MARGIN is kept to that overflow.
+ * 
+ * @callgraph This function does not call any other function.
+ * 
+ * @callergraph
+ */
+uint32_t trace_max_cycle_span(uint32_t cycles_per_us) {
+  return (uint32_t)((1ULL << 32) / cycles_per_us) - TRACE_CYCLE_SPAN_MARGIN;
+}
+
+/**
+ * @brief Writes all events in the Chrome trace-event format.
+ * 
+ * @param output - stream the JSON is written to (e.g. the client of the webserver)
+ * 
+ * @return size_t - number of written bytes
+ * 
+ * @details Every span becomes a complete event ("ph":"X") with start and duration in microseconds.
+ * Nested spans are shown below each other since they share one thread id. Format:\n
+ * {"traceEvents":[{"name":"send_signal","ph":"X","ts":123,"dur":45.250,"pid":1,"tid":1},...],"displayTimeUnit":"ms"}
+ * 
+ * @callgraph
+ * 
+ * @callergraph
+ */
+size_t print_trace_json(Print &output) {
+
+  size_t written = 0;
+  uint32_t cycles_per_us = ESP.getCpuFreqMHz();
+  uint32_t max_cycle_span = trace_max_cycle_span(cycles_per_us);
+  char line[TRACE_LINE_LENGTH];
+
+  written += output.print("{\"traceEvents\":[");
+  for (int age = TRACE_FILLED - 1; age >= 0; age--) {
+    trace_event event = get_trace_event(age);
+    // duration with three decimal places (nanoseconds) without using floats
+    uint64_t duration_ns = (uint64_t)event.cycles * 1000 / cycles_per_us;
+    if (event.end_us - event.start_us > max_cycle_span) {
+      duration_ns = (uint64_t)(event.end_us - event.start_us) * 1000;
+    }
+    // formatted on the stack, Print::printf() would allocate its buffer in the heap
+    snprintf(line, sizeof(line), "{\"name\":\"%s\",\"ph\":\"X\",\"ts\":%lu,\"dur\":%lu.%03lu,\"pid\":1,\"tid\":1}",
+             event.name, (unsigned long)event.start_us,
+             (unsigned long)(duration_ns / 1000), (unsigned long)(duration_ns % 1000));
+    written += output.print(line);
+    if (age > 0) {
+      written += output.print(",");
+    }
+  }
+  written += output.print("],\"displayTimeUnit\":\"ms\"}");
+
+  return written;
+}
+
+#endif  // TRACE_ENABLED
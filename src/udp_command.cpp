@@ -0,0 +1,376 @@
+/**
+ * @file udp_command.cpp
+ *
+ * @author Marc Ubbelohde
+ *
+ * @brief In this file, the binary UDP command protocol is defined.
+ *
+ * @details Triggering a signal over HTTP costs a TCP handshake, the argument parsing of the
+ * webserver, a redirect and a reload of the page. A command on the UDP port is a single datagram
+ * of at most UDP_MAX_PACKET bytes that is read from the background work and answered with a single
+ * acknowledgement. This file only reads and writes the packets (no memory is allocated), the
+ * commands are executed by handle_udp_commands() in main.cpp. Commands can be authenticated with
+ * a HMAC-SHA256 tag, SHA-256 is implemented here so the protocol also compiles on a computer.
+ */
+
+#include "udp_command.h"
+
+#include <string.h>
+
+/**
+ * @brief Round constants of SHA-256.
+ *
+ */
+static const uint32_t SHA256_K[64] = {
+  0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+  0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+  0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+  0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+  0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+  0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+  0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+  0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+/**
+ * @brief State of a SHA-256 calculation.
+ *
+ */
+struct sha256_context {
+  uint32_t state[8];
+  uint8_t block[64];
+  size_t block_length;
+  uint64_t total_length;
+};
+
+/**
+ * @brief Rotates a word to the right.
+ *
+ * @callgraph This function does not call any other function.
+ *
+ * @callergraph
+ */
+static inline uint32_t rotate_right(uint32_t value, uint8_t bits) {
+  return (value >> bits) | (value << (32 - bits));
+}
+
+/**
+ * @brief Processes one block of 64 bytes.
+ *
+ * @param context - state of the calculation
+ *
+ * @callgraph This function does not call any other function.
+ *
+ * @callergraph
+ */
+static void sha256_block(sha256_context &context) {
+  uint32_t w[64];
+  for (uint8_t i = 0; i < 16; i++) {
+    w[i] = ((uint32_t)context.block[i * 4] << 24) | ((uint32_t)context.block[i * 4 + 1] << 16) |
+           ((uint32_t)context.block[i * 4 + 2] << 8) | context.block[i * 4 + 3];
+  }
+  for (uint8_t i = 16; i < 64; i++) {
+    uint32_t s0 = rotate_right(w[i - 15], 7) ^ rotate_right(w[i - 15], 18) ^ (w[i - 15] >> 3);
+    uint32_t s1 = rotate_right(w[i - 2], 17) ^ rotate_right(w[i - 2], 19) ^ (w[i - 2] >> 10);
+    w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+  }
+
+  uint32_t a = context.state[0], b = context.state[1], c = context.state[2], d = context.state[3];
+  uint32_t e = context.state[4], f = context.state[5], g = context.state[6], h = context.state[7];
+  for (uint8_t i = 0; i < 64; i++) {
+    uint32_t t1 = h + (rotate_right(e, 6) ^ rotate_right(e, 11) ^ rotate_right(e, 25)) + ((e & f) ^ (~e & g)) + SHA256_K[i] + w[i];
+    uint32_t t2 = (rotate_right(a, 2) ^ rotate_right(a, 13) ^ rotate_right(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+    h = g;
+    g = f;
+    f = e;
+    e = d + t1;
+    d = c;
+    c = b;
+    b = a;
+    a = t1 + t2;
+  }
+
+  context.state[0] += a;
+  context.state[1] += b;
+  context.state[2] += c;
+  context.state[3] += d;
+  context.state[4] += e;
+  context.state[5] += f;
+  context.state[6] += g;
+  context.state[7] += h;
+}
+
+/**
+ * @brief Starts a SHA-256 calculation.
+ *
+ * @param context - state of the calculation
+ *
+ * @callgraph This function does not call any other function.
+ *
+ * @callergraph
+ */
+static void sha256_begin(sha256_context &context) {
+  static const uint32_t initial[8] = {
+    0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+  };
+  memcpy(context.state, initial, sizeof(initial));
+  context.block_length = 0;
+  context.total_length = 0;
+}
+
+/**
+ * @brief Adds data to a SHA-256 calculation.
+ *
+ * @param context - state of the calculation
+ *
+ * @param data - data
+ *
+ * @param length - length of the data
+ *
+ * @callgraph
+ *
+ * @callergraph
+ */
+static void sha256_add(sha256_context &context, const uint8_t *data, size_t length) {
+  context.total_length += length;
+  while (length > 0) {
+    size_t chunk = 64 - context.block_length;
+    if (chunk > length) {
+      chunk = length;
+    }
+    memcpy(context.block + context.block_length, data, chunk);
+    context.block_length += chunk;
+    data += chunk;
+    length -= chunk;
+    if (context.block_length == 64) {
+      sha256_block(context);
+      context.block_length = 0;
+    }
+  }
+}
+
+/**
+ * @brief Ends a SHA-256 calculation.
+ *
+ * @param context - state of the calculation
+ *
+ * @param digest - 32 bytes the hash is written to
+ *
+ * @callgraph
+ *
+ * @callergraph
+ */
+static void sha256_end(sha256_context &context, uint8_t *digest) {
+  uint64_t bits = context.total_length * 8;
+
+  // padding: one bit, zeros and the length in bits
+  context.block[context.block_length++] = 0x80;
+  if (context.block_length > 56) {
+    memset(context.block + context.block_length, 0, 64 - context.block_length);
+    sha256_block(context);
+    context.block_length = 0;
+  }
+  memset(context.block + context.block_length, 0, 56 - context.block_length);
+  for (uint8_t i = 0; i < 8; i++) {
+    context.block[56 + i] = (uint8_t)(bits >> (56 - i * 8));
+  }
+  sha256_block(context);
+
+  for (uint8_t i = 0; i < 8; i++) {
+    digest[i * 4] = (uint8_t)(context.state[i] >> 24);
+    digest[i * 4 + 1] = (uint8_t)(context.state[i] >> 16);
+    digest[i * 4 + 2] = (uint8_t)(context.state[i] >> 8);
+    digest[i * 4 + 3] = (uint8_t)context.state[i];
+  }
+}
+
+/**
+ * @brief Calculates the HMAC-SHA256 of data (RFC 2104).
+ *
+ * @param key - key
+ *
+ * @param key_length - length of the key
+ *
+ * @param data - data
+ *
+ * @param length - length of the data
+ *
+ * @param digest - 32 bytes the HMAC is written to
+ *
+ * @callgraph
+ *
+ * @callergraph
+ */
+void hmac_sha256(const uint8_t *key, size_t key_length, const uint8_t *data, size_t length, uint8_t *digest) {
+  uint8_t block_key[64] = {0};
+  sha256_context context;
+
+  // keys longer than a block are hashed first
+  if (key_length > 64) {
+    sha256_begin(context);
+    sha256_add(context, key, key_length);
+    sha256_end(context, block_key);
+  }
+  else {
+    memcpy(block_key, key, key_length);
+  }
+
+  uint8_t pad[64];
+  for (uint8_t i = 0; i < 64; i++) {
+    pad[i] = block_key[i] ^ 0x36;
+  }
+  uint8_t inner[32];
+  sha256_begin(context);
+  sha256_add(context, pad, 64);
+  sha256_add(context, data, length);
+  sha256_end(context, inner);
+
+  for (uint8_t i = 0; i < 64; i++) {
+    pad[i] = block_key[i] ^ 0x5c;
+  }
+  sha256_begin(context);
+  sha256_add(context, pad, 64);
+  sha256_add(context, inner, 32);
+  sha256_end(context, digest);
+}
+
+/**
+ * @brief Writes the header of a packet (see udp_command.h).
+ *
+ * @callgraph This function does not call any other function.
+ *
+ * @callergraph
+ */
+static void write_udp_header(uint8_t *packet, uint8_t flags, uint32_t sequence, uint8_t type, uint8_t length) {
+  packet[0] = 'I';
+  packet[1] = 'R';
+  packet[2] = UDP_COMMAND_VERSION;
+  packet[3] = flags;
+  packet[4] = (uint8_t)(sequence >> 24);
+  packet[5] = (uint8_t)(sequence >> 16);
+  packet[6] = (uint8_t)(sequence >> 8);
+  packet[7] = (uint8_t)sequence;
+  packet[8] = type;
+  packet[9] = length;
+}
+
+/**
+ * @brief Reads and checks a command.
+ *
+ * @param packet - received datagram
+ *
+ * @param size - length of the datagram
+ *
+ * @param key - key of the tag (NULL or key_length 0 if commands are not authenticated)
+ *
+ * @param key_length - length of the key
+ *
+ * @param command - the command (the payload points into packet)
+ *
+ * @return udp_status - UDP_OK, UDP_BAD_PACKET if the packet is not a valid command or
+ * UDP_UNAUTHORIZED if a key is set and the tag is missing or wrong
+ *
+ * @details The sequence number is not checked here, since that needs the last accepted one.
+ * The tag is compared in constant time.
+ *
+ * @callgraph
+ *
+ * @callergraph
+ */
+udp_status parse_udp_command(const uint8_t *packet, size_t size, const uint8_t *key, size_t key_length, udp_command &command) {
+  if (size < UDP_HEADER_LENGTH || packet[0] != 'I' || packet[1] != 'R' || packet[2] != UDP_COMMAND_VERSION) {
+    return UDP_BAD_PACKET;
+  }
+
+  command.flags = packet[3];
+  command.sequence = ((uint32_t)packet[4] << 24) | ((uint32_t)packet[5] << 16) | ((uint32_t)packet[6] << 8) | packet[7];
+  command.type = packet[8];
+  command.length = packet[9];
+  command.payload = packet + UDP_HEADER_LENGTH;
+
+  size_t tag_length = (command.flags & UDP_FLAG_TAG) ? UDP_TAG_LENGTH : 0;
+  if ((command.flags & UDP_FLAG_ACK) || command.length > UDP_MAX_PAYLOAD || size != UDP_HEADER_LENGTH + command.length + tag_length) {
+    return UDP_BAD_PACKET;
+  }
+
+  if (key == NULL || key_length == 0) {
+    return UDP_OK;
+  }
+  if (tag_length == 0) {
+    return UDP_UNAUTHORIZED;
+  }
+
+  uint8_t digest[32];
+  hmac_sha256(key, key_length, packet, UDP_HEADER_LENGTH + command.length, digest);
+  uint8_t difference = 0;
+  for (uint8_t i = 0; i < UDP_TAG_LENGTH; i++) {
+    difference |= digest[i] ^ packet[UDP_HEADER_LENGTH + command.length + i];
+  }
+  return difference == 0 ? UDP_OK : UDP_UNAUTHORIZED;
+}
+
+/**
+ * @brief Writes a command (used by the tests and the load generator).
+ *
+ * @param command - command, the tag is added if key is set
+ *
+ * @param key - key of the tag (NULL or key_length 0 for no tag)
+ *
+ * @param key_length - length of the key
+ *
+ * @param packet - buffer of at least UDP_MAX_PACKET bytes
+ *
+ * @return size_t - length of the datagram (0 if the payload is too long)
+ *
+ * @callgraph
+ *
+ * @callergraph
+ */
+size_t build_udp_command(const udp_command &command, const uint8_t *key, size_t key_length, uint8_t *packet) {
+  if (command.length > UDP_MAX_PAYLOAD) {
+    return 0;
+  }
+
+  bool tag = key != NULL && key_length > 0;
+  write_udp_header(packet, tag ? UDP_FLAG_TAG : 0, command.sequence, command.type, command.length);
+  memcpy(packet + UDP_HEADER_LENGTH, command.payload, command.length);
+  size_t size = UDP_HEADER_LENGTH + command.length;
+
+  if (tag) {
+    uint8_t digest[32];
+    hmac_sha256(key, key_length, packet, size, digest);
+    memcpy(packet + size, digest, UDP_TAG_LENGTH);
+    size += UDP_TAG_LENGTH;
+  }
+  return size;
+}
+
+/**
+ * @brief Writes the acknowledgement of a command.
+ *
+ * @param command - command that is acknowledged (sequence number and command are copied)
+ *
+ * @param status - result of the command
+ *
+ * @param message - message of the action (cut to UDP_MAX_PAYLOAD), NULL for none
+ *
+ * @param packet - buffer of at least UDP_MAX_PACKET bytes
+ *
+ * @return size_t - length of the datagram
+ *
+ * @callgraph
+ *
+ * @callergraph
+ */
+size_t build_udp_ack(const udp_command &command, udp_status status, const char *message, uint8_t *packet) {
+  size_t length = message == NULL ? 0 : strlen(message);
+  if (length > UDP_MAX_PAYLOAD) {
+    length = UDP_MAX_PAYLOAD;
+  }
+
+  write_udp_header(packet, UDP_FLAG_ACK, command.sequence, command.type, (uint8_t)status);
+  if (length > 0) {
+    memcpy(packet + UDP_HEADER_LENGTH, message, length);
+  }
+  return UDP_HEADER_LENGTH + length;
+}
@@ -12,6 +12,12 @@
 
 #include "workflows.h"
 
+/**
+ * @brief Line the played program continues at after a reset (0 if it starts at the beginning).
+ * 
+ */
+int PROGRAM_RESUME_LINE = 0;
+
 /**
  * @brief This function deletes a file from the LittleFS filesystem.
  * 
@@ -28,6 +34,23 @@
  * @callergraph 
  */
 String deleting_workflow(String directory, String name) {
+  action_status status;
+  return(deleting_workflow(directory, name, status));
+}
+
+/**
+ * @brief This function deletes a file from the LittleFS filesystem.
+ * 
+ * @param directory - "signals" or "programs"
+ * @param name - name of the sequence or program to be deleted
+ * @param status - set to ACTION_OK or ACTION_NOT_FOUND
+ * @return String - message of deleting_workflow(directory, name)
+ * 
+ * @callgraph This function does not call other functions.
+ * 
+ * @callergraph 
+ */
+String deleting_workflow(String directory, String name, action_status &status) {
   
   // generate filename
   String filename = "/" + directory + "/" + name + ".json";
@@ -40,17 +63,20 @@ String deleting_workflow(String directory, String name) {
   if(LittleFS.exists(filename)){
     LittleFS.remove(filename);
     LittleFS.end();
+    status = ACTION_OK;
     return("successfully deleted " + directory + ": " + name);
   }
 
   if(LittleFS.exists(filename2)){
     LittleFS.remove(filename2);
     LittleFS.end();
+    status = ACTION_OK;
     return("successfully deleted " + directory + ": " + name);
   }
 
   // return error message if file was not found
   LittleFS.end();
+  status = ACTION_NOT_FOUND;
   return("could not find " + directory + ": " + name);
 }
 
@@ -71,31 +97,69 @@ String deleting_workflow(String directory, String name) {
  * @callergraph
  */
 String recording_workflow(String signal_name) {
-  
-  // receive signal sequence
-  String raw_sequence = capture_signal();
+  action_status status;
+  return(recording_workflow(signal_name, status));
+}
 
-  // return error message if no signal was captured
-  if (raw_sequence == "no_signal"){
-    return("failed to record signal");
+/**
+ * @brief This function records and saves a signal.
+ * 
+ * @param signal_name - name of the sequence to be recorded
+ * 
+ * @param status - set to ACTION_OK, ACTION_BUSY or ACTION_FAILED
+ * 
+ * @return String - message of recording_workflow(signal_name)
+ * 
+ * @details Only one capture can run at a time since all captures share one IR-Receiver (see
+ * start_receiver()). While a learning session or another job runs the recording is refused.
+ * 
+ * @callgraph
+ * 
+ * @callergraph
+ */
+String recording_workflow(String signal_name, action_status &status) {
+
+  // the receiver is used by the learning session (or another job runs)
+  String busy;
+  if (job_busy(busy) || get_learning_session().active) {
+    status = ACTION_BUSY;
+    if (busy == "") {
+      busy = "learning session is still running";
+    }
+    return("Error: " + busy);
   }
-  Serial.println(raw_sequence);
+
+  job_scope job(JOB_CAPTURE);
 
   // remove spaces at the end of the signal name
-  while(signal_name.lastIndexOf(" ") == signal_name.length() - 1){
+  while(signal_name.endsWith(" ")){
     signal_name.remove(signal_name.length() - 1);
   }
 
-  // save signal to file
-  String message = save_signal(raw_sequence, signal_name);
+  // receive signal and save it to file
+  String message = capture_signal(signal_name);
+
+  // return error message if no signal was captured
+  if (message == "no_signal"){
+    status = ACTION_FAILED;
+    return("failed to record signal");
+  }
+
+  // return error message if the user canceled the capture
+  if (message == "canceled"){
+    status = ACTION_FAILED;
+    return("recording was canceled by the user.");
+  }
 
   // return success message if signal was saved
   if (message == "success"){
+    status = ACTION_OK;
     return("successfully recorded signal: " + signal_name);
   }
 
   // return error message if signal could not be saved
   else {
+    status = ACTION_FAILED;
     return(message);
   }
 }
@@ -116,25 +180,50 @@ String recording_workflow(String signal_name) {
  * @callergraph
  */
 String sending_workflow(String signal_name) {
+  action_status status;
+  return(sending_workflow(signal_name, status));
+}
+
+/**
+ * @brief This function loads a signal from a file and sends it.
+ * 
+ * @param signal_name - name of the sequence to be sent
+ * 
+ * @param status - set to ACTION_OK, ACTION_NOT_FOUND or ACTION_FAILED
+ * 
+ * @return String - message of sending_workflow(signal_name)
+ * 
+ * @callgraph
+ * 
+ * @callergraph
+ */
+String sending_workflow(String signal_name, action_status &status) {
+  TRACE_SPAN("sending_workflow");
+  job_scope job(JOB_SEND);
+
   // generate filename
   String filename = "/signals/" + signal_name + ".json";
 
   // check if file exists
   if (check_if_file_exists(filename) == false) {
+    status = ACTION_NOT_FOUND;
     return("could not find signal: " + signal_name);
   }
 
   // load signal from file
-  DynamicJsonDocument doc = load_json(filename);
+  json_document doc(JSON_FILE_CAPACITY);
+  load_json(filename, doc);
 
   // send signal
 
   String message = send_signal(doc);
 
-  if (message.indexOf("success") != -1) {
+  if (message == "success") {
+    status = ACTION_OK;
     return("successfully sent signal: " + signal_name);
   }
   else {
+    status = ACTION_FAILED;
     return(message);
   }
 }
@@ -157,6 +246,26 @@ String sending_workflow(String signal_name) {
  * @callergraph
  */
 String adding_workflow(String program_name, String program_code) {
+  action_status status;
+  return(adding_workflow(program_name, program_code, status));
+}
+
+/**
+ * @brief This function creates a file with the programs name and writes the code to it.
+ * 
+ * @param program_name - name of the program to be added
+ * 
+ * @param program_code - code of the program to be added
+ * 
+ * @param status - set to ACTION_OK or ACTION_FAILED
+ * 
+ * @return String - message of adding_workflow(program_name, program_code)
+ * 
+ * @callgraph
+ * 
+ * @callergraph
+ */
+String adding_workflow(String program_name, String program_code, action_status &status) {
 
   // generate filename
   String filename = "/programs/" + program_name + ".txt";
@@ -164,26 +273,29 @@ String adding_workflow(String program_name, String program_code) {
   // start filesystem
   LittleFS.begin();
 
-  // check if file exists and delete if found (to overwrite old file)
-  if (LittleFS.exists(filename)) {
-    LittleFS.remove(filename);
-  }
-
-  // create or recreate file
-  File myfile = LittleFS.open(filename, "w");
+  // write to a temporary file that replaces the old file (a reset while writing keeps the old file)
+  File myfile = LittleFS.open(REPLACE_TEMP_FILE, "w");
   
   // return error message if file could not be created
   if (!myfile) {
     myfile.close();
     LittleFS.end();
+    status = ACTION_FAILED;
     return("failed to create file");
   }
 
   // write code to file
-  myfile.write(program_code.c_str());
+  size_t written = myfile.write(program_code.c_str());
   myfile.close();
+  if (written != program_code.length() || LittleFS.rename(REPLACE_TEMP_FILE, filename) == false) {
+    LittleFS.remove(REPLACE_TEMP_FILE);
+    LittleFS.end();
+    status = ACTION_FAILED;
+    return("failed to write file");
+  }
   LittleFS.end();
 
+  status = ACTION_OK;
   return("successfully saved program: " + program_name);
 }
 
@@ -205,6 +317,28 @@ String adding_workflow(String program_name, String program_code) {
  * @callergraph
  */
 String playing_workflow(String program_name) {
+  return(playing_workflow(program_name, 0));
+}
+
+/**
+ * @brief This function loads a program from a file and hands it to the program_parser.
+ * 
+ * @param program_name - name of the program to be played
+ * 
+ * @param resume_line - line the program continues at (0 to start at the beginning)
+ * 
+ * @return String - message of playing_workflow(program_name)
+ * 
+ * @details Used to continue a program that was running before a reset (see restore_rtc_state()).
+ * The commands before resume_line are skipped, the command in resume_line is executed again
+ * since it may not have finished. Loops that contain resume_line are entered and count their
+ * iterations from the beginning.
+ * 
+ * @callgraph
+ * 
+ * @callergraph
+ */
+String playing_workflow(String program_name, int resume_line) {
 
   // generate filename
   String filename = "/programs/" + program_name + ".txt";
@@ -218,8 +352,12 @@ String playing_workflow(String program_name) {
   String programcode = read_program(program_name);
   programcode += " \n";
 
-  // hand program to parser and catch error message
+  // hand program to parser and catch error message (LED flashes while the program runs)
+  led_state previous_led_state = led_set_state(LED_PROGRAM_RUNNING);
+  PROGRAM_RESUME_LINE = resume_line;
   String message = program_parser(programcode);
+  PROGRAM_RESUME_LINE = 0;
+  led_set_state(previous_led_state);
   
   // return error message if error occured
   if (message.indexOf("success") == -1){
@@ -236,114 +374,117 @@ String playing_workflow(String program_name) {
  * 
  * @param code - code of the program to be parsed
  * 
+ * @return String - message of program_parser(code, 1)
+ * 
+ * @callgraph
+ * 
+ * @callergraph
+ */
+String program_parser(String code){
+  return(program_parser(code, 1));
+}
+
+/**
+ * @brief This function parses the code of a program line by line and executes the commands.
+ * 
+ * @param code - code of the program to be parsed
+ * 
+ * @param first_line - number of the first line of code in the program (for the loop code)
+ * 
  * @return String - message that will be displayed on the webpage:\n
  * "success message" - if program was played successfully\n
  * "error message" - if in one of the commands an error occured an command specific error message is returned
  * 
  * @details This function parses the code of a program line by line and executes the commands.
  * It was necessary to split the parser from the playing_workflow function to be able
- * to call it recursively (for loops). Each line is searched for command specific keywords
- * and the corresponding command handler is called.
+ * to call it recursively (for loops). Each line is split into tokens by tokenize_program_line()
+ * and the corresponding command handler is called. Invalid lines are reported with the column
+ * of the first character that could not be read. The current line and loop iteration are
+ * published as job events.
  * 
  * @callgraph
  * 
  * @callergraph
  */
-String program_parser(String code){
+String program_parser(String code, int first_line){
+  metrics_scope scope(METRICS_PARSER);
 
   // initialize variables
   String line = "";
   String error_message = "success";
-  String command = "invalid";
-  
-  // declare matchstate for regex
-  MatchState REGEX;
+  program_line tokens;
+  int line_number = first_line - 1;
+  uint16_t job_id = get_current_job().id;
 
   // loop through code line by line (until no more newlines are found)
   while (code.indexOf("\n") != -1){
+    TRACE_SPAN("program_parser_step");
+
+    // stop if the user pressed the interrupt button or canceled the program
+    if (job_cancelled() == true) {
+      return("program was canceled by the user.");
+    }
+
     // get current line and remaining code
     line = code.substring(0, code.indexOf("\n") - 1);
     code = code.substring(code.indexOf("\n") + 1);    
-
-    // check with regex which command was found
-    char * line_as_char_array = (char *)line.c_str();
-    REGEX.Target(line_as_char_array);
-
-    // check which command was found
-    if (REGEX.Match("play [a-zA-Z0-9\\s\\-\\_]+") == REGEXP_MATCHED){
-      command = "play";
-    }
-    else if (REGEX.Match("wait [0-9]+") == REGEXP_MATCHED){
-      command = "wait";
-    }
-    else if (REGEX.Match("^(0[0-9]|1[0-9]|2[0-3]):[0-5][0-9]:[0-5][0-9] [a-zA-Z0-9\\s\\-\\_]+") == REGEXP_MATCHED){
-      command = "time";
-    }
-    else if (REGEX.Match("^(monday|tuesday|wednesday|thursday|friday|saturday|sunday|Monday|Tuesday|Wednesday|Thursday|Friday|Saturday|Sunday) (0[0-9]|1[0-9]|2[0-3]):[0-5][0-9]:[0-5][0-9] [a-zA-Z0-9\\s\\-\\_]+") == REGEXP_MATCHED){
-      command = "day";
-    }
-    else if (REGEX.Match("skip [0-9]+") == REGEXP_MATCHED){
-      command = "skip";
-    }
-    else if (REGEX.Match("loop [0-9]+") == REGEXP_MATCHED || REGEX.Match("loop inf") == REGEXP_MATCHED){
-      command = "loop";
+    line_number++;
+
+    // lines before the line the program was at before a reset are skipped
+    boolean skip = line_number < PROGRAM_RESUME_LINE;
+    if (skip == false) {
+      PROGRAM_RESUME_LINE = 0;
+      rtc_set_program_line(line_number);
+      publish_event(EVENT_JOB, PSTR("{\"job\":%u,\"line\":%d}"), job_id, line_number);
     }
-    else if (line == ""){ // TODO: check why regex didnt work
-      command = "empty";
+
+    // split line into tokens and check which command was found
+    if (tokenize_program_line(line.c_str(), line.length(), tokens) == false) {
+      error_message = "invalid command: " + line + " (column " + String(tokens.error_column) + ": " + tokens.error + ")";
     }
-    else {
-      error_message = "invalid command: " + line;
-      command = "invalid";
+
+    // only loops are read while skipping (the line may be inside of them)
+    if (skip == true && tokens.command != PROGRAM_LOOP) {
+      error_message = "success";
+      continue;
     }
 
-    if (command != "invalid"){
+    if (tokens.command != PROGRAM_INVALID){
 
       // play command was found
-      if (command == "play"){
+      if (tokens.command == PROGRAM_PLAY){
         // slice command name from line
-        String command_name = line.substring(5);
+        String command_name = line.substring(tokens.name_start);
 
         // send signal
         error_message = sending_workflow(command_name);
 
-        Serial.println("-");
+        LOG_DEBUG("play %s: %s", command_name.c_str(), error_message.c_str());
       }
       
       // wait command was found
-      else if (command == "wait"){
-        // slice delay time from line
-        String delay_time = line.substring(5);
-        // typecast
-        unsigned long delay_time_long = atol(delay_time.c_str());
-        // check if number is not too high
-        if (delay_time_long == 0 && delay_time != "0"){
-          error_message = "invalid delay time";
-        }
-        else {
-          // wait for delay time
-          error_message = handle_wait_command(delay_time_long);
-        }
+      else if (tokens.command == PROGRAM_WAIT){
+        // wait for delay time
+        error_message = handle_wait_command(tokens.number);
       }
 
       // time command was found
-      else if (command == "time") {
+      else if (tokens.command == PROGRAM_TIME) {
         // whole line is passed to handler
         String time_command = line;
         error_message = handle_times_commands(time_command, false);
       }
 
       // day command was found
-      else if (command == "day") {
+      else if (tokens.command == PROGRAM_DAY) {
         // whole line is passed to handler
         String day_command = line;
         error_message = handle_times_commands(day_command, true);
       }
 
       // skip command was found
-      else if (command == "skip") {
-        // slice days from line
-        String skip_days = line.substring(5);
-        unsigned long days = atoi(skip_days.c_str());
+      else if (tokens.command == PROGRAM_SKIP) {
+        unsigned long days = tokens.number;
 
         // check if amount of days is valid (49 days in ms is limit for unsigned long)
         if (days == 0) {
@@ -365,10 +506,7 @@ String program_parser(String code){
       // after loop is executed, the part after the loop is given back to method
 
       // loop command was found
-      else if (command == "loop") {
-        // slice loop time from line
-        String loop_time = line.substring(5);
-        
+      else if (tokens.command == PROGRAM_LOOP) {
         // track loop lines
         int loop_counter = 1;
 
@@ -378,12 +516,16 @@ String program_parser(String code){
         // variable for loop code
         String loop_code = "";
 
+        // the loop code starts in the line after the loop command
+        int loop_line_number = line_number;
+
         // go through lines and find end of loop by adding 1 to loop_counter for every loop and 
         // subtracting 1 for every end if the counter reches 0, the end of the loop was found
         while(loop_counter != 0) {
           // update loop line and remaining code
           loop_line = code.substring(0, code.indexOf("\n"));
           code = code.substring(code.indexOf("\n") + 1);
+          line_number++;
 
           // check if "loop" or "end" was found and adjust counter
           if (loop_line.indexOf("loop") == 0) {
@@ -399,11 +541,18 @@ String program_parser(String code){
           }
         }
 
+        // the program was after the loop before the reset
+        if (line_number < PROGRAM_RESUME_LINE) {
+          continue;
+        }
+
         // loop is repeated indefinitely
-        if (loop_time == "inf") {
-          while(true) {
+        if (tokens.infinite == true) {
+          for (unsigned long i = 1; ; i++) {
+            publish_event(EVENT_JOB, PSTR("{\"job\":%u,\"line\":%d,\"iteration\":%lu,\"iterations\":0}"), job_id, loop_line_number, i);
+
             // execute loop code with parser indefinitely
-            error_message = program_parser(loop_code);
+            error_message = program_parser(loop_code, loop_line_number + 1);
 
             // check for error since end of this parser is not reached
             if (error_message.indexOf("success") == -1) {
@@ -414,13 +563,13 @@ String program_parser(String code){
 
         // loop is repeated a certain amount of times
         else {
-          // convert loop time to unsigned long
-          unsigned long loop_time_long = atol(loop_time.c_str());
-
-          // loop is repeated the given amount of times
+          // loop is repeated the given amount of times (copied since tokens is overwritten by the lines of the loop)
+          unsigned long loop_time_long = tokens.number;
           for (unsigned long i = 0; i < loop_time_long; i++) {
+            publish_event(EVENT_JOB, PSTR("{\"job\":%u,\"line\":%d,\"iteration\":%lu,\"iterations\":%lu}"), job_id, loop_line_number, i + 1, loop_time_long);
+
             // code is passed again to parser and checked for errors
-            error_message = program_parser(loop_code);
+            error_message = program_parser(loop_code, loop_line_number + 1);
             if (error_message.indexOf("success") == -1) {
               return(error_message);
             }
@@ -448,10 +597,9 @@ String program_parser(String code){
  *                "error message" - if command was interrupted by the user
  * 
  * @details This function waits a certain amount of time. It is used for the wait and skip command.
- *         It is necessary to check beforehand if a millis() overflow will occur during the waiting time.
- *        If an overflow will occur, the function will first calculate the time it will have to
- *       wait after the overflow occurs, then it will wait until the overflow occurs and waits
- *      the remaining time. The function also checks if the user pressed the interrupt button.
+ *         The time is slept with job_sleep(), which measures it over a millis() overflow and ends
+ *        early if the user pressed the interrupt button or canceled the program on /api/jobs/{id}/cancel.
+ *       Afterwards the time is checked for a millis() overflow that occurred while waiting.
  * 
  * @callgraph
  * 
@@ -459,53 +607,13 @@ String program_parser(String code){
  */
 String handle_wait_command(unsigned long waiting_time) {
 
-  // initialize variables:
-  unsigned long time_now = millis();
-  const int Interrupt_Button = 12;
-  pinMode(Interrupt_Button, INPUT_PULLUP);
-
-  // check if overflow will occur (if yes:)
-  if (time_now + waiting_time < time_now) {
-    Serial.println("overflow will occur in wait command");
-
-    // calculate time to wait after overflow
-    unsigned long extra_wait = time_now + waiting_time;
-
-    // wait for overflow to occur (buffer of 1s not to miss it)
-    while(millis() > 1000) {
-      // update time
-      check_and_update_offset();
-
-      // check if user pressed interrupt button
-      if (digitalRead(Interrupt_Button) == LOW) {
-        return("program was canceled by the user.");
-      }
-    }
-
-    // wait the extra time (after overflow)
-    while(millis() < extra_wait){
-      // update time
-      check_and_update_offset();
-
-      // check if user pressed interrupt button
-      if (digitalRead(Interrupt_Button) == LOW) {
-        return("program was canceled by the user.");
-      }
-    }
+  // sleep the given time
+  if (job_sleep(waiting_time) == false) {
+    return("program was canceled by the user.");
   }
 
-  // no overflow will occur
-  else{
-    // wait the given time
-    while(millis() < time_now + waiting_time){
-      check_and_update_offset(); // no trusting my own code haha
-
-      // check if user pressed interrupt button
-      if (digitalRead(Interrupt_Button) == LOW) {
-        return("program was canceled by the user.");
-      }
-    }
-  }
+  // update time
+  check_and_update_offset();
   return("success");
 }
 
@@ -522,6 +630,8 @@ String handle_wait_command(unsigned long waiting_time) {
  *                "success message" - if command was executed successfully\n
  * 
  * @details This function waits until a certain day and/or time is reached and then executes the given signal.
+ *         The time is checked between job_sleep() slices, so the requests are still handled while it waits
+ *        and the wait ends early if the program is canceled.
  * 
  * @callgraph
  * 
@@ -533,8 +643,6 @@ String handle_times_commands(String command, boolean day_included) {
   String day = "";
   String command_name = "";
   String timestamp = "";
-  const int Interrupt_Button = 12;
-  pinMode(Interrupt_Button, INPUT_PULLUP);
   
   // input command format: "day hh:mm:ss command_name" (day command)
   if (day_included == true) {
@@ -579,12 +687,9 @@ String handle_times_commands(String command, boolean day_included) {
     return("signal in command " + command + " not found");
   }
 
-  // loop waits for day and/or time to be reached or button to be pressed
-  while(true) {
-    if (compare_time(timestamp, day_included) == true) {
-      break;
-    }
-    if (digitalRead(Interrupt_Button) == LOW) {
+  // sleep in slices until the day and/or time is reached or the program is canceled
+  while (compare_time(timestamp, day_included) == false) {
+    if (job_sleep(JOB_SLEEP_SLICE) == false) {
       return("program was canceled by the user.");
     }
   }